@@ -0,0 +1,555 @@
+/*
+  SPDX-FileCopyrightText: 2023 Junde Yhi <junde@yhi.moe>
+  SPDX-License-Identifier: MIT
+*/
+
+/*!
+  \file
+  \brief TinyWoT Core CBOR writer and reader.
+
+  A small CBOR (RFC 8949) writer and pull reader on top of
+  `tinywot_payload`. Like the JSON writer, they work in place, without
+  any dynamic memory allocation, and errors are sticky: once an
+  operation has failed, all further operations are ignored and return
+  the same status, so `tinywot_cbor_writer::status` or
+  `tinywot_cbor_reader::status` only needs to be checked once at the
+  end. A failed write leaves the payload as it was before that write; a
+  failed read does not move the reader.
+
+  Only definite-length items are supported. Arrays and maps are written
+  with the number of their elements up front; indefinite-length items
+  are rejected by the reader. Integers are limited to the range of
+  `long` and `unsigned long`.
+*/
+
+#ifndef TINYWOT_CBOR_H
+#define TINYWOT_CBOR_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include <tinywot/core.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*!
+  \brief The CoAP Content-Format of `application/cbor`.
+*/
+#define TINYWOT_CBOR_CONTENT_TYPE 60U
+
+/*!
+  \brief A CBOR writer state.
+*/
+struct tinywot_cbor_writer {
+  /*!
+    \brief The payload to write into.
+  */
+  struct tinywot_payload *payload;
+
+  /*!
+    \brief The status of the first failed write, or
+    `::TINYWOT_STATUS_SUCCESS` if nothing has failed.
+  */
+  enum tinywot_status status;
+};
+
+/*!
+  \brief Initialize a `tinywot_cbor_writer`.
+  \memberof tinywot_cbor_writer
+
+  Output is appended to the existing content of `payload`, which can be
+  a scatter-gather payload.
+
+  \param[inout] self An instance of `tinywot_cbor_writer`.
+  \param[in] payload The payload to write into.
+*/
+void tinywot_cbor_writer_init(
+  struct tinywot_cbor_writer *self, struct tinywot_payload *payload
+);
+
+/*!
+  \brief Write an unsigned integer.
+  \memberof tinywot_cbor_writer
+
+  The shortest encoding is always used.
+
+  \param[inout] self An instance of `tinywot_cbor_writer`.
+  \param[in] value An integer.
+  \return
+    - `::TINYWOT_STATUS_ERROR_NOT_ENOUGH_MEMORY` if the payload is full.
+    - `::TINYWOT_STATUS_SUCCESS` if the operation has been successful.
+    - Any earlier error of `self`.
+*/
+enum tinywot_status tinywot_cbor_write_uint(
+  struct tinywot_cbor_writer *self, unsigned long value
+);
+
+/*!
+  \brief Write a signed integer.
+  \memberof tinywot_cbor_writer
+
+  \param[inout] self An instance of `tinywot_cbor_writer`.
+  \param[in] value An integer.
+  \return See `tinywot_cbor_write_uint()`.
+*/
+enum tinywot_status tinywot_cbor_write_int(
+  struct tinywot_cbor_writer *self, long value
+);
+
+/*!
+  \brief Write a floating-point number.
+  \memberof tinywot_cbor_writer
+
+  The shortest of half, single and double precision that represents
+  `value` exactly is used, e.g. `21.5` takes 3 bytes.
+
+  \param[inout] self An instance of `tinywot_cbor_writer`.
+  \param[in] value A floating-point number.
+  \return See `tinywot_cbor_write_uint()`.
+*/
+enum tinywot_status tinywot_cbor_write_float(
+  struct tinywot_cbor_writer *self, double value
+);
+
+/*!
+  \brief Write a byte string.
+  \memberof tinywot_cbor_writer
+
+  \param[inout] self An instance of `tinywot_cbor_writer`.
+  \param[in] data A pointer to bytes.
+  \param[in] data_size_byte The number of bytes in `data`.
+  \return See `tinywot_cbor_write_uint()`.
+*/
+enum tinywot_status tinywot_cbor_write_bytes(
+  struct tinywot_cbor_writer *self, void const *data, size_t data_size_byte
+);
+
+/*!
+  \brief Write a text string.
+  \memberof tinywot_cbor_writer
+
+  `str` is expected to be UTF-8, and is written as is.
+
+  \param[inout] self An instance of `tinywot_cbor_writer`.
+  \param[in] str A string.
+  \return See `tinywot_cbor_write_uint()`.
+*/
+enum tinywot_status tinywot_cbor_write_string(
+  struct tinywot_cbor_writer *self, char const *str
+);
+
+/*!
+  \brief Write a text string of a known length.
+  \memberof tinywot_cbor_writer
+
+  This is like `tinywot_cbor_write_string()`, but `str` does not need
+  to be terminated by a NUL.
+
+  \param[inout] self An instance of `tinywot_cbor_writer`.
+  \param[in] str A pointer to characters.
+  \param[in] str_length_byte The number of characters in `str`.
+  \return See `tinywot_cbor_write_uint()`.
+*/
+enum tinywot_status tinywot_cbor_write_string_n(
+  struct tinywot_cbor_writer *self, char const *str, size_t str_length_byte
+);
+
+/*!
+  \brief Write the beginning of an array.
+  \memberof tinywot_cbor_writer
+
+  Exactly `items_count_n` items must be written after this.
+
+  \param[inout] self An instance of `tinywot_cbor_writer`.
+  \param[in] items_count_n The number of items in the array.
+  \return See `tinywot_cbor_write_uint()`.
+*/
+enum tinywot_status tinywot_cbor_write_array_begin(
+  struct tinywot_cbor_writer *self, size_t items_count_n
+);
+
+/*!
+  \brief Write the beginning of a map.
+  \memberof tinywot_cbor_writer
+
+  Exactly `pairs_count_n` keys, each followed by a value, must be
+  written after this.
+
+  \param[inout] self An instance of `tinywot_cbor_writer`.
+  \param[in] pairs_count_n The number of key-value pairs in the map.
+  \return See `tinywot_cbor_write_uint()`.
+*/
+enum tinywot_status tinywot_cbor_write_map_begin(
+  struct tinywot_cbor_writer *self, size_t pairs_count_n
+);
+
+/*!
+  \brief Write a tag, which applies to the next item.
+  \memberof tinywot_cbor_writer
+
+  \param[inout] self An instance of `tinywot_cbor_writer`.
+  \param[in] tag A tag number, e.g. 1 for epoch-based date/time.
+  \return See `tinywot_cbor_write_uint()`.
+*/
+enum tinywot_status tinywot_cbor_write_tag(
+  struct tinywot_cbor_writer *self, unsigned long tag
+);
+
+/*!
+  \brief Write a boolean (`true` or `false`).
+  \memberof tinywot_cbor_writer
+
+  \param[inout] self An instance of `tinywot_cbor_writer`.
+  \param[in] value A boolean.
+  \return See `tinywot_cbor_write_uint()`.
+*/
+enum tinywot_status tinywot_cbor_write_bool(
+  struct tinywot_cbor_writer *self, bool value
+);
+
+/*!
+  \brief Write `null`.
+  \memberof tinywot_cbor_writer
+
+  \param[inout] self An instance of `tinywot_cbor_writer`.
+  \return See `tinywot_cbor_write_uint()`.
+*/
+enum tinywot_status tinywot_cbor_write_null(struct tinywot_cbor_writer *self);
+
+/*!
+  \brief Write already encoded CBOR items as is.
+  \memberof tinywot_cbor_writer
+
+  \param[inout] self An instance of `tinywot_cbor_writer`.
+  \param[in] data A pointer to encoded CBOR items.
+  \param[in] data_size_byte The length of `data` in byte.
+  \return See `tinywot_cbor_write_uint()`.
+*/
+enum tinywot_status tinywot_cbor_write_raw(
+  struct tinywot_cbor_writer *self, void const *data, size_t data_size_byte
+);
+
+/*!
+  \brief The type of a CBOR item.
+*/
+enum tinywot_cbor_type {
+  /*!
+    \brief An unknown type.
+  */
+  TINYWOT_CBOR_TYPE_UNKNOWN = 0,
+
+  /*!
+    \brief An unsigned integer (major type 0).
+  */
+  TINYWOT_CBOR_TYPE_UINT,
+
+  /*!
+    \brief A negative integer (major type 1).
+  */
+  TINYWOT_CBOR_TYPE_NEGATIVE_INT,
+
+  /*!
+    \brief A byte string (major type 2).
+  */
+  TINYWOT_CBOR_TYPE_BYTES,
+
+  /*!
+    \brief A text string (major type 3).
+  */
+  TINYWOT_CBOR_TYPE_TEXT,
+
+  /*!
+    \brief The beginning of an array (major type 4).
+  */
+  TINYWOT_CBOR_TYPE_ARRAY,
+
+  /*!
+    \brief The beginning of a map (major type 5).
+  */
+  TINYWOT_CBOR_TYPE_MAP,
+
+  /*!
+    \brief A tag (major type 6).
+  */
+  TINYWOT_CBOR_TYPE_TAG,
+
+  /*!
+    \brief `false` or `true`.
+  */
+  TINYWOT_CBOR_TYPE_BOOL,
+
+  /*!
+    \brief `null`.
+  */
+  TINYWOT_CBOR_TYPE_NULL,
+
+  /*!
+    \brief `undefined`.
+  */
+  TINYWOT_CBOR_TYPE_UNDEFINED,
+
+  /*!
+    \brief A half, single or double precision floating-point number.
+  */
+  TINYWOT_CBOR_TYPE_FLOAT,
+};
+
+/*!
+  \brief A CBOR item, as read by `tinywot_cbor_read()`.
+
+  Arrays and maps are read as their beginning only; their elements are
+  the items following them.
+*/
+struct tinywot_cbor_item {
+  /*!
+    \brief The type of the item.
+  */
+  enum tinywot_cbor_type type;
+
+  /*!
+    \brief The argument of the item.
+
+    This is:
+
+    - The value of a `::TINYWOT_CBOR_TYPE_UINT`.
+    - -1 minus the value of a `::TINYWOT_CBOR_TYPE_NEGATIVE_INT`.
+    - The length in byte of a `::TINYWOT_CBOR_TYPE_BYTES` or
+      `::TINYWOT_CBOR_TYPE_TEXT`.
+    - The number of items of a `::TINYWOT_CBOR_TYPE_ARRAY`.
+    - The number of key-value pairs of a `::TINYWOT_CBOR_TYPE_MAP`.
+    - The tag number of a `::TINYWOT_CBOR_TYPE_TAG`.
+    - 1 for `true` and 0 for `false` of a `::TINYWOT_CBOR_TYPE_BOOL`.
+  */
+  unsigned long argument;
+
+  /*!
+    \brief A pointer to the content of a `::TINYWOT_CBOR_TYPE_BYTES` or
+    `::TINYWOT_CBOR_TYPE_TEXT` in the payload.
+
+    Text strings are not terminated by a NUL.
+  */
+  void const *content;
+
+  /*!
+    \brief The value of a `::TINYWOT_CBOR_TYPE_FLOAT`.
+  */
+  double number;
+};
+
+/*!
+  \brief A CBOR pull reader state.
+*/
+struct tinywot_cbor_reader {
+  /*!
+    \brief The encoded data to read.
+  */
+  unsigned char const *data;
+
+  /*!
+    \brief The length of `data` in byte.
+  */
+  size_t data_size_byte;
+
+  /*!
+    \brief The position of the next item in `data`.
+  */
+  size_t offset_byte;
+
+  /*!
+    \brief The status of the first failed read, or
+    `::TINYWOT_STATUS_SUCCESS` if nothing has failed.
+  */
+  enum tinywot_status status;
+};
+
+/*!
+  \brief Initialize a `tinywot_cbor_reader`.
+  \memberof tinywot_cbor_reader
+
+  The payload must not be a scatter-gather payload; if it is, every
+  read fails with `::TINYWOT_STATUS_ERROR_NOT_IMPLEMENTED`. Items read
+  point into the payload, so it must outlive them.
+
+  \param[inout] self An instance of `tinywot_cbor_reader`.
+  \param[in] payload The payload to read from.
+*/
+void tinywot_cbor_reader_init(
+  struct tinywot_cbor_reader *self, struct tinywot_payload const *payload
+);
+
+/*!
+  \brief Read the next item without moving past it.
+  \memberof tinywot_cbor_reader
+
+  This is useful to decide which of the typed reads to use. It never
+  changes `tinywot_cbor_reader::status`.
+
+  \param[in] self An instance of `tinywot_cbor_reader`.
+  \param[out] item The next item.
+  \return See `tinywot_cbor_read()`.
+*/
+enum tinywot_status tinywot_cbor_peek(
+  struct tinywot_cbor_reader const *self, struct tinywot_cbor_item *item
+);
+
+/*!
+  \brief Read the next item.
+  \memberof tinywot_cbor_reader
+
+  \param[inout] self An instance of `tinywot_cbor_reader`.
+  \param[out] item The next item.
+  \return
+    - `::TINYWOT_STATUS_END_OF_STREAM` if there are no more items.
+    - `::TINYWOT_STATUS_ERROR_NOT_ALLOWED` if the item is malformed or
+      truncated.
+    - `::TINYWOT_STATUS_ERROR_NOT_IMPLEMENTED` if the item is of an
+      indefinite length, a simple value other than `false`, `true`,
+      `null` and `undefined`, or an integer not fitting into an
+      `unsigned long`.
+    - `::TINYWOT_STATUS_SUCCESS` if the operation has been successful.
+    - Any earlier error of `self`.
+*/
+enum tinywot_status tinywot_cbor_read(
+  struct tinywot_cbor_reader *self, struct tinywot_cbor_item *item
+);
+
+/*!
+  \brief Skip the next item, including the elements of an array or a
+  map, and the item following a tag.
+  \memberof tinywot_cbor_reader
+
+  \param[inout] self An instance of `tinywot_cbor_reader`.
+  \return
+    - `::TINYWOT_STATUS_ERROR_NOT_ALLOWED` if the item ends before all
+      of its elements.
+    - See `tinywot_cbor_read()` for others.
+*/
+enum tinywot_status tinywot_cbor_skip(struct tinywot_cbor_reader *self);
+
+/*!
+  \brief Read an unsigned integer.
+  \memberof tinywot_cbor_reader
+
+  \param[inout] self An instance of `tinywot_cbor_reader`.
+  \param[out] value The integer.
+  \return
+    - `::TINYWOT_STATUS_ERROR_NOT_ALLOWED` if the next item is of
+      another type.
+    - See `tinywot_cbor_read()` for others.
+*/
+enum tinywot_status tinywot_cbor_read_uint(
+  struct tinywot_cbor_reader *self, unsigned long *value
+);
+
+/*!
+  \brief Read a signed integer.
+  \memberof tinywot_cbor_reader
+
+  \param[inout] self An instance of `tinywot_cbor_reader`.
+  \param[out] value The integer.
+  \return
+    - `::TINYWOT_STATUS_ERROR_NOT_ALLOWED` if the next item is not an
+      integer, or does not fit into a `long`.
+    - See `tinywot_cbor_read()` for others.
+*/
+enum tinywot_status tinywot_cbor_read_int(
+  struct tinywot_cbor_reader *self, long *value
+);
+
+/*!
+  \brief Read a number.
+  \memberof tinywot_cbor_reader
+
+  Both floating-point numbers and integers are accepted.
+
+  \param[inout] self An instance of `tinywot_cbor_reader`.
+  \param[out] value The number.
+  \return See `tinywot_cbor_read_uint()`.
+*/
+enum tinywot_status tinywot_cbor_read_float(
+  struct tinywot_cbor_reader *self, double *value
+);
+
+/*!
+  \brief Read a boolean.
+  \memberof tinywot_cbor_reader
+
+  \param[inout] self An instance of `tinywot_cbor_reader`.
+  \param[out] value The boolean.
+  \return See `tinywot_cbor_read_uint()`.
+*/
+enum tinywot_status tinywot_cbor_read_bool(
+  struct tinywot_cbor_reader *self, bool *value
+);
+
+/*!
+  \brief Read a byte string.
+  \memberof tinywot_cbor_reader
+
+  \param[inout] self An instance of `tinywot_cbor_reader`.
+  \param[out] data A pointer to the bytes in the payload.
+  \param[out] data_size_byte The number of bytes.
+  \return See `tinywot_cbor_read_uint()`.
+*/
+enum tinywot_status tinywot_cbor_read_bytes(
+  struct tinywot_cbor_reader *self,
+  void const **data,
+  size_t *data_size_byte
+);
+
+/*!
+  \brief Read a text string.
+  \memberof tinywot_cbor_reader
+
+  \param[inout] self An instance of `tinywot_cbor_reader`.
+  \param[out] str A pointer to the characters in the payload, not
+  terminated by a NUL.
+  \param[out] str_length_byte The number of characters.
+  \return See `tinywot_cbor_read_uint()`.
+*/
+enum tinywot_status tinywot_cbor_read_string(
+  struct tinywot_cbor_reader *self,
+  char const **str,
+  size_t *str_length_byte
+);
+
+/*!
+  \brief Read the beginning of an array.
+  \memberof tinywot_cbor_reader
+
+  \param[inout] self An instance of `tinywot_cbor_reader`.
+  \param[out] items_count_n The number of items in the array.
+  \return See `tinywot_cbor_read_uint()`.
+*/
+enum tinywot_status tinywot_cbor_read_array_begin(
+  struct tinywot_cbor_reader *self, size_t *items_count_n
+);
+
+/*!
+  \brief Read the beginning of a map.
+  \memberof tinywot_cbor_reader
+
+  \param[inout] self An instance of `tinywot_cbor_reader`.
+  \param[out] pairs_count_n The number of key-value pairs in the map.
+  \return See `tinywot_cbor_read_uint()`.
+*/
+enum tinywot_status tinywot_cbor_read_map_begin(
+  struct tinywot_cbor_reader *self, size_t *pairs_count_n
+);
+
+/*!
+  \brief Read `null`.
+  \memberof tinywot_cbor_reader
+
+  \param[inout] self An instance of `tinywot_cbor_reader`.
+  \return See `tinywot_cbor_read_uint()`.
+*/
+enum tinywot_status tinywot_cbor_read_null(struct tinywot_cbor_reader *self);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* TINYWOT_CBOR_H */
@@ -31,10 +31,38 @@
 #include <stddef.h>
 #include <stdint.h>
 
+#if defined(__AVR__)
+#include <avr/pgmspace.h>
+#endif
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+/*!
+  \brief Place a variable in program memory.
+
+  On a Harvard architecture like AVR, constant data is still copied into
+  RAM at startup, unless it is placed in program memory (flash), which
+  must then be accessed with special instructions. See
+  `tinywot_thing_init_static_flash()`.
+
+  On other architectures, this is empty. Define this together with
+  `TINYWOT_FLASH_READ()` and `TINYWOT_FLASH_STRCMP()` for other
+  platforms.
+*/
+#ifndef TINYWOT_FLASH
+#if defined(__AVR__)
+#define TINYWOT_FLASH PROGMEM
+#define TINYWOT_FLASH_READ(dest, src, size) memcpy_P((dest), (src), (size))
+#define TINYWOT_FLASH_STRCMP(str, flash_str) strcmp_P((str), (flash_str))
+#else
+#define TINYWOT_FLASH
+#define TINYWOT_FLASH_READ(dest, src, size) memcpy((dest), (src), (size))
+#define TINYWOT_FLASH_STRCMP(str, flash_str) strcmp((str), (flash_str))
+#endif
+#endif
+
 /*!
   \brief Status codes.
 
@@ -74,6 +102,22 @@ enum tinywot_status {
   */
   TINYWOT_STATUS_NOT_FINISHED,
 
+  /*!
+    \brief The requested data has not changed since the requester last
+    got it, so it is not sent again.
+
+    See `tinywot_form_cache`.
+  */
+  TINYWOT_STATUS_NOT_MODIFIED,
+
+  /*!
+    \brief The operation has been started, but its result will only be
+    known later.
+
+    See `tinywot_response_complete()`.
+  */
+  TINYWOT_STATUS_PENDING,
+
   /*!
     \brief A generic error.
 
@@ -108,6 +152,15 @@ enum tinywot_status {
     \brief There is insufficient memory to complete an action.
   */
   TINYWOT_STATUS_ERROR_NOT_ENOUGH_MEMORY,
+
+  /*!
+    \brief The data has changed since the requester started to get it,
+    as told by `tinywot_request::etag`.
+
+    This can happen when a response is sent in blocks. The requester
+    should start again from the first block.
+  */
+  TINYWOT_STATUS_ERROR_VERSION_MISMATCH,
 };
 
 /*!
@@ -251,6 +304,16 @@ enum tinywot_operation_type {
   TINYWOT_OPERATION_TYPE_UNSUBSCRIBEALLEVENTS,
 };
 
+/*!
+  \brief The bit of an operation type in a set of operation types.
+
+  A set of operation types is a bitwise OR of these in an
+  `uint_least32_t`, e.g. `tinywot_form::ops`.
+
+  \param[in] op A `tinywot_operation_type`.
+*/
+#define TINYWOT_OPERATION_TYPE_BIT(op) ((uint_least32_t)1U << (op))
+
 /*!
   \brief Response status.
 
@@ -289,6 +352,27 @@ enum tinywot_response_status {
     \brief The requested operation is not allowed.
   */
   TINYWOT_RESPONSE_STATUS_NOT_ALLOWED,
+
+  /*!
+    \brief The requested data has not changed, as told by
+    `tinywot_request::etag`. The response has no content.
+  */
+  TINYWOT_RESPONSE_STATUS_NOT_MODIFIED,
+
+  /*!
+    \brief The response is not ready yet. It will be completed by
+    `tinywot_response_complete()`.
+
+    A protocol binding can acknowledge the request in the meantime, e.g.
+    with an empty CoAP ACK, and send a separate response later.
+  */
+  TINYWOT_RESPONSE_STATUS_PENDING,
+
+  /*!
+    \brief The requested data has changed since `tinywot_request::etag`,
+    e.g. between two blocks of a response.
+  */
+  TINYWOT_RESPONSE_STATUS_PRECONDITION_FAILED,
 };
 
 /*!
@@ -302,8 +386,60 @@ enum tinywot_response_status tinywot_response_status_from_tinywot_status(
   enum tinywot_status const status
 );
 
+/*!
+  \brief How long the memory of a `tinywot_payload_segment` is valid.
+*/
+enum tinywot_payload_segment_ownership {
+  /*!
+    \brief The memory is always valid, e.g. a constant in ROM.
+  */
+  TINYWOT_PAYLOAD_SEGMENT_OWNERSHIP_STATIC = 0,
+
+  /*!
+    \brief The memory is owned by someone else, and is only guaranteed
+    to be valid until the `tinywot_payload` has been sent, e.g. a
+    sensor buffer of a handler.
+  */
+  TINYWOT_PAYLOAD_SEGMENT_OWNERSHIP_BORROWED,
+
+  /*!
+    \brief The memory is part of `tinywot_payload::content`, where data
+    has been copied into.
+  */
+  TINYWOT_PAYLOAD_SEGMENT_OWNERSHIP_CONTENT,
+};
+
+/*!
+  \brief A piece of data in a scatter-gather `tinywot_payload`.
+
+  This is designed to be converted to a `struct iovec` for `sendmsg()`,
+  or to a DMA descriptor, by a protocol binding.
+*/
+struct tinywot_payload_segment {
+  /*!
+    \brief A pointer to the data.
+  */
+  void const *content;
+
+  /*!
+    \brief The length of `content` in byte.
+  */
+  size_t content_length_byte;
+
+  /*!
+    \brief How long `content` is valid.
+  */
+  enum tinywot_payload_segment_ownership ownership;
+};
+
 /*!
   \brief Metadata about a chunk of data.
+
+  A payload normally holds all of its data in `content`. Optionally, it
+  can be turned into a scatter-gather payload with
+  `tinywot_payload_init_segments()`, which holds a list of
+  `tinywot_payload_segment`s instead. Data then does not need to be
+  copied into `content` to be sent.
 */
 struct tinywot_payload {
   /*!
@@ -318,6 +454,9 @@ struct tinywot_payload {
 
   /*!
     \brief The valid data length of `content` in byte.
+
+    For a scatter-gather payload, this is the total length of all
+    `segments`.
   */
   size_t content_length_byte;
 
@@ -332,8 +471,149 @@ struct tinywot_payload {
     [coap-cf]: https://www.iana.org/assignments/core-parameters/core-parameters.xhtml#content-formats
   */
   uint_fast16_t content_type;
+
+  /*!
+    \brief A list of segments making up the data of a scatter-gather
+    payload, or `NULL` for a normal payload.
+
+    For a scatter-gather payload, `content` is only used as the memory
+    to copy data into. Such data is then referenced by segments of
+    `::TINYWOT_PAYLOAD_SEGMENT_OWNERSHIP_CONTENT`. A protocol binding
+    should send the data of all segments in order.
+  */
+  struct tinywot_payload_segment *segments;
+
+  /*!
+    \brief The number of valid elements in `segments`.
+  */
+  size_t segments_count_n;
+
+  /*!
+    \brief The maximum number of elements `segments` can contain.
+  */
+  size_t segments_max_n;
+};
+
+/*!
+  \brief Turn a `tinywot_payload` into a scatter-gather payload.
+  \memberof tinywot_payload
+
+  The payload is emptied. `tinywot_payload::content` and
+  `tinywot_payload::content_buffer_size_byte` are kept, as space to copy
+  data into.
+
+  In a scatter-gather payload, `tinywot_payload_append()` and
+  `tinywot_payload_append_string()` still copy data into
+  `tinywot_payload::content`, and `tinywot_payload_append_segment()` can
+  add references to data without copying. Do not write to
+  `tinywot_payload::content` directly.
+
+  \param[inout] self An instance of `tinywot_payload`.
+  \param[in] memory A pointer to an array of `tinywot_payload_segment`.
+  \param[in] memory_size_byte The size of `memory` in byte.
+*/
+void tinywot_payload_init_segments(
+  struct tinywot_payload *self, void *memory, size_t memory_size_byte
+);
+
+/*!
+  \brief Append a reference to data to a scatter-gather
+  `tinywot_payload`.
+  \memberof tinywot_payload
+
+  With `::TINYWOT_PAYLOAD_SEGMENT_OWNERSHIP_STATIC` or
+  `::TINYWOT_PAYLOAD_SEGMENT_OWNERSHIP_BORROWED`, only a reference to
+  `data` is stored. With `::TINYWOT_PAYLOAD_SEGMENT_OWNERSHIP_CONTENT`,
+  this is the same as `tinywot_payload_append()`.
+
+  \param[in] self An instance of `tinywot_payload`.
+  \param[in] data A pointer to a memory region containing data.
+  \param[in] data_size_byte How long is the data, in bytes.
+  \param[in] ownership How long `data` is valid.
+  \return
+    - `::TINYWOT_STATUS_ERROR_NOT_ALLOWED` if `self` is not a
+      scatter-gather payload.
+    - `::TINYWOT_STATUS_ERROR_NOT_ENOUGH_MEMORY` if there is no space
+      left for a new segment, or for the copied data.
+    - `::TINYWOT_STATUS_SUCCESS` if the operation has been successful.
+*/
+enum tinywot_status tinywot_payload_append_segment(
+  struct tinywot_payload *self,
+  void const *data,
+  size_t data_size_byte,
+  enum tinywot_payload_segment_ownership ownership
+);
+
+/*!
+  \brief Copy the data of a `tinywot_payload` into a contiguous buffer.
+  \memberof tinywot_payload
+
+  This is for protocol bindings which cannot send a scatter-gather
+  payload directly. It works with normal payloads too.
+
+  \param[in] self An instance of `tinywot_payload`.
+  \param[out] buffer A pointer to a memory region to copy data into.
+  \param[in] buffer_size_byte The size of `buffer` in byte.
+  \return
+    - `::TINYWOT_STATUS_ERROR_NOT_ENOUGH_MEMORY` if `buffer` cannot hold
+      `tinywot_payload::content_length_byte` bytes.
+    - `::TINYWOT_STATUS_SUCCESS` if the operation has been successful.
+*/
+enum tinywot_status tinywot_payload_gather(
+  struct tinywot_payload const *self, void *buffer, size_t buffer_size_byte
+);
+
+/*!
+  \brief Where a `tinywot_payload` was, so that later appends to it can
+  be undone.
+
+  See `tinywot_payload_mark()` and `tinywot_payload_rollback()`.
+*/
+struct tinywot_payload_mark {
+  /*!
+    \brief The `tinywot_payload::content_length_byte` at the mark.
+  */
+  size_t content_length_byte;
+
+  /*!
+    \brief The `tinywot_payload::segments_count_n` at the mark.
+  */
+  size_t segments_count_n;
+
+  /*!
+    \brief The length of the last segment at the mark, which appends of
+    copied data can grow.
+  */
+  size_t last_segment_length_byte;
 };
 
+/*!
+  \brief Remember where a `tinywot_payload` is.
+  \memberof tinywot_payload
+
+  This works with both normal and scatter-gather payloads.
+
+  \param[in] self An instance of `tinywot_payload`.
+  \param[out] mark Where to remember it.
+*/
+void tinywot_payload_mark(
+  struct tinywot_payload const *self, struct tinywot_payload_mark *mark
+);
+
+/*!
+  \brief Undo all appends to a `tinywot_payload` since a mark.
+  \memberof tinywot_payload
+
+  This is for writers of formats that must not leave a half-written
+  item in a payload when it runs out of space.
+
+  \param[inout] self An instance of `tinywot_payload`.
+  \param[in] mark A mark set by `tinywot_payload_mark()` on `self`.
+*/
+void tinywot_payload_rollback(
+  struct tinywot_payload *self, struct tinywot_payload_mark const *mark
+);
+
 /*!
   \brief Append the memory content pointed by `data` to a
   `tinywot_payload`.
@@ -361,6 +641,9 @@ enum tinywot_status tinywot_payload_append(
   This function is like `tinywot_payload_append()` except that it
   copies and concatenates the strings rather than blindly append.
 
+  A scatter-gather payload is not a string, so in this case `str` is
+  appended without the trailing NUL.
+
   \param[in] self An instance of `tinywot_payload`.
   \param[in] str A pointer to a NUL-terminated string.
   \return `tinywot_status`
@@ -370,13 +653,94 @@ enum tinywot_status tinywot_payload_append_string(
   char const *str
 );
 
+/*!
+  \brief A numeric identifier of a submission target.
+
+  A target ID is an interned form of a submission target string, handed
+  out by a `tinywot_target_registry`. Comparing two IDs is much cheaper
+  than comparing two strings.
+*/
+typedef uint_least16_t tinywot_target_id_t;
+
+/*!
+  \brief A `tinywot_target_id_t` that identifies no target.
+
+  This is the value of a zero-initialized `tinywot_target_id_t`, so a
+  `tinywot_request` without an ID is looked up by its target string as
+  usual.
+*/
+#define TINYWOT_TARGET_ID_NONE ((tinywot_target_id_t)0U)
+
 /*!
   \brief The size of buffer reserved for `tinywot_request::target`.
+
+  Protocol bindings that always resolve `tinywot_request::target_id` or
+  set `tinywot_request::target_view` can define this to a small value,
+  or to 0 to drop the buffer, to save memory.
 */
 #ifndef TINYWOT_REQUEST_TARGET_BUFFER_SIZE_BYTE
 #define TINYWOT_REQUEST_TARGET_BUFFER_SIZE_BYTE (64U)
 #endif
 
+/*!
+  \brief The maximum number of parameters a `tinywot_request` can hold.
+
+  See `tinywot_request::params`. This is 0 by default, which drops
+  `tinywot_request::params` and `tinywot_request::params_count_n`; a
+  `tinywot_router` then still matches wildcards, but captures nothing.
+*/
+#ifndef TINYWOT_REQUEST_PARAMS_MAX_N
+#define TINYWOT_REQUEST_PARAMS_MAX_N (0U)
+#endif
+
+/*!
+  \brief A part of a submission target captured by a wildcard.
+
+  This is a view into the target string of a `tinywot_request`, so it is
+  not NUL-terminated.
+*/
+struct tinywot_target_param {
+  /*!
+    \brief A pointer to the first character of the captured part.
+  */
+  char const *value;
+
+  /*!
+    \brief The length of the captured part in byte.
+  */
+  size_t value_length_byte;
+};
+
+/*!
+  \brief Which part of a request body is in `tinywot_request::payload`.
+
+  A protocol binding can feed a large request body (e.g. CoAP Block1) to
+  a handler in fragments, so it never needs to reassemble the whole body
+  in memory. Only handlers of forms with `::TINYWOT_FORM_FLAG_STREAMING`
+  receive fragments.
+*/
+enum tinywot_request_fragment {
+  /*!
+    \brief The payload is the whole request body.
+  */
+  TINYWOT_REQUEST_FRAGMENT_NONE = 0,
+
+  /*!
+    \brief The payload is the first fragment of the body.
+  */
+  TINYWOT_REQUEST_FRAGMENT_BEGIN,
+
+  /*!
+    \brief The payload is a fragment in the middle of the body.
+  */
+  TINYWOT_REQUEST_FRAGMENT_CONTINUE,
+
+  /*!
+    \brief The payload is the last fragment of the body.
+  */
+  TINYWOT_REQUEST_FRAGMENT_END,
+};
+
 /*!
   \brief An incoming request.
   \extends tinywot_payload
@@ -385,6 +749,23 @@ enum tinywot_status tinywot_payload_append_string(
   `tinywot_payload` with an associated target and an operation type. The
   two criteria is then used to find a handler in a `tinywot_thing` to
   handle this request.
+
+  A request lives as long as it is in flight, so members that only some
+  protocol bindings need are compiled in on demand:
+
+  - `params` and `params_count_n`, with `TINYWOT_REQUEST_PARAMS_MAX_N`
+    defined to more than 0.
+  - `fragment` and `offset_byte`, with `TINYWOT_ENABLE_REQUEST_FRAGMENTS`
+    defined. Without them, every request carries a whole body.
+  - `origin` and `origin_length_byte`, with
+    `TINYWOT_ENABLE_REQUEST_ORIGIN` defined. Without them, all requests
+    have an empty origin, so observers cannot tell requesters apart.
+  - `etag`, with `TINYWOT_ENABLE_REQUEST_ETAG` defined. Without it,
+    requests are never responded with
+    `::TINYWOT_RESPONSE_STATUS_NOT_MODIFIED`.
+
+  These macros change the layout of `tinywot_request`, so they must be
+  the same for the library and everything using it.
 */
 struct tinywot_request {
   /*!
@@ -397,348 +778,3413 @@ struct tinywot_request {
   */
   enum tinywot_operation_type op;
 
+#if TINYWOT_REQUEST_TARGET_BUFFER_SIZE_BYTE > 0
   /*!
     \brief The intended submision target extracted from the request.
+
+    This is used when `target_view` is `NULL`.
   */
   char target[TINYWOT_REQUEST_TARGET_BUFFER_SIZE_BYTE];
-};
+#endif
 
-/*!
-  \brief An outgoing response.
-  \extends tinywot_payload
+  /*!
+    \brief A view of the intended submission target, or `NULL`.
+
+    If this is not `NULL`, it is used instead of `target`, so a protocol
+    binding can point it into its receive buffer instead of copying the
+    target, and the target is not limited by
+    `TINYWOT_REQUEST_TARGET_BUFFER_SIZE_BYTE`. It does not need to be
+    terminated by a NUL; its length is `target_view_length_byte`. Use
+    `tinywot_request_get_target()` to read either of them.
+  */
+  char const *target_view;
 
-  A response is a `tinywot_payload` with a status code. This is usually
-  generated by a handler in `tinywot_thing` and is accepted by a
-  protocol binding library to serialize a response message.
-*/
-struct tinywot_response {
   /*!
-    \brief The content to send with the response.
+    \brief The length of `target_view` in byte.
   */
-  struct tinywot_payload payload;
+  size_t target_view_length_byte;
 
   /*!
-    \brief A status code for the response.
+    \brief The ID of the intended submission target.
 
-    This is normally calculated from the \ref status_codes returned by
-    functions.
+    If this is not `::TINYWOT_TARGET_ID_NONE`, it is used instead of
+    `target` to find a `tinywot_form`. A protocol binding can resolve an
+    ID from a `tinywot_target_registry` once, e.g. per CoAP token or per
+    connection, then reuse it for subsequent requests.
   */
-  enum tinywot_response_status status;
-};
-
-/*!
-  \brief The signature of a handler function implementing a form (the
-  behavior of a submission target).
+  tinywot_target_id_t target_id;
 
-  `response_payload` and `request_payload` are the `payload` fields of
-  `tinywot_response` and `tinywot_request` respectively. The handler can
-  assume the two to be always non-NULL. Handlers should read contents
-  from the request payload (if applicable) and write contents to the
-  response payload.
+#if TINYWOT_REQUEST_PARAMS_MAX_N > 0
+  /*!
+    \brief Parts of the target captured by wildcards.
 
-  \param[out] response_payload A pointer to a new `tinywot_payload` in a
-  `tinywot_response`.
-  \param[in] request_payload A pointer to a `tinywot_payload` in a
-  `tinywot_response`.
-  \param[inout] context  The context information set in the
-  corresponding `tinywot_form`.
-  \return `tinywot_status`
-*/
-typedef enum tinywot_status tinywot_form_handler_t(
-  struct tinywot_payload *response_payload,
-  struct tinywot_payload *request_payload,
-  void *context
-);
+    When a `tinywot_thing` has a `tinywot_router`, a form target may
+    contain wildcards (see `tinywot_router`). The parts of the target
+    (`target_view` or `target`) matching them are stored here in order, up to
+    `TINYWOT_REQUEST_PARAMS_MAX_N`. A handler can reach them with
+    `tinywot_request_of_payload()`.
+  */
+  struct tinywot_target_param params[TINYWOT_REQUEST_PARAMS_MAX_N];
 
-/*!
-  \brief An operation endpoint.
-*/
-struct tinywot_form {
   /*!
-    \brief The name of affordance that this form is attached to.
+    \brief The number of valid elements in `params`.
+  */
+  size_t params_count_n;
+#endif
 
-    For a top-level form, this field should be set to `NULL`.
+#ifdef TINYWOT_ENABLE_REQUEST_FRAGMENTS
+  /*!
+    \brief Which part of the request body `payload` is.
 
-    This field is so far informative only -- no procedure relies on its
-    value. In the future, however, this field may be useful.
+    This needs `TINYWOT_ENABLE_REQUEST_FRAGMENTS`.
   */
-  char const *name;
+  enum tinywot_request_fragment fragment;
 
   /*!
-    \brief The submission target of the form.
+    \brief The offset of `payload` in the whole request body, in byte.
 
-    A `tinywot_thing` will compare this field with the `target` field in
-    a `tinywot_request` to figure out a registered form.
-
-    The exact way to specify a submission target is undefined. This
-    largely depends on the protocol binding implementation, who is
-    responsible for extracting this information from the request
-    message. Often, for an IRI specified in a Thing Description
-    document, this should be the path name of it. For example, for the
-    following IRI:
+    This is 0 unless `fragment` is `::TINYWOT_REQUEST_FRAGMENT_CONTINUE`
+    or `::TINYWOT_REQUEST_FRAGMENT_END`.
+  */
+  size_t offset_byte;
+#endif
 
-        http://thing.example.com/action/update
+#ifdef TINYWOT_ENABLE_REQUEST_ORIGIN
+  /*!
+    \brief Opaque bytes identifying who sent the request, or `NULL`.
 
-    Its path name is `/action/update`, so this field should be
-    `/action/update`.
+    The content is defined by the protocol binding, e.g. an address, a
+    port and a CoAP token. It is stored in a `tinywot_observer` when the
+    request observes a property or subscribes to an event, so that the
+    binding knows where to send notifications later. This needs
+    `TINYWOT_ENABLE_REQUEST_ORIGIN`.
   */
-  char const *target;
+  unsigned char const *origin;
 
   /*!
-    \brief The allowed operation type on this form.
+    \brief The length of `origin` in byte.
   */
-  enum tinywot_operation_type op;
+  size_t origin_length_byte;
+#endif
 
+#ifdef TINYWOT_ENABLE_REQUEST_ETAG
   /*!
-    \brief A function pointer to the actual implementation of the form.
+    \brief The `tinywot_response::etag` the requester has got before, or
+    0 for none.
+
+    This needs `TINYWOT_ENABLE_REQUEST_ETAG`.
+  */
+  uint_least32_t etag;
+#endif
+};
+
+/*!
+  \brief Get the `tinywot_request` containing a `tinywot_payload`.
+  \memberof tinywot_request
+
+  `tinywot_thing_process_request()` always passes
+  `tinywot_request::payload` to a `tinywot_form_handler_t`, so the
+  handler can use this function to reach other members of the request,
+  like `tinywot_request::params`. Do not use this on a `tinywot_payload`
+  that is not in a `tinywot_request`.
+
+  \param[in] payload A pointer to `tinywot_request::payload`.
+  \return A pointer to the `tinywot_request`.
+*/
+struct tinywot_request *tinywot_request_of_payload(
+  struct tinywot_payload *payload
+);
+
+/*!
+  \brief Get the intended submission target of a `tinywot_request`.
+  \memberof tinywot_request
+
+  This is `tinywot_request::target_view` if it is set, or
+  `tinywot_request::target` otherwise.
+
+  \param[in] self An instance of `tinywot_request`.
+  \param[out] target_length_byte The length of the target in byte.
+  \return A pointer to the target, which is not always terminated by a
+  NUL, or `NULL` if there is neither a view nor a buffer.
+*/
+char const *tinywot_request_get_target(
+  struct tinywot_request const *self, size_t *target_length_byte
+);
+
+/*!
+  \brief Get which part of the request body a `tinywot_request` carries.
+  \memberof tinywot_request
+
+  \param[in] self An instance of `tinywot_request`.
+  \return `tinywot_request::fragment`, or
+  `::TINYWOT_REQUEST_FRAGMENT_NONE` without
+  `TINYWOT_ENABLE_REQUEST_FRAGMENTS`.
+*/
+enum tinywot_request_fragment tinywot_request_get_fragment(
+  struct tinywot_request const *self
+);
+
+/*!
+  \brief Get who sent a `tinywot_request`.
+  \memberof tinywot_request
+
+  \param[in] self An instance of `tinywot_request`.
+  \param[out] origin_length_byte The length of the origin in byte.
+  \return `tinywot_request::origin`, or `NULL` without
+  `TINYWOT_ENABLE_REQUEST_ORIGIN`.
+*/
+unsigned char const *tinywot_request_get_origin(
+  struct tinywot_request const *self, size_t *origin_length_byte
+);
+
+/*!
+  \brief Get the `tinywot_response::etag` the sender of a
+  `tinywot_request` has got before.
+  \memberof tinywot_request
+
+  \param[in] self An instance of `tinywot_request`.
+  \return `tinywot_request::etag`, or 0 without
+  `TINYWOT_ENABLE_REQUEST_ETAG`.
+*/
+uint_least32_t tinywot_request_get_etag(struct tinywot_request const *self);
+
+/*!
+  \brief A bump allocator over a region of memory.
+
+  A protocol binding owns an arena sized for the worst case of all
+  handlers, and resets it after each response has been sent. Handlers
+  allocate memory for their responses from it (see
+  `tinywot_response::arena`), instead of keeping buffers of their own.
+  Memory is never freed one by one, so there is no fragmentation.
+*/
+struct tinywot_arena {
+  /*!
+    \brief The memory to allocate from.
+  */
+  unsigned char *memory;
+
+  /*!
+    \brief The size of `memory` in byte.
+  */
+  size_t memory_size_byte;
+
+  /*!
+    \brief How many bytes of `memory` have been allocated.
+  */
+  size_t used_byte;
+};
+
+/*!
+  \brief Initialize a `tinywot_arena`.
+  \memberof tinywot_arena
+
+  \param[inout] self An instance of `tinywot_arena`.
+  \param[in] memory A pointer to a memory region to allocate from.
+  \param[in] memory_size_byte The size of `memory` in byte.
+*/
+void tinywot_arena_init(
+  struct tinywot_arena *self, void *memory, size_t memory_size_byte
+);
+
+/*!
+  \brief Allocate memory from a `tinywot_arena`.
+  \memberof tinywot_arena
+
+  The memory is aligned for any basic type.
+
+  \param[inout] self An instance of `tinywot_arena`.
+  \param[in] size_byte The size of memory to allocate in byte.
+  \return A pointer to the allocated memory, or `NULL` if there is not
+  enough memory left.
+*/
+void *tinywot_arena_alloc(struct tinywot_arena *self, size_t size_byte);
+
+/*!
+  \brief Get the number of bytes that can still be allocated from a
+  `tinywot_arena`.
+  \memberof tinywot_arena
+
+  \param[in] self An instance of `tinywot_arena`.
+  \return The size of the largest allocation that can succeed, in byte.
+*/
+size_t tinywot_arena_remaining_byte(struct tinywot_arena const *self);
+
+/*!
+  \brief Free all memory allocated from a `tinywot_arena`.
+  \memberof tinywot_arena
+
+  \param[inout] self An instance of `tinywot_arena`.
+*/
+void tinywot_arena_reset(struct tinywot_arena *self);
+
+struct tinywot_response;
+
+/*!
+  \brief A function called when a pending `tinywot_response` has been
+  completed.
+
+  See `tinywot_response_complete()`.
+
+  \param[inout] response The completed response.
+  \param[inout] context `tinywot_response::on_complete_context`.
+*/
+typedef void tinywot_response_complete_t(
+  struct tinywot_response *response, void *context
+);
+
+/*!
+  \brief An outgoing response.
+  \extends tinywot_payload
+
+  A response is a `tinywot_payload` with a status code. This is usually
+  generated by a handler in `tinywot_thing` and is accepted by a
+  protocol binding library to serialize a response message.
+*/
+struct tinywot_response {
+  /*!
+    \brief The content to send with the response.
+  */
+  struct tinywot_payload payload;
+
+  /*!
+    \brief A status code for the response.
+
+    This is normally calculated from the \ref status_codes returned by
+    functions.
+  */
+  enum tinywot_response_status status;
+
+  /*!
+    \brief The offset of `payload` in the whole response, in byte.
+
+    A response can be sent in blocks (e.g. CoAP Block2), each fitting
+    into `payload`. This is where the current block starts, so it is 0
+    for the first block. See `tinywot_response_next_block()`.
+  */
+  size_t offset_byte;
+
+  /*!
+    \brief Opaque state kept by a handler between blocks.
+
+    This is 0 for the first block. A handler returning
+    `::TINYWOT_STATUS_NOT_FINISHED` can store where to carry on here,
+    e.g. an index into its data, so it does not need to find that again
+    from `offset_byte`. A protocol binding that cannot keep it between
+    blocks should reset it to 0, so handlers must be able to carry on
+    from `offset_byte` alone.
+  */
+  size_t cursor;
+
+  /*!
+    \brief An optional `tinywot_arena` to allocate memory from, or `NULL`.
+
+    This is set by the protocol binding. Handlers allocate memory for
+    `payload` from it with `tinywot_response_alloc_content()`, or any
+    other memory they need while preparing the response. The binding
+    resets it after the response has been sent.
+  */
+  struct tinywot_arena *arena;
+
+  /*!
+    \brief An entity tag identifying the version of the content, or 0
+    for none.
+
+    This is set by handlers like `tinywot_form_cache_handler()`. A
+    protocol binding can send it as a CoAP ETag option or an HTTP ETag
+    header.
+  */
+  uint_least32_t etag;
+
+  /*!
+    \brief A function to call when this response is completed after
+    `::TINYWOT_STATUS_PENDING`, or `NULL`.
+
+    This is set by the protocol binding, which sends the response from
+    there.
+  */
+  tinywot_response_complete_t *on_complete;
+
+  /*!
+    \brief The context to pass to `on_complete`.
+  */
+  void *on_complete_context;
+};
+
+/*!
+  \brief Get the `tinywot_response` containing a `tinywot_payload`.
+  \memberof tinywot_response
+
+  `tinywot_thing_process_request()` always passes
+  `tinywot_response::payload` to a `tinywot_form_handler_t`, so the
+  handler can use this function to reach other members of the response,
+  like `tinywot_response::offset_byte`. Do not use this on a
+  `tinywot_payload` that is not in a `tinywot_response`.
+
+  \param[in] payload A pointer to `tinywot_response::payload`.
+  \return A pointer to the `tinywot_response`.
+*/
+struct tinywot_response *tinywot_response_of_payload(
+  struct tinywot_payload *payload
+);
+
+/*!
+  \brief Prepare a `tinywot_response` for its next block.
+  \memberof tinywot_response
+
+  Call this after a block of the response has been sent, when
+  `tinywot_thing_process_request()` returned
+  `::TINYWOT_STATUS_NOT_FINISHED`. `tinywot_response::offset_byte` is
+  advanced over the sent block, and the payload is emptied.
+  `tinywot_response::cursor` is kept.
+
+  \param[inout] self An instance of `tinywot_response`.
+*/
+void tinywot_response_next_block(struct tinywot_response *self);
+
+/*!
+  \brief Complete a pending `tinywot_response`.
+  \memberof tinywot_response
+
+  A handler that cannot respond right away, e.g. one waiting for a slow
+  sensor, returns `::TINYWOT_STATUS_PENDING` after keeping its response
+  (from `tinywot_response_of_payload()`) as a token. The request is then
+  responded with `::TINYWOT_RESPONSE_STATUS_PENDING`, and other requests
+  can be processed meanwhile. When the result is known, the application
+  fills in `tinywot_response::payload` and calls this function with the
+  token, which sets `tinywot_response::status` and calls
+  `tinywot_response::on_complete`.
+
+  The protocol binding must keep the response, including its payload
+  memory, valid until then. This function must not be called before the
+  handler has returned, and should be called from the same context as
+  `tinywot_thing_process_request()`.
+
+  \param[inout] self A pending `tinywot_response`.
+  \param[in] status The result of the operation, as would be returned by
+  a `tinywot_form_handler_t`.
+*/
+void tinywot_response_complete(
+  struct tinywot_response *self, enum tinywot_status status
+);
+
+/*!
+  \brief Allocate `tinywot_response::payload` from
+  `tinywot_response::arena`.
+  \memberof tinywot_response
+
+  `tinywot_payload::content` and `tinywot_payload::content_buffer_size_byte`
+  are set to the allocated memory, and the payload is emptied. A handler
+  not knowing how much it is going to write can pass 0 to take all the
+  memory left.
+
+  \param[inout] self An instance of `tinywot_response`.
+  \param[in] size_byte The size of memory to allocate in byte, or 0 for
+  all memory left in the arena.
+  \return
+    - `::TINYWOT_STATUS_ERROR_NOT_ENOUGH_MEMORY` if there is no arena, or
+      not enough memory left in it.
+    - `::TINYWOT_STATUS_SUCCESS` if the operation has been successful.
+*/
+enum tinywot_status tinywot_response_alloc_content(
+  struct tinywot_response *self, size_t size_byte
+);
+
+/*!
+  \brief The signature of a handler function implementing a form (the
+  behavior of a submission target).
+
+  `response_payload` and `request_payload` are the `payload` fields of
+  `tinywot_response` and `tinywot_request` respectively. The handler can
+  assume the two to be always non-NULL. Handlers should read contents
+  from the request payload (if applicable) and write contents to the
+  response payload.
+
+  When called from `tinywot_thing_process_request()`, `request_payload`
+  is always the `payload` of a `tinywot_request`, so use
+  `tinywot_request_of_payload()` to get the full request. Likewise,
+  `response_payload` is always the `payload` of a `tinywot_response`
+  (see `tinywot_response_of_payload()`).
+
+  A handler producing more data than `response_payload` can hold can
+  send it in blocks: it writes the block starting at
+  `tinywot_response::offset_byte`, and returns
+  `::TINYWOT_STATUS_NOT_FINISHED` if there is more to come after it. It
+  is then called again for the next block.
+
+  The handler of a form with `::TINYWOT_FORM_FLAG_STREAMING` may be
+  called once per fragment of a large request body, as told by
+  `tinywot_request::fragment` and `tinywot_request::offset_byte`, in
+  order. For a fragment before the last one, it returns
+  `::TINYWOT_STATUS_SUCCESS` to accept more (e.g. CoAP 2.31 Continue),
+  or an error to abort the transfer. The response to the last fragment
+  is the response to the whole request.
+
+  A handler may also return `::TINYWOT_STATUS_PENDING` to respond later
+  with `tinywot_response_complete()`.
+
+  \param[out] response_payload A pointer to a new `tinywot_payload` in a
+  `tinywot_response`.
+  \param[in] request_payload A pointer to a `tinywot_payload` in a
+  `tinywot_response`.
+  \param[inout] context  The context information set in the
+  corresponding `tinywot_form`.
+  \return `tinywot_status`
+*/
+typedef enum tinywot_status tinywot_form_handler_t(
+  struct tinywot_payload *response_payload,
+  struct tinywot_payload *request_payload,
+  void *context
+);
+
+/*!
+  \brief The handler of a `tinywot_form` accepts request fragments.
+
+  See `tinywot_form::flags` and `tinywot_request_fragment`.
+*/
+#define TINYWOT_FORM_FLAG_STREAMING (1U << 0)
+
+/*!
+  \brief An operation endpoint.
+
+  A Thing usually has many forms, so members that only some applications
+  need are compiled in on demand:
+
+  - `flags`, with `TINYWOT_ENABLE_REQUEST_FRAGMENTS` defined, as its only
+    flag is `::TINYWOT_FORM_FLAG_STREAMING`.
+  - `priority`, with `TINYWOT_ENABLE_FORM_PRIORITY` defined. Without it,
+    a `tinywot_scheduler` only uses `tinywot_task::priority`.
+
+  These macros change the layout of `tinywot_form`, so they must be the
+  same for the library and everything using it.
+*/
+struct tinywot_form {
+  /*!
+    \brief The name of affordance that this form is attached to.
+
+    For a top-level form, this field should be set to `NULL`.
+
+    This field is so far informative only -- no procedure relies on its
+    value. In the future, however, this field may be useful.
+  */
+  char const *name;
+
+  /*!
+    \brief The submission target of the form.
+
+    A `tinywot_thing` will compare this field with the `target` field in
+    a `tinywot_request` to figure out a registered form.
+
+    The exact way to specify a submission target is undefined. This
+    largely depends on the protocol binding implementation, who is
+    responsible for extracting this information from the request
+    message. Often, for an IRI specified in a Thing Description
+    document, this should be the path name of it. For example, for the
+    following IRI:
+
+        http://thing.example.com/action/update
+
+    Its path name is `/action/update`, so this field should be
+    `/action/update`.
+  */
+  char const *target;
+
+  /*!
+    \brief The allowed operation type on this form.
+  */
+  enum tinywot_operation_type op;
+
+  /*!
+    \brief More allowed operation types on this form, as a set of
+    `TINYWOT_OPERATION_TYPE_BIT()`, or 0.
+
+    This lets one form serve e.g. readproperty, writeproperty and
+    observeproperty on the same target, instead of one form for each.
+    The handler can tell them apart with `tinywot_request::op` (see
+    `tinywot_request_of_payload()`). `op` must still be set, and the
+    operation types should be of the same kind of affordance as `op`.
+    `::TINYWOT_OPERATION_TYPE_UNKNOWN` must not be in the set.
+  */
+  uint_least32_t ops;
+
+#ifdef TINYWOT_ENABLE_REQUEST_FRAGMENTS
+  /*!
+    \brief A bitwise OR of `TINYWOT_FORM_FLAG_*`, or 0.
+
+    This needs `TINYWOT_ENABLE_REQUEST_FRAGMENTS`.
+  */
+  uint_least8_t flags;
+#endif
+
+#ifdef TINYWOT_ENABLE_FORM_PRIORITY
+  /*!
+    \brief How urgent requests to this form are, for a
+    `tinywot_scheduler`. Larger values run first; the default, 0, is the
+    lowest.
+
+    This needs `TINYWOT_ENABLE_FORM_PRIORITY`.
+  */
+  uint_least8_t priority;
+#endif
+
+  /*!
+    \brief A function pointer to the actual implementation of the form.
 
     This can be `NULL`, in which case this form is identified as not
     implemented.
   */
-  tinywot_form_handler_t *handler;
+  tinywot_form_handler_t *handler;
+
+  /*!
+    \brief Arbitrary data to pass to `handler` when it is called.
+  */
+  void *context;
+};
+
+/*!
+  \brief Whether a `tinywot_form` allows an operation type.
+  \memberof tinywot_form
+
+  \param[in] self An instance of `tinywot_form`.
+  \param[in] op A `tinywot_operation_type`.
+  \return Whether `op` is `tinywot_form::op` or in `tinywot_form::ops`.
+  A removed form allows nothing.
+*/
+bool tinywot_form_accepts(
+  struct tinywot_form const *self, enum tinywot_operation_type op
+);
+
+/*!
+  \brief A cache of the response of a `tinywot_form_handler_t`.
+
+  Use `tinywot_form_cache_handler()` as the handler of a `tinywot_form`
+  and a `tinywot_form_cache` as its context, to wrap a handler whose
+  response changes rarely, e.g. of a readproperty form. The wrapped
+  handler is only called again after the application has called
+  `tinywot_form_cache_invalidate()`; otherwise the cached response is
+  returned.
+
+  The version of the cached response is also given as
+  `tinywot_response::etag`. A client sending it back as
+  `tinywot_request::etag` gets an empty response with
+  `::TINYWOT_RESPONSE_STATUS_NOT_MODIFIED` (e.g. CoAP 2.03 Valid or
+  HTTP 304 Not Modified).
+*/
+struct tinywot_form_cache {
+  /*!
+    \brief The wrapped handler.
+  */
+  tinywot_form_handler_t *handler;
+
+  /*!
+    \brief The context to pass to `handler`.
+  */
+  void *context;
+
+  /*!
+    \brief The memory holding the cached response.
+  */
+  void *content;
+
+  /*!
+    \brief The size of `content` in byte.
+
+    The response of `handler` must fit into this to be cached.
+  */
+  size_t content_buffer_size_byte;
+
+  /*!
+    \brief The length of the cached response in byte.
+  */
+  size_t content_length_byte;
+
+  /*!
+    \brief The content type of the cached response.
+  */
+  uint_fast16_t content_type;
+
+  /*!
+    \brief The current version of the data behind `handler`.
+
+    This is never 0. It starts at 1, and is bumped by
+    `tinywot_form_cache_invalidate()`. An application can set a random
+    value after initialization, so that ETags from before a reboot are
+    unlikely to match.
+  */
+  uint_least32_t version;
+
+  /*!
+    \brief The version of the cached response, or 0 if there is none.
+  */
+  uint_least32_t cached_version;
+};
+
+/*!
+  \brief Initialize a `tinywot_form_cache`.
+  \memberof tinywot_form_cache
+
+  \param[inout] self An instance of `tinywot_form_cache`.
+  \param[in] handler The handler to wrap.
+  \param[in] context The context to pass to `handler`.
+  \param[in] memory A pointer to a memory region holding the cached
+  response.
+  \param[in] memory_size_byte The size of `memory` in byte.
+*/
+void tinywot_form_cache_init(
+  struct tinywot_form_cache *self,
+  tinywot_form_handler_t *handler,
+  void *context,
+  void *memory,
+  size_t memory_size_byte
+);
+
+/*!
+  \brief Tell a `tinywot_form_cache` that the data behind it has changed.
+  \memberof tinywot_form_cache
+
+  This bumps `tinywot_form_cache::version`, so that the next request
+  calls the wrapped handler again. It is not atomic, so call it from
+  the same context as `tinywot_thing_process_request()`.
+
+  \param[inout] self An instance of `tinywot_form_cache`.
+*/
+void tinywot_form_cache_invalidate(struct tinywot_form_cache *self);
+
+/*!
+  \brief A form handler returning a cached response.
+
+  See `tinywot_form_cache`. If the response payload has no buffer
+  (`tinywot_payload::content_buffer_size_byte` is 0), it is pointed to
+  the cached response instead of copying it.
+
+  The wrapped handler must write its response in one block, i.e. it
+  must not return `::TINYWOT_STATUS_NOT_FINISHED`.
+
+  \param[out] response_payload See `tinywot_form_handler_t`.
+  \param[in] request_payload See `tinywot_form_handler_t`.
+  \param[inout] context A pointer to a `tinywot_form_cache`.
+  \return
+    - `::TINYWOT_STATUS_NOT_MODIFIED` if `tinywot_request::etag` matches
+      the cached response. The response payload is empty.
+    - `::TINYWOT_STATUS_ERROR_NOT_ENOUGH_MEMORY` if the response does not
+      fit into `tinywot_form_cache::content` or the response payload.
+    - `::TINYWOT_STATUS_ERROR_NOT_IMPLEMENTED` if the wrapped handler
+      returns `::TINYWOT_STATUS_NOT_FINISHED`.
+    - `::TINYWOT_STATUS_SUCCESS` if the operation has been successful.
+    - Other codes are also possible if the wrapped handler returns them.
+*/
+enum tinywot_status tinywot_form_cache_handler(
+  struct tinywot_payload *response_payload,
+  struct tinywot_payload *request_payload,
+  void *context
+);
+
+/*!
+  \brief Hash a submission target.
+
+  This is the hash function used by `tinywot_form_hash_table`. It is a
+  32-bit FNV-1a hash of the NUL-terminated string `target`. Generators
+  of `tinywot_form_hash_table` must use exactly the same function.
+
+  \param[in] target A NUL-terminated submission target.
+  \return The hash value of `target`.
+*/
+uint_least32_t tinywot_target_hash(char const *target);
+
+/*!
+  \brief Hash a submission target of a known length.
+
+  This is `tinywot_target_hash()` for a target that is not terminated by
+  a NUL (see `tinywot_request::target_view`).
+
+  \param[in] target A pointer to the characters of the target.
+  \param[in] target_length_byte The number of characters in `target`.
+  \return The hash value of `target`.
+*/
+uint_least32_t tinywot_target_hash_n(
+  char const *target, size_t target_length_byte
+);
+
+/*!
+  \brief A minimal perfect hash table over a list of `tinywot_form`s.
+
+  A `tinywot_form_hash_table` is generated at build time from a list of
+  `tinywot_form`s where all possible targets are known, so looking up a
+  target costs one hash and one string comparison, and no memory is
+  needed at run time. Use `script/tinywot-forms.py` to generate it,
+  then pass it to `tinywot_thing_init_static_hashed()`.
+
+  The list of `tinywot_form`s is grouped by `tinywot_form::target`. A
+  target hashed to `h` is placed in the group numbered `k`:
+
+      k = tinywot_form_hash_table_mix(
+            h, displacements[h % displacements_n]
+          ) % targets_n
+
+  The forms in group `k` are `forms[offsets[k]]` to
+  `forms[offsets[k + 1] - 1]`, in the order they were declared.
+*/
+struct tinywot_form_hash_table {
+  /*!
+    \brief The displacement (second-level seed) of each bucket.
+  */
+  uint_least16_t const *displacements;
+
+  /*!
+    \brief The number of elements in `displacements`.
+  */
+  size_t displacements_n;
+
+  /*!
+    \brief The position of the first `tinywot_form` in each group.
+
+    There are `targets_n + 1` elements in this array. The last one is
+    the total number of `tinywot_form`s.
+  */
+  uint_least16_t const *offsets;
+
+  /*!
+    \brief The number of distinct targets, i.e. groups.
+  */
+  size_t targets_n;
+};
+
+/*!
+  \brief Statically initialize a `tinywot_form_hash_table` from the
+  arrays of displacements and offsets.
+  \memberof tinywot_form_hash_table
+
+  Both arguments must be arrays, not pointers.
+*/
+#define TINYWOT_FORM_HASH_TABLE_INIT(displacements_, offsets_) \
+  { \
+    .displacements = (displacements_), \
+    .displacements_n = sizeof(displacements_) / sizeof((displacements_)[0]), \
+    .offsets = (offsets_), \
+    .targets_n = sizeof(offsets_) / sizeof((offsets_)[0]) - 1, \
+  }
+
+/*!
+  \brief Mix a target hash with a displacement.
+  \memberof tinywot_form_hash_table
+
+  \param[in] hash A value returned from `tinywot_target_hash()`.
+  \param[in] displacement One of `tinywot_form_hash_table::displacements`.
+  \return A new hash value.
+*/
+uint_least32_t tinywot_form_hash_table_mix(
+  uint_least32_t hash, uint_least16_t displacement
+);
+
+/*!
+  \brief The maximum number of segments in a form target added to a
+  `tinywot_router`.
+
+  Matching keeps a small record per segment on the stack, so this bounds
+  the stack used by `tinywot_router_match()`. Requested targets may be
+  longer; the part beyond can only be matched by `*`.
+*/
+#ifndef TINYWOT_ROUTER_DEPTH_MAX_N
+#define TINYWOT_ROUTER_DEPTH_MAX_N (8U)
+#endif
+
+/*!
+  \brief A node in a `tinywot_router`.
+
+  Each node stands for a segment of a form target, i.e. the part between
+  two slashes.
+*/
+struct tinywot_router_node {
+  /*!
+    \brief A pointer to the segment in a form target.
+
+    This is not NUL-terminated. It is `NULL` for the root node.
+  */
+  char const *segment;
+
+  /*!
+    \brief The length of `segment` in byte.
+  */
+  size_t segment_length_byte;
+
+  /*!
+    \brief The form target ending at this node, or `NULL` if there is
+    none.
+  */
+  char const *pattern;
+
+  /*!
+    \brief The first child of this node.
+  */
+  struct tinywot_router_node *child;
+
+  /*!
+    \brief The next sibling of this node.
+  */
+  struct tinywot_router_node *sibling;
+};
+
+/*!
+  \brief A tree of form targets split by segments.
+
+  A `tinywot_router` lets one `tinywot_form` serve a family of targets.
+  A form target is split into segments by slashes. Apart from literal
+  text, a segment can be:
+
+  - `{name}`, which matches any one segment of a requested target. The
+    name is informative only.
+  - `*`, which must be the last segment and matches the rest of a
+    requested target, including slashes.
+
+  For example, `/properties/{name}` matches `/properties/status`, and
+  `/logs/` followed by `*` matches `/logs/2023/01/01`. When more
+  than one form target matches, literal segments are preferred over
+  `{name}`, and `{name}` over `*`, segment by segment from the left.
+
+  Matching costs O(length) of the requested target, as long as wildcards
+  do not overlap with literal segments at the same position. The tree
+  only refers to the form targets, so they must point to `'static`
+  memory, as required by `tinywot_form::target` anyway.
+*/
+struct tinywot_router {
+  /*!
+    \brief Memory for the nodes. The first one is the root.
+  */
+  struct tinywot_router_node *nodes;
+
+  /*!
+    \brief The number of nodes in use.
+  */
+  size_t nodes_count_n;
+
+  /*!
+    \brief The maximum number of nodes `nodes` can contain.
+  */
+  size_t nodes_max_n;
+};
+
+/*!
+  \brief Initialize a `tinywot_router` with RAM.
+  \memberof tinywot_router
+
+  One node is needed for the root, and at most one more for each
+  segment of each form target; segments shared by a prefix are stored
+  once.
+
+  \param[inout] self An instance of `tinywot_router`.
+  \param[in] memory A pointer to any segment of RAM.
+  \param[in] memory_size_byte The size of `memory` in byte.
+  \return
+    - `::TINYWOT_STATUS_ERROR_NOT_ENOUGH_MEMORY` if `memory` cannot even
+      hold the root node.
+    - `::TINYWOT_STATUS_SUCCESS` if the initialization succeeds.
+*/
+enum tinywot_status tinywot_router_init(
+  struct tinywot_router *self, void *memory, size_t memory_size_byte
+);
+
+/*!
+  \brief Add a form target to a `tinywot_router`.
+  \memberof tinywot_router
+
+  Adding the same form target more than once has no further effect.
+
+  \param[inout] self An instance of `tinywot_router`.
+  \param[in] pattern A NUL-terminated form target in `'static` memory.
+  \return
+    - `::TINYWOT_STATUS_ERROR_NOT_ALLOWED` if `pattern` has more than
+      `TINYWOT_ROUTER_DEPTH_MAX_N` segments.
+    - `::TINYWOT_STATUS_ERROR_NOT_ENOUGH_MEMORY` if there are not enough
+      free nodes. The router is still usable, but `pattern` cannot be
+      matched.
+    - `::TINYWOT_STATUS_SUCCESS` if the operation has been successful.
+*/
+enum tinywot_status tinywot_router_insert(
+  struct tinywot_router *self, char const *pattern
+);
+
+/*!
+  \brief Remove a form target from a `tinywot_router`.
+  \memberof tinywot_router
+
+  The form target is no longer matched. Its nodes are kept, and reused
+  if it is added again.
+
+  \param[inout] self An instance of `tinywot_router`.
+  \param[in] pattern A NUL-terminated form target.
+  \return
+    - `::TINYWOT_STATUS_ERROR_NOT_FOUND` if `pattern` is not in the
+      router.
+    - `::TINYWOT_STATUS_SUCCESS` if the operation has been successful.
+*/
+enum tinywot_status tinywot_router_remove(
+  struct tinywot_router *self, char const *pattern
+);
+
+/*!
+  \brief Match a requested target against a `tinywot_router`.
+  \memberof tinywot_router
+
+  \param[in] self An instance of `tinywot_router`.
+  \param[in] target A NUL-terminated requested target.
+  \param[out] pattern The matching form target.
+  \param[out] params Parts of `target` captured by wildcards. Can be
+  `NULL` if `params_max_n` is `0`.
+  \param[in] params_max_n The maximum number of elements in `params`.
+  Further captured parts are dropped.
+  \param[out] params_count_n The number of elements written to
+  `params`.
+  \return
+    - `::TINYWOT_STATUS_ERROR_NOT_FOUND` if no form target matches.
+    - `::TINYWOT_STATUS_SUCCESS` if a form target has been returned via
+      `pattern`.
+*/
+enum tinywot_status tinywot_router_match(
+  struct tinywot_router const *self,
+  char const *target,
+  char const **pattern,
+  struct tinywot_target_param *params,
+  size_t params_max_n,
+  size_t *params_count_n
+);
+
+/*!
+  \brief A full memory barrier.
+
+  This keeps the compiler (and the CPU, when it matters) from reordering
+  memory accesses across it. It is used by `tinywot_event_ring` to
+  publish an event only after the event has been written. Define this
+  for compilers other than GCC and Clang; otherwise only the `volatile`
+  indices of the ring are relied on, which is not enough on multi-core
+  systems.
+*/
+#ifndef TINYWOT_MEMORY_BARRIER
+#if defined(__GNUC__)
+#define TINYWOT_MEMORY_BARRIER() __atomic_thread_fence(__ATOMIC_SEQ_CST)
+#else
+#define TINYWOT_MEMORY_BARRIER() ((void)0)
+#endif
+#endif
+
+/*!
+  \brief The maximum number of `tinywot_event`s in a `tinywot_event_ring`.
+
+  Indices of the ring are 8-bit, so that they are read and written
+  atomically even on 8-bit MCUs.
+*/
+#define TINYWOT_EVENT_RING_MAX_N (128U)
+
+/*!
+  \brief Something that has happened on a property or an event, posted
+  to a `tinywot_event_ring`.
+*/
+struct tinywot_event {
+  /*!
+    \brief The target of the changed property or the emitted event.
+
+    This must stay valid until the event is drained, e.g. be a string
+    literal.
+  */
+  char const *target;
+
+  /*!
+    \brief A small value describing the event, e.g. a sensor reading.
+
+    See `tinywot_observer::value`.
+  */
+  uint_least32_t value;
+};
+
+/*!
+  \brief A lock-free single-producer, single-consumer ring of
+  `tinywot_event`s.
+
+  This is for handing events from an interrupt service routine (the
+  producer) to the main loop (the consumer) without disabling
+  interrupts. Posting is wait-free, takes constant time, and copies only
+  a `tinywot_event`.
+
+  There must be at most one producer and one consumer at a time. Use
+  one ring per interrupt priority level if several of them post events.
+*/
+struct tinywot_event_ring {
+  /*!
+    \brief The memory holding the events.
+  */
+  struct tinywot_event *events;
+
+  /*!
+    \brief The number of elements in `events` minus 1.
+
+    The number of elements is always a power of 2.
+  */
+  uint_least8_t mask;
+
+  /*!
+    \brief How many events have been posted, modulo 256.
+
+    This is only written by the producer.
+  */
+  volatile uint_least8_t head;
+
+  /*!
+    \brief How many events have been taken, modulo 256.
+
+    This is only written by the consumer.
+  */
+  volatile uint_least8_t tail;
+};
+
+/*!
+  \brief Initialize a `tinywot_event_ring`.
+  \memberof tinywot_event_ring
+
+  The ring uses the largest power of 2 of `tinywot_event`s, up to
+  `TINYWOT_EVENT_RING_MAX_N`, that fits into `memory`. Do this before
+  the producer and the consumer start.
+
+  \param[inout] self An instance of `tinywot_event_ring`.
+  \param[in] memory A pointer to an array of `tinywot_event`.
+  \param[in] memory_size_byte The size of `memory` in byte.
+  \return
+    - `::TINYWOT_STATUS_ERROR_NOT_ENOUGH_MEMORY` if `memory` cannot hold
+      one `tinywot_event`.
+    - `::TINYWOT_STATUS_SUCCESS` if the operation has been successful.
+*/
+enum tinywot_status tinywot_event_ring_init(
+  struct tinywot_event_ring *self, void *memory, size_t memory_size_byte
+);
+
+/*!
+  \brief Post an event to a `tinywot_event_ring`.
+  \memberof tinywot_event_ring
+
+  This is called by the producer, e.g. an interrupt service routine.
+
+  \param[inout] self An instance of `tinywot_event_ring`.
+  \param[in] target See `tinywot_event::target`.
+  \param[in] value See `tinywot_event::value`.
+  \return
+    - `::TINYWOT_STATUS_ERROR_NOT_ENOUGH_MEMORY` if the ring is full. The
+      event is dropped.
+    - `::TINYWOT_STATUS_SUCCESS` if the operation has been successful.
+*/
+enum tinywot_status tinywot_event_ring_post(
+  struct tinywot_event_ring *self, char const *target, uint_least32_t value
+);
+
+/*!
+  \brief Take the oldest event from a `tinywot_event_ring`.
+  \memberof tinywot_event_ring
+
+  This is called by the consumer, e.g. the main loop.
+
+  \param[inout] self An instance of `tinywot_event_ring`.
+  \param[out] event The taken event.
+  \return
+    - `::TINYWOT_STATUS_ERROR_NOT_FOUND` if the ring is empty.
+    - `::TINYWOT_STATUS_SUCCESS` if the operation has been successful.
+*/
+enum tinywot_status tinywot_event_ring_take(
+  struct tinywot_event_ring *self, struct tinywot_event *event
+);
+
+/*!
+  \brief The size of `tinywot_observer::origin` in byte.
+
+  This must be able to hold the largest `tinywot_request::origin` used
+  by the protocol binding.
+*/
+#ifndef TINYWOT_OBSERVER_ORIGIN_SIZE_BYTE
+#define TINYWOT_OBSERVER_ORIGIN_SIZE_BYTE (32U)
+#endif
+
+/*!
+  \brief A record of someone observing a property or subscribing to an
+  event of a `tinywot_thing`.
+
+  Observers are kept in a pool supplied to
+  `tinywot_thing_init_observers()`. They are created and removed by
+  `tinywot_thing_process_request()`, marked dirty by
+  `tinywot_thing_mark_dirty()`, and handed to the protocol binding by
+  `tinywot_thing_next_notification()`.
+*/
+struct tinywot_observer {
+  /*!
+    \brief The target of the observed `tinywot_form`.
+
+    For `::TINYWOT_OPERATION_TYPE_OBSERVEALLPROPERTIES` and
+    `::TINYWOT_OPERATION_TYPE_SUBSCRIBEALLEVENTS`, this is the target of
+    the top-level form.
+  */
+  char const *target;
+
+  /*!
+    \brief How the observer has been registered, e.g.
+    `::TINYWOT_OPERATION_TYPE_OBSERVEPROPERTY`.
+
+    This is `::TINYWOT_OPERATION_TYPE_UNKNOWN` for a free record.
+  */
+  enum tinywot_operation_type op;
+
+  /*!
+    \brief A copy of `tinywot_request::origin`.
+  */
+  unsigned char origin[TINYWOT_OBSERVER_ORIGIN_SIZE_BYTE];
+
+  /*!
+    \brief The length of `origin` in byte.
+  */
+  size_t origin_length_byte;
+
+  /*!
+    \brief Whether a notification is pending.
+  */
+  bool dirty;
+
+  /*!
+    \brief The value of the latest `tinywot_event` marking this observer.
+
+    This is set by `tinywot_thing_drain_events()`, and passed to the
+    handler of an event in `tinywot_thing_process_notification()`.
+  */
+  uint_least32_t value;
+};
+
+#ifdef TINYWOT_ENABLE_INSTRUMENTATION
+/*!
+  \brief The number of buckets in `tinywot_form_stats::latencies_n`.
+*/
+#ifndef TINYWOT_INSTRUMENTATION_LATENCY_BUCKETS_N
+#define TINYWOT_INSTRUMENTATION_LATENCY_BUCKETS_N (8U)
+#endif
+
+/*!
+  \brief The number of low bits dropped from a latency before it is put
+  into a bucket of `tinywot_form_stats::latencies_n`.
+
+  This sets the resolution of the histogram, e.g. 4 for 16 ticks.
+*/
+#ifndef TINYWOT_INSTRUMENTATION_LATENCY_BUCKET_SHIFT
+#define TINYWOT_INSTRUMENTATION_LATENCY_BUCKET_SHIFT (0U)
+#endif
+
+/*!
+  \brief Statistics about one `tinywot_form`.
+
+  See `tinywot_instrumentation`.
+*/
+struct tinywot_form_stats {
+  /*!
+    \brief The number of requests dispatched to the form.
+  */
+  uint_least32_t hits_n;
+
+  /*!
+    \brief The number of requests to the form that have ended with an
+    error, e.g. from its handler.
+  */
+  uint_least32_t errors_n;
+
+  /*!
+    \brief A histogram of dispatch latencies, in ticks of
+    `tinywot_instrumentation::clock`.
+
+    With `s` being `TINYWOT_INSTRUMENTATION_LATENCY_BUCKET_SHIFT`,
+    bucket 0 counts latencies below `2^s`, and bucket `i` counts those
+    from `2^(s+i-1)` to below `2^(s+i)`. The last bucket also counts all
+    larger latencies.
+  */
+  uint_least32_t latencies_n[TINYWOT_INSTRUMENTATION_LATENCY_BUCKETS_N];
+};
+
+/*!
+  \brief A function returning the current time, e.g. a cycle counter.
+
+  Only differences between two calls are used, so it may wrap around.
+
+  \param[inout] context `tinywot_instrumentation::context`.
+  \return The current time in any unit ("ticks").
+*/
+typedef uint_least32_t tinywot_instrumentation_clock_t(void *context);
+
+/*!
+  \brief A function called around a dispatch by
+  `tinywot_thing_process_request()`.
+
+  \param[inout] context `tinywot_instrumentation::context`.
+  \param[in] request The request being processed.
+  \param[in] response The response being prepared. It has not been
+  written before the dispatch.
+  \param[in] form The form found for `request`, or `NULL`.
+  \param[in] status Before the dispatch, the result of finding `form`;
+  after it, the result of the dispatch.
+*/
+typedef void tinywot_instrumentation_hook_t(
+  void *context,
+  struct tinywot_request const *request,
+  struct tinywot_response const *response,
+  struct tinywot_form const *form,
+  enum tinywot_status status
+);
+
+/*!
+  \brief Counters and hooks on the hot paths of a `tinywot_thing`.
+
+  This is only available with `TINYWOT_ENABLE_INSTRUMENTATION` defined
+  (for both TinyWoT and the application). Otherwise, none of it is
+  compiled, and it costs one pointer per `tinywot_thing`
+  (`tinywot_thing::instrumentation`).
+
+  Set it up with `tinywot_thing_init_instrumentation()`, then set
+  `clock`, `before_dispatch`, `after_dispatch` and `context` as needed.
+  Counters can be read directly, or through
+  `tinywot_json_handler_read_instrumentation()`. They are not atomic.
+*/
+struct tinywot_instrumentation {
+  /*!
+    \brief Statistics of each `tinywot_form`, by its position in
+    `tinywot_thing::forms`.
+  */
+  struct tinywot_form_stats *forms_stats;
+
+  /*!
+    \brief The number of elements in `forms_stats`.
+
+    Forms at a position beyond this are not counted.
+  */
+  size_t forms_stats_max_n;
+
+  /*!
+    \brief The number of calls of `tinywot_thing_find_form()` and
+    `tinywot_thing_find_form_by_id()`.
+  */
+  uint_least32_t lookups_n;
+
+  /*!
+    \brief The number of lookups that have found no form.
+  */
+  uint_least32_t not_found_n;
+
+  /*!
+    \brief The number of lookups that have found a target, but not the
+    operation type.
+  */
+  uint_least32_t not_allowed_n;
+
+  /*!
+    \brief A clock for `tinywot_form_stats::latencies_n`, or `NULL` to
+    not measure latencies.
+  */
+  tinywot_instrumentation_clock_t *clock;
+
+  /*!
+    \brief A function called before a dispatch, or `NULL`.
+  */
+  tinywot_instrumentation_hook_t *before_dispatch;
+
+  /*!
+    \brief A function called after a dispatch, or `NULL`.
+  */
+  tinywot_instrumentation_hook_t *after_dispatch;
+
+  /*!
+    \brief The context to pass to `clock`, `before_dispatch` and
+    `after_dispatch`.
+  */
+  void *context;
+};
+#endif
+
+/*!
+  \brief A Web Thing.
+
+  A Thing is currently just a collection of `tinywot_form`s.
+*/
+struct tinywot_thing {
+  /*!
+    \brief A list of forms describing the behavior of this Thing.
+  */
+  struct tinywot_form *forms;
+
+  /*!
+    \brief The number of registered forms in `forms`.
+  */
+  size_t forms_count_n;
+
+  /*!
+    \brief The maximum number of `tinywot_form`s that the supporting
+    memory can contain.
+
+    This field mainly supports the dynamic changing of `tinywot_thing`.
+    If `forms` points to a read-only memory, then this field should
+    either be equal to `forms_count_n` or `0` to prevent any method from
+    rewriting a non-modifyable memory.
+  */
+  size_t forms_max_n;
+
+  /*!
+    \brief Whether `forms`, and the strings they point to, are in
+    program memory.
+
+    This is set by `tinywot_thing_init_static_flash()`, and reset to
+    `false` by all other `tinywot_thing_init_*()` functions.
+  */
+  bool forms_in_flash;
+
+  /*!
+    \brief The number of removed `tinywot_form`s still occupying space
+    in `forms`.
+
+    `tinywot_thing_remove_form()` only marks a `tinywot_form` as removed
+    by setting its `tinywot_form::op` to `TINYWOT_OPERATION_TYPE_UNKNOWN`;
+    the space is reclaimed by `tinywot_thing_compact_forms()`. Removed
+    `tinywot_form`s are still counted in `forms_count_n`.
+  */
+  size_t forms_removed_n;
+
+  /*!
+    \brief A counter bumped whenever `forms` are changed.
+
+    `tinywot_thing_add_form()`, `tinywot_thing_change_form()` and
+    `tinywot_thing_remove_form()` increase this by 1 (wrapping around),
+    so that data derived from `forms`, like a `tinywot_json_td`, can tell
+    whether it is outdated. All `tinywot_thing_init_*()` functions reset
+    it to 0.
+  */
+  uint_least32_t forms_generation;
+
+  /*!
+    \brief An optional index over `forms`, sorted by
+    `tinywot_form::target`.
+
+    Each element is the position of a `tinywot_form` in `forms`.
+    Elements with the same `tinywot_form::target` are further sorted by
+    their positions, so the latest registered form comes last. When this
+    field is not `NULL`, `tinywot_thing_find_form()` performs a binary
+    search on it instead of a linear scan on `forms`.
+
+    Use `tinywot_thing_init_index()` to set up this field. All
+    `tinywot_thing_init_*()` functions reset it to `NULL`.
+  */
+  size_t *forms_index;
+
+  /*!
+    \brief The maximum number of elements that the memory pointed by
+    `forms_index` can contain.
+  */
+  size_t forms_index_max_n;
+
+  /*!
+    \brief An optional minimal perfect hash table over `forms`.
+
+    When this field is not `NULL`, `tinywot_thing_find_form()` uses it
+    to look up a `tinywot_form`. It is set by
+    `tinywot_thing_init_static_hashed()`, and reset to `NULL` by all
+    other `tinywot_thing_init_*()` functions.
+  */
+  struct tinywot_form_hash_table const *forms_hash;
+
+  /*!
+    \brief An optional `tinywot_router` over `forms`.
+
+    When this field is not `NULL`, `tinywot_thing_process_request()`
+    matches `tinywot_request::target` against it first, so form targets
+    may contain wildcards. Use `tinywot_thing_init_router()` to set up
+    this field. All `tinywot_thing_init_*()` functions reset it to
+    `NULL`.
+  */
+  struct tinywot_router *router;
+
+  /*!
+    \brief An optional pool of `tinywot_observer`s.
+
+    When this field is not `NULL`, `tinywot_thing_process_request()`
+    registers observers on observe and subscribe operations. Use
+    `tinywot_thing_init_observers()` to set up this field. All
+    `tinywot_thing_init_*()` functions reset it to `NULL`.
+  */
+  struct tinywot_observer *observers;
+
+  /*!
+    \brief The number of elements in `observers`.
+  */
+  size_t observers_max_n;
+
+  /*!
+    \brief An optional `tinywot_target_registry` resolving
+    `tinywot_request::target_id`s.
+
+    Use `tinywot_thing_intern_targets()` to set up this field and
+    `target_slots`. All `tinywot_thing_init_*()` functions reset it to
+    `NULL`.
+  */
+  struct tinywot_target_registry const *target_registry;
+
+  /*!
+    \brief The latest `tinywot_form` of each target ID.
+
+    Element `id - 1` is the position of the latest `tinywot_form` in
+    `forms` whose target has the ID `id` in `target_registry`, plus 1,
+    or 0 if there is none. Older `tinywot_form`s of the same target are
+    chained through `target_slots_next`, so finding a `tinywot_form` by
+    ID compares no strings.
+  */
+  size_t *target_slots;
+
+  /*!
+    \brief The number of elements in `target_slots`.
+  */
+  size_t target_slots_max_n;
+
+  /*!
+    \brief For each `tinywot_form` in `forms`, the position plus 1 of the
+    next older `tinywot_form` with the same target, or 0 if there is
+    none.
+  */
+  size_t *target_slots_next;
+
+  /*!
+    \brief An optional `tinywot_instrumentation`.
+
+    Use `tinywot_thing_init_instrumentation()` to set up this field. All
+    `tinywot_thing_init_*()` functions reset it to `NULL`. It is only
+    used with `TINYWOT_ENABLE_INSTRUMENTATION` defined, but always
+    exists, so that the layout of `tinywot_thing` does not depend on the
+    macro.
+  */
+  struct tinywot_instrumentation *instrumentation;
+};
+
+/*!
+  \brief The size of memory required by `tinywot_thing_init_index()` to
+  index `n` `tinywot_form`s, in byte.
+*/
+#define TINYWOT_THING_INDEX_SIZE_BYTE(n) ((n) * sizeof(size_t))
+
+/*!
+  \brief The size of memory required by `tinywot_thing_intern_targets()`
+  for `targets_n` target IDs and `forms_n` `tinywot_form`s, in byte.
+*/
+#define TINYWOT_THING_TARGET_SLOTS_SIZE_BYTE(targets_n, forms_n) \
+  (((targets_n) + (forms_n)) * sizeof(size_t))
+
+/*!
+  \brief Initialize a `tinywot_thing` with a static list of forms.
+  \memberof tinywot_thing
+
+  If you have a list of `tinywot_form`s declared in a `static const`
+  array, then this helps correctly setting up a `tinywot_thing`. The
+  `tinywot_thing` initialized in this way should prevent any later
+  modification from method calls, e.g. `tinywot_thing_change_form()`.
+
+  Note that:
+
+  - `forms` is only shallow copied, so it must point to `'static`
+    memory. Otherwise, a dangling pointer would be used.
+  - `forms_size_byte` is the size of `forms` in byte, not the number of
+    `tinywot_forms` in the array. Most often, this should just be
+    `sizeof(forms)` (when `forms` is still `struct tinywot_form []`).
+
+  \param[inout] self An instance of `tinywot_thing`.
+  \param[in] forms An array of `tinywot_form` in ROM.
+  \param[in] forms_size_byte The size of `forms` in byte.
+*/
+void tinywot_thing_init_static(
+  struct tinywot_thing *self,
+  struct tinywot_form const *forms,
+  size_t forms_size_byte
+);
+
+/*!
+  \brief Initialize a `tinywot_thing` with a static list of forms and a
+  `tinywot_form_hash_table` generated for it.
+  \memberof tinywot_thing
+
+  This is like `tinywot_thing_init_static()`, but
+  `tinywot_thing_find_form()` then uses `hash_table` instead of scanning
+  `forms`. Both `forms` and `hash_table` are usually generated by
+  `script/tinywot-forms.py`, and must come from the same run of it.
+
+  \param[inout] self An instance of `tinywot_thing`.
+  \param[in] forms An array of `tinywot_form` in ROM.
+  \param[in] forms_size_byte The size of `forms` in byte.
+  \param[in] hash_table A `tinywot_form_hash_table` over `forms`.
+*/
+void tinywot_thing_init_static_hashed(
+  struct tinywot_thing *self,
+  struct tinywot_form const *forms,
+  size_t forms_size_byte,
+  struct tinywot_form_hash_table const *hash_table
+);
+
+/*!
+  \brief Initialize a `tinywot_thing` with a static list of forms in
+  program memory.
+  \memberof tinywot_thing
+
+  This is like `tinywot_thing_init_static()`, but `forms` and the
+  `tinywot_form::target` strings stay in program memory (flash) instead
+  of RAM, which matters on AVR. Declare them with `TINYWOT_FLASH`:
+
+      static char const target_status[] TINYWOT_FLASH = "/status";
+      static struct tinywot_form const forms[] TINYWOT_FLASH = {
+        {
+          .target = target_status,
+          .op = TINYWOT_OPERATION_TYPE_READPROPERTY,
+          .handler = status_read,
+        },
+      };
+
+  `tinywot_thing_find_form()` then compares targets in place, and
+  `tinywot_thing_process_request()` copies the matching form into RAM.
+  The `tinywot_form`s returned by `tinywot_thing_find_form()` are in
+  program memory, so read them with `tinywot_thing_read_form()`.
+
+  Such a `tinywot_thing` cannot have an index or a router. Observers and
+  the JSON batch handlers are not supported either, as they read form
+  strings directly.
+
+  \param[inout] self An instance of `tinywot_thing`.
+  \param[in] forms An array of `tinywot_form` in program memory.
+  \param[in] forms_size_byte The size of `forms` in byte.
+*/
+void tinywot_thing_init_static_flash(
+  struct tinywot_thing *self,
+  struct tinywot_form const *forms,
+  size_t forms_size_byte
+);
+
+/*!
+  \brief Initialize a `tinywot_thing` with Randomly Accessible Memory
+  (RAM).
+  \memberof tinywot_thing
+
+  If you want to add, change and remove `tinywot_form`s interactively,
+  then this helps correctly setting up a `tinywot_thing`. The
+  `tinywot_thing` initialized in this way allows all methods that change
+  the list of forms of a `tinywot_thing`.
+
+  `memory` is seen as blank memory with `0` forms.
+
+  \param[inout] self An instance of `tinywot_thing`.
+  \param[in] memory A pointer to any segment of RAM.
+  \param[in] memory_size_byte The size of `memory` in byte.
+*/
+void tinywot_thing_init_dynamic(
+  struct tinywot_thing *self, void *memory, size_t memory_size_byte
+);
+
+/*!
+  \brief Initialize a `tinywot_thing` with Randomly Accessible Memory
+  (RAM), then copy a static list of forms into the RAM.
+  \memberof tinywot_thing
+
+  If you want to initialize a dynamic (changable) `tinywot_thing` out of
+  a pre-defined list of `tinywot_form`s, then this helps correctly
+  setting up a `tinywot_thing`.
+
+  Memory pointed by `forms` will be copied to memory pointed by
+  `memory`. Note that in this way `tinywot_form::name` and
+  `tinywot_form::target` are only shallow copied, but this is by design
+  as they are required to be `const char`. `forms` does not have to
+  point to ROM either, as it is copied to `memory`.
+
+  \param[inout] self An instance of `tinywot_thing`.
+  \param[in] memory A pointer to any segment of RAM.
+  \param[in] memory_size_byte The size of `memory` in byte.
+  \param[in] forms An array of `tinywot_form` in ROM or RAM.
+  \param[in] forms_size_byte The size of `forms` in byte.
+  \return
+    - `::TINYWOT_STATUS_ERROR_NOT_ENOUGH_MEMORY` if `memory_size_byte`
+      is smaller than `forms_size_byte`.
+    - `::TINYWOT_STATUS_SUCCESS` if the initialization succeeds.
+*/
+enum tinywot_status tinywot_thing_init_dynamic_from_static(
+  struct tinywot_thing *self,
+  void *memory,
+  size_t memory_size_byte,
+  struct tinywot_form const *forms,
+  size_t forms_size_byte
+);
+
+/*!
+  \brief Build an index over the `tinywot_form`s of a `tinywot_thing`.
+  \memberof tinywot_thing
+
+  This function is optional. It should be called after one of the
+  `tinywot_thing_init_*()` functions. Once an index is built,
+  `tinywot_thing_find_form()` finds a `tinywot_form` in O(log n) string
+  comparisons instead of O(n), and `tinywot_thing_add_form()` and
+  `tinywot_thing_change_form()` keep the index up to date.
+
+  The memory must be able to hold an index for every `tinywot_form`
+  that the `tinywot_thing` can contain, i.e. the larger one of
+  `tinywot_thing::forms_count_n` and `tinywot_thing::forms_max_n`. Use
+  `TINYWOT_THING_INDEX_SIZE_BYTE()` to calculate the size.
+
+  \param[inout] self An instance of `tinywot_thing`.
+  \param[in] memory A pointer to any segment of RAM.
+  \param[in] memory_size_byte The size of `memory` in byte.
+  \return
+    - `::TINYWOT_STATUS_ERROR_NOT_ALLOWED` if the forms are in program
+      memory (see `tinywot_thing_init_static_flash()`).
+    - `::TINYWOT_STATUS_ERROR_NOT_ENOUGH_MEMORY` if `memory_size_byte`
+      is too small to index all `tinywot_form`s. The `tinywot_thing` is
+      left without an index.
+    - `::TINYWOT_STATUS_SUCCESS` if the index has been built.
+*/
+enum tinywot_status tinywot_thing_init_index(
+  struct tinywot_thing *self, void *memory, size_t memory_size_byte
+);
+
+/*!
+  \brief Attach a `tinywot_router` to a `tinywot_thing`.
+  \memberof tinywot_thing
+
+  This inserts the targets of all registered `tinywot_form`s into
+  `router`, which must have been initialized with
+  `tinywot_router_init()`. `tinywot_thing_add_form()` and
+  `tinywot_thing_change_form()` then insert new targets as well, and
+  `tinywot_thing_change_form()` and `tinywot_thing_remove_form()` remove
+  targets no longer used by any form.
+
+  A requested target is served by the most specific form target (see
+  `tinywot_router`) that has a form of the requested op. A form target
+  without one does not shadow a less specific one that has it.
+
+  Note that only `tinywot_thing_process_request()` takes the router into
+  account. `tinywot_thing_find_form()` still compares targets exactly.
+
+  \param[inout] self An instance of `tinywot_thing`.
+  \param[inout] router An instance of `tinywot_router`.
+  \return
+    - `::TINYWOT_STATUS_ERROR_NOT_ALLOWED` if the forms are in program
+      memory (see `tinywot_thing_init_static_flash()`), or the
+      `tinywot_thing` has observers (see
+      `tinywot_thing_init_observers()`).
+    - `::TINYWOT_STATUS_ERROR_NOT_ENOUGH_MEMORY` if `router` is too
+      small, or `::TINYWOT_STATUS_ERROR_NOT_ALLOWED` if a form target
+      has too many segments (see `tinywot_router_insert()`). The
+      `tinywot_thing` is left without a router.
+    - `::TINYWOT_STATUS_SUCCESS` if the operation has been successful.
+*/
+enum tinywot_status tinywot_thing_init_router(
+  struct tinywot_thing *self, struct tinywot_router *router
+);
+
+/*!
+  \brief Find a `tinywot_form` registered in the `tinywot_thing`.
+  \memberof tinywot_thing
+
+  This function finds a matching `tinywot_form` according to `target`
+  and `op` from the end of the list of registered `tinywot_form` in the
+  `tinywot_thing`. The first matching `tinywot_form` is retured to the
+  caller via the `form` parameter. If the `tinywot_thing` has an index
+  (see `tinywot_thing_init_index()`), it is used to speed up the search;
+  the result is the same either way. If the forms are in program memory
+  (see `tinywot_thing_init_static_flash()`), so is the returned form.
+
+  \param[in] self An instance of `tinywot_thing`.
+  \param[out] form A copy of pointer to the matching `form`.
+  \param[in] target `tinywot_form::target`.
+  \param[in] op `tinywot_form::op`.
+  \return
+    - `::TINYWOT_STATUS_ERROR_NOT_FOUND` if no matching `tinywot_form`
+      can be found in the `tinywot_thing`.
+    - `::TINYWOT_STATUS_ERROR_NOT_ALLOWED` if there is at least one
+      `tinywot_form::target` matches, but no `tinywot_form::op` matches.
+      This usually means that the `tinywot_form::target` cannot accept
+      the requested interaction.
+    - `::TINYWOT_STATUS_SUCCESS` if a matching `tinywot_form` has been
+      returned via the `form` parameter.
+*/
+enum tinywot_status tinywot_thing_find_form(
+  struct tinywot_thing const *self,
+  struct tinywot_form **form,
+  char const *target,
+  enum tinywot_operation_type op
+);
+
+/*!
+  \brief Find a `tinywot_form` by a target of a known length.
+  \memberof tinywot_thing
+
+  This function is like `tinywot_thing_find_form()`, but `target` does
+  not need to be terminated by a NUL, e.g. when it points into the
+  receive buffer of a protocol binding (see
+  `tinywot_request::target_view`).
+
+  \param[in] self An instance of `tinywot_thing`.
+  \param[out] form A copy of pointer to the matching `form`.
+  \param[in] target A pointer to the characters of the target.
+  \param[in] target_length_byte The number of characters in `target`.
+  \param[in] op `tinywot_form::op`.
+  \return See `tinywot_thing_find_form()`.
+*/
+enum tinywot_status tinywot_thing_find_form_n(
+  struct tinywot_thing const *self,
+  struct tinywot_form **form,
+  char const *target,
+  size_t target_length_byte,
+  enum tinywot_operation_type op
+);
+
+/*!
+  \brief Get all operation types allowed on the target of a request.
+  \memberof tinywot_thing
+
+  The target is resolved from `request` as
+  `tinywot_thing_process_request()` does, and `tinywot_request::op` is
+  ignored. This lets a protocol binding tell a client what it can do
+  instead, e.g. to build an `Allow` header for a `405 Method Not
+  Allowed` response.
+
+  \param[in] self An instance of `tinywot_thing`.
+  \param[in] request A request.
+  \param[out] ops A set of `TINYWOT_OPERATION_TYPE_BIT()` of all
+  operation types allowed on the target.
+  \return
+    - `::TINYWOT_STATUS_ERROR_NOT_FOUND` if no `tinywot_form` has the
+      target.
+    - `::TINYWOT_STATUS_SUCCESS` if the operation has been successful.
+*/
+enum tinywot_status tinywot_thing_get_allowed_ops(
+  struct tinywot_thing const *self,
+  struct tinywot_request *request,
+  uint_least32_t *ops
+);
+
+/*!
+  \brief Copy a `tinywot_form` of a `tinywot_thing` into RAM.
+  \memberof tinywot_thing
+
+  This is needed for a `tinywot_form` returned by
+  `tinywot_thing_find_form()` when the forms are in program memory (see
+  `tinywot_thing_init_static_flash()`), and is a plain copy otherwise.
+  The strings pointed to by the copy are still in program memory.
+
+  \param[in] self An instance of `tinywot_thing`.
+  \param[in] form A `tinywot_form` of `self`.
+  \param[out] copy The memory to copy `form` into.
+*/
+void tinywot_thing_read_form(
+  struct tinywot_thing const *self,
+  struct tinywot_form const *form,
+  struct tinywot_form *copy
+);
+
+/*!
+  \brief Find a `tinywot_form` registered in the `tinywot_thing` by the
+  ID of its target.
+  \memberof tinywot_thing
+
+  `target_id` indexes `tinywot_thing::target_slots`, so no strings are
+  compared: this takes O(1) time, plus one step for every newer
+  `tinywot_form` of the same target that does not allow `op`. If the
+  targets of the `tinywot_thing` have not been interned (see
+  `tinywot_thing_intern_targets()`), no ID matches.
+
+  \param[in] self An instance of `tinywot_thing`.
+  \param[out] form A copy of pointer to the matching `form`.
+  \param[in] target_id The ID of `tinywot_form::target`.
+  \param[in] op `tinywot_form::op`.
+  \return See `tinywot_thing_find_form()`.
+*/
+enum tinywot_status tinywot_thing_find_form_by_id(
+  struct tinywot_thing const *self,
+  struct tinywot_form **form,
+  tinywot_target_id_t target_id,
+  enum tinywot_operation_type op
+);
+
+/*!
+  \brief Add (register) a `tinywot_form` to the `tinywot_thing`.
+  \memberof tinywot_thing
+
+  This function merely appends `form` to the end of list of
+  `tinywot_form` in the supplied `tinywot_thing`. If the list is full
+  but some `tinywot_form`s have been removed, it is compacted first (see
+  `tinywot_thing_compact_forms()`). Because
+  `tinywot_thing_find_form()` looks up the list from the end, adding a
+  `tinywot_form` with the same `tinywot_form::target` and
+  `tinywot_form::op` effectively overrides a formerly added (registered)
+  `tinywot_form`. Removing it (using `tinywot_thing_remove_form()`) can
+  re-enable the formerly added (registered) `tinywot_form`.
+
+  To change an already added (registered) `tinywot_form`, use
+  `tinywot_thing_change_form()`.
+
+  \param[inout] self An instance of `tinywot_thing`.
+  \param[in] form A pointer to a `tinywot_form` to be added (registered)
+  to the supplied `tinywot_thing`.
+  \return
+    - `::TINYWOT_STATUS_ERROR_NOT_ALLOWED` if `tinywot_form::ops` of
+      `form` contains `::TINYWOT_OPERATION_TYPE_UNKNOWN`.
+    - `::TINYWOT_STATUS_ERROR_NOT_ENOUGH_MEMORY` if there is not enough
+      space in the backing memory of the `tinywot_thing` (or its
+      `tinywot_router`) to insert a new `tinywot_form`.
+    - `::TINYWOT_STATUS_SUCCESS` if the operation has been successful.
+*/
+enum tinywot_status tinywot_thing_add_form(
+  struct tinywot_thing *self, struct tinywot_form const *form
+);
+
+/*!
+  \brief Modify a `tinywot_form` registered in the `tinywot_thing`.
+  \memberof tinywot_thing
+
+  This function first finds a matching form in the supplied
+  `tinywot_thing`, then overwrites it with the `tinywot_form` provided
+  via the `form` parameter.
+
+  \param[inout] self An instance of `tinywot_thing`.
+  \param[in] target `tinywot_form::target`.
+  \param[in] op `tinywot_form::op`.
+  \param[in] form The new `tinywot_form` replacing the matching one.
+  \return
+    - `::TINYWOT_STATUS_ERROR_NOT_ALLOWED` if the `tinywot_thing` is
+      initialized with a static list of forms, or if
+      `tinywot_form::ops` of `form` contains
+      `::TINYWOT_OPERATION_TYPE_UNKNOWN`.
+    - `::TINYWOT_STATUS_ERROR_NOT_FOUND` if the specified `target` and
+      `op` cannot match a registered `tinywot_form`.
+    - `::TINYWOT_STATUS_ERROR_NOT_ENOUGH_MEMORY` if the new target
+      cannot be inserted into the `tinywot_router` of the
+      `tinywot_thing`. Nothing is changed in this case.
+    - `::TINYWOT_STATUS_SUCCESS` if the operation has been successful.
+*/
+enum tinywot_status tinywot_thing_change_form(
+  struct tinywot_thing *self,
+  char const *target,
+  enum tinywot_operation_type op,
+  struct tinywot_form const *form
+);
+
+/*!
+  \brief Delete a `tinywot_form` registered in the `tinywot_thing`.
+  \memberof tinywot_thing
+
+  This function finds a matching form in the supplied `tinywot_thing`
+  as `tinywot_thing_find_form()` does, then marks it as removed, which
+  takes constant time. A `tinywot_form` overridden by the removed one
+  becomes visible again.
+
+  The space taken by a removed `tinywot_form` is not reclaimed until
+  `tinywot_thing_compact_forms()` is called, or
+  `tinywot_thing_add_form()` runs out of space. Until then, lookups
+  simply skip it.
+
+  A `tinywot_form` allowing more operation types (see
+  `tinywot_form::ops`) only stops allowing `op`, and is kept for the
+  others.
+
+  \param[inout] self An instance of `tinywot_thing`.
+  \param[in] target `tinywot_form::target`.
+  \param[in] op `tinywot_form::op`.
+  \return
+    - `::TINYWOT_STATUS_ERROR_NOT_ALLOWED` if the `tinywot_thing` is
+      initialized with a static list of forms, or if `target` matches
+      but `op` does not.
+    - `::TINYWOT_STATUS_ERROR_NOT_FOUND` if the specified `target` and
+      `op` cannot match a registered `tinywot_form`.
+    - `::TINYWOT_STATUS_SUCCESS` if the operation has been successful.
+*/
+enum tinywot_status tinywot_thing_remove_form(
+  struct tinywot_thing *self,
+  char const *target,
+  enum tinywot_operation_type op
+);
+
+/*!
+  \brief A mapping from submission targets to `tinywot_target_id_t`s.
+
+  The registry only holds pointers to target strings, so they must
+  point to `'static` memory, like `tinywot_form::target` does. The ID of
+  `targets[i]` is `i + 1`.
+*/
+struct tinywot_target_registry {
+  /*!
+    \brief A list of interned targets.
+  */
+  char const **targets;
+
+  /*!
+    \brief The number of interned targets in `targets`.
+  */
+  size_t targets_count_n;
+
+  /*!
+    \brief The maximum number of targets that `targets` can contain.
+  */
+  size_t targets_max_n;
+};
+
+/*!
+  \brief Initialize a `tinywot_target_registry` with RAM.
+  \memberof tinywot_target_registry
+
+  \param[inout] self An instance of `tinywot_target_registry`.
+  \param[in] memory A pointer to any segment of RAM.
+  \param[in] memory_size_byte The size of `memory` in byte.
+*/
+void tinywot_target_registry_init(
+  struct tinywot_target_registry *self, void *memory, size_t memory_size_byte
+);
+
+/*!
+  \brief Get the ID of a target, assigning a new one if it is not
+  interned yet.
+  \memberof tinywot_target_registry
+
+  \param[inout] self An instance of `tinywot_target_registry`.
+  \param[in] target A NUL-terminated target in `'static` memory.
+  \param[out] id The ID of `target`.
+  \return
+    - `::TINYWOT_STATUS_ERROR_NOT_ENOUGH_MEMORY` if `target` is new, and
+      there is no space left in the registry.
+    - `::TINYWOT_STATUS_SUCCESS` if the ID is returned via `id`.
+*/
+enum tinywot_status tinywot_target_registry_intern(
+  struct tinywot_target_registry *self,
+  char const *target,
+  tinywot_target_id_t *id
+);
+
+/*!
+  \brief Get the ID of an interned target.
+  \memberof tinywot_target_registry
+
+  This is what a protocol binding should use to resolve a target string
+  from a request. `target` can point to any memory.
+
+  \param[in] self An instance of `tinywot_target_registry`.
+  \param[in] target A NUL-terminated target.
+  \param[out] id The ID of `target`.
+  \return
+    - `::TINYWOT_STATUS_ERROR_NOT_FOUND` if `target` is not interned.
+    - `::TINYWOT_STATUS_SUCCESS` if the ID is returned via `id`.
+*/
+enum tinywot_status tinywot_target_registry_find(
+  struct tinywot_target_registry const *self,
+  char const *target,
+  tinywot_target_id_t *id
+);
+
+/*!
+  \brief Intern the targets of all `tinywot_form`s in a `tinywot_thing`.
+  \memberof tinywot_thing
+
+  This interns the target of every registered `tinywot_form` into
+  `registry`, then builds `tinywot_thing::target_slots` in `memory`, so
+  that `tinywot_request::target_id`s from `registry` are looked up by
+  array indexing. The `tinywot_form`s themselves are not changed, so
+  this works on a static list of forms as well.
+
+  `tinywot_thing_add_form()`, `tinywot_thing_change_form()`,
+  `tinywot_thing_remove_form()` and `tinywot_thing_compact_forms()` keep
+  the slots up to date. A `tinywot_form` added later with a target not
+  in `registry` cannot be found by ID; intern the targets again for it.
+  Use `TINYWOT_THING_TARGET_SLOTS_SIZE_BYTE()` with
+  `tinywot_target_registry::targets_max_n` and
+  `tinywot_thing::forms_max_n` (or `tinywot_thing::forms_count_n` for a
+  static list of forms) to calculate the size of `memory`.
+
+  \param[inout] self An instance of `tinywot_thing`.
+  \param[inout] registry An instance of `tinywot_target_registry`.
+  \param[in] memory A pointer to any segment of RAM.
+  \param[in] memory_size_byte The size of `memory` in byte.
+  \return
+    - `::TINYWOT_STATUS_ERROR_NOT_ALLOWED` if the `tinywot_thing` is
+      initialized with a list of forms in program memory.
+    - `::TINYWOT_STATUS_ERROR_NOT_ENOUGH_MEMORY` if `registry` is full,
+      or `memory_size_byte` is too small. The `tinywot_thing` is left
+      without target slots.
+    - `::TINYWOT_STATUS_SUCCESS` if all targets have been interned.
+*/
+enum tinywot_status tinywot_thing_intern_targets(
+  struct tinywot_thing *self,
+  struct tinywot_target_registry *registry,
+  void *memory,
+  size_t memory_size_byte
+);
+
+/*!
+  \brief Reclaim the space taken by removed `tinywot_form`s.
+  \memberof tinywot_thing
+
+  This moves all remaining `tinywot_form`s to the front of
+  `tinywot_thing::forms`, keeping their order, and rebuilds the index
+  of the `tinywot_thing` if it has one. Pointers to `tinywot_form`s in
+  the `tinywot_thing` obtained before are invalidated.
+
+  This takes O(n) time, or O(n log n) with an index. It is a no-op if no
+  `tinywot_form` has been removed.
+
+  \param[inout] self An instance of `tinywot_thing`.
+*/
+void tinywot_thing_compact_forms(struct tinywot_thing *self);
+
+/*!
+  \brief Transforming a `tinywot_request` to a `tinywot_response` with
+  the `tinywot_thing`.
+  \memberof tinywot_thing
+
+  If the `tinywot_thing` has a `tinywot_router` and
+  `tinywot_request::target_id` is not set, `tinywot_request::target` is
+  matched against it, and the matching form target is then used to find
+  a `tinywot_form`. Parts captured by wildcards are stored in
+  `tinywot_request::params`.
+
+  \param[in] self An instance of `tinywot_thing`.
+  \param[out] response An outgoing `tinywot_response`.
+  \param[in] request An incoming `tinywot_request`.
+  \return
+    - `::TINYWOT_STATUS_ERROR_NOT_IMPLEMENTED` if a matching
+      `tinywot_form` is found, but it has no registered handler
+      function (`tinywot_form::handler` is `NULL`), or
+      `tinywot_request::fragment` is set but the form does not have
+      `::TINYWOT_FORM_FLAG_STREAMING`.
+    - `::TINYWOT_STATUS_ERROR_NOT_FOUND` if the requested
+      `tinywot_request::target` (or `tinywot_request::target_id`, if it
+      is set) and `tinywot_request::op` cannot match a
+      registered `tinywot_form`. An empty response with this status is
+      prepared in the supplied `tinywot_response` in this case.
+    - `::TINYWOT_STATUS_ERROR_NOT_ALLOWED` if at least one
+      `tinywot_form` can be found with `tinywot_request::target`, but
+      none matches `tinywot_request::op`.
+    - `::TINYWOT_STATUS_ERROR_NOT_ENOUGH_MEMORY` if an observer should
+      be registered (see `tinywot_thing_init_observers()`), but the pool
+      is full. The response status is then
+      `::TINYWOT_RESPONSE_STATUS_INTERNAL_ERROR`.
+    - `::TINYWOT_STATUS_NOT_FINISHED` if the handler has written a block
+      of the response, and there are more. The response status is
+      `::TINYWOT_RESPONSE_STATUS_OK`. Send the block, call
+      `tinywot_response_next_block()`, then call this function again
+      with the same request.
+    - `::TINYWOT_STATUS_PENDING` if the handler will respond later with
+      `tinywot_response_complete()`. The response status is
+      `::TINYWOT_RESPONSE_STATUS_PENDING`.
+    - `::TINYWOT_STATUS_SUCCESS` if the request has been successfully
+      processed with the `tinywot_thing`.
+    - Other codes are also possible if the registered handler function
+      returns them.
+*/
+enum tinywot_status tinywot_thing_process_request(
+  struct tinywot_thing const *self,
+  struct tinywot_response *response,
+  struct tinywot_request *request
+);
+
+/*!
+  \brief Transform an array of `tinywot_request`s to an array of
+  `tinywot_response`s with the `tinywot_thing`.
+  \memberof tinywot_thing
+
+  This is like calling `tinywot_thing_process_request()` on each pair of
+  `requests[i]` and `responses[i]`, for protocol bindings receiving many
+  requests at once (e.g. with `recvmmsg()`). Requests with the same
+  target and op share one lookup, and are processed one after another,
+  so that their handler stays hot in the cache.
+
+  Requests may therefore be processed out of order, but never across
+  another request on the same target: requests on each target are
+  always processed in their order in `requests`. Two requests are on the
+  same target if they have the same `tinywot_request::target_id`, or no
+  ID and the same `tinywot_request::target`.
+
+  Finding requests to group takes O(n^2) comparisons of targets
+  in the worst case, so keep `requests_n` in the tens.
+
+  \param[in] self An instance of `tinywot_thing`.
+  \param[out] responses An array of `requests_n` outgoing
+  `tinywot_response`s.
+  \param[in] requests An array of `requests_n` incoming
+  `tinywot_request`s.
+  \param[in] requests_n The number of requests.
+  \param[out] statuses An optional array of `requests_n` elements, to
+  receive the status each response has been made from, e.g.
+  `::TINYWOT_STATUS_NOT_FINISHED` for a response to be sent in blocks.
+  This can be `NULL`.
+  \return `::TINYWOT_STATUS_SUCCESS`. Each response has its own
+  `tinywot_response::status`.
+*/
+enum tinywot_status tinywot_thing_process_requests(
+  struct tinywot_thing const *self,
+  struct tinywot_response *responses,
+  struct tinywot_request *requests,
+  size_t requests_n,
+  enum tinywot_status *statuses
+);
+
+/*!
+  \brief Set up a pool of `tinywot_observer`s for a `tinywot_thing`.
+  \memberof tinywot_thing
+
+  Afterwards, `tinywot_thing_process_request()` handles these operations
+  on top of calling the handler of the matching `tinywot_form`:
+
+  - `::TINYWOT_OPERATION_TYPE_OBSERVEPROPERTY`,
+    `::TINYWOT_OPERATION_TYPE_SUBSCRIBEEVENT`,
+    `::TINYWOT_OPERATION_TYPE_OBSERVEALLPROPERTIES` and
+    `::TINYWOT_OPERATION_TYPE_SUBSCRIBEALLEVENTS` register an observer
+    with `tinywot_request::origin`, or update the existing one with the
+    same origin.
+  - `::TINYWOT_OPERATION_TYPE_UNOBSERVEPROPERTY`,
+    `::TINYWOT_OPERATION_TYPE_UNSUBSCRIBEEVENT`,
+    `::TINYWOT_OPERATION_TYPE_UNOBSERVEALLPROPERTIES` and
+    `::TINYWOT_OPERATION_TYPE_UNSUBSCRIBEALLEVENTS` remove it.
+
+  A matching `tinywot_form` is still required for these operations, but
+  its handler can be `NULL`. If the handler fails, no observer is
+  registered or removed.
+
+  Observers keep `tinywot_form::target` and compare it with the targets
+  passed to `tinywot_thing_mark_dirty()` in RAM, so they cannot be used
+  with forms in program memory, or with a router, whose form targets
+  are patterns rather than the targets being observed.
+
+  \param[inout] self An instance of `tinywot_thing`.
+  \param[in] memory A pointer to an array of `tinywot_observer`.
+  \param[in] memory_size_byte The size of `memory` in byte.
+  \return
+    - `::TINYWOT_STATUS_ERROR_NOT_ALLOWED` if the forms are in program
+      memory (see `tinywot_thing_init_static_flash()`), or the
+      `tinywot_thing` has a router (see `tinywot_thing_init_router()`).
+      The `tinywot_thing` is left without observers.
+    - `::TINYWOT_STATUS_SUCCESS` if the operation has been successful.
+*/
+enum tinywot_status tinywot_thing_init_observers(
+  struct tinywot_thing *self, void *memory, size_t memory_size_byte
+);
+
+#ifdef TINYWOT_ENABLE_INSTRUMENTATION
+/*!
+  \brief Set up a `tinywot_instrumentation` for a `tinywot_thing`.
+  \memberof tinywot_thing
+
+  All counters of `instrumentation` are cleared, and `clock` and the
+  hooks are reset to `NULL`. `memory` holds a `tinywot_form_stats` for
+  each form, so it should be large enough for `tinywot_thing::forms_max_n`
+  (or `tinywot_thing::forms_count_n` for a static list of forms) of them.
+  `tinywot_thing_compact_forms()` moves statistics together with forms.
+
+  \param[inout] self An instance of `tinywot_thing`.
+  \param[inout] instrumentation An instance of `tinywot_instrumentation`.
+  \param[in] memory A pointer to an array of `tinywot_form_stats`.
+  \param[in] memory_size_byte The size of `memory` in byte.
+*/
+void tinywot_thing_init_instrumentation(
+  struct tinywot_thing *self,
+  struct tinywot_instrumentation *instrumentation,
+  void *memory,
+  size_t memory_size_byte
+);
+#endif
+
+/*!
+  \brief Mark observers of a target as having a pending notification.
+  \memberof tinywot_thing
+
+  Call this when a property has changed, or an event has been emitted.
+  Observers of `target` are marked, and so are observers of all
+  properties (or events), if the `tinywot_thing` has a form of
+  `::TINYWOT_OPERATION_TYPE_OBSERVEPROPERTY` (or
+  `::TINYWOT_OPERATION_TYPE_SUBSCRIBEEVENT`) on `target`. Marking an
+  observer twice before it is notified results in one notification.
+
+  This takes O(n) time, where n is the size of the observer pool.
+
+  \param[in] self An instance of `tinywot_thing`.
+  \param[in] target The target of the changed property or event.
+  \return The number of observers marked.
+*/
+size_t tinywot_thing_mark_dirty(
+  struct tinywot_thing const *self, char const *target
+);
+
+/*!
+  \brief Get the next `tinywot_observer` to notify.
+  \memberof tinywot_thing
+
+  The dirty mark of the returned observer is cleared. A protocol
+  binding calls this until it fails, e.g. in its main loop after
+  `tinywot_thing_mark_dirty()`, then sleeps.
+
+  \param[in] self An instance of `tinywot_thing`.
+  \param[out] observer The observer to notify.
+  \return
+    - `::TINYWOT_STATUS_ERROR_NOT_FOUND` if there is no pending
+      notification.
+    - `::TINYWOT_STATUS_SUCCESS` if the operation has been successful.
+*/
+enum tinywot_status tinywot_thing_next_notification(
+  struct tinywot_thing const *self, struct tinywot_observer **observer
+);
+
+/*!
+  \brief Prepare a notification for a `tinywot_observer`.
+  \memberof tinywot_thing
+
+  For property observers, the content of the notification is produced
+  by the handler of the form of `::TINYWOT_OPERATION_TYPE_READPROPERTY`
+  (or `::TINYWOT_OPERATION_TYPE_READALLPROPERTIES`) on
+  `tinywot_observer::target`. For event subscribers, the handler of the
+  form they have subscribed with is called again, with
+  `tinywot_observer::value` as the request payload (an
+  `uint_least32_t`), or the notification is empty if it has no handler.
+  The handler gets a `tinywot_request` with `tinywot_request::origin`
+  set to the one of the observer.
+
+  \param[in] self An instance of `tinywot_thing`.
+  \param[out] response An outgoing `tinywot_response`.
+  \param[in] observer The observer to notify.
+  \return
+    - `::TINYWOT_STATUS_ERROR_NOT_FOUND` if the forms needed have been
+      removed. The observer should then be removed with
+      `tinywot_thing_remove_observer()`.
+    - `::TINYWOT_STATUS_ERROR_NOT_IMPLEMENTED` if the form of a property
+      has no handler.
+    - `::TINYWOT_STATUS_SUCCESS` if the notification has been prepared.
+    - Other codes are also possible if the handler returns them.
+*/
+enum tinywot_status tinywot_thing_process_notification(
+  struct tinywot_thing const *self,
+  struct tinywot_response *response,
+  struct tinywot_observer const *observer
+);
+
+/*!
+  \brief Remove a `tinywot_observer`.
+  \memberof tinywot_thing
+
+  This is for protocol bindings noticing that an observer is gone, e.g.
+  on a CoAP Reset message.
+
+  \param[in] self An instance of `tinywot_thing`.
+  \param[inout] observer The observer to remove.
+*/
+void tinywot_thing_remove_observer(
+  struct tinywot_thing const *self, struct tinywot_observer *observer
+);
+
+/*!
+  \brief Mark observers with all events in a `tinywot_event_ring`.
+  \memberof tinywot_thing
+
+  This takes every event in `ring`, and does
+  `tinywot_thing_mark_dirty()` with its target. The value of the event
+  is stored in `tinywot_observer::value` of each marked observer, so
+  when several events of one target are drained before a notification,
+  the latest value is notified.
+
+  This is called by the consumer of `ring`, e.g. the main loop, before
+  `tinywot_thing_next_notification()`.
+
+  \param[in] self An instance of `tinywot_thing`.
+  \param[inout] ring The ring to drain.
+  \return The number of events drained.
+*/
+size_t tinywot_thing_drain_events(
+  struct tinywot_thing const *self, struct tinywot_event_ring *ring
+);
+
+/*!
+  \brief Take all pending notifications with the same content.
+  \memberof tinywot_thing
+
+  This is `tinywot_thing_next_notification()` for many observers at
+  once: it takes the first dirty observer, and every other dirty
+  observer on the same target registered with the same operation type,
+  whose notifications are the same. Their dirty marks are cleared.
+  Prepare the notification once for `observers[0]`, e.g. with
+  `tinywot_thing_process_shared_notification()`, then send it to all of
+  them.
+
+  This takes O(n) time, where n is the size of the observer pool.
+
+  \param[in] self An instance of `tinywot_thing`.
+  \param[out] observers An array to receive the observers.
+  \param[in] observers_max_n The number of elements in `observers`.
+  Observers that do not fit are left dirty for the next call.
+  \return The number of observers taken, or 0 if there is no pending
+  notification.
+*/
+size_t tinywot_thing_take_notifications(
+  struct tinywot_thing const *self,
+  struct tinywot_observer **observers,
+  size_t observers_max_n
+);
+
+/*!
+  \brief A reference-counted `tinywot_response` from a
+  `tinywot_response_pool`.
+  \extends tinywot_response
+
+  This lets one serialized notification be sent to many observers: each
+  send path holds a reference, and the buffer goes back to the pool when
+  the last one is released.
+*/
+struct tinywot_shared_response {
+  /*!
+    \brief The response, whose `tinywot_payload::content` is a buffer of
+    the pool.
+  */
+  struct tinywot_response response;
+
+  /*!
+    \brief The number of references. The response is free if this is 0.
+
+    This is only changed with the `TINYWOT_ATOMIC_*` operations, so
+    references can be released from other tasks or interrupts.
+  */
+  unsigned int references_n;
+};
+
+/*!
+  \brief A pool of `tinywot_shared_response`s with buffers of the same
+  size.
+
+  The pool is not thread-safe: acquire, retain and release references
+  from the same task, e.g. the main loop.
+*/
+struct tinywot_response_pool {
+  /*!
+    \brief The responses.
+  */
+  struct tinywot_shared_response *responses;
+
+  /*!
+    \brief The number of elements in `responses`.
+  */
+  size_t responses_max_n;
+};
+
+/*!
+  \brief Initialize a `tinywot_response_pool` with RAM.
+  \memberof tinywot_response_pool
+
+  There are as many responses as `responses_memory` can hold, and
+  `buffers_memory` is split evenly into a buffer for each of them.
+
+  \param[inout] self An instance of `tinywot_response_pool`.
+  \param[in] responses_memory A pointer to an array of
+  `tinywot_shared_response`.
+  \param[in] responses_memory_size_byte The size of `responses_memory` in
+  byte.
+  \param[in] buffers_memory A pointer to any segment of RAM.
+  \param[in] buffers_memory_size_byte The size of `buffers_memory` in
+  byte.
+*/
+void tinywot_response_pool_init(
+  struct tinywot_response_pool *self,
+  void *responses_memory,
+  size_t responses_memory_size_byte,
+  void *buffers_memory,
+  size_t buffers_memory_size_byte
+);
+
+/*!
+  \brief Get a free response from a `tinywot_response_pool`.
+  \memberof tinywot_response_pool
+
+  The response is empty, with its buffer as `tinywot_payload::content`,
+  and has one reference.
+
+  \param[inout] self An instance of `tinywot_response_pool`.
+  \param[out] response The response.
+  \return
+    - `::TINYWOT_STATUS_ERROR_NOT_ENOUGH_MEMORY` if all responses are in
+      use.
+    - `::TINYWOT_STATUS_SUCCESS` if the response has been returned via
+      `response`.
+*/
+enum tinywot_status tinywot_response_pool_acquire(
+  struct tinywot_response_pool *self,
+  struct tinywot_shared_response **response
+);
+
+/*!
+  \brief Add a reference to a `tinywot_shared_response`.
+  \memberof tinywot_shared_response
+
+  \param[inout] self An instance of `tinywot_shared_response`.
+*/
+void tinywot_shared_response_retain(struct tinywot_shared_response *self);
+
+/*!
+  \brief Drop a reference to a `tinywot_shared_response`.
+  \memberof tinywot_shared_response
+
+  The response goes back to its pool with the last reference, so it
+  must not be used by the caller afterwards. Releasing a response
+  without references does nothing.
+
+  \param[inout] self An instance of `tinywot_shared_response`.
+*/
+void tinywot_shared_response_release(struct tinywot_shared_response *self);
+
+/*!
+  \brief Prepare one notification for many observers.
+  \memberof tinywot_thing
+
+  This takes observers with `tinywot_thing_take_notifications()`, and
+  prepares their notification once, with
+  `tinywot_thing_process_notification()` for `observers[0]`, into a
+  response from `pool`. The response has one reference for each
+  observer taken, so release it once after each send has finished.
+
+  The handler only sees `tinywot_request::origin` of `observers[0]`, so
+  do not share notifications whose content depends on the observer.
+
+  \param[in] self An instance of `tinywot_thing`.
+  \param[inout] pool The pool to get a response from.
+  \param[out] observers An array to receive the observers.
+  \param[in] observers_max_n The number of elements in `observers`.
+  \param[out] observers_n The number of observers taken, which is also
+  set on failure.
+  \param[out] response The prepared response.
+  \return
+    - `::TINYWOT_STATUS_ERROR_NOT_FOUND` if there is no pending
+      notification (`observers_n` is 0), or the forms needed have been
+      removed; see `tinywot_thing_process_notification()`.
+    - `::TINYWOT_STATUS_ERROR_NOT_ENOUGH_MEMORY` if `pool` is empty. The
+      observers are marked dirty again.
+    - `::TINYWOT_STATUS_SUCCESS` if the notification has been prepared.
+    - Other codes from `tinywot_thing_process_notification()`, in which
+      case no response is returned.
+*/
+enum tinywot_status tinywot_thing_process_shared_notification(
+  struct tinywot_thing const *self,
+  struct tinywot_response_pool *pool,
+  struct tinywot_observer **observers,
+  size_t observers_max_n,
+  size_t *observers_n,
+  struct tinywot_shared_response **response
+);
+
+/*!
+  \brief Atomic operations on an `unsigned int`, used by
+  `tinywot_thing_rcu` and `tinywot_shared_response`.
+
+  These default to the `__atomic` (and `__sync`) builtins of GCC and
+  Clang, if they are lock-free for `unsigned int` on the target.
+  Otherwise they are plain `volatile` accesses around
+  `TINYWOT_MEMORY_BARRIER()`, which is only enough for targets with a
+  single core and no preemption, e.g. AVR. Define all five of them to
+  use other primitives, e.g. of an RTOS.
+
+  `TINYWOT_ATOMIC_COMPARE_EXCHANGE(p, e, d)` sets `*p` to `d` if it is
+  `e`, and evaluates to whether it has done so.
+*/
+#ifndef TINYWOT_ATOMIC_LOAD
+#if defined(__GCC_ATOMIC_INT_LOCK_FREE) && __GCC_ATOMIC_INT_LOCK_FREE == 2
+#define TINYWOT_ATOMIC_LOAD(p) __atomic_load_n((p), __ATOMIC_SEQ_CST)
+#define TINYWOT_ATOMIC_STORE(p, v) \
+  __atomic_store_n((p), (v), __ATOMIC_SEQ_CST)
+#define TINYWOT_ATOMIC_INCREMENT(p) \
+  ((void)__atomic_add_fetch((p), 1U, __ATOMIC_SEQ_CST))
+#define TINYWOT_ATOMIC_DECREMENT(p) \
+  ((void)__atomic_sub_fetch((p), 1U, __ATOMIC_SEQ_CST))
+#define TINYWOT_ATOMIC_COMPARE_EXCHANGE(p, e, d) \
+  __sync_bool_compare_and_swap((p), (e), (d))
+#else
+#define TINYWOT_ATOMIC_LOAD(p) (TINYWOT_MEMORY_BARRIER(), *(p))
+#define TINYWOT_ATOMIC_STORE(p, v) \
+  (TINYWOT_MEMORY_BARRIER(), *(p) = (v), TINYWOT_MEMORY_BARRIER())
+#define TINYWOT_ATOMIC_INCREMENT(p) \
+  (TINYWOT_MEMORY_BARRIER(), *(p) += 1U, TINYWOT_MEMORY_BARRIER())
+#define TINYWOT_ATOMIC_DECREMENT(p) \
+  (TINYWOT_MEMORY_BARRIER(), *(p) -= 1U, TINYWOT_MEMORY_BARRIER())
+#define TINYWOT_ATOMIC_COMPARE_EXCHANGE(p, e, d) \
+  (TINYWOT_MEMORY_BARRIER(), \
+   *(p) == (e) ? (*(p) = (d), TINYWOT_MEMORY_BARRIER(), 1) : 0)
+#endif
+#endif
+
+/*!
+  \brief A `tinywot_thing` shared by several tasks or cores.
+
+  Modifying a `tinywot_thing` while another task is processing a request
+  on it is not safe: `tinywot_thing_change_form()`, for example, copies
+  over a form that may be being read. A `tinywot_thing_rcu` keeps two
+  versions of a `tinywot_thing` instead, in the manner of read-copy-update
+  (RCU):
+
+  - Readers take the current version with `tinywot_thing_rcu_read_lock()`
+    (or `tinywot_thing_rcu_process_request()`). They take no lock and do
+    not wait, and see the same forms until
+    `tinywot_thing_rcu_read_unlock()`.
+  - A writer takes a copy of the current version with
+    `tinywot_thing_rcu_update_begin()`, modifies it with the usual
+    methods of `tinywot_thing`, and makes it the current version with
+    `tinywot_thing_rcu_update_publish()`.
+
+  The previous version is reclaimed by the next
+  `tinywot_thing_rcu_update_begin()`, which fails without waiting if
+  there are still readers of it. There can only be one writer at a time;
+  use a mutex of the RTOS if several tasks modify forms.
+
+  Only forms are copied between versions. An index, hash table, router,
+  observer pool or target slots must not be set up on a version, since
+  readers would then modify shared memory (observers) or see it change
+  (the others); `tinywot_thing_rcu_update_begin()` refuses to copy
+  between versions with any of them.
+*/
+struct tinywot_thing_rcu {
+  /*!
+    \brief The two versions.
+  */
+  struct tinywot_thing versions[2];
+
+  /*!
+    \brief The position of the current version in `versions`.
+  */
+  unsigned int current;
+
+  /*!
+    \brief The number of readers on each of `versions`.
+  */
+  unsigned int readers_n[2];
+};
+
+/*!
+  \brief Initialize a `tinywot_thing_rcu` with no forms.
+  \memberof tinywot_thing_rcu
+
+  `memory` is split into two halves, one for each version, so it must be
+  twice as large as the memory for one `tinywot_thing`. This function
+  is not thread-safe.
+
+  \param[inout] self An instance of `tinywot_thing_rcu`.
+  \param[in] memory A pointer to a memory region holding forms.
+  \param[in] memory_size_byte The size of `memory` in byte.
+*/
+void tinywot_thing_rcu_init(
+  struct tinywot_thing_rcu *self, void *memory, size_t memory_size_byte
+);
+
+/*!
+  \brief Start reading the current version of a `tinywot_thing_rcu`.
+  \memberof tinywot_thing_rcu
+
+  The returned `tinywot_thing` stays valid and unchanged until it is
+  given back to `tinywot_thing_rcu_read_unlock()`. Readers should not
+  hold it for long, as the next update cannot start before that.
+
+  \param[inout] self An instance of `tinywot_thing_rcu`.
+  \return The current version.
+*/
+struct tinywot_thing const *tinywot_thing_rcu_read_lock(
+  struct tinywot_thing_rcu *self
+);
+
+/*!
+  \brief Stop reading a version of a `tinywot_thing_rcu`.
+  \memberof tinywot_thing_rcu
+
+  \param[inout] self An instance of `tinywot_thing_rcu`.
+  \param[in] thing A version returned by `tinywot_thing_rcu_read_lock()`.
+*/
+void tinywot_thing_rcu_read_unlock(
+  struct tinywot_thing_rcu *self, struct tinywot_thing const *thing
+);
+
+/*!
+  \brief Process a request on the current version of a
+  `tinywot_thing_rcu`.
+  \memberof tinywot_thing_rcu
+
+  This does `tinywot_thing_process_request()` between
+  `tinywot_thing_rcu_read_lock()` and `tinywot_thing_rcu_read_unlock()`.
+  It can be called from several tasks at the same time.
+
+  \param[inout] self An instance of `tinywot_thing_rcu`.
+  \param[inout] response See `tinywot_thing_process_request()`.
+  \param[inout] request See `tinywot_thing_process_request()`.
+  \return See `tinywot_thing_process_request()`.
+*/
+enum tinywot_status tinywot_thing_rcu_process_request(
+  struct tinywot_thing_rcu *self,
+  struct tinywot_response *response,
+  struct tinywot_request *request
+);
+
+/*!
+  \brief Start updating a `tinywot_thing_rcu`.
+  \memberof tinywot_thing_rcu
+
+  This copies the forms of the current version into the other version,
+  and returns it via `thing`. Modify it with e.g.
+  `tinywot_thing_add_form()`, then call
+  `tinywot_thing_rcu_update_publish()`. To give up the update, just do
+  not publish it.
+
+  \param[inout] self An instance of `tinywot_thing_rcu`.
+  \param[out] thing The version to modify.
+  \return
+    - `::TINYWOT_STATUS_ERROR_NOT_ALLOWED` if either version has an
+      index, a hash table, a router, an observer pool or target slots.
+    - `::TINYWOT_STATUS_NOT_FINISHED` if the other version is still
+      being read. Nothing is changed; try again later.
+    - `::TINYWOT_STATUS_SUCCESS` if the operation has been successful.
+*/
+enum tinywot_status tinywot_thing_rcu_update_begin(
+  struct tinywot_thing_rcu *self, struct tinywot_thing **thing
+);
+
+/*!
+  \brief Make the version from `tinywot_thing_rcu_update_begin()` the
+  current version.
+  \memberof tinywot_thing_rcu
+
+  Readers already holding the previous version keep it; later readers
+  get the new one.
+
+  \param[inout] self An instance of `tinywot_thing_rcu`.
+*/
+void tinywot_thing_rcu_update_publish(struct tinywot_thing_rcu *self);
+
+/*!
+  \brief A read-only list of forms in a compact layout.
+
+  A `tinywot_form` carries fields which many forms do not need, and
+  padding between them. A `tinywot_form_table` stores forms as a
+  structure of arrays instead: the `i`-th form is made of the `i`-th
+  element of each array. Only `targets`, `ops` and `handlers` are
+  required, and `ops` takes one byte per form, so nothing is padded.
+  Looking up a form only scans `targets`, `ops` and `op_sets`.
+
+  This is meant for small devices with a fixed set of forms, e.g.:
+
+      static char const *const targets[] = {"/status", "/toggle"};
+      static uint_least8_t const ops[] = {
+        TINYWOT_OPERATION_TYPE_READPROPERTY,
+        TINYWOT_OPERATION_TYPE_INVOKEACTION,
+      };
+      static tinywot_form_handler_t *const handlers[] = {
+        status_read, toggle_invoke,
+      };
+      static struct tinywot_form_table const table = {
+        .targets = targets,
+        .ops = ops,
+        .handlers = handlers,
+        .forms_count_n = 2,
+      };
+
+  It does not support routers, target IDs, request fragments or
+  observers; use a `tinywot_thing` for them.
+*/
+struct tinywot_form_table {
+  /*!
+    \brief The `tinywot_form::target` of each form.
+  */
+  char const *const *targets;
+
+  /*!
+    \brief The `tinywot_form::op` of each form.
+
+    A form with `::TINYWOT_OPERATION_TYPE_UNKNOWN` is skipped, as a
+    removed `tinywot_form` is.
+  */
+  uint_least8_t const *ops;
+
+  /*!
+    \brief The `tinywot_form::ops` of each form, or `NULL` if every form
+    allows its `ops` element only.
+  */
+  uint_least32_t const *op_sets;
+
+  /*!
+    \brief The `tinywot_form::handler` of each form.
+  */
+  tinywot_form_handler_t *const *handlers;
+
+  /*!
+    \brief The `tinywot_form::name` of each form, or `NULL` if no form
+    has a name.
+  */
+  char const *const *names;
+
+  /*!
+    \brief The `tinywot_form::context` of each form, or `NULL` if no
+    handler takes a context.
+  */
+  void *const *contexts;
+
+  /*!
+    \brief The number of forms, i.e. of elements in each array.
+  */
+  size_t forms_count_n;
+};
+
+/*!
+  \brief Find a form in a `tinywot_form_table`.
+  \memberof tinywot_form_table
+
+  Like `tinywot_thing_find_form()`, forms later in the table take
+  precedence, and a form matches `op` if it is its `ops` element or in
+  its `op_sets` element.
+
+  \param[in] self An instance of `tinywot_form_table`.
+  \param[out] position The position of the form found.
+  \param[in] target The submission target to look up.
+  \param[in] op The operation type to look up.
+  \return
+    - `::TINYWOT_STATUS_ERROR_NOT_ALLOWED` if at least one form can be
+      found with `target`, but none matches `op`.
+    - `::TINYWOT_STATUS_ERROR_NOT_FOUND` if no form can be found.
+    - `::TINYWOT_STATUS_SUCCESS` if a form has been returned via
+      `position`.
+*/
+enum tinywot_status tinywot_form_table_find(
+  struct tinywot_form_table const *self,
+  size_t *position,
+  char const *target,
+  enum tinywot_operation_type op
+);
+
+/*!
+  \brief Process a request with a `tinywot_form_table`.
+  \memberof tinywot_form_table
+
+  This is `tinywot_thing_process_request()` for a `tinywot_form_table`.
+  `tinywot_request::target_id` is ignored, and a request with
+  `tinywot_request::fragment` set is responded with
+  `::TINYWOT_RESPONSE_STATUS_NOT_SUPPORTED`.
+
+  \param[in] self An instance of `tinywot_form_table`.
+  \param[out] response An outgoing `tinywot_response`.
+  \param[in] request An incoming `tinywot_request`.
+  \return See `tinywot_thing_process_request()`.
+*/
+enum tinywot_status tinywot_form_table_process_request(
+  struct tinywot_form_table const *self,
+  struct tinywot_response *response,
+  struct tinywot_request *request
+);
+
+/*!
+  \brief A `tinywot_thing` hosted by a `tinywot_servient` under a base
+  path.
+*/
+struct tinywot_servient_thing {
+  /*!
+    \brief The path that all targets of the `tinywot_thing` start with,
+    e.g. `/devices/42`.
+
+    It should point to `'static` memory, like `tinywot_form::target`
+    does. It must not end with a slash; an empty base matches every
+    target that no other base matches.
+  */
+  char const *base;
+
+  /*!
+    \brief The length of `base` in byte.
+  */
+  size_t base_length_byte;
+
+  /*!
+    \brief The hosted `tinywot_thing`.
+  */
+  struct tinywot_thing const *thing;
+};
+
+/*!
+  \brief A table of `tinywot_thing`s keyed by base path, for gateways
+  hosting many (e.g. proxied) Things behind one protocol binding.
+
+  Requests are routed in two stages: the `tinywot_thing` whose base is
+  the longest prefix of the target (ending before a slash or at the end
+  of the target), then a form in that `tinywot_thing` by the rest of the
+  target. The table is kept sorted by base, so the first stage takes
+  O(log n) string comparisons for each slash in the target.
+
+  For example, with `/devices/42` registered, a request on
+  `/devices/42/status` is processed by its `tinywot_thing` as a request
+  on `/status`.
+*/
+struct tinywot_servient {
+  /*!
+    \brief The hosted `tinywot_thing`s, sorted by
+    `tinywot_servient_thing::base`.
+  */
+  struct tinywot_servient_thing *things;
+
+  /*!
+    \brief The number of `tinywot_thing`s in `things`.
+  */
+  size_t things_count_n;
+
+  /*!
+    \brief The maximum number of `tinywot_thing`s that `things` can
+    contain.
+  */
+  size_t things_max_n;
+};
+
+/*!
+  \brief Initialize a `tinywot_servient` with RAM.
+  \memberof tinywot_servient
+
+  \param[inout] self An instance of `tinywot_servient`.
+  \param[in] memory A pointer to an array of `tinywot_servient_thing`.
+  \param[in] memory_size_byte The size of `memory` in byte.
+*/
+void tinywot_servient_init(
+  struct tinywot_servient *self, void *memory, size_t memory_size_byte
+);
+
+/*!
+  \brief Host a `tinywot_thing` in a `tinywot_servient`.
+  \memberof tinywot_servient
+
+  This takes O(n) time to keep the table sorted, which is meant to
+  happen rarely compared to requests.
+
+  \param[inout] self An instance of `tinywot_servient`.
+  \param[in] base A NUL-terminated base path in `'static` memory (see
+  `tinywot_servient_thing::base`).
+  \param[in] thing The `tinywot_thing` to host.
+  \return
+    - `::TINYWOT_STATUS_ERROR_NOT_ALLOWED` if `base` ends with a slash,
+      or another `tinywot_thing` is already hosted on `base`.
+    - `::TINYWOT_STATUS_ERROR_NOT_ENOUGH_MEMORY` if the table is full.
+    - `::TINYWOT_STATUS_SUCCESS` if `thing` has been added.
+*/
+enum tinywot_status tinywot_servient_add_thing(
+  struct tinywot_servient *self,
+  char const *base,
+  struct tinywot_thing const *thing
+);
+
+/*!
+  \brief Stop hosting the `tinywot_thing` on a base path.
+  \memberof tinywot_servient
+
+  \param[inout] self An instance of `tinywot_servient`.
+  \param[in] base A NUL-terminated base path.
+  \return
+    - `::TINYWOT_STATUS_ERROR_NOT_FOUND` if no `tinywot_thing` is hosted
+      on `base`.
+    - `::TINYWOT_STATUS_SUCCESS` if the `tinywot_thing` has been
+      removed.
+*/
+enum tinywot_status tinywot_servient_remove_thing(
+  struct tinywot_servient *self, char const *base
+);
+
+/*!
+  \brief Find the `tinywot_thing` responsible for a target.
+  \memberof tinywot_servient
+
+  \param[in] self An instance of `tinywot_servient`.
+  \param[out] thing The `tinywot_thing` found.
+  \param[in] target A pointer to the characters of the target.
+  \param[in] target_length_byte The number of characters in `target`.
+  \param[out] base_length_byte The length of the matching base, i.e.
+  where the target within `thing` starts in `target`.
+  \return
+    - `::TINYWOT_STATUS_ERROR_NOT_FOUND` if no base matches `target`.
+    - `::TINYWOT_STATUS_SUCCESS` if the `tinywot_thing` has been
+      returned via `thing`.
+*/
+enum tinywot_status tinywot_servient_find_thing(
+  struct tinywot_servient const *self,
+  struct tinywot_thing const **thing,
+  char const *target,
+  size_t target_length_byte,
+  size_t *base_length_byte
+);
+
+/*!
+  \brief Process a request with the `tinywot_thing` responsible for its
+  target.
+  \memberof tinywot_servient
+
+  This finds the `tinywot_thing` with `tinywot_servient_find_thing()`,
+  then calls `tinywot_thing_process_request()` with the target view of
+  `request` (see `tinywot_request::target_view`) set to the rest of the
+  target, so that handlers see the target within their Thing. A request
+  on a base itself is processed as a request on `/`. `request` is
+  restored before returning, so it can be passed again e.g. for the next
+  block.
+
+  `tinywot_request::target_id` is ignored, as target IDs are only unique
+  in one `tinywot_thing`.
+
+  \param[in] self An instance of `tinywot_servient`.
+  \param[out] response An outgoing `tinywot_response`.
+  \param[inout] request An incoming `tinywot_request`.
+  \return
+    - `::TINYWOT_STATUS_SUCCESS` with an empty response of
+      `::TINYWOT_RESPONSE_STATUS_NOT_FOUND` if no `tinywot_thing` is
+      responsible for the target.
+    - Otherwise, see `tinywot_thing_process_request()`.
+*/
+enum tinywot_status tinywot_servient_process_request(
+  struct tinywot_servient const *self,
+  struct tinywot_response *response,
+  struct tinywot_request *request
+);
+
+/*!
+  \brief The type of work in a `tinywot_task`.
+*/
+enum tinywot_task_type {
+  /*!
+    \brief No work; this is the zero value.
+  */
+  TINYWOT_TASK_TYPE_UNKNOWN = 0,
+
+  /*!
+    \brief `tinywot_thing_process_request()` with `tinywot_task::thing`,
+    `tinywot_task::response` and `tinywot_task::request`.
+  */
+  TINYWOT_TASK_TYPE_REQUEST,
+
+  /*!
+    \brief `tinywot_thing_process_notification()` with
+    `tinywot_task::thing`, `tinywot_task::response` and
+    `tinywot_task::observer`.
+  */
+  TINYWOT_TASK_TYPE_NOTIFICATION,
+
+  /*!
+    \brief `tinywot_task::function`, e.g. the rest of the work of a
+    handler that has returned `::TINYWOT_STATUS_PENDING`.
+  */
+  TINYWOT_TASK_TYPE_FUNCTION,
+};
+
+struct tinywot_task;
+
+/*!
+  \brief The type of function called when a `tinywot_task` has run.
+
+  This is where a protocol binding sends `tinywot_task::response`. If
+  `status` is `::TINYWOT_STATUS_NOT_FINISHED`, the task is queued again
+  after this returns, e.g. for the next block of a response; call
+  `tinywot_response_next_block()` here.
+
+  \param[inout] task The task that has run.
+  \param[in] status The status returned by the work of `task`.
+*/
+typedef void tinywot_task_done_t(
+  struct tinywot_task *task, enum tinywot_status status
+);
+
+/*!
+  \brief A piece of work queued in a `tinywot_scheduler`.
+*/
+struct tinywot_task {
+  /*!
+    \brief What to run.
+  */
+  enum tinywot_task_type type;
+
+  /*!
+    \brief How urgent this task is. Larger values run first.
+
+    For `::TINYWOT_TASK_TYPE_REQUEST` and
+    `::TINYWOT_TASK_TYPE_NOTIFICATION`, the larger one of this and
+    `tinywot_form::priority` of the form to run is used, with
+    `TINYWOT_ENABLE_FORM_PRIORITY` defined. For a notification, that is
+    the form producing it, e.g. the readproperty form of an observed
+    property.
+  */
+  uint_least8_t priority;
+
+  /*!
+    \brief Whether `deadline` is set.
+  */
+  bool has_deadline;
+
+  /*!
+    \brief When this task should have run, in ticks of any clock of the
+    application.
+
+    Among tasks of the same priority, the one with the earliest deadline
+    runs first, and tasks without a deadline run after all of them.
+    Deadlines may wrap around, but all queued deadlines must be within
+    2^31 ticks of each other. A task past its deadline still runs.
+  */
+  uint_least32_t deadline;
+
+  /*!
+    \brief The order of submission, which breaks ties. This is set by
+    the `tinywot_scheduler`.
+  */
+  uint_least32_t sequence;
+
+  /*!
+    \brief The `tinywot_thing` of a request or a notification.
+  */
+  struct tinywot_thing const *thing;
 
   /*!
-    \brief Arbitrary data to pass to `handler` when it is called.
+    \brief The response of a request or a notification.
   */
-  void *context;
-};
+  struct tinywot_response *response;
 
-/*!
-  \brief A Web Thing.
+  /*!
+    \brief The request of `::TINYWOT_TASK_TYPE_REQUEST`.
+  */
+  struct tinywot_request *request;
 
-  A Thing is currently just a collection of `tinywot_form`s.
-*/
-struct tinywot_thing {
   /*!
-    \brief A list of forms describing the behavior of this Thing.
+    \brief The observer of `::TINYWOT_TASK_TYPE_NOTIFICATION`.
   */
-  struct tinywot_form *forms;
+  struct tinywot_observer const *observer;
 
   /*!
-    \brief The number of registered forms in `forms`.
+    \brief The function of `::TINYWOT_TASK_TYPE_FUNCTION`, which is
+    passed `context`. Return `::TINYWOT_STATUS_NOT_FINISHED` to run again
+    later, after other tasks of the same urgency.
   */
-  size_t forms_count_n;
+  enum tinywot_status (*function)(void *context);
 
   /*!
-    \brief The maximum number of `tinywot_form`s that the supporting
-    memory can contain.
+    \brief The function called after the task has run, or `NULL`.
+  */
+  tinywot_task_done_t *done;
 
-    This field mainly supports the dynamic changing of `tinywot_thing`.
-    If `forms` points to a read-only memory, then this field should
-    either be equal to `forms_count_n` or `0` to prevent any method from
-    rewriting a non-modifyable memory.
+  /*!
+    \brief The form to run for a request or a notification, found by
+    `tinywot_scheduler_submit()`. This is set by the `tinywot_scheduler`.
   */
-  size_t forms_max_n;
+  struct tinywot_form *form;
+
+  /*!
+    \brief The status of finding `form`, or
+    `::TINYWOT_STATUS_ERROR_GENERIC` if it has not been looked up. This
+    is set by the `tinywot_scheduler`.
+  */
+  enum tinywot_status form_status;
+
+  /*!
+    \brief `tinywot_thing::forms_generation` when `form` was found. If the
+    forms have changed since, `form` is looked up again before running.
+    This is set by the `tinywot_scheduler`.
+  */
+  uint_least32_t forms_generation;
+
+  /*!
+    \brief Arbitrary data for `function` and `done`.
+  */
+  void *context;
 };
 
 /*!
-  \brief Initialize a `tinywot_thing` with a static list of forms.
-  \memberof tinywot_thing
+  \brief A cooperative scheduler of `tinywot_task`s, for single-core
+  main loops that should not let a burst of unimportant requests hold
+  up an urgent one behind them.
+
+  The main loop submits requests, notifications and continuations of
+  work as `tinywot_task`s, then calls `tinywot_scheduler_run()` for the
+  most urgent one: the highest priority first, then the earliest
+  deadline, then the earliest submitted. A task is never preempted, so
+  the latency of an urgent task is bounded by the longest single task,
+  not by the length of the queue.
+
+  Tasks are copied into a binary heap in the memory given to
+  `tinywot_scheduler_init()`, so submitting and running take O(log n)
+  time. The pointers in them must stay valid until they have run.
+*/
+struct tinywot_scheduler {
+  /*!
+    \brief The queued tasks, as a binary heap with the most urgent first.
+  */
+  struct tinywot_task *tasks;
 
-  If you have a list of `tinywot_form`s declared in a `static const`
-  array, then this helps correctly setting up a `tinywot_thing`. The
-  `tinywot_thing` initialized in this way should prevent any later
-  modification from method calls, e.g. `tinywot_thing_change_form()`.
+  /*!
+    \brief The number of tasks in `tasks`.
+  */
+  size_t tasks_count_n;
 
-  Note that:
+  /*!
+    \brief The maximum number of tasks that `tasks` can contain.
+  */
+  size_t tasks_max_n;
 
-  - `forms` is only shallow copied, so it must point to `'static`
-    memory. Otherwise, a dangling pointer would be used.
-  - `forms_size_byte` is the size of `forms` in byte, not the number of
-    `tinywot_forms` in the array. Most often, this should just be
-    `sizeof(forms)` (when `forms` is still `struct tinywot_form []`).
+  /*!
+    \brief The `tinywot_task::sequence` of the next submitted task.
+  */
+  uint_least32_t sequence;
 
-  \param[inout] self An instance of `tinywot_thing`.
-  \param[in] forms An array of `tinywot_form` in ROM.
-  \param[in] forms_size_byte The size of `forms` in byte.
+  /*!
+    \brief Whether a task is running. Its place in `tasks` is kept, so
+    that it can always be queued again.
+  */
+  bool running;
+};
+
+/*!
+  \brief Initialize a `tinywot_scheduler` with RAM.
+  \memberof tinywot_scheduler
+
+  \param[inout] self An instance of `tinywot_scheduler`.
+  \param[in] memory A pointer to an array of `tinywot_task`.
+  \param[in] memory_size_byte The size of `memory` in byte.
 */
-void tinywot_thing_init_static(
-  struct tinywot_thing *self,
-  struct tinywot_form const *forms,
-  size_t forms_size_byte
+void tinywot_scheduler_init(
+  struct tinywot_scheduler *self, void *memory, size_t memory_size_byte
 );
 
 /*!
-  \brief Initialize a `tinywot_thing` with Randomly Accessible Memory
-  (RAM).
-  \memberof tinywot_thing
-
-  If you want to add, change and remove `tinywot_form`s interactively,
-  then this helps correctly setting up a `tinywot_thing`. The
-  `tinywot_thing` initialized in this way allows all methods that change
-  the list of forms of a `tinywot_thing`.
+  \brief Queue a `tinywot_task` in a `tinywot_scheduler`.
+  \memberof tinywot_scheduler
 
-  `memory` is seen as blank memory with `0` forms.
+  With `TINYWOT_ENABLE_FORM_PRIORITY` defined, this looks up the form to
+  run for a request or a notification, to take its
+  `tinywot_form::priority` into account. The form is kept in the task
+  and run by `tinywot_scheduler_run()` without looking it up again,
+  unless the forms of the `tinywot_thing` have changed in between.
 
-  \param[inout] self An instance of `tinywot_thing`.
-  \param[in] memory A pointer to any segment of RAM.
-  \param[in] memory_size_byte The size of `memory` in byte.
+  \param[inout] self An instance of `tinywot_scheduler`.
+  \param[in] task The task to queue, which is copied.
+  \return
+    - `::TINYWOT_STATUS_ERROR_NOT_ENOUGH_MEMORY` if the scheduler is
+      full.
+    - `::TINYWOT_STATUS_SUCCESS` if the task has been queued.
 */
-void tinywot_thing_init_dynamic(
-  struct tinywot_thing *self, void *memory, size_t memory_size_byte
+enum tinywot_status tinywot_scheduler_submit(
+  struct tinywot_scheduler *self, struct tinywot_task const *task
 );
 
 /*!
-  \brief Initialize a `tinywot_thing` with Randomly Accessible Memory
-  (RAM), then copy a static list of forms into the RAM.
-  \memberof tinywot_thing
+  \brief Run the most urgent `tinywot_task` in a `tinywot_scheduler`.
+  \memberof tinywot_scheduler
 
-  If you want to initialize a dynamic (changable) `tinywot_thing` out of
-  a pre-defined list of `tinywot_form`s, then this helps correctly
-  setting up a `tinywot_thing`.
+  The task is removed from the queue, run, and passed to
+  `tinywot_task::done`. If it has returned
+  `::TINYWOT_STATUS_NOT_FINISHED`, it is then queued again, behind the
+  other tasks of the same priority and deadline.
 
-  Memory pointed by `forms` will be copied to memory pointed by
-  `memory`. Note that in this way `tinywot_form::name` and
-  `tinywot_form::target` are only shallow copied, but this is by design
-  as they are required to be `const char`. `forms` does not have to
-  point to ROM either, as it is copied to `memory`.
+  A main loop calls this once per iteration, or until it fails.
 
-  \param[inout] self An instance of `tinywot_thing`.
-  \param[in] memory A pointer to any segment of RAM.
-  \param[in] memory_size_byte The size of `memory` in byte.
-  \param[in] forms An array of `tinywot_form` in ROM or RAM.
-  \param[in] forms_size_byte The size of `forms` in byte.
+  \param[inout] self An instance of `tinywot_scheduler`.
   \return
-    - `::TINYWOT_STATUS_ERROR_NOT_ENOUGH_MEMORY` if `memory_size_byte`
-      is smaller than `forms_size_byte`.
-    - `::TINYWOT_STATUS_SUCCESS` if the initialization succeeds.
+    - `::TINYWOT_STATUS_ERROR_NOT_FOUND` if there is no task to run.
+    - Otherwise, the status returned by the work of the task.
 */
-enum tinywot_status tinywot_thing_init_dynamic_from_static(
-  struct tinywot_thing *self,
-  void *memory,
-  size_t memory_size_byte,
-  struct tinywot_form const *forms,
-  size_t forms_size_byte
-);
+enum tinywot_status tinywot_scheduler_run(struct tinywot_scheduler *self);
 
 /*!
-  \brief Find a `tinywot_form` registered in the `tinywot_thing`.
-  \memberof tinywot_thing
+  \brief How updates of a target are merged into fewer notifications by
+  a `tinywot_coalescer`.
 
-  This function finds a matching `tinywot_form` according to `target`
-  and `op` from the end of the list of registered `tinywot_form` in the
-  `tinywot_thing`. The first matching `tinywot_form` is retured to the
-  caller via the `form` parameter.
+  An update is pending from when it is first accepted until it is
+  notified. It is notified at the later one of `window_ticks` after it
+  became pending, and `min_interval_ticks` after the target was last
+  notified, so it is never older than the larger of the two when it is
+  sent. Updates arriving in the meantime only replace the pending value.
 
-  \param[in] self An instance of `tinywot_thing`.
-  \param[out] form A copy of pointer to the matching `form`.
-  \param[in] target `tinywot_form::target`.
-  \param[in] op `tinywot_form::op`.
-  \return
-    - `::TINYWOT_STATUS_ERROR_NOT_FOUND` if no matching `tinywot_form`
-      can be found in the `tinywot_thing`.
-    - `::TINYWOT_STATUS_ERROR_NOT_ALLOWED` if there is at least one
-      `tinywot_form::target` matches, but no `tinywot_form::op` matches.
-      This usually means that the `tinywot_form::target` cannot accept
-      the requested interaction.
-    - `::TINYWOT_STATUS_SUCCESS` if a matching `tinywot_form` has been
-      returned via the `form` parameter.
+  All members set to 0 notify every update as soon as it is polled.
+  Ticks are of any clock of the application, wrapping around at 2^32.
 */
-enum tinywot_status tinywot_thing_find_form(
-  struct tinywot_thing const *self,
-  struct tinywot_form **form,
-  char const *target,
-  enum tinywot_operation_type op
-);
+struct tinywot_coalesce_policy {
+  /*!
+    \brief The shortest time between two notifications of the target.
+  */
+  uint_least32_t min_interval_ticks;
+
+  /*!
+    \brief How long a pending update waits for other updates to be
+    merged with it.
+
+    Whenever an update is notified, all other pending updates that are
+    not held back by `min_interval_ticks` are notified with it, so
+    updates of several targets go out in one go, and observers of all
+    properties get one notification for all of them.
+  */
+  uint_least32_t window_ticks;
+
+  /*!
+    \brief How much a value must differ from the last notified one for
+    an update to become pending.
+
+    Values are compared as unsigned numbers. Smaller changes are dropped
+    while nothing is pending, so a reading jittering around a level is
+    not notified over and over. 0 accepts every update.
+  */
+  uint_least32_t threshold;
+};
 
 /*!
-  \brief Add (register) a `tinywot_form` to the `tinywot_thing`.
-  \memberof tinywot_thing
+  \brief A target whose updates are coalesced, and its state.
+*/
+struct tinywot_coalesced_target {
+  /*!
+    \brief The target of the property or the event.
+  */
+  char const *target;
 
-  This function merely appends `form` to the end of list of
-  `tinywot_form` in the supplied `tinywot_thing`. Because
-  `tinywot_thing_find_form()` looks up the list from the end, adding a
-  `tinywot_form` with the same `tinywot_form::target` and
-  `tinywot_form::op` effectively overrides a formerly added (registered)
-  `tinywot_form`. Removing it (using `tinywot_thing_remove_form()`) can
-  re-enable the formerly added (registered) `tinywot_form`.
+  /*!
+    \brief How updates of `target` are coalesced.
+  */
+  struct tinywot_coalesce_policy const *policy;
 
-  To change an already added (registered) `tinywot_form`, use
-  `tinywot_thing_change_form()`.
+  /*!
+    \brief Whether an update is waiting to be notified.
+  */
+  bool pending;
 
-  \param[inout] self An instance of `tinywot_thing`.
-  \param[in] form A pointer to a `tinywot_form` to be added (registered)
-  to the supplied `tinywot_thing`.
-  \return
-    - `::TINYWOT_STATUS_ERROR_NOT_ENOUGH_MEMORY` if there is not enough
-      space in the backing memory of the `tinywot_thing` to insert a new
-      `tinywot_form`.
-    - `::TINYWOT_STATUS_SUCCESS` if the operation has been successful.
+  /*!
+    \brief Whether `target` has been notified.
+  */
+  bool notified;
+
+  /*!
+    \brief The value of the latest update.
+  */
+  uint_least32_t value;
+
+  /*!
+    \brief The value last notified.
+  */
+  uint_least32_t notified_value;
+
+  /*!
+    \brief When the pending update became pending.
+  */
+  uint_least32_t pending_since;
+
+  /*!
+    \brief When `target` was last notified.
+  */
+  uint_least32_t notified_at;
+};
+
+/*!
+  \brief A set of targets whose updates are merged into fewer, larger
+  notifications, so that a battery-powered node wakes its radio up less
+  often.
+
+  Instead of marking observers with `tinywot_thing_mark_dirty()` or
+  `tinywot_thing_drain_events()` on every update, the application passes
+  updates to `tinywot_coalescer_update()` or
+  `tinywot_coalescer_drain_events()`, and calls
+  `tinywot_coalescer_poll()` when it wakes up. Observers are marked only
+  when the pending updates are due, and are then notified as usual, e.g.
+  with `tinywot_thing_take_notifications()`.
 */
-enum tinywot_status tinywot_thing_add_form(
-  struct tinywot_thing *self, struct tinywot_form const *form
-);
+struct tinywot_coalescer {
+  /*!
+    \brief The coalesced targets, in the order of being added.
+  */
+  struct tinywot_coalesced_target *targets;
+
+  /*!
+    \brief The number of targets in `targets`.
+  */
+  size_t targets_count_n;
+
+  /*!
+    \brief The maximum number of targets that `targets` can contain.
+  */
+  size_t targets_max_n;
+};
 
 /*!
-  \brief Modify a `tinywot_form` registered in the `tinywot_thing`.
-  \memberof tinywot_thing
+  \brief Initialize a `tinywot_coalescer` with RAM.
+  \memberof tinywot_coalescer
 
-  This function first finds a matching form in the supplied
-  `tinywot_thing`, then overwrites it with the `tinywot_form` provided
-  via the `form` parameter.
+  \param[inout] self An instance of `tinywot_coalescer`.
+  \param[in] memory A pointer to an array of `tinywot_coalesced_target`.
+  \param[in] memory_size_byte The size of `memory` in byte.
+*/
+void tinywot_coalescer_init(
+  struct tinywot_coalescer *self, void *memory, size_t memory_size_byte
+);
 
-  \param[inout] self An instance of `tinywot_thing`.
-  \param[in] target `tinywot_form::target`.
-  \param[in] op `tinywot_form::op`.
-  \param[in] form The new `tinywot_form` replacing the matching one.
+/*!
+  \brief Coalesce the updates of a target in a `tinywot_coalescer`.
+  \memberof tinywot_coalescer
+
+  \param[inout] self An instance of `tinywot_coalescer`.
+  \param[in] target The target, which must stay valid, e.g. be a string
+  literal.
+  \param[in] policy How to coalesce updates of `target`, which must stay
+  valid.
   \return
-    - `::TINYWOT_STATUS_ERROR_NOT_FOUND` if the specified `target` and
-      `op` cannot match a registered `tinywot_form`.
-    - `::TINYWOT_STATUS_SUCCESS` if the operation has been successful.
+    - `::TINYWOT_STATUS_ERROR_NOT_ALLOWED` if `target` has already been
+      added.
+    - `::TINYWOT_STATUS_ERROR_NOT_ENOUGH_MEMORY` if the coalescer is
+      full.
+    - `::TINYWOT_STATUS_SUCCESS` if the target has been added.
 */
-enum tinywot_status tinywot_thing_change_form(
-  struct tinywot_thing *self,
+enum tinywot_status tinywot_coalescer_add_target(
+  struct tinywot_coalescer *self,
   char const *target,
-  enum tinywot_operation_type op,
-  struct tinywot_form const *form
+  struct tinywot_coalesce_policy const *policy
 );
 
 /*!
-  \brief Delete a `tinywot_form` registered in the `tinywot_thing`.
-  \memberof tinywot_thing
+  \brief Pass an update of a target to a `tinywot_coalescer`.
+  \memberof tinywot_coalescer
 
-  \param[inout] self An instance of `tinywot_thing`.
-  \param[in] target `tinywot_form::target`.
-  \param[in] op `tinywot_form::op`.
+  \param[inout] self An instance of `tinywot_coalescer`.
+  \param[in] target The target of the update.
+  \param[in] value The new value, see `tinywot_observer::value`.
+  \param[in] now The current time in ticks.
   \return
-    - `::TINYWOT_STATUS_ERROR_NOT_FOUND` if the specified `target` and
-      `op` cannot match a registered `tinywot_form`.
-    - `::TINYWOT_STATUS_SUCCESS` if the operation has been successful.
+    - `::TINYWOT_STATUS_ERROR_NOT_FOUND` if `target` is not coalesced;
+      mark its observers directly instead.
+    - `::TINYWOT_STATUS_SUCCESS` if the update has been taken, or
+      dropped for `tinywot_coalesce_policy::threshold`.
 */
-enum tinywot_status tinywot_thing_remove_form(
-  struct tinywot_thing *self,
+enum tinywot_status tinywot_coalescer_update(
+  struct tinywot_coalescer *self,
   char const *target,
-  enum tinywot_operation_type op
+  uint_least32_t value,
+  uint_least32_t now
 );
 
 /*!
-  \brief Transforming a `tinywot_request` to a `tinywot_response` with
-  the `tinywot_thing`.
-  \memberof tinywot_thing
+  \brief Pass all events in a `tinywot_event_ring` to a
+  `tinywot_coalescer`.
+  \memberof tinywot_coalescer
+
+  Events of targets that are not coalesced mark their observers in
+  `thing` at once, like `tinywot_thing_drain_events()`.
+
+  \param[inout] self An instance of `tinywot_coalescer`.
+  \param[in] thing The `tinywot_thing` of the observers.
+  \param[inout] ring The ring to take events from.
+  \param[in] now The current time in ticks.
+  \return The number of events taken.
+*/
+size_t tinywot_coalescer_drain_events(
+  struct tinywot_coalescer *self,
+  struct tinywot_thing const *thing,
+  struct tinywot_event_ring *ring,
+  uint_least32_t now
+);
 
-  \param[in] self An instance of `tinywot_thing`.
-  \param[out] response An outgoing `tinywot_response`.
-  \param[in] request An incoming `tinywot_request`.
+/*!
+  \brief Mark observers of the due updates in a `tinywot_coalescer`.
+  \memberof tinywot_coalescer
+
+  If any pending update is due, it is marked in `thing` together with
+  every other pending update that `tinywot_coalesce_policy::min_interval_ticks`
+  allows to be notified now.
+
+  \param[inout] self An instance of `tinywot_coalescer`.
+  \param[in] thing The `tinywot_thing` of the observers.
+  \param[in] now The current time in ticks.
+  \param[out] wait_ticks How long the application may sleep before
+  calling this again, unless a new update arrives.
   \return
-    - `::TINYWOT_STATUS_ERROR_NOT_IMPLEMENTED` if a matching
-      `tinywot_form` is found, but it has no registered handler
-      function (`tinywot_form::handler` is `NULL`).
-    - `::TINYWOT_STATUS_ERROR_NOT_FOUND` if the requested
-      `tinywot_request::target` and `tinywot_request::op` cannot match a
-      registered `tinywot_form`. An empty response with this status is
-      prepared in the supplied `tinywot_response` in this case.
-    - `::TINYWOT_STATUS_ERROR_NOT_ALLOWED` if at least one
-      `tinywot_form` can be found with `tinywot_request::target`, but
-      none matches `tinywot_request::op`.
-    - `::TINYWOT_STATUS_SUCCESS` if the request has been successfully
-      processed with the `tinywot_thing`.
-    - Other codes are also possible if the registered handler function
-      returns them.
+    - `::TINYWOT_STATUS_ERROR_NOT_FOUND` if no update is pending after
+      this; `wait_ticks` is not set, and nothing is due until the next
+      update.
+    - `::TINYWOT_STATUS_SUCCESS` if updates are still pending.
 */
-enum tinywot_status tinywot_thing_process_request(
-  struct tinywot_thing const *self,
-  struct tinywot_response *response,
-  struct tinywot_request *request
+enum tinywot_status tinywot_coalescer_poll(
+  struct tinywot_coalescer *self,
+  struct tinywot_thing const *thing,
+  uint_least32_t now,
+  uint_least32_t *wait_ticks
 );
 
 /*!
@@ -0,0 +1,193 @@
+/*
+  SPDX-FileCopyrightText: 2023 Junde Yhi <junde@yhi.moe>
+  SPDX-License-Identifier: MIT
+*/
+
+/*!
+  \file
+  \brief TinyWoT Core compile-time dispatchers.
+
+  For firmware whose forms are all known at compile time, this turns a
+  list of forms into a function that processes requests like
+  `tinywot_thing_process_request()`, but without a `tinywot_thing`:
+  every target is compared with a string literal of known length, and
+  every handler is called directly, so the compiler can inline it.
+
+  The list of forms is an X-macro, taking one macro to apply to each
+  form with the members of a `tinywot_form`:
+
+      #define THING_FORMS(X) \
+        X("status", "/status", TINYWOT_OPERATION_TYPE_READPROPERTY, \
+          status_read, NULL) \
+        X("toggle", "/toggle", TINYWOT_OPERATION_TYPE_INVOKEACTION, \
+          toggle_invoke, NULL)
+
+      static TINYWOT_DISPATCH_DEFINE(thing_dispatch, THING_FORMS)
+
+  The same list can also make a static list of `tinywot_form`s, e.g.
+  for a Thing Description (see `TINYWOT_DISPATCH_FORM`):
+
+      static struct tinywot_form const thing_forms[] = {
+        THING_FORMS(TINYWOT_DISPATCH_FORM)
+      };
+
+  Targets must be string literals. The first form matching a target and
+  an operation type is used, so each pair should only be listed once.
+
+  `script/tinywot-forms.py --dispatch` generates such a list, and a
+  dispatcher switching on the hash of the target (see
+  `tinywot_target_hash_n()`) instead of comparing it with each target in
+  turn, which is faster for more than a few targets.
+*/
+
+#ifndef TINYWOT_DISPATCH_H
+#define TINYWOT_DISPATCH_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <tinywot/core.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*!
+  \brief Finish a response in a dispatcher, after the handler of a
+  matching form has returned `status`.
+
+  This is the end of `tinywot_thing_process_request()`. It is used by
+  the code from `TINYWOT_DISPATCH_DEFINE()` and
+  `script/tinywot-forms.py --dispatch`.
+
+  \param[out] response The outgoing `tinywot_response`.
+  \param[in] status The status returned by the handler.
+  \return See `tinywot_thing_process_request()`.
+*/
+static inline enum tinywot_status tinywot_dispatch_finish(
+  struct tinywot_response *response, enum tinywot_status status
+) {
+  response->status = tinywot_response_status_from_tinywot_status(status);
+
+  if (status == TINYWOT_STATUS_NOT_FINISHED
+      || status == TINYWOT_STATUS_PENDING) {
+    return status;
+  }
+
+  return TINYWOT_STATUS_SUCCESS;
+}
+
+/*!
+  \brief Finish a response in a dispatcher, when no form matches.
+
+  \param[out] response The outgoing `tinywot_response`.
+  \param[in] allowed Whether a form matches the target, but not the
+  operation type.
+  \return `::TINYWOT_STATUS_SUCCESS`.
+*/
+static inline enum tinywot_status tinywot_dispatch_reject(
+  struct tinywot_response *response, bool allowed
+) {
+  response->status = allowed ? TINYWOT_RESPONSE_STATUS_NOT_ALLOWED :
+                               TINYWOT_RESPONSE_STATUS_NOT_FOUND;
+
+  return TINYWOT_STATUS_SUCCESS;
+}
+
+/*!
+  \brief Call the handler of a form in a dispatcher, and finish the
+  response.
+
+  A `NULL` handler, or a request with `tinywot_request::fragment` set,
+  is responded with `::TINYWOT_STATUS_ERROR_NOT_IMPLEMENTED`. Going
+  through a local variable lets `handler_` be `NULL`; the compiler still
+  calls (or inlines) a constant handler directly.
+*/
+#define TINYWOT_DISPATCH_CALL(handler_, context_) \
+  do { \
+    tinywot_form_handler_t *tinywot_handler_ = (handler_); \
+    enum tinywot_status tinywot_status_ = \
+      TINYWOT_STATUS_ERROR_NOT_IMPLEMENTED; \
+    if (tinywot_handler_ \
+        && tinywot_request_get_fragment(request) \
+             == TINYWOT_REQUEST_FRAGMENT_NONE) { \
+      tinywot_status_ = tinywot_handler_( \
+        &response->payload, &request->payload, (void *)(context_) \
+      ); \
+    } \
+    return tinywot_dispatch_finish(response, tinywot_status_); \
+  } while (0)
+
+/*!
+  \brief Expand a form in a list of forms into a case of a dispatcher.
+
+  This is used by `TINYWOT_DISPATCH_DEFINE()`.
+*/
+#define TINYWOT_DISPATCH_CASE(name_, target_, op_, handler_, context_) \
+  if (target_length_byte == sizeof(target_) - 1U \
+      && memcmp(target, (target_), sizeof(target_) - 1U) == 0) { \
+    allowed = true; \
+    if (request->op == (op_)) { \
+      TINYWOT_DISPATCH_CALL(handler_, context_); \
+    } \
+  }
+
+/*!
+  \brief Expand a form in a list of forms into an initializer of a
+  `tinywot_form`.
+*/
+#define TINYWOT_DISPATCH_FORM(name_, target_, op_, handler_, context_) \
+  { \
+    .name = (name_), \
+    .target = (target_), \
+    .op = (op_), \
+    .handler = (handler_), \
+    .context = (void *)(context_), \
+  },
+
+/*!
+  \brief Declare a dispatcher defined with `TINYWOT_DISPATCH_DEFINE()`.
+
+  This has the signature of `tinywot_thing_process_request()` without
+  the `tinywot_thing`.
+*/
+#define TINYWOT_DISPATCH_DECLARE(function_) \
+  enum tinywot_status function_( \
+    struct tinywot_response *response, struct tinywot_request *request \
+  )
+
+/*!
+  \brief Define a dispatcher for a list of forms.
+
+  The function processes a request like `tinywot_thing_process_request()`
+  with a `tinywot_thing` of the forms, and returns the same statuses,
+  except that:
+
+  - `tinywot_request::target_id` is ignored;
+  - there are no routers or observers;
+  - `tinywot_request::fragment` is never accepted (there are no
+    `tinywot_form::flags`).
+
+  This is a function definition, so it can be preceded by `static`, and
+  it must not be followed by a semicolon.
+
+  \param function_ The name of the function.
+  \param forms_ The X-macro listing the forms.
+*/
+#define TINYWOT_DISPATCH_DEFINE(function_, forms_) \
+  TINYWOT_DISPATCH_DECLARE(function_) { \
+    size_t target_length_byte = 0; \
+    char const *target = \
+      tinywot_request_get_target(request, &target_length_byte); \
+    bool allowed = false; \
+    if (target) { \
+      forms_(TINYWOT_DISPATCH_CASE) \
+    } \
+    return tinywot_dispatch_reject(response, allowed); \
+  }
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* TINYWOT_DISPATCH_H */
@@ -0,0 +1,559 @@
+/*
+  SPDX-FileCopyrightText: 2023 Junde Yhi <junde@yhi.moe>
+  SPDX-License-Identifier: MIT
+*/
+
+/*!
+  \file
+  \brief TinyWoT Core JSON writer.
+
+  A small streaming JSON writer on top of `tinywot_payload`. It writes
+  in place into the payload, without any dynamic memory allocation or
+  `printf()`, and keeps track of where commas are needed.
+
+  Errors are sticky: once a write has failed, all further writes are
+  ignored and return the same status, so a handler can write a whole
+  document and check `tinywot_json_writer::status` only once at the end.
+  A failed write leaves the payload as it was before that write.
+
+  The writer does not check that the document is well-formed, e.g. that
+  every object member has a key. It also does not terminate the output
+  with a NUL.
+*/
+
+#ifndef TINYWOT_JSON_H
+#define TINYWOT_JSON_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <tinywot/core.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*!
+  \brief The maximum number of decimals written by
+  `tinywot_json_write_float()`.
+*/
+#define TINYWOT_JSON_FLOAT_DECIMALS_MAX_N 6U
+
+/*!
+  \brief A JSON writer state.
+*/
+struct tinywot_json_writer {
+  /*!
+    \brief The payload to write into.
+  */
+  struct tinywot_payload *payload;
+
+  /*!
+    \brief The status of the first failed write, or
+    `::TINYWOT_STATUS_SUCCESS` if nothing has failed.
+  */
+  enum tinywot_status status;
+
+  /*!
+    \brief Whether a comma is needed before the next value.
+  */
+  bool need_comma;
+};
+
+/*!
+  \brief Initialize a `tinywot_json_writer`.
+  \memberof tinywot_json_writer
+
+  Output is appended to the existing content of `payload`, which can be
+  a scatter-gather payload.
+
+  \param[inout] self An instance of `tinywot_json_writer`.
+  \param[in] payload The payload to write into.
+*/
+void tinywot_json_writer_init(
+  struct tinywot_json_writer *self, struct tinywot_payload *payload
+);
+
+/*!
+  \brief Write the beginning of an object (`{`).
+  \memberof tinywot_json_writer
+
+  \param[inout] self An instance of `tinywot_json_writer`.
+  \return
+    - `::TINYWOT_STATUS_ERROR_NOT_ENOUGH_MEMORY` if the payload is full.
+    - `::TINYWOT_STATUS_SUCCESS` if the operation has been successful.
+    - Any earlier error of `self`.
+*/
+enum tinywot_status tinywot_json_write_object_begin(
+  struct tinywot_json_writer *self
+);
+
+/*!
+  \brief Write the end of an object (`}`).
+  \memberof tinywot_json_writer
+
+  \param[inout] self An instance of `tinywot_json_writer`.
+  \return See `tinywot_json_write_object_begin()`.
+*/
+enum tinywot_status tinywot_json_write_object_end(
+  struct tinywot_json_writer *self
+);
+
+/*!
+  \brief Write the beginning of an array (`[`).
+  \memberof tinywot_json_writer
+
+  \param[inout] self An instance of `tinywot_json_writer`.
+  \return See `tinywot_json_write_object_begin()`.
+*/
+enum tinywot_status tinywot_json_write_array_begin(
+  struct tinywot_json_writer *self
+);
+
+/*!
+  \brief Write the end of an array (`]`).
+  \memberof tinywot_json_writer
+
+  \param[inout] self An instance of `tinywot_json_writer`.
+  \return See `tinywot_json_write_object_begin()`.
+*/
+enum tinywot_status tinywot_json_write_array_end(
+  struct tinywot_json_writer *self
+);
+
+/*!
+  \brief Write the key of an object member, followed by a colon.
+  \memberof tinywot_json_writer
+
+  \param[inout] self An instance of `tinywot_json_writer`.
+  \param[in] key A string to be escaped and written as the key.
+  \return See `tinywot_json_write_object_begin()`.
+*/
+enum tinywot_status tinywot_json_write_key(
+  struct tinywot_json_writer *self, char const *key
+);
+
+/*!
+  \brief Write a string.
+  \memberof tinywot_json_writer
+
+  `"`, `\` and control characters are escaped. Other bytes, including
+  UTF-8 sequences, are written as is.
+
+  \param[inout] self An instance of `tinywot_json_writer`.
+  \param[in] str A string.
+  \return See `tinywot_json_write_object_begin()`.
+*/
+enum tinywot_status tinywot_json_write_string(
+  struct tinywot_json_writer *self, char const *str
+);
+
+/*!
+  \brief Write a string of a known length.
+  \memberof tinywot_json_writer
+
+  This is like `tinywot_json_write_string()`, but `str` does not need
+  to be terminated by a NUL.
+
+  \param[inout] self An instance of `tinywot_json_writer`.
+  \param[in] str A pointer to characters.
+  \param[in] str_length_byte The number of characters in `str`.
+  \return See `tinywot_json_write_object_begin()`.
+*/
+enum tinywot_status tinywot_json_write_string_n(
+  struct tinywot_json_writer *self, char const *str, size_t str_length_byte
+);
+
+/*!
+  \brief Write a signed integer.
+  \memberof tinywot_json_writer
+
+  \param[inout] self An instance of `tinywot_json_writer`.
+  \param[in] value An integer.
+  \return See `tinywot_json_write_object_begin()`.
+*/
+enum tinywot_status tinywot_json_write_int(
+  struct tinywot_json_writer *self, long value
+);
+
+/*!
+  \brief Write an unsigned integer.
+  \memberof tinywot_json_writer
+
+  \param[inout] self An instance of `tinywot_json_writer`.
+  \param[in] value An integer.
+  \return See `tinywot_json_write_object_begin()`.
+*/
+enum tinywot_status tinywot_json_write_uint(
+  struct tinywot_json_writer *self, unsigned long value
+);
+
+/*!
+  \brief Write a floating-point number with a fixed number of decimals.
+  \memberof tinywot_json_writer
+
+  The value is rounded to `decimals_n` decimals and written without an
+  exponent, e.g. `21.50`. JSON does not have NaN or infinity, so they
+  are written as `null`.
+
+  \param[inout] self An instance of `tinywot_json_writer`.
+  \param[in] value A floating-point number.
+  \param[in] decimals_n The number of decimals, at most
+  `::TINYWOT_JSON_FLOAT_DECIMALS_MAX_N`.
+  \return
+    - `::TINYWOT_STATUS_ERROR_NOT_ALLOWED` if `decimals_n` is too large,
+      or if `value` scaled by `decimals_n` does not fit into an
+      `unsigned long`.
+    - See `tinywot_json_write_object_begin()` for others.
+*/
+enum tinywot_status tinywot_json_write_float(
+  struct tinywot_json_writer *self, double value, unsigned int decimals_n
+);
+
+/*!
+  \brief Write a boolean (`true` or `false`).
+  \memberof tinywot_json_writer
+
+  \param[inout] self An instance of `tinywot_json_writer`.
+  \param[in] value A boolean.
+  \return See `tinywot_json_write_object_begin()`.
+*/
+enum tinywot_status tinywot_json_write_bool(
+  struct tinywot_json_writer *self, bool value
+);
+
+/*!
+  \brief Write `null`.
+  \memberof tinywot_json_writer
+
+  \param[inout] self An instance of `tinywot_json_writer`.
+  \return See `tinywot_json_write_object_begin()`.
+*/
+enum tinywot_status tinywot_json_write_null(struct tinywot_json_writer *self);
+
+/*!
+  \brief Write an already serialized JSON value as is.
+  \memberof tinywot_json_writer
+
+  A comma is still written before it if needed.
+
+  \param[inout] self An instance of `tinywot_json_writer`.
+  \param[in] data A pointer to a serialized JSON value.
+  \param[in] data_size_byte The length of `data` in byte.
+  \return See `tinywot_json_write_object_begin()`.
+*/
+enum tinywot_status tinywot_json_write_raw(
+  struct tinywot_json_writer *self, void const *data, size_t data_size_byte
+);
+
+/*!
+  \brief What to do when one property of a batch read fails.
+*/
+enum tinywot_json_batch_policy {
+  /*!
+    \brief Fail the whole batch with the status of the failed property.
+  */
+  TINYWOT_JSON_BATCH_POLICY_ABORT = 0,
+
+  /*!
+    \brief Leave the failed property out of the result.
+
+    Running out of memory still fails the whole batch, as the result
+    would be silently truncated otherwise.
+  */
+  TINYWOT_JSON_BATCH_POLICY_SKIP,
+};
+
+/*!
+  \brief The context of `tinywot_json_handler_read_all_properties()` and
+  `tinywot_json_handler_read_multiple_properties()`.
+*/
+struct tinywot_json_batch {
+  /*!
+    \brief The `tinywot_thing` to read properties from.
+  */
+  struct tinywot_thing const *thing;
+
+  /*!
+    \brief The content type of the result, e.g. 50 for
+    `application/json` in CoAP.
+
+    Every property handler must write a JSON value with this content
+    type, so that they can be put together into one JSON object.
+  */
+  uint_fast16_t content_type;
+
+  /*!
+    \brief What to do when a property fails.
+  */
+  enum tinywot_json_batch_policy policy;
+};
+
+/*!
+  \brief A form handler reading all properties of a `tinywot_thing` at
+  once.
+
+  Register this with a `tinywot_json_batch` as the context on a form of
+  `::TINYWOT_OPERATION_TYPE_READALLPROPERTIES`. Every form allowing
+  `::TINYWOT_OPERATION_TYPE_READPROPERTY` with a name is called in one
+  pass, in the order of the forms, except forms overridden by a later
+  form of the same target (see `tinywot_thing_find_form()`), so each
+  property appears once. The result is a JSON object mapping
+  form names to the values written by their handlers, e.g.
+  `{"status":false,"temperature":21.5}`.
+
+  Property handlers write straight into the response payload, so
+  nothing is copied. Trailing NULs written by them are dropped. They get
+  a `tinywot_request` of their own, with only `tinywot_request::op` and
+  `tinywot_request::target` set. A handler failing, returning
+  `::TINYWOT_STATUS_NOT_FINISHED`, writing nothing, or writing a content
+  type other than `tinywot_json_batch::content_type`, is a failed
+  property, handled by `tinywot_json_batch::policy`.
+
+  The response payload must not be a scatter-gather payload.
+
+  \param[out] response_payload See `tinywot_form_handler_t`.
+  \param[in] request_payload See `tinywot_form_handler_t`.
+  \param[in] context A pointer to a `tinywot_json_batch`.
+  \return
+    - `::TINYWOT_STATUS_ERROR_NOT_IMPLEMENTED` if the response payload is
+      a scatter-gather payload, or if the forms are in program memory
+      (see `tinywot_thing_init_static_flash()`).
+    - `::TINYWOT_STATUS_ERROR_NOT_ENOUGH_MEMORY` if the result does not
+      fit into the response payload.
+    - `::TINYWOT_STATUS_SUCCESS` if the operation has been successful.
+    - The status of a failed property, with
+      `::TINYWOT_JSON_BATCH_POLICY_ABORT`.
+*/
+enum tinywot_status tinywot_json_handler_read_all_properties(
+  struct tinywot_payload *response_payload,
+  struct tinywot_payload *request_payload,
+  void *context
+);
+
+/*!
+  \brief A form handler reading some properties of a `tinywot_thing` at
+  once.
+
+  This is like `tinywot_json_handler_read_all_properties()`, for a form
+  of `::TINYWOT_OPERATION_TYPE_READMULTIPLEPROPERTIES`. The request
+  payload is a JSON array of property names, e.g.
+  `["status","temperature"]`. Properties are read in the order of the
+  array. A name that cannot be found is a failed property. Escapes in
+  names are not supported.
+
+  \param[out] response_payload See `tinywot_form_handler_t`.
+  \param[in] request_payload See `tinywot_form_handler_t`.
+  \param[in] context A pointer to a `tinywot_json_batch`.
+  \return
+    - `::TINYWOT_STATUS_ERROR_NOT_ALLOWED` if the request payload is not
+      a JSON array of strings.
+    - `::TINYWOT_STATUS_ERROR_NOT_FOUND` if a name cannot be found, with
+      `::TINYWOT_JSON_BATCH_POLICY_ABORT`.
+    - See `tinywot_json_handler_read_all_properties()` for others.
+*/
+enum tinywot_status tinywot_json_handler_read_multiple_properties(
+  struct tinywot_payload *response_payload,
+  struct tinywot_payload *request_payload,
+  void *context
+);
+
+/*!
+  \brief A Thing Description generated from the forms of a
+  `tinywot_thing`, and kept serialized.
+
+  The Thing Description (TD) is only generated again when
+  `tinywot_thing::forms_generation` shows that the forms have changed,
+  so most requests for it only cost a copy. It is then generated in
+  full, grouping forms in time quadratic in their number. It describes:
+
+  - A property, action or event affordance for each
+    `tinywot_form::name` with forms of the corresponding operation
+    types, with a form for each target and its operation types.
+  - Top-level forms for all other forms, e.g. readallproperties.
+
+  Other information, e.g. data schemas of properties, is not included.
+  Removed forms are left out. Security is `nosec`.
+
+  Use `tinywot_json_td_handler()` to serve it.
+*/
+struct tinywot_json_td {
+  /*!
+    \brief The `tinywot_thing` to describe.
+  */
+  struct tinywot_thing const *thing;
+
+  /*!
+    \brief The `title` of the TD.
+  */
+  char const *title;
+
+  /*!
+    \brief The `base` of the TD, e.g. `coap://thing.local`, or `NULL`.
+  */
+  char const *base;
+
+  /*!
+    \brief The content type of the TD, e.g. 432 for
+    `application/td+json` in CoAP.
+  */
+  uint_fast16_t content_type;
+
+  /*!
+    \brief The memory holding the serialized TD.
+  */
+  unsigned char *content;
+
+  /*!
+    \brief The size of `content` in byte.
+  */
+  size_t content_buffer_size_byte;
+
+  /*!
+    \brief The length of the serialized TD in byte, or 0 if there is
+    none.
+  */
+  size_t content_length_byte;
+
+  /*!
+    \brief The `tinywot_thing::forms_generation` that the TD has been
+    generated from.
+  */
+  uint_least32_t generation;
+
+  /*!
+    \brief The version of the serialized TD.
+
+    This is bumped every time the TD is generated, skipping 0, and is
+    returned as `tinywot_response::etag`. It starts at 0, so the first
+    TD after every boot is version 1. An application can set a random
+    value after initialization, so that ETags from before a reboot are
+    unlikely to match a different TD.
+  */
+  uint_least32_t version;
+};
+
+/*!
+  \brief Initialize a `tinywot_json_td`.
+  \memberof tinywot_json_td
+
+  Nothing is generated yet. Call this again after initializing `thing`
+  again, since `tinywot_thing::forms_generation` is then reset.
+
+  \param[inout] self An instance of `tinywot_json_td`.
+  \param[in] thing The `tinywot_thing` to describe.
+  \param[in] title The title of the TD.
+  \param[in] base The base of the TD, or `NULL`.
+  \param[in] content_type The content type of the TD.
+  \param[in] memory A pointer to a memory region holding the TD. While
+  generating, one bit for each form is also kept at its end.
+  \param[in] memory_size_byte The size of `memory` in byte.
+*/
+void tinywot_json_td_init(
+  struct tinywot_json_td *self,
+  struct tinywot_thing const *thing,
+  char const *title,
+  char const *base,
+  uint_fast16_t content_type,
+  void *memory,
+  size_t memory_size_byte
+);
+
+/*!
+  \brief Generate the TD of a `tinywot_json_td`, if it is outdated.
+  \memberof tinywot_json_td
+
+  \param[inout] self An instance of `tinywot_json_td`.
+  \return
+    - `::TINYWOT_STATUS_ERROR_NOT_IMPLEMENTED` if the forms are in
+      program memory (see `tinywot_thing_init_static_flash()`).
+    - `::TINYWOT_STATUS_ERROR_NOT_ENOUGH_MEMORY` if the TD does not fit
+      into `tinywot_json_td::content`. There is no TD then.
+    - `::TINYWOT_STATUS_SUCCESS` if the TD is up to date.
+*/
+enum tinywot_status tinywot_json_td_update(struct tinywot_json_td *self);
+
+/*!
+  \brief A form handler serving the TD of a `tinywot_json_td`.
+
+  Register this with a `tinywot_json_td` as the context on a form, e.g. a
+  readproperty form on `/.well-known/wot`.
+
+  The TD is brought up to date with `tinywot_json_td_update()` at the
+  beginning of a response (`tinywot_response::offset_byte` is 0). If the
+  response payload has no buffer
+  (`tinywot_payload::content_buffer_size_byte` is 0), it is pointed to
+  the whole TD. Otherwise, the TD is sent in blocks of the buffer size
+  (see `tinywot_form_handler_t`).
+
+  `tinywot_response::etag` is set to `tinywot_json_td::version`. A
+  request for the first block with the same `tinywot_request::etag`
+  gets an empty response with `::TINYWOT_STATUS_NOT_MODIFIED`.
+
+  The TD is shared by all requests, so a request for the first block may
+  generate it again while another requester is in the middle of it. To
+  detect this, send the `tinywot_response::etag` of the first block as
+  `tinywot_request::etag` with the following blocks. They then fail with
+  `::TINYWOT_STATUS_ERROR_VERSION_MISMATCH` if the TD has changed.
+  Without an ETag, the following blocks may come from a newer TD.
+
+  \param[out] response_payload See `tinywot_form_handler_t`.
+  \param[in] request_payload See `tinywot_form_handler_t`.
+  \param[inout] context A pointer to a `tinywot_json_td`.
+  \return
+    - `::TINYWOT_STATUS_NOT_FINISHED` if there are more blocks to come.
+    - `::TINYWOT_STATUS_NOT_MODIFIED` if `tinywot_request::etag` matches.
+    - `::TINYWOT_STATUS_ERROR_VERSION_MISMATCH` if `tinywot_request::etag`
+      does not match on a following block.
+    - `::TINYWOT_STATUS_ERROR_NOT_ALLOWED` if
+      `tinywot_response::offset_byte` is beyond the TD.
+    - See `tinywot_json_td_update()` for others.
+*/
+enum tinywot_status tinywot_json_td_handler(
+  struct tinywot_payload *response_payload,
+  struct tinywot_payload *request_payload,
+  void *context
+);
+
+#ifdef TINYWOT_ENABLE_INSTRUMENTATION
+/*!
+  \brief A form handler reading the `tinywot_instrumentation` of a
+  `tinywot_thing`.
+
+  Register this with a `tinywot_json_batch` as the context on a
+  diagnostic form, e.g. a readproperty form on `/.well-known/stats`. The
+  result is a JSON object like:
+
+      {"lookups":10,"notFound":1,"notAllowed":0,"forms":[
+        {"target":"/status","op":1,"hits":9,"errors":0,
+         "latencies":[0,0,3,6,0,0,0,0]}]}
+
+  where `op` is a `tinywot_operation_type`, and `latencies` is
+  `tinywot_form_stats::latencies_n`. `tinywot_json_batch::policy` is not
+  used. This is only available with `TINYWOT_ENABLE_INSTRUMENTATION`
+  defined.
+
+  \param[out] response_payload See `tinywot_form_handler_t`.
+  \param[in] request_payload See `tinywot_form_handler_t`.
+  \param[in] context A pointer to a `tinywot_json_batch`.
+  \return
+    - `::TINYWOT_STATUS_ERROR_NOT_IMPLEMENTED` if the `tinywot_thing` has
+      no `tinywot_instrumentation`, or if its forms are in program
+      memory.
+    - `::TINYWOT_STATUS_ERROR_NOT_ENOUGH_MEMORY` if the result does not
+      fit into the response payload.
+    - `::TINYWOT_STATUS_SUCCESS` if the operation has been successful.
+*/
+enum tinywot_status tinywot_json_handler_read_instrumentation(
+  struct tinywot_payload *response_payload,
+  struct tinywot_payload *request_payload,
+  void *context
+);
+#endif
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* TINYWOT_JSON_H */
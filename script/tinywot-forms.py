@@ -0,0 +1,447 @@
+#!/usr/bin/env python3
+#
+# Generate a C header containing a static list of `tinywot_form`s and a
+# minimal perfect hash table (`tinywot_form_hash_table`) over it, for use
+# with `tinywot_thing_init_static_hashed()`.
+#
+# SPDX-FileCopyrightText: 2023 Junde Yhi <junde@yhi.moe>
+# SPDX-License-Identifier: MIT
+
+"""Generate TinyWoT form tables from a form list or a Thing Description.
+
+A form list is a text file with one form per line:
+
+    <name> <target> <op> <handler> [<context>]
+
+`op` is a well-known operation type in lower case, e.g. `readproperty`,
+or several of them separated by commas, e.g. `readproperty,writeproperty`,
+which makes one `tinywot_form` serving all of them (`tinywot_form::ops`).
+Use `-` for a `NULL` name, handler or context. Empty lines and lines
+starting with `#` are ignored. Later lines override earlier lines with
+the same target and op, as `tinywot_thing_add_form()` does.
+
+A Thing Description (`--td`) is read as JSON. Every form of every
+Property, Action and Event, and every top-level form, is turned into one
+`tinywot_form` per operation type. The path of `href` is used as the
+target. The handler is named `handler_<kind>_<name>_<op>` (e.g.
+`handler_property_status_readproperty`), unless the form has a
+`tinywot:handler` member, in which case that handler serves all
+operation types of the form in one `tinywot_form`. Top-level forms are
+named `handler_thing_<op>`.
+
+Handlers are declared in the generated header. A context is copied as a
+C expression, so anything it refers to must be declared before the
+generated header is included.
+
+With `--dispatch`, the header instead contains the forms as an X-macro
+list (`<PREFIX>_FORMS`, see `tinywot/dispatch.h`), and a dispatcher
+`<prefix>_dispatch()` switching on the hash of the target, which calls
+handlers directly instead of through a `tinywot_thing`.
+
+Usage:
+
+    tinywot-forms.py [--td] [--dispatch] [--prefix PREFIX] INPUT [OUTPUT]
+"""
+
+import argparse
+import json
+import os
+import sys
+import urllib.parse
+
+OPS = [
+    "readproperty",
+    "writeproperty",
+    "observeproperty",
+    "unobserveproperty",
+    "invokeaction",
+    "queryaction",
+    "cancelaction",
+    "subscribeevent",
+    "unsubscribeevent",
+    "readallproperties",
+    "writeallproperties",
+    "readmultipleproperties",
+    "writemultipleproperties",
+    "observeallproperties",
+    "unobserveallproperties",
+    "queryallactions",
+    "subscribeallevents",
+    "unsubscribeallevents",
+]
+
+# Default operation types of an affordance without an explicit `op`, per
+# the WoT Thing Description specification.
+DEFAULT_OPS = {
+    "properties": ["readproperty", "writeproperty"],
+    "actions": ["invokeaction"],
+    "events": ["subscribeevent", "unsubscribeevent"],
+}
+
+KINDS = {
+    "properties": "property",
+    "actions": "action",
+    "events": "event",
+}
+
+MASK32 = 0xFFFFFFFF
+
+
+def target_hash(target):
+    """Must be identical to `tinywot_target_hash()`."""
+    h = 0x811C9DC5
+    for c in target.encode("utf-8"):
+        h ^= c
+        h = (h * 0x01000193) & MASK32
+    return h
+
+
+def mix(h, d):
+    """Must be identical to `tinywot_form_hash_table_mix()`."""
+    x = (h ^ ((d * 0x9E3779B1) & MASK32)) & MASK32
+    x ^= x >> 16
+    x = (x * 0x85EBCA6B) & MASK32
+    x ^= x >> 13
+    return x
+
+
+class Form:
+    def __init__(self, name, target, ops, handler, context):
+        """`ops` is an operation type, or a list of them; the first one is
+        `tinywot_form::op`, and the others go to `tinywot_form::ops`."""
+        if isinstance(ops, str):
+            ops = ops.split(",")
+        for op in ops:
+            if op not in OPS:
+                raise ValueError(f"unknown operation type: {op}")
+        self.name = name
+        self.target = target
+        self.op = ops[0]
+        self.ops = list(dict.fromkeys(op for op in ops[1:] if op != ops[0]))
+        self.handler = handler
+        self.context = context
+
+
+def read_form_list(f):
+    forms = []
+    for lineno, line in enumerate(f, 1):
+        line = line.strip()
+        if not line or line.startswith("#"):
+            continue
+        fields = line.split()
+        if len(fields) not in (4, 5):
+            raise ValueError(f"line {lineno}: expected 4 or 5 fields")
+        fields = [None if x == "-" else x for x in fields]
+        if fields[1] is None:
+            raise ValueError(f"line {lineno}: target cannot be empty")
+        forms.append(Form(*fields, *([None] * (5 - len(fields)))))
+    return forms
+
+
+def td_forms(affordance, default_ops):
+    for form in affordance.get("forms", []):
+        ops = form.get("op", default_ops)
+        if isinstance(ops, str):
+            ops = [ops]
+        target = urllib.parse.urlsplit(form["href"]).path or "/"
+        yield form, target, ops
+
+
+def read_td(f):
+    td = json.load(f)
+    forms = []
+    for key, kind in KINDS.items():
+        for name, affordance in td.get(key, {}).items():
+            default_ops = DEFAULT_OPS[key]
+            if key == "properties":
+                if affordance.get("readOnly"):
+                    default_ops = ["readproperty"]
+                elif affordance.get("writeOnly"):
+                    default_ops = ["writeproperty"]
+            for form, target, ops in td_forms(affordance, default_ops):
+                if "tinywot:handler" in form and ops:
+                    forms.append(
+                        Form(name, target, ops, form["tinywot:handler"], None)
+                    )
+                    continue
+                for op in ops:
+                    handler = form.get(
+                        "tinywot:handler", f"handler_{kind}_{name}_{op}"
+                    )
+                    forms.append(Form(name, target, op, handler, None))
+    for form, target, ops in td_forms(td, []):
+        if "tinywot:handler" in form and ops:
+            forms.append(
+                Form(None, target, ops, form["tinywot:handler"], None)
+            )
+            continue
+        for op in ops:
+            handler = form.get("tinywot:handler", f"handler_thing_{op}")
+            forms.append(Form(None, target, op, handler, None))
+    return forms
+
+
+def build_hash_table(targets):
+    """Hash-and-displace: distribute targets into buckets with the plain
+    hash, then find a displacement for each bucket (largest first) that
+    moves all of its targets into free slots."""
+    n = len(targets)
+    r = max(1, (n + 1) // 2)
+    buckets = [[] for _ in range(r)]
+    for t in targets:
+        buckets[target_hash(t) % r].append(t)
+
+    displacements = [0] * r
+    slots = [None] * n
+    for b in sorted(range(r), key=lambda b: -len(buckets[b])):
+        if not buckets[b]:
+            continue
+        for d in range(0x10000):
+            taken = set()
+            ok = True
+            for t in buckets[b]:
+                k = mix(target_hash(t), d) % n
+                if slots[k] is not None or k in taken:
+                    ok = False
+                    break
+                taken.add(k)
+            if ok:
+                break
+        else:
+            raise RuntimeError("cannot find a perfect hash function")
+        displacements[b] = d
+        for t in buckets[b]:
+            slots[mix(target_hash(t), d) % n] = t
+    return displacements, slots
+
+
+def c_str(s):
+    if s is None:
+        return "NULL"
+    return '"' + s.replace("\\", "\\\\").replace('"', '\\"') + '"'
+
+
+def c_ref(s):
+    return "NULL" if s is None else s
+
+
+def generate(forms, prefix, source):
+    targets = list(dict.fromkeys(f.target for f in forms))
+    if len(targets) > 0xFFFF or len(forms) > 0xFFFF:
+        raise ValueError("too many forms")
+    displacements, slots = build_hash_table(targets)
+
+    # Group forms by slot; the declaration order is kept in each group.
+    ordered = []
+    offsets = []
+    for t in slots:
+        offsets.append(len(ordered))
+        ordered.extend(f for f in forms if f.target == t)
+    offsets.append(len(ordered))
+
+    guard = f"{prefix.upper()}_FORMS_H"
+    out = []
+    out.append(
+        f"/* Generated by tinywot-forms.py from {os.path.basename(source)}. */"
+    )
+    out.append("/* Do not edit. */")
+    out.append("")
+    out.append(f"#ifndef {guard}")
+    out.append(f"#define {guard}")
+    out.append("")
+    out.append("#include <stddef.h>")
+    out.append("#include <stdint.h>")
+    out.append("#include <tinywot/core.h>")
+    out.append("")
+
+    handlers = dict.fromkeys(f.handler for f in forms if f.handler)
+    for h in handlers:
+        out.append(f"tinywot_form_handler_t {h};")
+    if handlers:
+        out.append("")
+
+    out.append(f"static struct tinywot_form const {prefix}_forms[] = {{")
+    for f in ordered:
+        out.append("  {")
+        out.append(f"    .name = {c_str(f.name)},")
+        out.append(f"    .target = {c_str(f.target)},")
+        out.append(f"    .op = TINYWOT_OPERATION_TYPE_{f.op.upper()},")
+        if f.ops:
+            bit = "TINYWOT_OPERATION_TYPE_BIT(TINYWOT_OPERATION_TYPE_{})"
+            bits = [bit.format(op.upper()) for op in f.ops]
+            out.append("    .ops =")
+            out.append("      " + "\n      | ".join(bits) + ",")
+        out.append(f"    .handler = {c_ref(f.handler)},")
+        out.append(f"    .context = {c_ref(f.context)},")
+        out.append("  },")
+    out.append("};")
+    out.append("")
+
+    def array(name, values):
+        out.append(f"static uint_least16_t const {name}[] = {{")
+        for i in range(0, len(values), 8):
+            chunk = ", ".join(str(v) for v in values[i:i + 8])
+            out.append(f"  {chunk},")
+        out.append("};")
+        out.append("")
+
+    array(f"{prefix}_forms_hash_displacements", displacements)
+    array(f"{prefix}_forms_hash_offsets", offsets)
+
+    out.append(
+        f"static struct tinywot_form_hash_table const {prefix}_forms_hash ="
+    )
+    out.append("  TINYWOT_FORM_HASH_TABLE_INIT(")
+    out.append(
+        f"    {prefix}_forms_hash_displacements, {prefix}_forms_hash_offsets"
+    )
+    out.append("  );")
+    out.append("")
+    out.append(f"#endif /* {guard} */")
+    return "\n".join(out) + "\n"
+
+
+def generate_dispatch(forms, prefix, source):
+    # One entry per target and op; later forms override earlier ones.
+    entries = {}
+    for f in forms:
+        for op in [f.op] + f.ops:
+            entries.pop((f.target, op), None)
+            entries[(f.target, op)] = f
+
+    guard = f"{prefix.upper()}_DISPATCH_H"
+    out = []
+    out.append(
+        f"/* Generated by tinywot-forms.py from {os.path.basename(source)}. */"
+    )
+    out.append("/* Do not edit. */")
+    out.append("")
+    out.append(f"#ifndef {guard}")
+    out.append(f"#define {guard}")
+    out.append("")
+    out.append("#include <stdbool.h>")
+    out.append("#include <stddef.h>")
+    out.append("#include <string.h>")
+    out.append("#include <tinywot/core.h>")
+    out.append("#include <tinywot/dispatch.h>")
+    out.append("")
+
+    handlers = dict.fromkeys(f.handler for f in forms if f.handler)
+    for h in handlers:
+        out.append(f"tinywot_form_handler_t {h};")
+    if handlers:
+        out.append("")
+
+    out.append(f"#define {prefix.upper()}_FORMS(X) \\")
+    lines = []
+    for (target, op), f in entries.items():
+        lines.append(
+            f"  X({c_str(f.name)}, {c_str(target)}, "
+            f"TINYWOT_OPERATION_TYPE_{op.upper()}, {c_ref(f.handler)}, "
+            f"{c_ref(f.context)})"
+        )
+    out.append(" \\\n".join(lines))
+    out.append("")
+
+    # Group targets by hash, in case two of them collide.
+    targets = list(dict.fromkeys(target for target, _ in entries))
+    hashes = {}
+    for t in targets:
+        hashes.setdefault(target_hash(t), []).append(t)
+
+    out.append(f"static inline enum tinywot_status {prefix}_dispatch(")
+    out.append(
+        "  struct tinywot_response *response, struct tinywot_request *request"
+    )
+    out.append(") {")
+    out.append("  size_t target_length_byte = 0;")
+    out.append("  char const *target =")
+    out.append("    tinywot_request_get_target(request, &target_length_byte);")
+    out.append("  bool allowed = false;")
+    out.append("")
+    out.append("  if (!target) {")
+    out.append("    return tinywot_dispatch_reject(response, false);")
+    out.append("  }")
+    out.append("")
+    out.append(
+        "  switch (tinywot_target_hash_n(target, target_length_byte)) {"
+    )
+    for h, ts in hashes.items():
+        out.append(f"    case 0x{h:08x}UL:")
+        for t in ts:
+            n = len(t.encode("utf-8"))
+            out.append(f"      if (target_length_byte == {n}U")
+            out.append(
+                f"          && memcmp(target, {c_str(t)}, {n}U) == 0) {{"
+            )
+            out.append("        allowed = true;")
+            out.append("")
+            out.append("        switch (request->op) {")
+            for (target, op), f in entries.items():
+                if target != t:
+                    continue
+                out.append(
+                    f"          case TINYWOT_OPERATION_TYPE_{op.upper()}:"
+                )
+                out.append(
+                    f"            TINYWOT_DISPATCH_CALL("
+                    f"{c_ref(f.handler)}, {c_ref(f.context)});"
+                )
+                out.append("            break;")
+            out.append("          default:")
+            out.append("            break;")
+            out.append("        }")
+            out.append("      }")
+        out.append("      break;")
+    out.append("    default:")
+    out.append("      break;")
+    out.append("  }")
+    out.append("")
+    out.append("  return tinywot_dispatch_reject(response, allowed);")
+    out.append("}")
+    out.append("")
+    out.append(f"#endif /* {guard} */")
+    return "\n".join(out) + "\n"
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Generate TinyWoT form tables with a perfect hash table."
+    )
+    parser.add_argument(
+        "--td", action="store_true",
+        help="read a Thing Description instead of a form list"
+    )
+    parser.add_argument(
+        "--dispatch", action="store_true",
+        help="generate a dispatcher instead of a form table"
+    )
+    parser.add_argument(
+        "--prefix", default="thing",
+        help="prefix of generated identifiers (default: thing)"
+    )
+    parser.add_argument("input", help="input file, or - for stdin")
+    parser.add_argument(
+        "output", nargs="?", default="-", help="output file (default: stdout)"
+    )
+    args = parser.parse_args()
+
+    fin = sys.stdin if args.input == "-" else open(args.input, encoding="utf-8")
+    with fin:
+        forms = read_td(fin) if args.td else read_form_list(fin)
+    if not forms:
+        parser.error("no forms found in input")
+
+    if args.dispatch:
+        text = generate_dispatch(forms, args.prefix, args.input)
+    else:
+        text = generate(forms, args.prefix, args.input)
+    if args.output == "-":
+        sys.stdout.write(text)
+    else:
+        with open(args.output, "w", encoding="utf-8") as fout:
+            fout.write(text)
+
+
+if __name__ == "__main__":
+    main()
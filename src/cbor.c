@@ -0,0 +1,811 @@
+/*
+  SPDX-FileCopyrightText: 2023 Junde Yhi <junde@yhi.moe>
+  SPDX-License-Identifier: MIT
+*/
+
+/*!
+  \file
+  \brief TinyWoT Core CBOR writer and reader implementation.
+*/
+
+#include <float.h>
+#include <limits.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <tinywot/cbor.h>
+#include <tinywot/core.h>
+
+/* Major types, in the top 3 bits of the initial byte. */
+#define TINYWOT_CBOR_MAJOR_UINT 0U
+#define TINYWOT_CBOR_MAJOR_NEGATIVE_INT 1U
+#define TINYWOT_CBOR_MAJOR_BYTES 2U
+#define TINYWOT_CBOR_MAJOR_TEXT 3U
+#define TINYWOT_CBOR_MAJOR_ARRAY 4U
+#define TINYWOT_CBOR_MAJOR_MAP 5U
+#define TINYWOT_CBOR_MAJOR_TAG 6U
+#define TINYWOT_CBOR_MAJOR_SIMPLE 7U
+
+/* Additional information, in the low 5 bits of the initial byte. */
+#define TINYWOT_CBOR_INFO_ONE_BYTE 24U
+#define TINYWOT_CBOR_INFO_INDEFINITE 31U
+#define TINYWOT_CBOR_SIMPLE_FALSE 20U
+#define TINYWOT_CBOR_SIMPLE_TRUE 21U
+#define TINYWOT_CBOR_SIMPLE_NULL 22U
+#define TINYWOT_CBOR_SIMPLE_UNDEFINED 23U
+#define TINYWOT_CBOR_SIMPLE_HALF 25U
+#define TINYWOT_CBOR_SIMPLE_SINGLE 26U
+#define TINYWOT_CBOR_SIMPLE_DOUBLE 27U
+
+/* An initial byte and an argument of at most 8 bytes. */
+#define TINYWOT_CBOR_HEAD_SIZE_BYTE 9U
+
+/* Single precision is read and written through its bit pattern. */
+typedef char tinywot_cbor_float_is_32_bit[sizeof(float) == 4 ? 1 : -1];
+
+/*
+  Encode the initial byte and the argument into head, using the
+  shortest form, and return the length of the head.
+*/
+static size_t tinywot_cbor_encode_head(
+  unsigned char *head, unsigned int major, unsigned long argument
+) {
+  size_t argument_size_byte = 0;
+  unsigned int info = 0;
+
+  if (argument < TINYWOT_CBOR_INFO_ONE_BYTE) {
+    head[0] = (unsigned char)((major << 5) | (unsigned int)argument);
+    return 1;
+  } else if (argument <= 0xffUL) {
+    argument_size_byte = 1;
+    info = 24;
+  } else if (argument <= 0xffffUL) {
+    argument_size_byte = 2;
+    info = 25;
+  } else if (argument <= 0xffffffffUL) {
+    argument_size_byte = 4;
+    info = 26;
+  } else {
+    argument_size_byte = 8;
+    info = 27;
+  }
+
+  head[0] = (unsigned char)((major << 5) | info);
+
+  /* Shifting one byte at a time also works for a 32-bit long. */
+  for (size_t i = argument_size_byte; i > 0; i--) {
+    head[i] = (unsigned char)(argument & 0xffU);
+    argument >>= 8;
+  }
+
+  return argument_size_byte + 1;
+}
+
+/*
+  Write a head and some data after it atomically.
+*/
+static enum tinywot_status tinywot_cbor_write_item(
+  struct tinywot_cbor_writer *self,
+  unsigned char const *head,
+  size_t head_size_byte,
+  void const *data,
+  size_t data_size_byte
+) {
+  struct tinywot_payload_mark mark;
+  enum tinywot_status status = TINYWOT_STATUS_SUCCESS;
+
+  if (tinywot_status_is_error(self->status)) {
+    return self->status;
+  }
+
+  tinywot_payload_mark(self->payload, &mark);
+
+  status = tinywot_payload_append(self->payload, head, head_size_byte);
+
+  if (!tinywot_status_is_error(status) && data_size_byte > 0) {
+    status = tinywot_payload_append(self->payload, data, data_size_byte);
+  }
+
+  if (tinywot_status_is_error(status)) {
+    tinywot_payload_rollback(self->payload, &mark);
+    self->status = status;
+  }
+
+  return status;
+}
+
+static enum tinywot_status tinywot_cbor_write_head(
+  struct tinywot_cbor_writer *self,
+  unsigned int major,
+  unsigned long argument,
+  void const *data,
+  size_t data_size_byte
+) {
+  unsigned char head[TINYWOT_CBOR_HEAD_SIZE_BYTE];
+  size_t head_size_byte = tinywot_cbor_encode_head(head, major, argument);
+
+  return tinywot_cbor_write_item(
+    self, head, head_size_byte, data, data_size_byte
+  );
+}
+
+static enum tinywot_status tinywot_cbor_write_simple(
+  struct tinywot_cbor_writer *self, unsigned int simple
+) {
+  unsigned char head = (unsigned char)((TINYWOT_CBOR_MAJOR_SIMPLE << 5)
+                                       | simple);
+
+  return tinywot_cbor_write_item(self, &head, 1, NULL, 0);
+}
+
+/*
+  Convert the bits of a single precision number to half precision.
+  Return false if it cannot be represented exactly.
+*/
+static bool tinywot_cbor_single_to_half(uint32_t single, uint16_t *half) {
+  uint16_t sign = (uint16_t)((single >> 16) & 0x8000U);
+  int exponent = (int)((single >> 23) & 0xffU) - 127;
+  uint32_t mantissa = single & 0x7fffffUL;
+
+  if ((single & 0x7fffffffUL) == 0) {
+    *half = sign;
+    return true;
+  }
+
+  if (exponent == 128 && mantissa == 0) {
+    *half = (uint16_t)(sign | 0x7c00U);
+    return true;
+  }
+
+  /* Subnormal half precision numbers are left to single precision. */
+  if (exponent < -14 || exponent > 15 || (mantissa & 0x1fffU) != 0) {
+    return false;
+  }
+
+  *half = (uint16_t)(sign | (uint16_t)((exponent + 15) << 10)
+                     | (uint16_t)(mantissa >> 13));
+
+  return true;
+}
+
+/*
+  Multiply value by 2 to the power of exponent, without pulling in
+  ldexp() from libm.
+*/
+static double tinywot_cbor_scale(double value, int exponent) {
+  for (; exponent > 0; exponent--) {
+    value *= 2;
+  }
+
+  for (; exponent < 0; exponent++) {
+    value /= 2;
+  }
+
+  return value;
+}
+
+static unsigned long tinywot_cbor_load(
+  unsigned char const *data, size_t data_size_byte
+) {
+  unsigned long value = 0;
+
+  for (size_t i = 0; i < data_size_byte; i++) {
+    value = (value << 8) | data[i];
+  }
+
+  return value;
+}
+
+static double tinywot_cbor_decode_half(unsigned char const *data) {
+  unsigned int half = (unsigned int)tinywot_cbor_load(data, 2);
+  int exponent = (int)((half >> 10) & 0x1fU);
+  double mantissa = (double)(half & 0x3ffU);
+  double value = 0;
+
+  if (exponent == 0) {
+    value = tinywot_cbor_scale(mantissa, -24);
+  } else if (exponent == 31) {
+    value = mantissa == 0 ? (double)INFINITY : (double)NAN;
+  } else {
+    value = tinywot_cbor_scale(mantissa + 1024, exponent - 25);
+  }
+
+  return (half & 0x8000U) ? -value : value;
+}
+
+static double tinywot_cbor_decode_single(unsigned char const *data) {
+  uint32_t bits = (uint32_t)tinywot_cbor_load(data, 4);
+  float value = 0;
+
+  memcpy(&value, &bits, sizeof(value));
+
+  return value;
+}
+
+static double tinywot_cbor_decode_double(unsigned char const *data) {
+#if DBL_MANT_DIG >= 53
+  uint64_t bits = 0;
+  double value = 0;
+
+  for (size_t i = 0; i < 8; i++) {
+    bits = (bits << 8) | data[i];
+  }
+
+  memcpy(&value, &bits, sizeof(value));
+
+  return value;
+#else
+  /* double is narrower than the data (e.g. on AVR), so round it. */
+  unsigned long high = tinywot_cbor_load(data, 4);
+  unsigned long low = tinywot_cbor_load(data + 4, 4);
+  int exponent = (int)((high >> 20) & 0x7ffU);
+  double value = 0;
+
+  if (exponent == 0x7ff) {
+    value = ((high & 0xfffffUL) | low) ? (double)NAN : (double)INFINITY;
+  } else if (exponent - 1023 > DBL_MAX_EXP) {
+    value = (double)INFINITY;
+  } else if (exponent != 0 && exponent - 1023 >= DBL_MIN_EXP - DBL_MANT_DIG) {
+    value = (double)((high & 0xfffffUL) | 0x100000UL)
+            + tinywot_cbor_scale((double)low, -32);
+    value = tinywot_cbor_scale(value, exponent - 1023 - 20);
+  }
+
+  return (high & 0x80000000UL) ? -value : value;
+#endif
+}
+
+/*
+  Decode the item at the position of self into item, and its length in
+  byte into item_size_byte, without moving self.
+*/
+static enum tinywot_status tinywot_cbor_decode(
+  struct tinywot_cbor_reader const *self,
+  struct tinywot_cbor_item *item,
+  size_t *item_size_byte
+) {
+  unsigned char const *data = self->data + self->offset_byte;
+  size_t remaining_byte = self->data_size_byte - self->offset_byte;
+  unsigned int major = 0;
+  unsigned int info = 0;
+  size_t argument_size_byte = 0;
+  unsigned long argument = 0;
+
+  if (tinywot_status_is_error(self->status)) {
+    return self->status;
+  }
+
+  if (remaining_byte == 0) {
+    return TINYWOT_STATUS_END_OF_STREAM;
+  }
+
+  major = data[0] >> 5;
+  info = data[0] & 0x1fU;
+
+  if (info < TINYWOT_CBOR_INFO_ONE_BYTE) {
+    argument = info;
+  } else if (info <= 27) {
+    argument_size_byte = (size_t)1 << (info - TINYWOT_CBOR_INFO_ONE_BYTE);
+  } else if (info == TINYWOT_CBOR_INFO_INDEFINITE
+             && major >= TINYWOT_CBOR_MAJOR_BYTES
+             && major <= TINYWOT_CBOR_MAJOR_MAP) {
+    return TINYWOT_STATUS_ERROR_NOT_IMPLEMENTED;
+  } else {
+    return TINYWOT_STATUS_ERROR_NOT_ALLOWED;
+  }
+
+  if (remaining_byte - 1 < argument_size_byte) {
+    return TINYWOT_STATUS_ERROR_NOT_ALLOWED;
+  }
+
+  remaining_byte -= argument_size_byte + 1;
+  *item_size_byte = argument_size_byte + 1;
+
+  item->type = TINYWOT_CBOR_TYPE_UNKNOWN;
+  item->argument = 0;
+  item->content = NULL;
+  item->number = 0;
+
+  if (major == TINYWOT_CBOR_MAJOR_SIMPLE) {
+    switch (info) {
+      case TINYWOT_CBOR_SIMPLE_FALSE:
+      case TINYWOT_CBOR_SIMPLE_TRUE:
+        item->type = TINYWOT_CBOR_TYPE_BOOL;
+        item->argument = info == TINYWOT_CBOR_SIMPLE_TRUE;
+        return TINYWOT_STATUS_SUCCESS;
+
+      case TINYWOT_CBOR_SIMPLE_NULL:
+        item->type = TINYWOT_CBOR_TYPE_NULL;
+        return TINYWOT_STATUS_SUCCESS;
+
+      case TINYWOT_CBOR_SIMPLE_UNDEFINED:
+        item->type = TINYWOT_CBOR_TYPE_UNDEFINED;
+        return TINYWOT_STATUS_SUCCESS;
+
+      case TINYWOT_CBOR_SIMPLE_HALF:
+        item->type = TINYWOT_CBOR_TYPE_FLOAT;
+        item->number = tinywot_cbor_decode_half(data + 1);
+        return TINYWOT_STATUS_SUCCESS;
+
+      case TINYWOT_CBOR_SIMPLE_SINGLE:
+        item->type = TINYWOT_CBOR_TYPE_FLOAT;
+        item->number = tinywot_cbor_decode_single(data + 1);
+        return TINYWOT_STATUS_SUCCESS;
+
+      case TINYWOT_CBOR_SIMPLE_DOUBLE:
+        item->type = TINYWOT_CBOR_TYPE_FLOAT;
+        item->number = tinywot_cbor_decode_double(data + 1);
+        return TINYWOT_STATUS_SUCCESS;
+
+      default:
+        return TINYWOT_STATUS_ERROR_NOT_IMPLEMENTED;
+    }
+  }
+
+  for (size_t i = 0; i < argument_size_byte; i++) {
+    if (argument > (ULONG_MAX >> 8)) {
+      return TINYWOT_STATUS_ERROR_NOT_IMPLEMENTED;
+    }
+
+    argument = (argument << 8) | data[i + 1];
+  }
+
+  item->argument = argument;
+
+  switch (major) {
+    case TINYWOT_CBOR_MAJOR_UINT:
+      item->type = TINYWOT_CBOR_TYPE_UINT;
+      break;
+
+    case TINYWOT_CBOR_MAJOR_NEGATIVE_INT:
+      item->type = TINYWOT_CBOR_TYPE_NEGATIVE_INT;
+      break;
+
+    case TINYWOT_CBOR_MAJOR_BYTES:
+    case TINYWOT_CBOR_MAJOR_TEXT:
+      if (argument > remaining_byte) {
+        return TINYWOT_STATUS_ERROR_NOT_ALLOWED;
+      }
+
+      item->type = major == TINYWOT_CBOR_MAJOR_BYTES
+                     ? TINYWOT_CBOR_TYPE_BYTES
+                     : TINYWOT_CBOR_TYPE_TEXT;
+      item->content = data + *item_size_byte;
+      *item_size_byte += (size_t)argument;
+      break;
+
+    /* Every element takes at least one byte, which also keeps the
+       counts of tinywot_cbor_skip() from overflowing. */
+    case TINYWOT_CBOR_MAJOR_ARRAY:
+      if (argument > remaining_byte) {
+        return TINYWOT_STATUS_ERROR_NOT_ALLOWED;
+      }
+
+      item->type = TINYWOT_CBOR_TYPE_ARRAY;
+      break;
+
+    case TINYWOT_CBOR_MAJOR_MAP:
+      if (argument > remaining_byte / 2) {
+        return TINYWOT_STATUS_ERROR_NOT_ALLOWED;
+      }
+
+      item->type = TINYWOT_CBOR_TYPE_MAP;
+      break;
+
+    case TINYWOT_CBOR_MAJOR_TAG:
+    default:
+      item->type = TINYWOT_CBOR_TYPE_TAG;
+      break;
+  }
+
+  return TINYWOT_STATUS_SUCCESS;
+}
+
+/*
+  Read the next item if it is of type, or make NOT_ALLOWED sticky.
+*/
+static enum tinywot_status tinywot_cbor_read_typed(
+  struct tinywot_cbor_reader *self,
+  struct tinywot_cbor_item *item,
+  enum tinywot_cbor_type type
+) {
+  struct tinywot_cbor_item next;
+  enum tinywot_status status = tinywot_cbor_peek(self, &next);
+
+  if (status == TINYWOT_STATUS_SUCCESS && next.type != type) {
+    status = TINYWOT_STATUS_ERROR_NOT_ALLOWED;
+  }
+
+  if (status != TINYWOT_STATUS_SUCCESS) {
+    if (tinywot_status_is_error(status)) {
+      self->status = status;
+    }
+
+    return status;
+  }
+
+  return tinywot_cbor_read(self, item);
+}
+
+void tinywot_cbor_writer_init(
+  struct tinywot_cbor_writer *self, struct tinywot_payload *payload
+) {
+  self->payload = payload;
+  self->status = TINYWOT_STATUS_SUCCESS;
+}
+
+enum tinywot_status tinywot_cbor_write_uint(
+  struct tinywot_cbor_writer *self, unsigned long value
+) {
+  return tinywot_cbor_write_head(self, TINYWOT_CBOR_MAJOR_UINT, value, NULL, 0);
+}
+
+enum tinywot_status tinywot_cbor_write_int(
+  struct tinywot_cbor_writer *self, long value
+) {
+  if (value >= 0) {
+    return tinywot_cbor_write_uint(self, (unsigned long)value);
+  }
+
+  /* -1 - value, without overflowing on LONG_MIN. */
+  return tinywot_cbor_write_head(
+    self,
+    TINYWOT_CBOR_MAJOR_NEGATIVE_INT,
+    (unsigned long)(-(value + 1)),
+    NULL,
+    0
+  );
+}
+
+enum tinywot_status tinywot_cbor_write_float(
+  struct tinywot_cbor_writer *self, double value
+) {
+  unsigned char head[TINYWOT_CBOR_HEAD_SIZE_BYTE];
+  float single = 0.0f;
+  uint32_t single_bits = 0;
+  uint16_t half_bits = 0;
+
+  /* NaN is the only value not equal to itself. */
+  if (value != value) {
+    head[0] = (TINYWOT_CBOR_MAJOR_SIMPLE << 5) | TINYWOT_CBOR_SIMPLE_HALF;
+    head[1] = 0x7e;
+    head[2] = 0x00;
+
+    return tinywot_cbor_write_item(self, head, 3, NULL, 0);
+  }
+
+#if DBL_MANT_DIG > FLT_MANT_DIG
+  /* Narrowing a finite value out of the range of float is undefined, so
+     it is checked first. Infinities fit. */
+  if ((fabs(value) > FLT_MAX && !isinf(value))
+      || (double)(float)value != value) {
+    uint64_t double_bits = 0;
+
+    memcpy(&double_bits, &value, sizeof(double_bits));
+
+    head[0] = (TINYWOT_CBOR_MAJOR_SIMPLE << 5) | TINYWOT_CBOR_SIMPLE_DOUBLE;
+
+    for (size_t i = 8; i > 0; i--) {
+      head[i] = (unsigned char)(double_bits & 0xffU);
+      double_bits >>= 8;
+    }
+
+    return tinywot_cbor_write_item(self, head, 9, NULL, 0);
+  }
+#endif
+
+  single = (float)value;
+  memcpy(&single_bits, &single, sizeof(single_bits));
+
+  if (tinywot_cbor_single_to_half(single_bits, &half_bits)) {
+    head[0] = (TINYWOT_CBOR_MAJOR_SIMPLE << 5) | TINYWOT_CBOR_SIMPLE_HALF;
+    head[1] = (unsigned char)(half_bits >> 8);
+    head[2] = (unsigned char)(half_bits & 0xffU);
+
+    return tinywot_cbor_write_item(self, head, 3, NULL, 0);
+  }
+
+  head[0] = (TINYWOT_CBOR_MAJOR_SIMPLE << 5) | TINYWOT_CBOR_SIMPLE_SINGLE;
+
+  for (size_t i = 4; i > 0; i--) {
+    head[i] = (unsigned char)(single_bits & 0xffU);
+    single_bits >>= 8;
+  }
+
+  return tinywot_cbor_write_item(self, head, 5, NULL, 0);
+}
+
+enum tinywot_status tinywot_cbor_write_bytes(
+  struct tinywot_cbor_writer *self, void const *data, size_t data_size_byte
+) {
+  return tinywot_cbor_write_head(
+    self, TINYWOT_CBOR_MAJOR_BYTES, data_size_byte, data, data_size_byte
+  );
+}
+
+enum tinywot_status tinywot_cbor_write_string(
+  struct tinywot_cbor_writer *self, char const *str
+) {
+  return tinywot_cbor_write_string_n(self, str, strlen(str));
+}
+
+enum tinywot_status tinywot_cbor_write_string_n(
+  struct tinywot_cbor_writer *self, char const *str, size_t str_length_byte
+) {
+  return tinywot_cbor_write_head(
+    self, TINYWOT_CBOR_MAJOR_TEXT, str_length_byte, str, str_length_byte
+  );
+}
+
+enum tinywot_status tinywot_cbor_write_array_begin(
+  struct tinywot_cbor_writer *self, size_t items_count_n
+) {
+  return tinywot_cbor_write_head(
+    self, TINYWOT_CBOR_MAJOR_ARRAY, items_count_n, NULL, 0
+  );
+}
+
+enum tinywot_status tinywot_cbor_write_map_begin(
+  struct tinywot_cbor_writer *self, size_t pairs_count_n
+) {
+  return tinywot_cbor_write_head(
+    self, TINYWOT_CBOR_MAJOR_MAP, pairs_count_n, NULL, 0
+  );
+}
+
+enum tinywot_status tinywot_cbor_write_tag(
+  struct tinywot_cbor_writer *self, unsigned long tag
+) {
+  return tinywot_cbor_write_head(self, TINYWOT_CBOR_MAJOR_TAG, tag, NULL, 0);
+}
+
+enum tinywot_status tinywot_cbor_write_bool(
+  struct tinywot_cbor_writer *self, bool value
+) {
+  return tinywot_cbor_write_simple(
+    self, value ? TINYWOT_CBOR_SIMPLE_TRUE : TINYWOT_CBOR_SIMPLE_FALSE
+  );
+}
+
+enum tinywot_status tinywot_cbor_write_null(struct tinywot_cbor_writer *self) {
+  return tinywot_cbor_write_simple(self, TINYWOT_CBOR_SIMPLE_NULL);
+}
+
+enum tinywot_status tinywot_cbor_write_raw(
+  struct tinywot_cbor_writer *self, void const *data, size_t data_size_byte
+) {
+  return tinywot_cbor_write_item(self, data, data_size_byte, NULL, 0);
+}
+
+void tinywot_cbor_reader_init(
+  struct tinywot_cbor_reader *self, struct tinywot_payload const *payload
+) {
+  self->data = payload->content;
+  self->data_size_byte = payload->content_length_byte;
+  self->offset_byte = 0;
+  self->status = TINYWOT_STATUS_SUCCESS;
+
+  if (payload->segments) {
+    self->data_size_byte = 0;
+    self->status = TINYWOT_STATUS_ERROR_NOT_IMPLEMENTED;
+  }
+}
+
+enum tinywot_status tinywot_cbor_peek(
+  struct tinywot_cbor_reader const *self, struct tinywot_cbor_item *item
+) {
+  size_t item_size_byte = 0;
+
+  return tinywot_cbor_decode(self, item, &item_size_byte);
+}
+
+enum tinywot_status tinywot_cbor_read(
+  struct tinywot_cbor_reader *self, struct tinywot_cbor_item *item
+) {
+  size_t item_size_byte = 0;
+  enum tinywot_status status
+    = tinywot_cbor_decode(self, item, &item_size_byte);
+
+  if (status == TINYWOT_STATUS_SUCCESS) {
+    self->offset_byte += item_size_byte;
+  } else if (tinywot_status_is_error(status)) {
+    self->status = status;
+  }
+
+  return status;
+}
+
+enum tinywot_status tinywot_cbor_skip(struct tinywot_cbor_reader *self) {
+  struct tinywot_cbor_item item;
+  size_t offset_byte = self->offset_byte;
+  size_t items_n = 1;
+
+  while (items_n > 0) {
+    enum tinywot_status status = tinywot_cbor_read(self, &item);
+
+    if (status == TINYWOT_STATUS_END_OF_STREAM && items_n > 0
+        && offset_byte != self->offset_byte) {
+      self->offset_byte = offset_byte;
+      self->status = TINYWOT_STATUS_ERROR_NOT_ALLOWED;
+      return self->status;
+    }
+
+    if (status != TINYWOT_STATUS_SUCCESS) {
+      self->offset_byte = offset_byte;
+      return status;
+    }
+
+    items_n -= 1;
+
+    if (item.type == TINYWOT_CBOR_TYPE_ARRAY) {
+      items_n += (size_t)item.argument;
+    } else if (item.type == TINYWOT_CBOR_TYPE_MAP) {
+      items_n += (size_t)item.argument * 2;
+    } else if (item.type == TINYWOT_CBOR_TYPE_TAG) {
+      items_n += 1;
+    }
+  }
+
+  return TINYWOT_STATUS_SUCCESS;
+}
+
+enum tinywot_status tinywot_cbor_read_uint(
+  struct tinywot_cbor_reader *self, unsigned long *value
+) {
+  struct tinywot_cbor_item item;
+  enum tinywot_status status
+    = tinywot_cbor_read_typed(self, &item, TINYWOT_CBOR_TYPE_UINT);
+
+  if (status == TINYWOT_STATUS_SUCCESS) {
+    *value = item.argument;
+  }
+
+  return status;
+}
+
+enum tinywot_status tinywot_cbor_read_int(
+  struct tinywot_cbor_reader *self, long *value
+) {
+  struct tinywot_cbor_item item;
+  enum tinywot_status status = tinywot_cbor_peek(self, &item);
+
+  if (status == TINYWOT_STATUS_SUCCESS) {
+    if ((item.type != TINYWOT_CBOR_TYPE_UINT
+         && item.type != TINYWOT_CBOR_TYPE_NEGATIVE_INT)
+        || item.argument > (unsigned long)LONG_MAX) {
+      self->status = TINYWOT_STATUS_ERROR_NOT_ALLOWED;
+      return self->status;
+    }
+
+    status = tinywot_cbor_read(self, &item);
+  } else if (tinywot_status_is_error(status)) {
+    self->status = status;
+  }
+
+  if (status == TINYWOT_STATUS_SUCCESS) {
+    if (item.type == TINYWOT_CBOR_TYPE_UINT) {
+      *value = (long)item.argument;
+    } else {
+      *value = -1 - (long)item.argument;
+    }
+  }
+
+  return status;
+}
+
+enum tinywot_status tinywot_cbor_read_float(
+  struct tinywot_cbor_reader *self, double *value
+) {
+  struct tinywot_cbor_item item;
+  enum tinywot_status status = tinywot_cbor_peek(self, &item);
+
+  if (status == TINYWOT_STATUS_SUCCESS) {
+    if (item.type != TINYWOT_CBOR_TYPE_FLOAT
+        && item.type != TINYWOT_CBOR_TYPE_UINT
+        && item.type != TINYWOT_CBOR_TYPE_NEGATIVE_INT) {
+      self->status = TINYWOT_STATUS_ERROR_NOT_ALLOWED;
+      return self->status;
+    }
+
+    status = tinywot_cbor_read(self, &item);
+  } else if (tinywot_status_is_error(status)) {
+    self->status = status;
+  }
+
+  if (status == TINYWOT_STATUS_SUCCESS) {
+    if (item.type == TINYWOT_CBOR_TYPE_UINT) {
+      *value = (double)item.argument;
+    } else if (item.type == TINYWOT_CBOR_TYPE_NEGATIVE_INT) {
+      *value = -1.0 - (double)item.argument;
+    } else {
+      *value = item.number;
+    }
+  }
+
+  return status;
+}
+
+enum tinywot_status tinywot_cbor_read_bool(
+  struct tinywot_cbor_reader *self, bool *value
+) {
+  struct tinywot_cbor_item item;
+  enum tinywot_status status
+    = tinywot_cbor_read_typed(self, &item, TINYWOT_CBOR_TYPE_BOOL);
+
+  if (status == TINYWOT_STATUS_SUCCESS) {
+    *value = item.argument != 0;
+  }
+
+  return status;
+}
+
+enum tinywot_status tinywot_cbor_read_bytes(
+  struct tinywot_cbor_reader *self,
+  void const **data,
+  size_t *data_size_byte
+) {
+  struct tinywot_cbor_item item;
+  enum tinywot_status status
+    = tinywot_cbor_read_typed(self, &item, TINYWOT_CBOR_TYPE_BYTES);
+
+  if (status == TINYWOT_STATUS_SUCCESS) {
+    *data = item.content;
+    *data_size_byte = (size_t)item.argument;
+  }
+
+  return status;
+}
+
+enum tinywot_status tinywot_cbor_read_string(
+  struct tinywot_cbor_reader *self,
+  char const **str,
+  size_t *str_length_byte
+) {
+  struct tinywot_cbor_item item;
+  enum tinywot_status status
+    = tinywot_cbor_read_typed(self, &item, TINYWOT_CBOR_TYPE_TEXT);
+
+  if (status == TINYWOT_STATUS_SUCCESS) {
+    *str = item.content;
+    *str_length_byte = (size_t)item.argument;
+  }
+
+  return status;
+}
+
+enum tinywot_status tinywot_cbor_read_array_begin(
+  struct tinywot_cbor_reader *self, size_t *items_count_n
+) {
+  struct tinywot_cbor_item item;
+  enum tinywot_status status
+    = tinywot_cbor_read_typed(self, &item, TINYWOT_CBOR_TYPE_ARRAY);
+
+  if (status == TINYWOT_STATUS_SUCCESS) {
+    *items_count_n = (size_t)item.argument;
+  }
+
+  return status;
+}
+
+enum tinywot_status tinywot_cbor_read_map_begin(
+  struct tinywot_cbor_reader *self, size_t *pairs_count_n
+) {
+  struct tinywot_cbor_item item;
+  enum tinywot_status status
+    = tinywot_cbor_read_typed(self, &item, TINYWOT_CBOR_TYPE_MAP);
+
+  if (status == TINYWOT_STATUS_SUCCESS) {
+    *pairs_count_n = (size_t)item.argument;
+  }
+
+  return status;
+}
+
+enum tinywot_status tinywot_cbor_read_null(struct tinywot_cbor_reader *self) {
+  struct tinywot_cbor_item item;
+
+  return tinywot_cbor_read_typed(self, &item, TINYWOT_CBOR_TYPE_NULL);
+}
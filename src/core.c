@@ -10,6 +10,7 @@
 
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 #include <string.h>
 
 #include <tinywot/core.h>
@@ -32,18 +33,176 @@ enum tinywot_response_status tinywot_response_status_from_tinywot_status(
       return TINYWOT_RESPONSE_STATUS_NOT_SUPPORTED;
 
     case TINYWOT_STATUS_SUCCESS:
+    case TINYWOT_STATUS_NOT_FINISHED:
       return TINYWOT_RESPONSE_STATUS_OK;
 
+    case TINYWOT_STATUS_NOT_MODIFIED:
+      return TINYWOT_RESPONSE_STATUS_NOT_MODIFIED;
+
+    case TINYWOT_STATUS_PENDING:
+      return TINYWOT_RESPONSE_STATUS_PENDING;
+
+    case TINYWOT_STATUS_ERROR_VERSION_MISMATCH:
+      return TINYWOT_RESPONSE_STATUS_PRECONDITION_FAILED;
+
     default:
       return TINYWOT_RESPONSE_STATUS_INTERNAL_ERROR;
   }
 }
 
+void tinywot_payload_init_segments(
+  struct tinywot_payload *self, void *memory, size_t memory_size_byte
+) {
+  self->content_length_byte = 0;
+  self->segments = (struct tinywot_payload_segment *)memory;
+  self->segments_count_n = 0;
+  self->segments_max_n
+    = memory_size_byte / sizeof(struct tinywot_payload_segment);
+}
+
+/*
+  Return the number of bytes in tinywot_payload::content used by a
+  scatter-gather payload. Data is copied into content in order, so this
+  is the end of the last segment of OWNERSHIP_CONTENT.
+*/
+static size_t tinywot_payload_content_used_byte(
+  struct tinywot_payload const *self
+) {
+  for (size_t i = self->segments_count_n; i > 0; i--) {
+    struct tinywot_payload_segment const *seg = &self->segments[i - 1];
+
+    if (seg->ownership == TINYWOT_PAYLOAD_SEGMENT_OWNERSHIP_CONTENT) {
+      return (size_t)((unsigned char const *)seg->content
+                      - (unsigned char const *)self->content)
+             + seg->content_length_byte;
+    }
+  }
+
+  return 0;
+}
+
+enum tinywot_status tinywot_payload_append_segment(
+  struct tinywot_payload *self,
+  void const *data,
+  size_t data_size_byte,
+  enum tinywot_payload_segment_ownership ownership
+) {
+  struct tinywot_payload_segment *last = NULL;
+  unsigned char *tail = NULL;
+
+  if (!self->segments) {
+    return TINYWOT_STATUS_ERROR_NOT_ALLOWED;
+  }
+
+  if (self->segments_count_n > 0) {
+    last = &self->segments[self->segments_count_n - 1];
+  }
+
+  if (ownership == TINYWOT_PAYLOAD_SEGMENT_OWNERSHIP_CONTENT) {
+    size_t used_byte = tinywot_payload_content_used_byte(self);
+
+    if (used_byte + data_size_byte > self->content_buffer_size_byte) {
+      return TINYWOT_STATUS_ERROR_NOT_ENOUGH_MEMORY;
+    }
+
+    tail = (unsigned char *)(self->content) + used_byte;
+  }
+
+  /* Data right after the last segment of the same ownership extends it,
+     so consecutive copies use only one segment. */
+  if (last && last->ownership == ownership
+      && (unsigned char const *)last->content + last->content_length_byte
+           == (tail ? tail : (unsigned char const *)data)) {
+    last->content_length_byte += data_size_byte;
+  } else {
+    if (self->segments_count_n >= self->segments_max_n) {
+      return TINYWOT_STATUS_ERROR_NOT_ENOUGH_MEMORY;
+    }
+
+    last = &self->segments[self->segments_count_n];
+    last->content = tail ? tail : data;
+    last->content_length_byte = data_size_byte;
+    last->ownership = ownership;
+    self->segments_count_n += 1;
+  }
+
+  if (tail && data_size_byte > 0) {
+    memcpy(tail, data, data_size_byte);
+  }
+
+  self->content_length_byte += data_size_byte;
+
+  return TINYWOT_STATUS_SUCCESS;
+}
+
+enum tinywot_status tinywot_payload_gather(
+  struct tinywot_payload const *self, void *buffer, size_t buffer_size_byte
+) {
+  unsigned char *tail = (unsigned char *)buffer;
+
+  if (self->content_length_byte > buffer_size_byte) {
+    return TINYWOT_STATUS_ERROR_NOT_ENOUGH_MEMORY;
+  }
+
+  if (!self->segments) {
+    if (self->content_length_byte > 0) {
+      memcpy(buffer, self->content, self->content_length_byte);
+    }
+
+    return TINYWOT_STATUS_SUCCESS;
+  }
+
+  for (size_t i = 0; i < self->segments_count_n; i++) {
+    struct tinywot_payload_segment const *seg = &self->segments[i];
+
+    if (seg->content_length_byte > 0) {
+      memcpy(tail, seg->content, seg->content_length_byte);
+      tail += seg->content_length_byte;
+    }
+  }
+
+  return TINYWOT_STATUS_SUCCESS;
+}
+
+void tinywot_payload_mark(
+  struct tinywot_payload const *self, struct tinywot_payload_mark *mark
+) {
+  mark->content_length_byte = self->content_length_byte;
+  mark->segments_count_n = self->segments_count_n;
+  mark->last_segment_length_byte = 0;
+
+  if (self->segments && self->segments_count_n > 0) {
+    mark->last_segment_length_byte
+      = self->segments[self->segments_count_n - 1].content_length_byte;
+  }
+}
+
+void tinywot_payload_rollback(
+  struct tinywot_payload *self, struct tinywot_payload_mark const *mark
+) {
+  self->content_length_byte = mark->content_length_byte;
+
+  if (self->segments) {
+    self->segments_count_n = mark->segments_count_n;
+
+    if (self->segments_count_n > 0) {
+      self->segments[self->segments_count_n - 1].content_length_byte
+        = mark->last_segment_length_byte;
+    }
+  }
+}
+
 enum tinywot_status tinywot_payload_append(
   struct tinywot_payload *self,
   void const *data,
   size_t data_size_byte
 ) {
+  if (self->segments) {
+    return tinywot_payload_append_segment(
+      self, data, data_size_byte, TINYWOT_PAYLOAD_SEGMENT_OWNERSHIP_CONTENT
+    );
+  }
+
   unsigned char *head = (unsigned char *)(self->content);
   unsigned char *tail = head + self->content_length_byte;
 
@@ -62,6 +221,12 @@ enum tinywot_status tinywot_payload_append_string(
   struct tinywot_payload *self,
   char const *str
 ) {
+  if (self->segments) {
+    return tinywot_payload_append_segment(
+      self, str, strlen(str), TINYWOT_PAYLOAD_SEGMENT_OWNERSHIP_CONTENT
+    );
+  }
+
   unsigned char *head = (unsigned char *)(self->content);
   unsigned char *tail = head + self->content_length_byte;
 
@@ -92,169 +257,3492 @@ enum tinywot_status tinywot_payload_append_string(
   return TINYWOT_STATUS_SUCCESS;
 }
 
-void tinywot_thing_init_static(
-  struct tinywot_thing *self,
-  struct tinywot_form const *forms,
-  size_t forms_size_byte
+struct tinywot_request *tinywot_request_of_payload(
+  struct tinywot_payload *payload
 ) {
-  self->forms = (struct tinywot_form *)forms;
-  self->forms_count_n = forms_size_byte / sizeof(struct tinywot_form);
-  self->forms_max_n = 0;
+  /* tinywot_request::payload is the first member, so a pointer to it is
+     also a pointer to the containing tinywot_request (C99 6.7.2.1). */
+  return (struct tinywot_request *)payload;
 }
 
-void tinywot_thing_init_dynamic(
-  struct tinywot_thing *self, void *memory, size_t memory_size_byte
+char const *tinywot_request_get_target(
+  struct tinywot_request const *self, size_t *target_length_byte
 ) {
-  self->forms = (struct tinywot_form *)memory;
-  self->forms_count_n = 0;
-  self->forms_max_n = memory_size_byte / sizeof(struct tinywot_form);
+  if (self->target_view) {
+    *target_length_byte = self->target_view_length_byte;
+    return self->target_view;
+  }
+
+#if TINYWOT_REQUEST_TARGET_BUFFER_SIZE_BYTE > 0
+  *target_length_byte = strlen(self->target);
+  return self->target;
+#else
+  *target_length_byte = 0;
+  return NULL;
+#endif
 }
 
-enum tinywot_status tinywot_thing_init_dynamic_from_static(
-  struct tinywot_thing *self,
-  void *memory,
-  size_t memory_size_byte,
-  struct tinywot_form const *forms,
-  size_t forms_size_byte
+enum tinywot_request_fragment tinywot_request_get_fragment(
+  struct tinywot_request const *self
 ) {
-  if (forms_size_byte > memory_size_byte) {
+#ifdef TINYWOT_ENABLE_REQUEST_FRAGMENTS
+  return self->fragment;
+#else
+  (void)self;
+  return TINYWOT_REQUEST_FRAGMENT_NONE;
+#endif
+}
+
+unsigned char const *tinywot_request_get_origin(
+  struct tinywot_request const *self, size_t *origin_length_byte
+) {
+#ifdef TINYWOT_ENABLE_REQUEST_ORIGIN
+  *origin_length_byte = self->origin ? self->origin_length_byte : 0;
+  return self->origin;
+#else
+  (void)self;
+  *origin_length_byte = 0;
+  return NULL;
+#endif
+}
+
+uint_least32_t tinywot_request_get_etag(struct tinywot_request const *self) {
+#ifdef TINYWOT_ENABLE_REQUEST_ETAG
+  return self->etag;
+#else
+  (void)self;
+  return 0;
+#endif
+}
+
+struct tinywot_response *tinywot_response_of_payload(
+  struct tinywot_payload *payload
+) {
+  /* tinywot_response::payload is the first member too. */
+  return (struct tinywot_response *)payload;
+}
+
+/* Any basic type has an alignment dividing the size of this. */
+union tinywot_arena_align {
+  long l;
+  double d;
+  long double ld;
+  void *p;
+  void (*f)(void);
+};
+
+void tinywot_arena_init(
+  struct tinywot_arena *self, void *memory, size_t memory_size_byte
+) {
+  self->memory = (unsigned char *)memory;
+  self->memory_size_byte = memory_size_byte;
+  self->used_byte = 0;
+}
+
+/* Return the number of bytes to skip from the used end of self, so that
+   the next allocation is aligned. */
+static size_t tinywot_arena_padding_byte(struct tinywot_arena const *self) {
+  size_t align_byte = sizeof(union tinywot_arena_align);
+  size_t misalign_byte =
+    (size_t)((uintptr_t)(self->memory + self->used_byte) % align_byte);
+
+  return misalign_byte == 0 ? 0 : align_byte - misalign_byte;
+}
+
+void *tinywot_arena_alloc(struct tinywot_arena *self, size_t size_byte) {
+  size_t padding_byte = tinywot_arena_padding_byte(self);
+  void *ptr = NULL;
+
+  if (size_byte > tinywot_arena_remaining_byte(self)) {
+    return NULL;
+  }
+
+  ptr = self->memory + self->used_byte + padding_byte;
+  self->used_byte += padding_byte + size_byte;
+
+  return ptr;
+}
+
+size_t tinywot_arena_remaining_byte(struct tinywot_arena const *self) {
+  size_t padding_byte = tinywot_arena_padding_byte(self);
+  size_t left_byte = self->memory_size_byte - self->used_byte;
+
+  return left_byte > padding_byte ? left_byte - padding_byte : 0;
+}
+
+void tinywot_arena_reset(struct tinywot_arena *self) {
+  self->used_byte = 0;
+}
+
+enum tinywot_status tinywot_response_alloc_content(
+  struct tinywot_response *self, size_t size_byte
+) {
+  void *content = NULL;
+
+  if (!self->arena) {
     return TINYWOT_STATUS_ERROR_NOT_ENOUGH_MEMORY;
   }
 
-  memcpy(memory, forms, forms_size_byte);
+  if (size_byte == 0) {
+    size_byte = tinywot_arena_remaining_byte(self->arena);
+  }
 
-  self->forms = (struct tinywot_form *)memory;
-  self->forms_count_n = forms_size_byte / sizeof(struct tinywot_form);
-  self->forms_max_n = memory_size_byte / sizeof(struct tinywot_form);
+  content = tinywot_arena_alloc(self->arena, size_byte);
+
+  if (!content || size_byte == 0) {
+    return TINYWOT_STATUS_ERROR_NOT_ENOUGH_MEMORY;
+  }
+
+  self->payload.content = content;
+  self->payload.content_buffer_size_byte = size_byte;
+  self->payload.content_length_byte = 0;
 
   return TINYWOT_STATUS_SUCCESS;
 }
 
-enum tinywot_status tinywot_thing_find_form(
-  struct tinywot_thing const *self,
-  struct tinywot_form **form,
-  char const *target,
-  enum tinywot_operation_type op
+void tinywot_response_next_block(struct tinywot_response *self) {
+  self->offset_byte += self->payload.content_length_byte;
+  self->payload.content_length_byte = 0;
+  self->payload.segments_count_n = 0;
+}
+
+void tinywot_response_complete(
+  struct tinywot_response *self, enum tinywot_status status
 ) {
-  enum tinywot_status status = TINYWOT_STATUS_ERROR_NOT_FOUND;
+  self->status = tinywot_response_status_from_tinywot_status(status);
 
-  /* When count is 0, there is no form added yet, so the status must be
-     NOT_FOUND. */
-  if (self->forms_count_n == 0) {
-    return TINYWOT_STATUS_ERROR_NOT_FOUND;
+  if (self->on_complete) {
+    self->on_complete(self, self->on_complete_context);
   }
+}
 
-  /* Search from the end of self->forms. This allows dynamic override;
-     forms added later would be found first, and thus would have a
-     higher priority.
+enum tinywot_status tinywot_router_init(
+  struct tinywot_router *self, void *memory, size_t memory_size_byte
+) {
+  size_t nodes_max_n = memory_size_byte / sizeof(struct tinywot_router_node);
 
-     When self->forms_count_n cannot be 0, we can always subtract 1 from
-     it. Note that i is an unsigned value, so a condition like i >= 0 is
-     always true to the compiler. To properly terminate the loop, we
-     write i != 0 as the loop continuing condition, which is equivalent
-     to i > 0. Inside the loop, we subtract 1 to obtain the array index.
-     */
-  for (size_t i = self->forms_count_n; i != 0; --i) {
-    struct tinywot_form *form_i = &self->forms[i - 1];
+  if (nodes_max_n == 0) {
+    return TINYWOT_STATUS_ERROR_NOT_ENOUGH_MEMORY;
+  }
 
-    if (strcmp(form_i->target, target) == 0) {
-      if (form_i->op == op) {
-        /* Both target and op matches. */
-        *form = form_i;
-        status = TINYWOT_STATUS_SUCCESS;
+  self->nodes = (struct tinywot_router_node *)memory;
+  self->nodes_count_n = 1;
+  self->nodes_max_n = nodes_max_n;
 
-        break;
-      } else {
-        /* Only target matches. However, there could be another separate
-           handler for the specified target and op in the front of the
-           list. We just skip this one now to continue searching, but
-           set the correct status in case there is no more. */
-        status = TINYWOT_STATUS_ERROR_NOT_ALLOWED;
+  self->nodes[0].segment = NULL;
+  self->nodes[0].segment_length_byte = 0;
+  self->nodes[0].pattern = NULL;
+  self->nodes[0].child = NULL;
+  self->nodes[0].sibling = NULL;
 
-        /* continue; */
-      }
-    } else {
-      /* Continue searching if the target does not match. */
-      /* continue; */
-    }
+  return TINYWOT_STATUS_SUCCESS;
+}
+
+/* Get the length of the segment starting at str, i.e. the number of
+   characters before the next slash or NUL, or the end of str after
+   str_length_byte characters. */
+static size_t tinywot_router_segment_length(
+  char const *str, size_t str_length_byte
+) {
+  size_t len = 0;
+
+  while (len < str_length_byte && str[len] != '\0' && str[len] != '/') {
+    len += 1;
   }
 
-  return status;
+  return len;
 }
 
-enum tinywot_status tinywot_thing_add_form(
-  struct tinywot_thing *self, struct tinywot_form const *form
+/* Find the node where pattern ends, adding the missing nodes on the way
+   if create is true. */
+static enum tinywot_status tinywot_router_walk(
+  struct tinywot_router *self,
+  char const *pattern,
+  bool create,
+  struct tinywot_router_node **found
 ) {
-  if (self->forms_count_n + 1 > self->forms_max_n) {
-    return TINYWOT_STATUS_ERROR_NOT_ENOUGH_MEMORY;
+  struct tinywot_router_node *node = &self->nodes[0];
+  char const *seg = pattern;
+  size_t depth = 1;
+
+  /* A leading slash separates nothing. */
+  if (*seg == '/') {
+    seg += 1;
   }
 
-  /* XXX: this also copies the padding of the supplied tinywot_form,
-     which contains undefined content. */
-  memcpy(&self->forms[self->forms_count_n], form, sizeof(struct tinywot_form));
-  self->forms_count_n += 1;
+  /* The matching has a level for each segment. */
+  for (char const *p = seg; *p != '\0'; p++) {
+    if (*p == '/') {
+      depth += 1;
+    }
+  }
+
+  if (depth > TINYWOT_ROUTER_DEPTH_MAX_N) {
+    return TINYWOT_STATUS_ERROR_NOT_ALLOWED;
+  }
+
+  /* A target with only a slash, or nothing at all, ends at the root. */
+  if (*seg != '\0') {
+    for (;;) {
+      size_t seg_len = tinywot_router_segment_length(seg, SIZE_MAX);
+      struct tinywot_router_node *child = node->child;
+
+      while (child) {
+        if (child->segment_length_byte == seg_len
+            && memcmp(child->segment, seg, seg_len) == 0) {
+          break;
+        }
+
+        child = child->sibling;
+      }
+
+      if (!child && !create) {
+        return TINYWOT_STATUS_ERROR_NOT_FOUND;
+      }
+
+      if (!child) {
+        if (self->nodes_count_n + 1 > self->nodes_max_n) {
+          return TINYWOT_STATUS_ERROR_NOT_ENOUGH_MEMORY;
+        }
+
+        child = &self->nodes[self->nodes_count_n];
+        self->nodes_count_n += 1;
+
+        child->segment = seg;
+        child->segment_length_byte = seg_len;
+        child->pattern = NULL;
+        child->child = NULL;
+        child->sibling = node->child;
+        node->child = child;
+      }
+
+      node = child;
+      seg += seg_len;
+
+      if (*seg == '\0') {
+        break;
+      }
+
+      /* Skip the slash. An empty segment may follow it. */
+      seg += 1;
+    }
+  }
+
+  *found = node;
 
   return TINYWOT_STATUS_SUCCESS;
 }
 
-enum tinywot_status tinywot_thing_change_form(
-  struct tinywot_thing *self,
-  char const *target,
-  enum tinywot_operation_type op,
-  struct tinywot_form const *form
+enum tinywot_status tinywot_router_insert(
+  struct tinywot_router *self, char const *pattern
 ) {
-  enum tinywot_status status = TINYWOT_STATUS_ERROR_GENERIC;
-  struct tinywot_form *form_old = NULL;
+  struct tinywot_router_node *node = NULL;
+  enum tinywot_status status =
+    tinywot_router_walk(self, pattern, true, &node);
 
-  status = tinywot_thing_find_form(self, &form_old, target, op);
-  if (status != TINYWOT_STATUS_SUCCESS) {
-    return status;
+  if (status == TINYWOT_STATUS_SUCCESS) {
+    node->pattern = pattern;
+  }
+
+  return status;
+}
+
+enum tinywot_status tinywot_router_remove(
+  struct tinywot_router *self, char const *pattern
+) {
+  struct tinywot_router_node *node = NULL;
+  enum tinywot_status status =
+    tinywot_router_walk(self, pattern, false, &node);
+
+  if (status != TINYWOT_STATUS_SUCCESS || !node->pattern) {
+    return TINYWOT_STATUS_ERROR_NOT_FOUND;
   }
 
-  /* XXX: this also copies the padding of the supplied tinywot_form,
-     which contains undefined content. */
-  memcpy(form_old, form, sizeof(struct tinywot_form));
+  /* The nodes stay, to be reused if the pattern is inserted again. */
+  node->pattern = NULL;
 
   return TINYWOT_STATUS_SUCCESS;
 }
 
-enum tinywot_status tinywot_thing_remove_form(
-  struct tinywot_thing *self,
-  char const *target,
-  enum tinywot_operation_type op
+/* The kinds of segments in a form target, ordered by priority. */
+enum tinywot_router_segment_kind {
+  TINYWOT_ROUTER_SEGMENT_KIND_LITERAL = 0,
+  TINYWOT_ROUTER_SEGMENT_KIND_PARAM,
+  TINYWOT_ROUTER_SEGMENT_KIND_REST,
+};
+
+static enum tinywot_router_segment_kind tinywot_router_node_kind(
+  struct tinywot_router_node const *node
 ) {
-  /* not implemented yet */
-  (void)self;
-  (void)target;
-  (void)op;
+  if (node->segment_length_byte == 1 && node->segment[0] == '*') {
+    return TINYWOT_ROUTER_SEGMENT_KIND_REST;
+  }
 
-  return TINYWOT_STATUS_ERROR_NOT_IMPLEMENTED;
+  if (node->segment_length_byte >= 2
+      && node->segment[0] == '{'
+      && node->segment[node->segment_length_byte - 1] == '}') {
+    return TINYWOT_ROUTER_SEGMENT_KIND_PARAM;
+  }
+
+  return TINYWOT_ROUTER_SEGMENT_KIND_LITERAL;
 }
 
-enum tinywot_status tinywot_thing_process_request(
-  struct tinywot_thing const *self,
-  struct tinywot_response *response,
-  struct tinywot_request *request
-) {
-  enum tinywot_status status = TINYWOT_STATUS_ERROR_GENERIC;
-  struct tinywot_form *form = NULL;
+/* Decide whether a matching form target is used, for a lookup that
+   would otherwise shadow a less specific form that can serve it. Return
+   SUCCESS to take pattern, or the reason to try the next one. */
+typedef enum tinywot_status tinywot_router_accept_t(
+  void *context, char const *pattern
+);
 
-  status = tinywot_thing_find_form(self, &form, request->target, request->op);
+/* A level of the backtracking in tinywot_router_match_n(): the children
+   of node are tried against one segment of the requested target. */
+struct tinywot_router_match_frame {
+  struct tinywot_router_node const *node;
+  struct tinywot_router_node const *child;
+  int kind;
+  char const *seg;
+  size_t rest_len;
+  size_t depth;
+};
 
-  /* If a matching form is found, then we further allow it to change the
-     response (if it has been implemented). */
-  if (status == TINYWOT_STATUS_SUCCESS) {
-    status = form->handler ?
-      form->handler(&response->payload, &request->payload, form->context) :
-      TINYWOT_STATUS_ERROR_NOT_IMPLEMENTED;
+static void tinywot_router_match_capture(
+  struct tinywot_target_param *params,
+  size_t params_max_n,
+  size_t depth,
+  char const *value,
+  size_t value_length_byte
+) {
+  if (depth < params_max_n) {
+    params[depth].value = value;
+    params[depth].value_length_byte = value_length_byte;
   }
+}
 
-  /* Convert the (TinyWoT) status to a response status, which comes from
-     either tinywot_thing_find_form(), form->handler(), or ourselves
-     (NOT_IMPLEMENTED). */
-  response->status = tinywot_response_status_from_tinywot_status(status);
+/* Move frame to its next child of the current kind, or to the first
+   child of the next kind. Returns false when all children have been
+   tried. */
+static bool tinywot_router_match_advance(
+  struct tinywot_router_match_frame *frame
+) {
+  for (;;) {
+    struct tinywot_router_node const *child =
+      frame->child ? frame->child->sibling : frame->node->child;
+
+    if (!child) {
+      if (frame->kind == TINYWOT_ROUTER_SEGMENT_KIND_REST) {
+        return false;
+      }
+
+      frame->kind += 1;
+      frame->child = NULL;
+
+      continue;
+    }
+
+    frame->child = child;
+
+    if ((int)tinywot_router_node_kind(child) == frame->kind) {
+      return true;
+    }
+  }
+}
+
+/* Take pattern if accept agrees, otherwise remember why not. */
+static bool tinywot_router_match_accept(
+  char const *pattern,
+  tinywot_router_accept_t *accept,
+  void *accept_context,
+  enum tinywot_status *status
+) {
+  enum tinywot_status accepted = TINYWOT_STATUS_SUCCESS;
+
+  if (!pattern) {
+    return false;
+  }
+
+  if (accept) {
+    accepted = accept(accept_context, pattern);
+  }
+
+  /* A form on the target with another op is a better reason to give
+     than no form at all. */
+  if (accepted == TINYWOT_STATUS_ERROR_NOT_ALLOWED) {
+    *status = accepted;
+  }
+
+  return accepted == TINYWOT_STATUS_SUCCESS;
+}
+
+/* Match a requested target of a known length; see
+   tinywot_router_match(). If accept is not NULL, matching form targets
+   it refuses are skipped, as if they were not in the router.
+
+   The backtracking keeps its levels in an array instead of recursing,
+   so the stack used is bounded by TINYWOT_ROUTER_DEPTH_MAX_N, which
+   tinywot_router_insert() enforces for form targets. */
+static enum tinywot_status tinywot_router_match_n(
+  struct tinywot_router const *self,
+  char const *target,
+  size_t target_length_byte,
+  tinywot_router_accept_t *accept,
+  void *accept_context,
+  char const **pattern,
+  struct tinywot_target_param *params,
+  size_t params_max_n,
+  size_t *params_count_n
+) {
+  struct tinywot_router_match_frame frames[TINYWOT_ROUTER_DEPTH_MAX_N];
+  enum tinywot_status status = TINYWOT_STATUS_ERROR_NOT_FOUND;
+  char const *seg = target;
+  size_t rest_len = target_length_byte;
+  size_t level = 0;
+  size_t found_params_n = 0;
+  char const *found = NULL;
+  bool walking = false;
+
+  if (rest_len > 0 && *seg == '/') {
+    seg += 1;
+    rest_len -= 1;
+  }
+
+  if (rest_len == 0 || *seg == '\0') {
+    /* The requested target is "/" or empty, which ends at the root. */
+    if (tinywot_router_match_accept(
+      self->nodes[0].pattern, accept, accept_context, &status
+    )) {
+      found = self->nodes[0].pattern;
+    }
+  } else {
+    frames[0].node = &self->nodes[0];
+    frames[0].child = NULL;
+    frames[0].kind = TINYWOT_ROUTER_SEGMENT_KIND_LITERAL;
+    frames[0].seg = seg;
+    frames[0].rest_len = rest_len;
+    frames[0].depth = 0;
+    walking = true;
+  }
+
+  /* Try every kind of children in the order of priority. If a child
+     matches the segment but nothing matches further down, we back off
+     and try the next one. */
+  while (walking && !found) {
+    struct tinywot_router_match_frame *frame = &frames[level];
+    struct tinywot_router_node const *child = NULL;
+    size_t seg_len =
+      tinywot_router_segment_length(frame->seg, frame->rest_len);
+    bool last = seg_len == frame->rest_len || frame->seg[seg_len] == '\0';
+    size_t depth = frame->depth;
+
+    if (!tinywot_router_match_advance(frame)) {
+      if (level == 0) {
+        walking = false;
+      } else {
+        level -= 1;
+      }
+
+      continue;
+    }
+
+    child = frame->child;
+
+    if (frame->kind == TINYWOT_ROUTER_SEGMENT_KIND_REST) {
+      if (tinywot_router_match_accept(
+        child->pattern, accept, accept_context, &status
+      )) {
+        tinywot_router_match_capture(
+          params, params_max_n, depth, frame->seg, frame->rest_len
+        );
+        found = child->pattern;
+        found_params_n = depth + 1;
+      }
+
+      continue;
+    }
+
+    if (frame->kind == TINYWOT_ROUTER_SEGMENT_KIND_LITERAL
+        && (child->segment_length_byte != seg_len
+            || memcmp(child->segment, frame->seg, seg_len) != 0)) {
+      continue;
+    }
+
+    if (frame->kind == TINYWOT_ROUTER_SEGMENT_KIND_PARAM) {
+      tinywot_router_match_capture(
+        params, params_max_n, depth, frame->seg, seg_len
+      );
+      depth += 1;
+    }
+
+    if (last) {
+      if (tinywot_router_match_accept(
+        child->pattern, accept, accept_context, &status
+      )) {
+        found = child->pattern;
+        found_params_n = depth;
+      }
+    } else if (child->child && level + 1 < TINYWOT_ROUTER_DEPTH_MAX_N) {
+      struct tinywot_router_match_frame *next = &frames[level + 1];
+
+      next->node = child;
+      next->child = NULL;
+      next->kind = TINYWOT_ROUTER_SEGMENT_KIND_LITERAL;
+      next->seg = frame->seg + seg_len + 1;
+      next->rest_len = frame->rest_len - seg_len - 1;
+      next->depth = depth;
+      level += 1;
+    }
+  }
+
+  if (!found) {
+    return status;
+  }
+
+  *pattern = found;
+
+  if (params_count_n) {
+    *params_count_n =
+      found_params_n < params_max_n ? found_params_n : params_max_n;
+  }
+
+  return TINYWOT_STATUS_SUCCESS;
+}
+
+enum tinywot_status tinywot_router_match(
+  struct tinywot_router const *self,
+  char const *target,
+  char const **pattern,
+  struct tinywot_target_param *params,
+  size_t params_max_n,
+  size_t *params_count_n
+) {
+  return tinywot_router_match_n(
+    self, target, strlen(target), NULL, NULL, pattern, params, params_max_n,
+    params_count_n
+  );
+}
+
+void tinywot_form_cache_init(
+  struct tinywot_form_cache *self,
+  tinywot_form_handler_t *handler,
+  void *context,
+  void *memory,
+  size_t memory_size_byte
+) {
+  self->handler = handler;
+  self->context = context;
+  self->content = memory;
+  self->content_buffer_size_byte = memory_size_byte;
+  self->content_length_byte = 0;
+  self->content_type = 0;
+  self->version = 1;
+  self->cached_version = 0;
+}
+
+void tinywot_form_cache_invalidate(struct tinywot_form_cache *self) {
+  self->version += 1;
+
+  /* 0 means nothing has been cached. */
+  if (self->version == 0) {
+    self->version = 1;
+  }
+}
+
+/* Call the wrapped handler of self, and cache its response. */
+static enum tinywot_status tinywot_form_cache_refresh(
+  struct tinywot_form_cache *self,
+  struct tinywot_response const *response,
+  struct tinywot_payload *request_payload
+) {
+  enum tinywot_status status = TINYWOT_STATUS_ERROR_GENERIC;
+  struct tinywot_response inner = {0};
+
+  inner.payload.content = self->content;
+  inner.payload.content_buffer_size_byte = self->content_buffer_size_byte;
+  inner.arena = response->arena;
+
+  status = self->handler ?
+    self->handler(&inner.payload, request_payload, self->context) :
+    TINYWOT_STATUS_ERROR_NOT_IMPLEMENTED;
+
+  if (status == TINYWOT_STATUS_NOT_FINISHED) {
+    return TINYWOT_STATUS_ERROR_NOT_IMPLEMENTED;
+  }
+
+  if (status != TINYWOT_STATUS_SUCCESS) {
+    return status;
+  }
+
+  /* The handler may have pointed content to its own memory. */
+  if (inner.payload.content != self->content) {
+    if (inner.payload.content_length_byte > self->content_buffer_size_byte) {
+      return TINYWOT_STATUS_ERROR_NOT_ENOUGH_MEMORY;
+    }
+
+    if (inner.payload.content_length_byte > 0) {
+      memcpy(
+        self->content,
+        inner.payload.content,
+        inner.payload.content_length_byte
+      );
+    }
+  }
+
+  self->content_length_byte = inner.payload.content_length_byte;
+  self->content_type = inner.payload.content_type;
+  self->cached_version = self->version;
+
+  return TINYWOT_STATUS_SUCCESS;
+}
+
+enum tinywot_status tinywot_form_cache_handler(
+  struct tinywot_payload *response_payload,
+  struct tinywot_payload *request_payload,
+  void *context
+) {
+  struct tinywot_form_cache *self = (struct tinywot_form_cache *)context;
+  struct tinywot_response *response =
+    tinywot_response_of_payload(response_payload);
+  struct tinywot_request *request =
+    tinywot_request_of_payload(request_payload);
+  enum tinywot_status status = TINYWOT_STATUS_ERROR_GENERIC;
+
+  if (self->cached_version != self->version) {
+    status = tinywot_form_cache_refresh(self, response, request_payload);
+
+    if (status != TINYWOT_STATUS_SUCCESS) {
+      return status;
+    }
+  }
+
+  response->etag = self->cached_version;
+  response_payload->content_type = self->content_type;
+
+  if (tinywot_request_get_etag(request) == self->cached_version) {
+    response_payload->content_length_byte = 0;
+    return TINYWOT_STATUS_NOT_MODIFIED;
+  }
+
+  if (response_payload->content_buffer_size_byte == 0) {
+    response_payload->content = self->content;
+  } else if (response_payload->content_buffer_size_byte
+             >= self->content_length_byte) {
+    if (self->content_length_byte > 0) {
+      memcpy(
+        response_payload->content, self->content, self->content_length_byte
+      );
+    }
+  } else {
+    return TINYWOT_STATUS_ERROR_NOT_ENOUGH_MEMORY;
+  }
+
+  response_payload->content_length_byte = self->content_length_byte;
+
+  return TINYWOT_STATUS_SUCCESS;
+}
+
+uint_least32_t tinywot_target_hash_n(
+  char const *target, size_t target_length_byte
+) {
+  /* 32-bit FNV-1a. uint_least32_t can be wider than 32 bits, so the
+     result is truncated after each multiplication. */
+  uint_least32_t hash = 0x811c9dc5UL;
+
+  for (size_t i = 0; i < target_length_byte; i++) {
+    hash ^= (unsigned char)target[i];
+    hash = (hash * 0x01000193UL) & 0xffffffffUL;
+  }
+
+  return hash;
+}
+
+uint_least32_t tinywot_target_hash(char const *target) {
+  return tinywot_target_hash_n(target, strlen(target));
+}
+
+/* Compare the NUL-terminated string str against target_length_byte
+   characters of target, in strcmp() style. str is never read past its
+   NUL, and target is never read past its length. */
+static int tinywot_target_compare_n(
+  char const *str, char const *target, size_t target_length_byte
+) {
+  for (size_t i = 0; i < target_length_byte; i++) {
+    unsigned char a = (unsigned char)str[i];
+    unsigned char b = (unsigned char)target[i];
+
+    if (a != b) {
+      return a < b ? -1 : 1;
+    }
+
+    /* Both have a NUL here, but target goes on. */
+    if (a == '\0') {
+      return -1;
+    }
+  }
+
+  return str[target_length_byte] != '\0';
+}
+
+bool tinywot_form_accepts(
+  struct tinywot_form const *self, enum tinywot_operation_type op
+) {
+  if (self->op == TINYWOT_OPERATION_TYPE_UNKNOWN) {
+    return false;
+  }
+
+  return self->op == op || (self->ops & TINYWOT_OPERATION_TYPE_BIT(op)) != 0;
+}
+
+uint_least32_t tinywot_form_hash_table_mix(
+  uint_least32_t hash, uint_least16_t displacement
+) {
+  /* A finalizer in the style of MurmurHash3 over the hash xor-ed with a
+     spread-out displacement, so that every displacement gives a rather
+     different distribution, as the generator relies on. */
+  uint_least32_t x =
+    (hash ^ ((uint_least32_t)displacement * 0x9e3779b1UL)) & 0xffffffffUL;
+
+  x ^= x >> 16;
+  x = (x * 0x85ebca6bUL) & 0xffffffffUL;
+  x ^= x >> 13;
+
+  return x;
+}
+
+/* Reset everything but the forms, for all tinywot_thing_init_*(). */
+static void tinywot_thing_init_extensions(struct tinywot_thing *self) {
+  self->forms_in_flash = false;
+  self->forms_removed_n = 0;
+  self->forms_generation = 0;
+  self->forms_index = NULL;
+  self->forms_index_max_n = 0;
+  self->forms_hash = NULL;
+  self->router = NULL;
+  self->observers = NULL;
+  self->observers_max_n = 0;
+  self->target_registry = NULL;
+  self->target_slots = NULL;
+  self->target_slots_max_n = 0;
+  self->target_slots_next = NULL;
+  self->instrumentation = NULL;
+}
+
+void tinywot_thing_init_static(
+  struct tinywot_thing *self,
+  struct tinywot_form const *forms,
+  size_t forms_size_byte
+) {
+  self->forms = (struct tinywot_form *)forms;
+  self->forms_count_n = forms_size_byte / sizeof(struct tinywot_form);
+  self->forms_max_n = 0;
+  tinywot_thing_init_extensions(self);
+}
+
+void tinywot_thing_init_static_hashed(
+  struct tinywot_thing *self,
+  struct tinywot_form const *forms,
+  size_t forms_size_byte,
+  struct tinywot_form_hash_table const *hash_table
+) {
+  tinywot_thing_init_static(self, forms, forms_size_byte);
+  self->forms_hash = hash_table;
+}
+
+void tinywot_thing_init_static_flash(
+  struct tinywot_thing *self,
+  struct tinywot_form const *forms,
+  size_t forms_size_byte
+) {
+  tinywot_thing_init_static(self, forms, forms_size_byte);
+  self->forms_in_flash = true;
+}
+
+void tinywot_thing_read_form(
+  struct tinywot_thing const *self,
+  struct tinywot_form const *form,
+  struct tinywot_form *copy
+) {
+  if (self->forms_in_flash) {
+    TINYWOT_FLASH_READ(copy, form, sizeof(struct tinywot_form));
+  } else {
+    *copy = *form;
+  }
+}
+
+/* Get the form at position i of self, copied into scratch if it is in
+   program memory. */
+static struct tinywot_form const *tinywot_thing_form_at(
+  struct tinywot_thing const *self, size_t i, struct tinywot_form *scratch
+) {
+  if (self->forms_in_flash) {
+    tinywot_thing_read_form(self, &self->forms[i], scratch);
+    return scratch;
+  }
+
+  return &self->forms[i];
+}
+
+/* Tell whether target_length_byte characters of target are the target
+   of form (from tinywot_thing_form_at()). */
+static bool tinywot_thing_form_target_equals(
+  struct tinywot_thing const *self,
+  struct tinywot_form const *form,
+  char const *target,
+  size_t target_length_byte
+) {
+  if (self->forms_in_flash) {
+    /* The target string itself is in program memory as well. */
+    for (size_t i = 0; i <= target_length_byte; i++) {
+      char c = '\0';
+
+      TINYWOT_FLASH_READ(&c, &form->target[i], 1);
+
+      if (i == target_length_byte) {
+        return c == '\0';
+      }
+
+      if (c == '\0' || c != target[i]) {
+        return false;
+      }
+    }
+  }
+
+  return tinywot_target_compare_n(
+    form->target, target, target_length_byte
+  ) == 0;
+}
+
+void tinywot_thing_init_dynamic(
+  struct tinywot_thing *self, void *memory, size_t memory_size_byte
+) {
+  self->forms = (struct tinywot_form *)memory;
+  self->forms_count_n = 0;
+  self->forms_max_n = memory_size_byte / sizeof(struct tinywot_form);
+  tinywot_thing_init_extensions(self);
+}
+
+enum tinywot_status tinywot_thing_init_dynamic_from_static(
+  struct tinywot_thing *self,
+  void *memory,
+  size_t memory_size_byte,
+  struct tinywot_form const *forms,
+  size_t forms_size_byte
+) {
+  if (forms_size_byte > memory_size_byte) {
+    return TINYWOT_STATUS_ERROR_NOT_ENOUGH_MEMORY;
+  }
+
+  memcpy(memory, forms, forms_size_byte);
+
+  self->forms = (struct tinywot_form *)memory;
+  self->forms_count_n = forms_size_byte / sizeof(struct tinywot_form);
+  self->forms_max_n = memory_size_byte / sizeof(struct tinywot_form);
+  tinywot_thing_init_extensions(self);
+
+  return TINYWOT_STATUS_SUCCESS;
+}
+
+/* Compare the form at position slot_a in self->forms against a (target,
+   position) pair, in the order used by self->forms_index. */
+static int tinywot_thing_index_compare(
+  struct tinywot_thing const *self,
+  size_t slot_a,
+  char const *target_b,
+  size_t target_b_length_byte,
+  size_t slot_b
+) {
+  int diff = tinywot_target_compare_n(
+    self->forms[slot_a].target, target_b, target_b_length_byte
+  );
+
+  if (diff != 0) {
+    return diff;
+  }
+
+  return (slot_a > slot_b) - (slot_a < slot_b);
+}
+
+/* Find the position in the first n elements of self->forms_index where
+   the form at position slot in self->forms, with a target of
+   target_length_byte characters, is, or should be inserted. */
+static size_t tinywot_thing_index_search(
+  struct tinywot_thing const *self,
+  size_t n,
+  char const *target,
+  size_t target_length_byte,
+  size_t slot
+) {
+  size_t lo = 0;
+  size_t hi = n;
+
+  while (lo < hi) {
+    size_t mid = lo + (hi - lo) / 2;
+
+    if (tinywot_thing_index_compare(
+      self, self->forms_index[mid], target, target_length_byte, slot
+    ) < 0) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+
+  return lo;
+}
+
+/* Insert the form at position slot in self->forms into the first n
+   elements of self->forms_index, which must have space for one more. */
+static void tinywot_thing_index_insert(
+  struct tinywot_thing *self, size_t n, size_t slot
+) {
+  char const *target = self->forms[slot].target;
+  size_t pos =
+    tinywot_thing_index_search(self, n, target, strlen(target), slot);
+
+  memmove(
+    &self->forms_index[pos + 1],
+    &self->forms_index[pos],
+    (n - pos) * sizeof(size_t)
+  );
+  self->forms_index[pos] = slot;
+}
+
+/* Remove the form at position slot in self->forms from the first n
+   elements of self->forms_index. */
+static void tinywot_thing_index_erase(
+  struct tinywot_thing *self, size_t n, size_t slot
+) {
+  char const *target = self->forms[slot].target;
+  size_t pos =
+    tinywot_thing_index_search(self, n, target, strlen(target), slot);
+
+  memmove(
+    &self->forms_index[pos],
+    &self->forms_index[pos + 1],
+    (n - pos - 1) * sizeof(size_t)
+  );
+}
+
+enum tinywot_status tinywot_thing_init_index(
+  struct tinywot_thing *self, void *memory, size_t memory_size_byte
+) {
+  size_t index_max_n = memory_size_byte / sizeof(size_t);
+
+  self->forms_index = NULL;
+  self->forms_index_max_n = 0;
+
+  /* The index compares form targets in RAM. */
+  if (self->forms_in_flash) {
+    return TINYWOT_STATUS_ERROR_NOT_ALLOWED;
+  }
+
+  if (index_max_n < self->forms_count_n || index_max_n < self->forms_max_n) {
+    return TINYWOT_STATUS_ERROR_NOT_ENOUGH_MEMORY;
+  }
+
+  self->forms_index = (size_t *)memory;
+  self->forms_index_max_n = index_max_n;
+
+  for (size_t i = 0; i < self->forms_count_n; i++) {
+    tinywot_thing_index_insert(self, i, i);
+  }
+
+  return TINYWOT_STATUS_SUCCESS;
+}
+
+static enum tinywot_status tinywot_thing_find_form_indexed(
+  struct tinywot_thing const *self,
+  struct tinywot_form **form,
+  char const *target,
+  size_t target_length_byte,
+  enum tinywot_operation_type op
+) {
+  enum tinywot_status status = TINYWOT_STATUS_ERROR_NOT_FOUND;
+
+  /* Forms with the same target are placed next to each other in the
+     index, sorted by their positions in self->forms. Find the end of
+     them, then walk backwards, so forms added later are still found
+     first. Searching with the largest possible position lands us right
+     after the last form with the target. */
+  size_t end = tinywot_thing_index_search(
+    self, self->forms_count_n, target, target_length_byte, SIZE_MAX
+  );
+
+  for (size_t i = end; i != 0; --i) {
+    struct tinywot_form *form_i = &self->forms[self->forms_index[i - 1]];
+
+    if (tinywot_target_compare_n(
+      form_i->target, target, target_length_byte
+    ) != 0) {
+      /* We have walked past all forms with the target. */
+      break;
+    }
+
+    /* Removed forms are kept in the index until compaction. */
+    if (form_i->op == TINYWOT_OPERATION_TYPE_UNKNOWN) {
+      continue;
+    }
+
+    if (tinywot_form_accepts(form_i, op)) {
+      *form = form_i;
+      status = TINYWOT_STATUS_SUCCESS;
+
+      break;
+    }
+
+    /* Only target matches; see tinywot_thing_find_form(). */
+    status = TINYWOT_STATUS_ERROR_NOT_ALLOWED;
+  }
+
+  return status;
+}
+
+enum tinywot_status tinywot_thing_init_router(
+  struct tinywot_thing *self, struct tinywot_router *router
+) {
+  enum tinywot_status status = TINYWOT_STATUS_ERROR_GENERIC;
+
+  self->router = NULL;
+
+  /* The router keeps form targets and compares them in RAM. Observers
+     would keep patterns instead of observed targets. */
+  if (self->forms_in_flash || self->observers) {
+    return TINYWOT_STATUS_ERROR_NOT_ALLOWED;
+  }
+
+  for (size_t i = 0; i < self->forms_count_n; i++) {
+    status = tinywot_router_insert(router, self->forms[i].target);
+    if (status != TINYWOT_STATUS_SUCCESS) {
+      return status;
+    }
+  }
+
+  self->router = router;
+
+  return TINYWOT_STATUS_SUCCESS;
+}
+
+static enum tinywot_status tinywot_thing_find_form_hashed(
+  struct tinywot_thing const *self,
+  struct tinywot_form **form,
+  char const *target,
+  size_t target_length_byte,
+  enum tinywot_operation_type op
+) {
+  enum tinywot_status status = TINYWOT_STATUS_ERROR_NOT_FOUND;
+  struct tinywot_form_hash_table const *table = self->forms_hash;
+
+  uint_least32_t hash = tinywot_target_hash_n(target, target_length_byte);
+  uint_least16_t displacement =
+    table->displacements[hash % table->displacements_n];
+  size_t k =
+    tinywot_form_hash_table_mix(hash, displacement) % table->targets_n;
+
+  size_t begin = table->offsets[k];
+  size_t end = table->offsets[k + 1];
+
+  /* A perfect hash function maps any unknown target to some group as
+     well. All forms in a group share the same target, so comparing with
+     the first one tells whether the target is known at all. */
+  if (tinywot_target_compare_n(
+    self->forms[begin].target, target, target_length_byte
+  ) != 0) {
+    return TINYWOT_STATUS_ERROR_NOT_FOUND;
+  }
+
+  /* Forms in a group keep their declaration order, so search from the
+     end as tinywot_thing_find_form() does. */
+  for (size_t i = end; i != begin; --i) {
+    struct tinywot_form *form_i = &self->forms[i - 1];
+
+    if (tinywot_form_accepts(form_i, op)) {
+      *form = form_i;
+      status = TINYWOT_STATUS_SUCCESS;
+
+      break;
+    }
+
+    status = TINYWOT_STATUS_ERROR_NOT_ALLOWED;
+  }
+
+  return status;
+}
+
+static enum tinywot_status tinywot_thing_find_form_uncounted(
+  struct tinywot_thing const *self,
+  struct tinywot_form **form,
+  char const *target,
+  size_t target_length_byte,
+  enum tinywot_operation_type op
+) {
+  enum tinywot_status status = TINYWOT_STATUS_ERROR_NOT_FOUND;
+
+  /* When count is 0, there is no form added yet, so the status must be
+     NOT_FOUND. */
+  if (self->forms_count_n == 0) {
+    return TINYWOT_STATUS_ERROR_NOT_FOUND;
+  }
+
+  if (self->forms_hash) {
+    return tinywot_thing_find_form_hashed(
+      self, form, target, target_length_byte, op
+    );
+  }
+
+  if (self->forms_index) {
+    return tinywot_thing_find_form_indexed(
+      self, form, target, target_length_byte, op
+    );
+  }
+
+  /* Search from the end of self->forms. This allows dynamic override;
+     forms added later would be found first, and thus would have a
+     higher priority.
+
+     When self->forms_count_n cannot be 0, we can always subtract 1 from
+     it. Note that i is an unsigned value, so a condition like i >= 0 is
+     always true to the compiler. To properly terminate the loop, we
+     write i != 0 as the loop continuing condition, which is equivalent
+     to i > 0. Inside the loop, we subtract 1 to obtain the array index.
+     */
+  for (size_t i = self->forms_count_n; i != 0; --i) {
+    struct tinywot_form scratch;
+    struct tinywot_form const *form_i =
+      tinywot_thing_form_at(self, i - 1, &scratch);
+
+    /* Skip removed forms; see tinywot_thing_remove_form(). */
+    if (form_i->op == TINYWOT_OPERATION_TYPE_UNKNOWN) {
+      continue;
+    }
+
+    if (tinywot_thing_form_target_equals(
+      self, form_i, target, target_length_byte
+    )) {
+      if (tinywot_form_accepts(form_i, op)) {
+        /* Both target and op matches. */
+        *form = &self->forms[i - 1];
+        status = TINYWOT_STATUS_SUCCESS;
+
+        break;
+      } else {
+        /* Only target matches. However, there could be another separate
+           handler for the specified target and op in the front of the
+           list. We just skip this one now to continue searching, but
+           set the correct status in case there is no more. */
+        status = TINYWOT_STATUS_ERROR_NOT_ALLOWED;
+
+        /* continue; */
+      }
+    } else {
+      /* Continue searching if the target does not match. */
+      /* continue; */
+    }
+  }
+
+  return status;
+}
+
+#ifdef TINYWOT_ENABLE_INSTRUMENTATION
+/* Count a lookup with its result. */
+static void tinywot_thing_count_lookup(
+  struct tinywot_thing const *self, enum tinywot_status status
+) {
+  struct tinywot_instrumentation *instrumentation = self->instrumentation;
+
+  if (!instrumentation) {
+    return;
+  }
+
+  instrumentation->lookups_n += 1;
+
+  if (status == TINYWOT_STATUS_ERROR_NOT_FOUND) {
+    instrumentation->not_found_n += 1;
+  } else if (status == TINYWOT_STATUS_ERROR_NOT_ALLOWED) {
+    instrumentation->not_allowed_n += 1;
+  }
+}
+#endif
+
+enum tinywot_status tinywot_thing_find_form(
+  struct tinywot_thing const *self,
+  struct tinywot_form **form,
+  char const *target,
+  enum tinywot_operation_type op
+) {
+  return tinywot_thing_find_form_n(self, form, target, strlen(target), op);
+}
+
+enum tinywot_status tinywot_thing_find_form_n(
+  struct tinywot_thing const *self,
+  struct tinywot_form **form,
+  char const *target,
+  size_t target_length_byte,
+  enum tinywot_operation_type op
+) {
+  enum tinywot_status status = tinywot_thing_find_form_uncounted(
+    self, form, target, target_length_byte, op
+  );
+
+#ifdef TINYWOT_ENABLE_INSTRUMENTATION
+  tinywot_thing_count_lookup(self, status);
+#endif
+
+  return status;
+}
+
+/* Get the position plus 1 of the latest form of target_id, or 0 if there
+   is none. */
+static size_t tinywot_thing_target_slot(
+  struct tinywot_thing const *self, tinywot_target_id_t target_id
+) {
+  /* IDs are assigned from 1, so TINYWOT_TARGET_ID_NONE has no slot. */
+  if (!self->target_slots || target_id == TINYWOT_TARGET_ID_NONE
+      || target_id > self->target_slots_max_n) {
+    return 0;
+  }
+
+  return self->target_slots[target_id - 1];
+}
+
+static enum tinywot_status tinywot_thing_find_form_by_id_uncounted(
+  struct tinywot_thing const *self,
+  struct tinywot_form **form,
+  tinywot_target_id_t target_id,
+  enum tinywot_operation_type op
+) {
+  enum tinywot_status status = TINYWOT_STATUS_ERROR_NOT_FOUND;
+
+  /* Forms of the same target are chained from the latest one, so the
+     first one allowing op is the one that tinywot_thing_find_form()
+     would return. */
+  for (size_t slot = tinywot_thing_target_slot(self, target_id); slot != 0;
+       slot = self->target_slots_next[slot - 1]) {
+    struct tinywot_form *form_i = &self->forms[slot - 1];
+
+    if (form_i->op == TINYWOT_OPERATION_TYPE_UNKNOWN) {
+      continue;
+    }
+
+    if (tinywot_form_accepts(form_i, op)) {
+      *form = form_i;
+
+      return TINYWOT_STATUS_SUCCESS;
+    }
+
+    status = TINYWOT_STATUS_ERROR_NOT_ALLOWED;
+  }
+
+  return status;
+}
+
+enum tinywot_status tinywot_thing_find_form_by_id(
+  struct tinywot_thing const *self,
+  struct tinywot_form **form,
+  tinywot_target_id_t target_id,
+  enum tinywot_operation_type op
+) {
+  enum tinywot_status status =
+    tinywot_thing_find_form_by_id_uncounted(self, form, target_id, op);
+
+#ifdef TINYWOT_ENABLE_INSTRUMENTATION
+  tinywot_thing_count_lookup(self, status);
+#endif
+
+  return status;
+}
+
+/* Whether form may be registered. tinywot_thing_remove_form() promotes
+   an op from tinywot_form::ops, which must not leave an uncounted
+   removed form behind. */
+static bool tinywot_form_is_valid(struct tinywot_form const *form) {
+  uint_least32_t unknown =
+    TINYWOT_OPERATION_TYPE_BIT(TINYWOT_OPERATION_TYPE_UNKNOWN);
+
+  return (form->ops & unknown) == 0;
+}
+
+/* Make the form at position the latest one of its target in the target
+   slots of self. */
+static void tinywot_thing_target_slots_insert(
+  struct tinywot_thing *self, size_t position
+) {
+  tinywot_target_id_t id = TINYWOT_TARGET_ID_NONE;
+
+  self->target_slots_next[position] = 0;
+
+  /* A target that is not interned cannot be requested by ID. */
+  if (tinywot_target_registry_find(
+        self->target_registry, self->forms[position].target, &id
+      ) != TINYWOT_STATUS_SUCCESS
+      || id > self->target_slots_max_n) {
+    return;
+  }
+
+  self->target_slots_next[position] = self->target_slots[id - 1];
+  self->target_slots[id - 1] = position + 1;
+}
+
+/* Rebuild the target slots of self, if it has them, after positions or
+   targets of forms have changed. */
+static void tinywot_thing_target_slots_rebuild(struct tinywot_thing *self) {
+  if (!self->target_slots) {
+    return;
+  }
+
+  memset(self->target_slots, 0, self->target_slots_max_n * sizeof(size_t));
+
+  /* Later forms are inserted last, so they come first in the chains. */
+  for (size_t i = 0; i < self->forms_count_n; i++) {
+    if (self->forms[i].op == TINYWOT_OPERATION_TYPE_UNKNOWN) {
+      self->target_slots_next[i] = 0;
+    } else {
+      tinywot_thing_target_slots_insert(self, i);
+    }
+  }
+}
+
+enum tinywot_status tinywot_thing_add_form(
+  struct tinywot_thing *self, struct tinywot_form const *form
+) {
+  enum tinywot_status status = TINYWOT_STATUS_ERROR_GENERIC;
+
+  if (!tinywot_form_is_valid(form)) {
+    return TINYWOT_STATUS_ERROR_NOT_ALLOWED;
+  }
+
+  /* Reclaim removed forms only when we actually need the space, so
+     removal stays cheap most of the time. */
+  if (self->forms_count_n + 1 > self->forms_max_n
+      && self->forms_removed_n > 0) {
+    tinywot_thing_compact_forms(self);
+  }
+
+  if (self->forms_count_n + 1 > self->forms_max_n) {
+    return TINYWOT_STATUS_ERROR_NOT_ENOUGH_MEMORY;
+  }
+
+  if (self->router) {
+    status = tinywot_router_insert(self->router, form->target);
+    if (status != TINYWOT_STATUS_SUCCESS) {
+      return status;
+    }
+  }
+
+  /* Forms are copied member-wise and never compared byte-wise, so the
+     padding of the supplied form does not matter. */
+  self->forms[self->forms_count_n] = *form;
+
+#ifdef TINYWOT_ENABLE_INSTRUMENTATION
+  /* The position may have been used by a compacted form. */
+  if (self->instrumentation
+      && self->forms_count_n < self->instrumentation->forms_stats_max_n) {
+    memset(
+      &self->instrumentation->forms_stats[self->forms_count_n],
+      0,
+      sizeof(struct tinywot_form_stats)
+    );
+  }
+#endif
+
+  if (self->forms_index) {
+    tinywot_thing_index_insert(
+      self, self->forms_count_n, self->forms_count_n
+    );
+  }
+
+  if (self->target_slots) {
+    tinywot_thing_target_slots_insert(self, self->forms_count_n);
+  }
+
+  self->forms_count_n += 1;
+  self->forms_generation += 1;
+
+  return TINYWOT_STATUS_SUCCESS;
+}
+
+/* Remove target from the router of self, if there is one and no form
+   uses target any more. */
+static void tinywot_thing_router_release(
+  struct tinywot_thing *self, char const *target
+) {
+  if (!self->router) {
+    return;
+  }
+
+  /* A router is never set up for forms in program memory. */
+  for (size_t i = 0; i < self->forms_count_n; i++) {
+    if (self->forms[i].op != TINYWOT_OPERATION_TYPE_UNKNOWN
+        && strcmp(self->forms[i].target, target) == 0) {
+      return;
+    }
+  }
+
+  (void)tinywot_router_remove(self->router, target);
+}
+
+enum tinywot_status tinywot_thing_change_form(
+  struct tinywot_thing *self,
+  char const *target,
+  enum tinywot_operation_type op,
+  struct tinywot_form const *form
+) {
+  enum tinywot_status status = TINYWOT_STATUS_ERROR_GENERIC;
+  struct tinywot_form *form_old = NULL;
+  char const *target_old = NULL;
+
+  /* A static list of forms may live in ROM, and may have been hashed by
+     a target that we must not change. */
+  if (self->forms_max_n == 0 || !tinywot_form_is_valid(form)) {
+    return TINYWOT_STATUS_ERROR_NOT_ALLOWED;
+  }
+
+  status = tinywot_thing_find_form(self, &form_old, target, op);
+  if (status != TINYWOT_STATUS_SUCCESS) {
+    return status;
+  }
+
+  if (self->router) {
+    status = tinywot_router_insert(self->router, form->target);
+    if (status != TINYWOT_STATUS_SUCCESS) {
+      return status;
+    }
+  }
+
+  /* The position of the form in the index depends on its target, so it
+     has to be taken out before the target changes, then put back. */
+  if (self->forms_index) {
+    tinywot_thing_index_erase(
+      self, self->forms_count_n, (size_t)(form_old - self->forms)
+    );
+  }
+
+  target_old = form_old->target;
+  *form_old = *form;
+
+  if (self->forms_index) {
+    tinywot_thing_index_insert(
+      self, self->forms_count_n - 1, (size_t)(form_old - self->forms)
+    );
+  }
+
+  /* Other changes leave the form in the same chain. */
+  if (strcmp(target_old, form->target) != 0) {
+    tinywot_thing_target_slots_rebuild(self);
+  }
+
+  tinywot_thing_router_release(self, target_old);
+  self->forms_generation += 1;
+
+  return TINYWOT_STATUS_SUCCESS;
+}
+
+enum tinywot_status tinywot_thing_remove_form(
+  struct tinywot_thing *self,
+  char const *target,
+  enum tinywot_operation_type op
+) {
+  enum tinywot_status status = TINYWOT_STATUS_ERROR_GENERIC;
+  struct tinywot_form *form = NULL;
+
+  if (self->forms_max_n == 0) {
+    return TINYWOT_STATUS_ERROR_NOT_ALLOWED;
+  }
+
+  status = tinywot_thing_find_form(self, &form, target, op);
+  if (status != TINYWOT_STATUS_SUCCESS) {
+    return status;
+  }
+
+  self->forms_generation += 1;
+  form->ops &= ~TINYWOT_OPERATION_TYPE_BIT(op);
+
+  /* A form serving more ops keeps serving the others. If op is the main
+     one, another op takes its place. */
+  if (form->op != op) {
+    return TINYWOT_STATUS_SUCCESS;
+  }
+
+  if (form->ops != 0) {
+    unsigned int next = 0;
+
+    while ((form->ops & TINYWOT_OPERATION_TYPE_BIT(next)) == 0) {
+      next += 1;
+    }
+
+    form->op = (enum tinywot_operation_type)next;
+    form->ops &= ~TINYWOT_OPERATION_TYPE_BIT(next);
+
+    return TINYWOT_STATUS_SUCCESS;
+  }
+
+  /* Only the op is cleared. The target is kept, so the form stays at
+     the same place in the index (if any), which then does not need to
+     be touched. All lookups skip forms with an UNKNOWN op. */
+  form->op = TINYWOT_OPERATION_TYPE_UNKNOWN;
+  self->forms_removed_n += 1;
+  tinywot_thing_router_release(self, form->target);
+
+  return TINYWOT_STATUS_SUCCESS;
+}
+
+void tinywot_thing_compact_forms(struct tinywot_thing *self) {
+  size_t n = 0;
+
+  if (self->forms_removed_n == 0) {
+    return;
+  }
+
+  for (size_t i = 0; i < self->forms_count_n; i++) {
+    if (self->forms[i].op == TINYWOT_OPERATION_TYPE_UNKNOWN) {
+      continue;
+    }
+
+    if (n != i) {
+      self->forms[n] = self->forms[i];
+
+#ifdef TINYWOT_ENABLE_INSTRUMENTATION
+      /* Statistics are kept by position as well. */
+      if (self->instrumentation
+          && i < self->instrumentation->forms_stats_max_n) {
+        self->instrumentation->forms_stats[n] =
+          self->instrumentation->forms_stats[i];
+      }
+#endif
+    }
+
+    n += 1;
+  }
+
+  self->forms_count_n = n;
+  self->forms_removed_n = 0;
+
+  /* Positions have changed, so the index has to be rebuilt. Its memory
+     is large enough, since there are fewer forms than before. */
+  if (self->forms_index) {
+    for (size_t i = 0; i < self->forms_count_n; i++) {
+      tinywot_thing_index_insert(self, i, i);
+    }
+  }
+
+  tinywot_thing_target_slots_rebuild(self);
+}
+
+void tinywot_target_registry_init(
+  struct tinywot_target_registry *self, void *memory, size_t memory_size_byte
+) {
+  size_t max_n = memory_size_byte / sizeof(char const *);
+
+  /* IDs are assigned from 1, and must fit in tinywot_target_id_t. */
+  if (max_n > (tinywot_target_id_t)-1) {
+    max_n = (tinywot_target_id_t)-1;
+  }
+
+  self->targets = (char const **)memory;
+  self->targets_count_n = 0;
+  self->targets_max_n = max_n;
+}
+
+enum tinywot_status tinywot_target_registry_find(
+  struct tinywot_target_registry const *self,
+  char const *target,
+  tinywot_target_id_t *id
+) {
+  for (size_t i = 0; i < self->targets_count_n; i++) {
+    if (strcmp(self->targets[i], target) == 0) {
+      *id = (tinywot_target_id_t)(i + 1);
+
+      return TINYWOT_STATUS_SUCCESS;
+    }
+  }
+
+  return TINYWOT_STATUS_ERROR_NOT_FOUND;
+}
+
+enum tinywot_status tinywot_target_registry_intern(
+  struct tinywot_target_registry *self,
+  char const *target,
+  tinywot_target_id_t *id
+) {
+  if (tinywot_target_registry_find(self, target, id)
+      == TINYWOT_STATUS_SUCCESS) {
+    return TINYWOT_STATUS_SUCCESS;
+  }
+
+  if (self->targets_count_n + 1 > self->targets_max_n) {
+    return TINYWOT_STATUS_ERROR_NOT_ENOUGH_MEMORY;
+  }
+
+  self->targets[self->targets_count_n] = target;
+  self->targets_count_n += 1;
+  *id = (tinywot_target_id_t)self->targets_count_n;
+
+  return TINYWOT_STATUS_SUCCESS;
+}
+
+enum tinywot_status tinywot_thing_intern_targets(
+  struct tinywot_thing *self,
+  struct tinywot_target_registry *registry,
+  void *memory,
+  size_t memory_size_byte
+) {
+  enum tinywot_status status = TINYWOT_STATUS_ERROR_GENERIC;
+  size_t forms_n = self->forms_max_n > self->forms_count_n ?
+                     self->forms_max_n :
+                     self->forms_count_n;
+
+  /* The registry compares targets with strcmp(). */
+  if (self->forms_in_flash) {
+    return TINYWOT_STATUS_ERROR_NOT_ALLOWED;
+  }
+
+  self->target_registry = NULL;
+  self->target_slots = NULL;
+  self->target_slots_max_n = 0;
+  self->target_slots_next = NULL;
+
+  for (size_t i = 0; i < self->forms_count_n; i++) {
+    struct tinywot_form const *form_i = &self->forms[i];
+    tinywot_target_id_t id = TINYWOT_TARGET_ID_NONE;
+
+    if (form_i->op == TINYWOT_OPERATION_TYPE_UNKNOWN) {
+      continue;
+    }
+
+    status = tinywot_target_registry_intern(registry, form_i->target, &id);
+    if (status != TINYWOT_STATUS_SUCCESS) {
+      return status;
+    }
+  }
+
+  if (memory_size_byte < TINYWOT_THING_TARGET_SLOTS_SIZE_BYTE(
+        registry->targets_max_n, forms_n
+      )) {
+    return TINYWOT_STATUS_ERROR_NOT_ENOUGH_MEMORY;
+  }
+
+  self->target_registry = registry;
+  self->target_slots = (size_t *)memory;
+  self->target_slots_max_n = registry->targets_max_n;
+  self->target_slots_next = self->target_slots + registry->targets_max_n;
+  tinywot_thing_target_slots_rebuild(self);
+
+  return TINYWOT_STATUS_SUCCESS;
+}
+
+/* Return the operation type an observer registered by op has, or
+   UNKNOWN if op does not register or remove observers. */
+static enum tinywot_operation_type tinywot_observer_op(
+  enum tinywot_operation_type op
+) {
+  switch (op) {
+    case TINYWOT_OPERATION_TYPE_OBSERVEPROPERTY:
+    case TINYWOT_OPERATION_TYPE_UNOBSERVEPROPERTY:
+      return TINYWOT_OPERATION_TYPE_OBSERVEPROPERTY;
+
+    case TINYWOT_OPERATION_TYPE_SUBSCRIBEEVENT:
+    case TINYWOT_OPERATION_TYPE_UNSUBSCRIBEEVENT:
+      return TINYWOT_OPERATION_TYPE_SUBSCRIBEEVENT;
+
+    case TINYWOT_OPERATION_TYPE_OBSERVEALLPROPERTIES:
+    case TINYWOT_OPERATION_TYPE_UNOBSERVEALLPROPERTIES:
+      return TINYWOT_OPERATION_TYPE_OBSERVEALLPROPERTIES;
+
+    case TINYWOT_OPERATION_TYPE_SUBSCRIBEALLEVENTS:
+    case TINYWOT_OPERATION_TYPE_UNSUBSCRIBEALLEVENTS:
+      return TINYWOT_OPERATION_TYPE_SUBSCRIBEALLEVENTS;
+
+    default:
+      return TINYWOT_OPERATION_TYPE_UNKNOWN;
+  }
+}
+
+/* Register (or remove) an observer of op on target from the origin of
+   request. */
+static enum tinywot_status tinywot_thing_observe(
+  struct tinywot_thing const *self,
+  char const *target,
+  enum tinywot_operation_type op,
+  bool remove,
+  struct tinywot_request const *request
+) {
+  struct tinywot_observer *vacant = NULL;
+  size_t origin_length_byte = 0;
+  unsigned char const *origin =
+    tinywot_request_get_origin(request, &origin_length_byte);
+
+  if (origin_length_byte > TINYWOT_OBSERVER_ORIGIN_SIZE_BYTE) {
+    return TINYWOT_STATUS_ERROR_NOT_ENOUGH_MEMORY;
+  }
+
+  for (size_t i = 0; i < self->observers_max_n; i++) {
+    struct tinywot_observer *observer = &self->observers[i];
+
+    if (observer->op == TINYWOT_OPERATION_TYPE_UNKNOWN) {
+      if (!vacant) {
+        vacant = observer;
+      }
+
+      continue;
+    }
+
+    if (observer->op == op
+        && strcmp(observer->target, target) == 0
+        && observer->origin_length_byte == origin_length_byte
+        && (origin_length_byte == 0
+            || memcmp(observer->origin, origin, origin_length_byte) == 0)) {
+      /* Observing again is the same as observing once. */
+      if (remove) {
+        tinywot_thing_remove_observer(self, observer);
+      }
+
+      return TINYWOT_STATUS_SUCCESS;
+    }
+  }
+
+  /* Nothing to remove is not an error. */
+  if (remove) {
+    return TINYWOT_STATUS_SUCCESS;
+  }
+
+  if (!vacant) {
+    return TINYWOT_STATUS_ERROR_NOT_ENOUGH_MEMORY;
+  }
+
+  vacant->target = target;
+  vacant->op = op;
+  vacant->origin_length_byte = origin_length_byte;
+  vacant->dirty = false;
+  vacant->value = 0;
+
+  if (origin_length_byte > 0) {
+    memcpy(vacant->origin, origin, origin_length_byte);
+  }
+
+  return TINYWOT_STATUS_SUCCESS;
+}
+
+/* A lookup of a form through a router; see tinywot_thing_router_accept(). */
+struct tinywot_thing_router_lookup {
+  struct tinywot_thing const *thing;
+  enum tinywot_operation_type op;
+  bool any_op;
+  struct tinywot_form *form;
+};
+
+/* Accept a form target matched by the router if it has a form of the
+   requested op, or of any op if lookup->any_op is set. Form targets
+   left without forms are skipped as well. */
+static enum tinywot_status tinywot_thing_router_accept(
+  void *context, char const *pattern
+) {
+  struct tinywot_thing_router_lookup *lookup =
+    (struct tinywot_thing_router_lookup *)context;
+  enum tinywot_status status = tinywot_thing_find_form_uncounted(
+    lookup->thing, &lookup->form, pattern, strlen(pattern), lookup->op
+  );
+
+  if (lookup->any_op && status == TINYWOT_STATUS_ERROR_NOT_ALLOWED) {
+    status = TINYWOT_STATUS_SUCCESS;
+  }
+
+  return status;
+}
+
+/* Find the form for request, filling in request->params with a router. */
+static enum tinywot_status tinywot_thing_lookup(
+  struct tinywot_thing const *self,
+  struct tinywot_request *request,
+  struct tinywot_form **form
+) {
+  enum tinywot_status status = TINYWOT_STATUS_ERROR_GENERIC;
+  size_t target_length_byte = 0;
+  char const *target = NULL;
+
+  /* An ID resolved by the protocol binding saves string comparisons. */
+  if (request->target_id != TINYWOT_TARGET_ID_NONE) {
+    return tinywot_thing_find_form_by_id(
+      self, form, request->target_id, request->op
+    );
+  }
+
+  target = tinywot_request_get_target(request, &target_length_byte);
+
+  if (!target) {
+    status = TINYWOT_STATUS_ERROR_NOT_FOUND;
+  } else if (self->router) {
+    struct tinywot_thing_router_lookup lookup = {
+      .thing = self,
+      .op = request->op,
+      .any_op = false,
+      .form = NULL,
+    };
+    char const *pattern = NULL;
+
+    /* Resolve the requested target to a form target first, which may
+       contain wildcards. The form is looked up for each candidate, so
+       that one without the requested op falls back to the next. */
+    status = tinywot_router_match_n(
+      self->router,
+      target,
+      target_length_byte,
+      tinywot_thing_router_accept,
+      &lookup,
+      &pattern,
+#if TINYWOT_REQUEST_PARAMS_MAX_N > 0
+      request->params,
+      TINYWOT_REQUEST_PARAMS_MAX_N,
+      &request->params_count_n
+#else
+      NULL,
+      0,
+      NULL
+#endif
+    );
+
+    if (status == TINYWOT_STATUS_SUCCESS) {
+      *form = lookup.form;
+    }
+
+#ifdef TINYWOT_ENABLE_INSTRUMENTATION
+    tinywot_thing_count_lookup(self, status);
+#endif
+  } else {
+    status = tinywot_thing_find_form_n(
+      self, form, target, target_length_byte, request->op
+    );
+  }
+
+  return status;
+}
+
+enum tinywot_status tinywot_thing_get_allowed_ops(
+  struct tinywot_thing const *self,
+  struct tinywot_request *request,
+  uint_least32_t *ops
+) {
+  enum tinywot_status status = TINYWOT_STATUS_ERROR_NOT_FOUND;
+  size_t target_length_byte = 0;
+  char const *target = NULL;
+
+  /* As in tinywot_thing_lookup(), an ID names a form target directly,
+     and all of its forms are chained from its slot. */
+  if (request->target_id != TINYWOT_TARGET_ID_NONE) {
+    *ops = 0;
+
+    for (size_t slot = tinywot_thing_target_slot(self, request->target_id);
+         slot != 0;
+         slot = self->target_slots_next[slot - 1]) {
+      struct tinywot_form const *form_i = &self->forms[slot - 1];
+
+      if (form_i->op != TINYWOT_OPERATION_TYPE_UNKNOWN) {
+        *ops |= TINYWOT_OPERATION_TYPE_BIT(form_i->op) | form_i->ops;
+        status = TINYWOT_STATUS_SUCCESS;
+      }
+    }
+
+    return status;
+  }
+
+  target = tinywot_request_get_target(request, &target_length_byte);
+
+  if (!target) {
+    return TINYWOT_STATUS_ERROR_NOT_FOUND;
+  }
+
+  if (self->router) {
+    struct tinywot_thing_router_lookup lookup = {
+      .thing = self,
+      .op = request->op,
+      .any_op = true,
+      .form = NULL,
+    };
+    char const *pattern = NULL;
+
+    status = tinywot_router_match_n(
+      self->router,
+      target,
+      target_length_byte,
+      tinywot_thing_router_accept,
+      &lookup,
+      &pattern,
+#if TINYWOT_REQUEST_PARAMS_MAX_N > 0
+      request->params,
+      TINYWOT_REQUEST_PARAMS_MAX_N,
+      &request->params_count_n
+#else
+      NULL,
+      0,
+      NULL
+#endif
+    );
+
+    if (status != TINYWOT_STATUS_SUCCESS) {
+      return status;
+    }
+
+    target = pattern;
+    target_length_byte = strlen(pattern);
+    status = TINYWOT_STATUS_ERROR_NOT_FOUND;
+  }
+
+  *ops = 0;
+
+  /* All forms on the target count, so there is no early exit that the
+     index or the hash table could speed up. */
+  for (size_t i = 0; i < self->forms_count_n; i++) {
+    struct tinywot_form scratch;
+    struct tinywot_form const *form_i =
+      tinywot_thing_form_at(self, i, &scratch);
+
+    if (form_i->op == TINYWOT_OPERATION_TYPE_UNKNOWN) {
+      continue;
+    }
+
+    if (tinywot_thing_form_target_equals(
+          self, form_i, target, target_length_byte
+        )) {
+      *ops |= TINYWOT_OPERATION_TYPE_BIT(form_i->op) | form_i->ops;
+      status = TINYWOT_STATUS_SUCCESS;
+    }
+  }
+
+  return status;
+}
+
+#ifdef TINYWOT_ENABLE_INSTRUMENTATION
+/* Get the bucket of latency in tinywot_form_stats::latencies_n. */
+static size_t tinywot_latency_bucket(uint_least32_t latency) {
+  size_t bucket = 0;
+
+  latency >>= TINYWOT_INSTRUMENTATION_LATENCY_BUCKET_SHIFT;
+
+  while (latency != 0
+         && bucket < TINYWOT_INSTRUMENTATION_LATENCY_BUCKETS_N - 1U) {
+    latency >>= 1;
+    bucket += 1;
+  }
+
+  return bucket;
+}
+
+/* Get the statistics of form in self, or NULL if it is not counted. */
+static struct tinywot_form_stats *tinywot_thing_form_stats(
+  struct tinywot_thing const *self, struct tinywot_form const *form
+) {
+  size_t position = (size_t)(form - self->forms);
+
+  if (position >= self->instrumentation->forms_stats_max_n) {
+    return NULL;
+  }
+
+  return &self->instrumentation->forms_stats[position];
+}
+#endif
+
+/* Prepare response to request with form, which has been looked up with
+   status. */
+static enum tinywot_status tinywot_thing_dispatch(
+  struct tinywot_thing const *self,
+  struct tinywot_response *response,
+  struct tinywot_request *request,
+  struct tinywot_form *form,
+  enum tinywot_status status
+) {
+  enum tinywot_operation_type observe_op = TINYWOT_OPERATION_TYPE_UNKNOWN;
+  struct tinywot_form scratch;
+#ifdef TINYWOT_ENABLE_INSTRUMENTATION
+  struct tinywot_instrumentation *instrumentation = self->instrumentation;
+  struct tinywot_form_stats *stats = NULL;
+  struct tinywot_form const *found = NULL;
+  uint_least32_t begin = 0;
+
+  if (instrumentation && status == TINYWOT_STATUS_SUCCESS) {
+    stats = tinywot_thing_form_stats(self, form);
+  }
+#endif
+
+  /* Only the matching form is copied out of program memory. */
+  if (status == TINYWOT_STATUS_SUCCESS && self->forms_in_flash) {
+    tinywot_thing_read_form(self, form, &scratch);
+    form = &scratch;
+  }
+
+#ifdef TINYWOT_ENABLE_INSTRUMENTATION
+  if (instrumentation) {
+    found = status == TINYWOT_STATUS_SUCCESS ? form : NULL;
+
+    if (instrumentation->before_dispatch) {
+      instrumentation->before_dispatch(
+        instrumentation->context, request, response, found, status
+      );
+    }
+
+    if (instrumentation->clock) {
+      begin = instrumentation->clock(instrumentation->context);
+    }
+  }
+#endif
+
+#ifdef TINYWOT_ENABLE_REQUEST_FRAGMENTS
+  /* A handler not expecting fragments would take one for a whole body,
+     so the binding should reassemble it instead. */
+  if (status == TINYWOT_STATUS_SUCCESS
+      && tinywot_request_get_fragment(request) != TINYWOT_REQUEST_FRAGMENT_NONE
+      && !(form->flags & TINYWOT_FORM_FLAG_STREAMING)) {
+    status = TINYWOT_STATUS_ERROR_NOT_IMPLEMENTED;
+  }
+#endif
+
+  /* If a matching form is found, then we further allow it to change the
+     response (if it has been implemented). */
+  if (status == TINYWOT_STATUS_SUCCESS) {
+    if (self->observers) {
+      observe_op = tinywot_observer_op(request->op);
+    }
+
+    if (form->handler) {
+      status =
+        form->handler(&response->payload, &request->payload, form->context);
+    } else if (observe_op == TINYWOT_OPERATION_TYPE_UNKNOWN) {
+      status = TINYWOT_STATUS_ERROR_NOT_IMPLEMENTED;
+    }
+  }
+
+  /* Observers are only changed when the handler has agreed. */
+  if (status == TINYWOT_STATUS_SUCCESS
+      && observe_op != TINYWOT_OPERATION_TYPE_UNKNOWN) {
+    status = tinywot_thing_observe(
+      self, form->target, observe_op, observe_op != request->op, request
+    );
+  }
+
+  /* Convert the (TinyWoT) status to a response status, which comes from
+     either tinywot_thing_find_form(), form->handler(), or ourselves
+     (NOT_IMPLEMENTED). */
+  response->status = tinywot_response_status_from_tinywot_status(status);
+
+#ifdef TINYWOT_ENABLE_INSTRUMENTATION
+  if (instrumentation) {
+    if (stats) {
+      stats->hits_n += 1;
+
+      if (tinywot_status_is_error(status)) {
+        stats->errors_n += 1;
+      }
+
+      if (instrumentation->clock) {
+        uint_least32_t latency =
+          instrumentation->clock(instrumentation->context) - begin;
+
+        stats->latencies_n[tinywot_latency_bucket(latency)] += 1;
+      }
+    }
+
+    if (instrumentation->after_dispatch) {
+      instrumentation->after_dispatch(
+        instrumentation->context, request, response, found, status
+      );
+    }
+  }
+#endif
+
+  return status;
+}
+
+/* Process request with the form found for it, and the status of
+   finding it. */
+static enum tinywot_status tinywot_thing_process_request_found(
+  struct tinywot_thing const *self,
+  struct tinywot_response *response,
+  struct tinywot_request *request,
+  struct tinywot_form *form,
+  enum tinywot_status status
+) {
+  status = tinywot_thing_dispatch(self, response, request, form, status);
+
+  /* The caller needs to know that there are more blocks to come, or
+     that the response will come later. */
+  if (status == TINYWOT_STATUS_NOT_FINISHED
+      || status == TINYWOT_STATUS_PENDING) {
+    return status;
+  }
 
   /* Technically, this function has successfully prepared a response, so
      there is no need to forward an error. */
   return TINYWOT_STATUS_SUCCESS;
 }
+
+enum tinywot_status tinywot_thing_process_request(
+  struct tinywot_thing const *self,
+  struct tinywot_response *response,
+  struct tinywot_request *request
+) {
+  struct tinywot_form *form = NULL;
+  enum tinywot_status status = tinywot_thing_lookup(self, request, &form);
+
+  return tinywot_thing_process_request_found(
+    self, response, request, form, status
+  );
+}
+
+/* Whether two requests are on the same target. */
+static bool tinywot_request_same_target(
+  struct tinywot_request const *a, struct tinywot_request const *b
+) {
+  size_t target_a_length_byte = 0;
+  size_t target_b_length_byte = 0;
+  char const *target_a = NULL;
+  char const *target_b = NULL;
+
+  if (a->target_id != TINYWOT_TARGET_ID_NONE
+      || b->target_id != TINYWOT_TARGET_ID_NONE) {
+    return a->target_id == b->target_id;
+  }
+
+  target_a = tinywot_request_get_target(a, &target_a_length_byte);
+  target_b = tinywot_request_get_target(b, &target_b_length_byte);
+
+  return target_a && target_b
+         && target_a_length_byte == target_b_length_byte
+         && memcmp(target_a, target_b, target_a_length_byte) == 0;
+}
+
+/* Give request the params matched for leader, which has the same target
+   string. */
+static void tinywot_request_copy_params(
+  struct tinywot_request *request, struct tinywot_request const *leader
+) {
+#if TINYWOT_REQUEST_PARAMS_MAX_N > 0
+  size_t target_length_byte = 0;
+  char const *target =
+    tinywot_request_get_target(request, &target_length_byte);
+  char const *leader_target =
+    tinywot_request_get_target(leader, &target_length_byte);
+
+  for (size_t i = 0; i < leader->params_count_n; i++) {
+    /* Captured parts point into the target of their own request. */
+    request->params[i].value =
+      target + (leader->params[i].value - leader_target);
+    request->params[i].value_length_byte =
+      leader->params[i].value_length_byte;
+  }
+
+  request->params_count_n = leader->params_count_n;
+#else
+  (void)request;
+  (void)leader;
+#endif
+}
+
+enum tinywot_status tinywot_thing_process_requests(
+  struct tinywot_thing const *self,
+  struct tinywot_response *responses,
+  struct tinywot_request *requests,
+  size_t requests_n,
+  enum tinywot_status *statuses
+) {
+  /* No response status is ever mapped to UNKNOWN, so it marks requests
+     that have not been processed yet. */
+  for (size_t i = 0; i < requests_n; i++) {
+    responses[i].status = TINYWOT_RESPONSE_STATUS_UNKNOWN;
+  }
+
+  for (size_t i = 0; i < requests_n; i++) {
+    struct tinywot_request *leader = &requests[i];
+    struct tinywot_form *form = NULL;
+    enum tinywot_status found = TINYWOT_STATUS_ERROR_GENERIC;
+
+    if (responses[i].status != TINYWOT_RESPONSE_STATUS_UNKNOWN) {
+      continue;
+    }
+
+    found = tinywot_thing_lookup(self, leader, &form);
+
+    /* Process all later requests sharing the lookup, until one on the
+       same target asks for another op: that must be processed first to
+       keep the order of requests on each target. */
+    for (size_t j = i; j < requests_n; j++) {
+      struct tinywot_request *request = &requests[j];
+      enum tinywot_status status = TINYWOT_STATUS_ERROR_GENERIC;
+
+      if (responses[j].status != TINYWOT_RESPONSE_STATUS_UNKNOWN) {
+        continue;
+      }
+
+      if (j != i) {
+        if (!tinywot_request_same_target(request, leader)) {
+          continue;
+        }
+
+        if (request->op != leader->op) {
+          break;
+        }
+
+        tinywot_request_copy_params(request, leader);
+      }
+
+      status = tinywot_thing_dispatch(
+        self, &responses[j], request, form, found
+      );
+
+      if (statuses) {
+        statuses[j] = status;
+      }
+    }
+  }
+
+  return TINYWOT_STATUS_SUCCESS;
+}
+
+enum tinywot_status tinywot_thing_init_observers(
+  struct tinywot_thing *self, void *memory, size_t memory_size_byte
+) {
+  self->observers = NULL;
+  self->observers_max_n = 0;
+
+  /* Observers compare form targets in RAM, and a router would give them
+     patterns instead of observed targets. */
+  if (self->forms_in_flash || self->router) {
+    return TINYWOT_STATUS_ERROR_NOT_ALLOWED;
+  }
+
+  self->observers = (struct tinywot_observer *)memory;
+  self->observers_max_n = memory_size_byte / sizeof(struct tinywot_observer);
+
+  for (size_t i = 0; i < self->observers_max_n; i++) {
+    tinywot_thing_remove_observer(self, &self->observers[i]);
+  }
+
+  return TINYWOT_STATUS_SUCCESS;
+}
+
+#ifdef TINYWOT_ENABLE_INSTRUMENTATION
+void tinywot_thing_init_instrumentation(
+  struct tinywot_thing *self,
+  struct tinywot_instrumentation *instrumentation,
+  void *memory,
+  size_t memory_size_byte
+) {
+  memset(instrumentation, 0, sizeof(struct tinywot_instrumentation));
+  instrumentation->forms_stats = (struct tinywot_form_stats *)memory;
+  instrumentation->forms_stats_max_n =
+    memory_size_byte / sizeof(struct tinywot_form_stats);
+  memset(
+    memory,
+    0,
+    instrumentation->forms_stats_max_n * sizeof(struct tinywot_form_stats)
+  );
+
+  self->instrumentation = instrumentation;
+}
+#endif
+
+/* Whether self has a form of op on target: -1 for not known yet, or a
+   cached result of 0 or 1. */
+static int tinywot_thing_has_form_cached(
+  struct tinywot_thing const *self,
+  int *cache,
+  char const *target,
+  enum tinywot_operation_type op
+) {
+  struct tinywot_form *form = NULL;
+
+  if (*cache < 0) {
+    *cache = tinywot_thing_find_form(self, &form, target, op)
+             == TINYWOT_STATUS_SUCCESS;
+  }
+
+  return *cache;
+}
+
+/* Mark observers of target, and set their values if value is not NULL. */
+static size_t tinywot_thing_mark_dirty_value(
+  struct tinywot_thing const *self,
+  char const *target,
+  uint_least32_t const *value
+) {
+  size_t marked_n = 0;
+  int is_property = -1;
+  int is_event = -1;
+
+  for (size_t i = 0; i < self->observers_max_n; i++) {
+    struct tinywot_observer *observer = &self->observers[i];
+    bool matched = false;
+
+    switch (observer->op) {
+      case TINYWOT_OPERATION_TYPE_OBSERVEPROPERTY:
+      case TINYWOT_OPERATION_TYPE_SUBSCRIBEEVENT:
+        matched = strcmp(observer->target, target) == 0;
+        break;
+
+      case TINYWOT_OPERATION_TYPE_OBSERVEALLPROPERTIES:
+        matched = tinywot_thing_has_form_cached(
+          self, &is_property, target, TINYWOT_OPERATION_TYPE_OBSERVEPROPERTY
+        );
+        break;
+
+      case TINYWOT_OPERATION_TYPE_SUBSCRIBEALLEVENTS:
+        matched = tinywot_thing_has_form_cached(
+          self, &is_event, target, TINYWOT_OPERATION_TYPE_SUBSCRIBEEVENT
+        );
+        break;
+
+      default:
+        break;
+    }
+
+    if (matched) {
+      observer->dirty = true;
+      marked_n += 1;
+
+      if (value) {
+        observer->value = *value;
+      }
+    }
+  }
+
+  return marked_n;
+}
+
+size_t tinywot_thing_mark_dirty(
+  struct tinywot_thing const *self, char const *target
+) {
+  return tinywot_thing_mark_dirty_value(self, target, NULL);
+}
+
+enum tinywot_status tinywot_thing_next_notification(
+  struct tinywot_thing const *self, struct tinywot_observer **observer
+) {
+  for (size_t i = 0; i < self->observers_max_n; i++) {
+    struct tinywot_observer *observer_i = &self->observers[i];
+
+    if (observer_i->op != TINYWOT_OPERATION_TYPE_UNKNOWN
+        && observer_i->dirty) {
+      observer_i->dirty = false;
+      *observer = observer_i;
+
+      return TINYWOT_STATUS_SUCCESS;
+    }
+  }
+
+  return TINYWOT_STATUS_ERROR_NOT_FOUND;
+}
+
+/* Return the operation type of the form notifying an observer
+   registered by op. */
+static enum tinywot_operation_type tinywot_notification_op(
+  enum tinywot_operation_type op
+) {
+  /* Properties are notified with their values; events are notified
+     with whatever their handlers produce. */
+  switch (op) {
+    case TINYWOT_OPERATION_TYPE_OBSERVEPROPERTY:
+      return TINYWOT_OPERATION_TYPE_READPROPERTY;
+
+    case TINYWOT_OPERATION_TYPE_OBSERVEALLPROPERTIES:
+      return TINYWOT_OPERATION_TYPE_READALLPROPERTIES;
+
+    default:
+      return op;
+  }
+}
+
+/* Find the form notifying observer. */
+static enum tinywot_status tinywot_thing_find_notification_form(
+  struct tinywot_thing const *self,
+  struct tinywot_observer const *observer,
+  struct tinywot_form **form
+) {
+  enum tinywot_status status = tinywot_thing_find_form(
+    self, form, observer->target, tinywot_notification_op(observer->op)
+  );
+
+  /* A removed form is as good as never registered for the observer. */
+  if (status == TINYWOT_STATUS_ERROR_NOT_ALLOWED) {
+    status = TINYWOT_STATUS_ERROR_NOT_FOUND;
+  }
+
+  return status;
+}
+
+/* Notify observer with the form found for it, and the status of
+   finding it. */
+static enum tinywot_status tinywot_thing_process_notification_found(
+  struct tinywot_response *response,
+  struct tinywot_observer const *observer,
+  struct tinywot_form *form,
+  enum tinywot_status status
+) {
+  struct tinywot_request request = {0};
+
+  request.op = tinywot_notification_op(observer->op);
+
+  /* The target of the observer lives as long as the observer. */
+  request.target_view = observer->target;
+  request.target_view_length_byte = strlen(observer->target);
+
+#if TINYWOT_REQUEST_TARGET_BUFFER_SIZE_BYTE > 0
+  if (request.target_view_length_byte < sizeof(request.target)) {
+    memcpy(
+      request.target,
+      observer->target,
+      request.target_view_length_byte + 1
+    );
+  }
+#endif
+
+#ifdef TINYWOT_ENABLE_REQUEST_ORIGIN
+  request.origin = observer->origin;
+  request.origin_length_byte = observer->origin_length_byte;
+#endif
+
+  /* The value is read-only to the handler, like any request payload. */
+  request.payload.content = (void *)&observer->value;
+  request.payload.content_length_byte = sizeof(observer->value);
+  request.payload.content_buffer_size_byte = sizeof(observer->value);
+
+  if (status == TINYWOT_STATUS_SUCCESS) {
+    if (form->handler) {
+      status =
+        form->handler(&response->payload, &request.payload, form->context);
+    } else if (request.op == observer->op) {
+      /* An event without a handler has no data. */
+      response->payload.content_length_byte = 0;
+    } else {
+      status = TINYWOT_STATUS_ERROR_NOT_IMPLEMENTED;
+    }
+  }
+
+  response->status = tinywot_response_status_from_tinywot_status(status);
+
+  return status;
+}
+
+enum tinywot_status tinywot_thing_process_notification(
+  struct tinywot_thing const *self,
+  struct tinywot_response *response,
+  struct tinywot_observer const *observer
+) {
+  struct tinywot_form *form = NULL;
+  enum tinywot_status status =
+    tinywot_thing_find_notification_form(self, observer, &form);
+
+  return tinywot_thing_process_notification_found(
+    response, observer, form, status
+  );
+}
+
+void tinywot_thing_remove_observer(
+  struct tinywot_thing const *self, struct tinywot_observer *observer
+) {
+  (void)self;
+
+  observer->target = NULL;
+  observer->op = TINYWOT_OPERATION_TYPE_UNKNOWN;
+  observer->origin_length_byte = 0;
+  observer->dirty = false;
+  observer->value = 0;
+}
+
+size_t tinywot_thing_drain_events(
+  struct tinywot_thing const *self, struct tinywot_event_ring *ring
+) {
+  struct tinywot_event event;
+  size_t drained_n = 0;
+
+  while (tinywot_event_ring_take(ring, &event) == TINYWOT_STATUS_SUCCESS) {
+    tinywot_thing_mark_dirty_value(self, event.target, &event.value);
+    drained_n += 1;
+  }
+
+  return drained_n;
+}
+
+/* Whether the notifications of a and b are the same. */
+static bool tinywot_observer_same_notification(
+  struct tinywot_observer const *a, struct tinywot_observer const *b
+) {
+  return a->op == b->op && a->value == b->value
+         && (a->target == b->target || strcmp(a->target, b->target) == 0);
+}
+
+size_t tinywot_thing_take_notifications(
+  struct tinywot_thing const *self,
+  struct tinywot_observer **observers,
+  size_t observers_max_n
+) {
+  size_t observers_n = 0;
+
+  for (size_t i = 0; i < self->observers_max_n; i++) {
+    struct tinywot_observer *observer_i = &self->observers[i];
+
+    if (observers_n == observers_max_n) {
+      break;
+    }
+
+    if (observer_i->op == TINYWOT_OPERATION_TYPE_UNKNOWN
+        || !observer_i->dirty) {
+      continue;
+    }
+
+    if (observers_n > 0
+        && !tinywot_observer_same_notification(observers[0], observer_i)) {
+      continue;
+    }
+
+    observer_i->dirty = false;
+    observers[observers_n] = observer_i;
+    observers_n += 1;
+  }
+
+  return observers_n;
+}
+
+void tinywot_response_pool_init(
+  struct tinywot_response_pool *self,
+  void *responses_memory,
+  size_t responses_memory_size_byte,
+  void *buffers_memory,
+  size_t buffers_memory_size_byte
+) {
+  size_t responses_max_n =
+    responses_memory_size_byte / sizeof(struct tinywot_shared_response);
+  size_t buffer_size_byte =
+    responses_max_n ? buffers_memory_size_byte / responses_max_n : 0;
+
+  self->responses = (struct tinywot_shared_response *)responses_memory;
+  self->responses_max_n = responses_max_n;
+
+  memset(responses_memory, 0, responses_memory_size_byte);
+
+  for (size_t i = 0; i < responses_max_n; i++) {
+    struct tinywot_payload *payload = &self->responses[i].response.payload;
+
+    payload->content = (unsigned char *)buffers_memory + i * buffer_size_byte;
+    payload->content_buffer_size_byte = buffer_size_byte;
+  }
+}
+
+enum tinywot_status tinywot_response_pool_acquire(
+  struct tinywot_response_pool *self,
+  struct tinywot_shared_response **response
+) {
+  for (size_t i = 0; i < self->responses_max_n; i++) {
+    struct tinywot_shared_response *response_i = &self->responses[i];
+
+    /* A reference may be released from another task meanwhile. */
+    if (TINYWOT_ATOMIC_COMPARE_EXCHANGE(&response_i->references_n, 0U, 1U)) {
+      struct tinywot_payload payload = response_i->response.payload;
+
+      /* Only the buffer is kept from the last use. */
+      memset(&response_i->response, 0, sizeof(response_i->response));
+      response_i->response.payload.content = payload.content;
+      response_i->response.payload.content_buffer_size_byte =
+        payload.content_buffer_size_byte;
+      *response = response_i;
+
+      return TINYWOT_STATUS_SUCCESS;
+    }
+  }
+
+  return TINYWOT_STATUS_ERROR_NOT_ENOUGH_MEMORY;
+}
+
+void tinywot_shared_response_retain(struct tinywot_shared_response *self) {
+  TINYWOT_ATOMIC_INCREMENT(&self->references_n);
+}
+
+void tinywot_shared_response_release(struct tinywot_shared_response *self) {
+  unsigned int references_n = 0;
+
+  /* A release too many would otherwise wrap around, and the response
+     would never go back to the pool. */
+  do {
+    references_n = TINYWOT_ATOMIC_LOAD(&self->references_n);
+
+    if (references_n == 0) {
+      return;
+    }
+  } while (!TINYWOT_ATOMIC_COMPARE_EXCHANGE(
+    &self->references_n, references_n, references_n - 1U
+  ));
+}
+
+enum tinywot_status tinywot_thing_process_shared_notification(
+  struct tinywot_thing const *self,
+  struct tinywot_response_pool *pool,
+  struct tinywot_observer **observers,
+  size_t observers_max_n,
+  size_t *observers_n,
+  struct tinywot_shared_response **response
+) {
+  enum tinywot_status status = TINYWOT_STATUS_ERROR_GENERIC;
+  struct tinywot_shared_response *shared = NULL;
+
+  *observers_n = tinywot_thing_take_notifications(
+    self, observers, observers_max_n
+  );
+
+  if (*observers_n == 0) {
+    return TINYWOT_STATUS_ERROR_NOT_FOUND;
+  }
+
+  status = tinywot_response_pool_acquire(pool, &shared);
+
+  /* Try again when a response has been released. */
+  if (status != TINYWOT_STATUS_SUCCESS) {
+    for (size_t i = 0; i < *observers_n; i++) {
+      observers[i]->dirty = true;
+    }
+
+    return status;
+  }
+
+  status = tinywot_thing_process_notification(
+    self, &shared->response, observers[0]
+  );
+
+  if (status != TINYWOT_STATUS_SUCCESS) {
+    tinywot_shared_response_release(shared);
+
+    return status;
+  }
+
+  TINYWOT_ATOMIC_STORE(&shared->references_n, (unsigned int)*observers_n);
+  *response = shared;
+
+  return TINYWOT_STATUS_SUCCESS;
+}
+
+enum tinywot_status tinywot_event_ring_init(
+  struct tinywot_event_ring *self, void *memory, size_t memory_size_byte
+) {
+  size_t events_max_n = memory_size_byte / sizeof(struct tinywot_event);
+  size_t events_n = TINYWOT_EVENT_RING_MAX_N;
+
+  while (events_n > events_max_n) {
+    events_n >>= 1;
+  }
+
+  if (events_n == 0) {
+    return TINYWOT_STATUS_ERROR_NOT_ENOUGH_MEMORY;
+  }
+
+  self->events = (struct tinywot_event *)memory;
+  self->mask = (uint_least8_t)(events_n - 1);
+  self->head = 0;
+  self->tail = 0;
+
+  return TINYWOT_STATUS_SUCCESS;
+}
+
+enum tinywot_status tinywot_event_ring_post(
+  struct tinywot_event_ring *self, char const *target, uint_least32_t value
+) {
+  uint_least8_t head = self->head;
+
+  /* Indices run freely and wrap at 256, which is a multiple of the ring
+     size, so their difference is always the number of events in it. */
+  if ((uint_least8_t)(head - self->tail) > self->mask) {
+    return TINYWOT_STATUS_ERROR_NOT_ENOUGH_MEMORY;
+  }
+
+  self->events[head & self->mask].target = target;
+  self->events[head & self->mask].value = value;
+
+  /* The consumer must see the event before the new head. */
+  TINYWOT_MEMORY_BARRIER();
+  self->head = (uint_least8_t)(head + 1U);
+
+  return TINYWOT_STATUS_SUCCESS;
+}
+
+enum tinywot_status tinywot_event_ring_take(
+  struct tinywot_event_ring *self, struct tinywot_event *event
+) {
+  uint_least8_t tail = self->tail;
+
+  if (tail == self->head) {
+    return TINYWOT_STATUS_ERROR_NOT_FOUND;
+  }
+
+  /* The event must be read after the head it was published with. */
+  TINYWOT_MEMORY_BARRIER();
+  *event = self->events[tail & self->mask];
+
+  /* The producer must not reuse the slot before it has been read. */
+  TINYWOT_MEMORY_BARRIER();
+  self->tail = (uint_least8_t)(tail + 1U);
+
+  return TINYWOT_STATUS_SUCCESS;
+}
+
+void tinywot_thing_rcu_init(
+  struct tinywot_thing_rcu *self, void *memory, size_t memory_size_byte
+) {
+  size_t half_size_byte = memory_size_byte / 2U
+    / sizeof(struct tinywot_form) * sizeof(struct tinywot_form);
+
+  tinywot_thing_init_dynamic(&self->versions[0], memory, half_size_byte);
+  tinywot_thing_init_dynamic(
+    &self->versions[1], (unsigned char *)memory + half_size_byte,
+    half_size_byte
+  );
+
+  self->current = 0;
+  self->readers_n[0] = 0;
+  self->readers_n[1] = 0;
+}
+
+struct tinywot_thing const *tinywot_thing_rcu_read_lock(
+  struct tinywot_thing_rcu *self
+) {
+  unsigned int current = 0;
+
+  /* Announce the reader first, then check that the version is still the
+     current one. Otherwise, a writer may have missed the announcement
+     and started reusing it. */
+  for (;;) {
+    current = TINYWOT_ATOMIC_LOAD(&self->current);
+    TINYWOT_ATOMIC_INCREMENT(&self->readers_n[current]);
+
+    if (TINYWOT_ATOMIC_LOAD(&self->current) == current) {
+      return &self->versions[current];
+    }
+
+    TINYWOT_ATOMIC_DECREMENT(&self->readers_n[current]);
+  }
+}
+
+void tinywot_thing_rcu_read_unlock(
+  struct tinywot_thing_rcu *self, struct tinywot_thing const *thing
+) {
+  TINYWOT_ATOMIC_DECREMENT(&self->readers_n[thing - self->versions]);
+}
+
+enum tinywot_status tinywot_thing_rcu_process_request(
+  struct tinywot_thing_rcu *self,
+  struct tinywot_response *response,
+  struct tinywot_request *request
+) {
+  struct tinywot_thing const *thing = tinywot_thing_rcu_read_lock(self);
+  enum tinywot_status status =
+    tinywot_thing_process_request(thing, response, request);
+
+  tinywot_thing_rcu_read_unlock(self, thing);
+
+  return status;
+}
+
+/* Whether self only has forms, which is all that a tinywot_thing_rcu
+   copies between versions. */
+static bool tinywot_thing_rcu_version_is_plain(
+  struct tinywot_thing const *self
+) {
+  return !self->forms_index && !self->forms_hash && !self->router
+         && !self->observers && !self->target_slots;
+}
+
+enum tinywot_status tinywot_thing_rcu_update_begin(
+  struct tinywot_thing_rcu *self, struct tinywot_thing **thing
+) {
+  /* Only the writer changes current, so it does not need to be atomic
+     here. */
+  struct tinywot_thing const *current = &self->versions[self->current];
+  unsigned int next = self->current ^ 1U;
+  struct tinywot_thing *version = &self->versions[next];
+
+  if (!tinywot_thing_rcu_version_is_plain(current)
+      || !tinywot_thing_rcu_version_is_plain(version)) {
+    return TINYWOT_STATUS_ERROR_NOT_ALLOWED;
+  }
+
+  if (TINYWOT_ATOMIC_LOAD(&self->readers_n[next]) != 0) {
+    return TINYWOT_STATUS_NOT_FINISHED;
+  }
+
+  /* Both versions have the same capacity, so the forms always fit. */
+  memcpy(
+    version->forms,
+    current->forms,
+    current->forms_count_n * sizeof(struct tinywot_form)
+  );
+  version->forms_count_n = current->forms_count_n;
+  version->forms_removed_n = current->forms_removed_n;
+  version->forms_generation = current->forms_generation;
+
+  *thing = version;
+
+  return TINYWOT_STATUS_SUCCESS;
+}
+
+void tinywot_thing_rcu_update_publish(struct tinywot_thing_rcu *self) {
+  TINYWOT_ATOMIC_STORE(&self->current, self->current ^ 1U);
+}
+
+/* Find a form by a target of a known length; see
+   tinywot_form_table_find(). */
+static enum tinywot_status tinywot_form_table_find_n(
+  struct tinywot_form_table const *self,
+  size_t *position,
+  char const *target,
+  size_t target_length_byte,
+  enum tinywot_operation_type op
+) {
+  enum tinywot_status status = TINYWOT_STATUS_ERROR_NOT_FOUND;
+
+  /* Search from the end, like tinywot_thing_find_form(). */
+  for (size_t i = self->forms_count_n; i != 0; --i) {
+    if (tinywot_target_compare_n(
+      self->targets[i - 1], target, target_length_byte
+    ) != 0) {
+      continue;
+    }
+
+    if (self->ops[i - 1] == TINYWOT_OPERATION_TYPE_UNKNOWN) {
+      continue;
+    }
+
+    if (self->ops[i - 1] == op
+        || (self->op_sets
+            && (self->op_sets[i - 1] & TINYWOT_OPERATION_TYPE_BIT(op)) != 0)) {
+      *position = i - 1;
+      return TINYWOT_STATUS_SUCCESS;
+    }
+
+    status = TINYWOT_STATUS_ERROR_NOT_ALLOWED;
+  }
+
+  return status;
+}
+
+enum tinywot_status tinywot_form_table_find(
+  struct tinywot_form_table const *self,
+  size_t *position,
+  char const *target,
+  enum tinywot_operation_type op
+) {
+  return tinywot_form_table_find_n(
+    self, position, target, strlen(target), op
+  );
+}
+
+enum tinywot_status tinywot_form_table_process_request(
+  struct tinywot_form_table const *self,
+  struct tinywot_response *response,
+  struct tinywot_request *request
+) {
+  size_t position = 0;
+  size_t target_length_byte = 0;
+  char const *target =
+    tinywot_request_get_target(request, &target_length_byte);
+  enum tinywot_status status = target ?
+    tinywot_form_table_find_n(
+      self, &position, target, target_length_byte, request->op
+    ) :
+    TINYWOT_STATUS_ERROR_NOT_FOUND;
+
+  /* There are no flags, so no handler accepts fragments. */
+  if (status == TINYWOT_STATUS_SUCCESS
+      && tinywot_request_get_fragment(request)
+           != TINYWOT_REQUEST_FRAGMENT_NONE) {
+    status = TINYWOT_STATUS_ERROR_NOT_IMPLEMENTED;
+  }
+
+  if (status == TINYWOT_STATUS_SUCCESS) {
+    tinywot_form_handler_t *handler = self->handlers[position];
+    void *context = self->contexts ? self->contexts[position] : NULL;
+
+    status = handler ?
+      handler(&response->payload, &request->payload, context) :
+      TINYWOT_STATUS_ERROR_NOT_IMPLEMENTED;
+  }
+
+  response->status = tinywot_response_status_from_tinywot_status(status);
+
+  if (status == TINYWOT_STATUS_NOT_FINISHED
+      || status == TINYWOT_STATUS_PENDING) {
+    return status;
+  }
+
+  return TINYWOT_STATUS_SUCCESS;
+}
+
+void tinywot_servient_init(
+  struct tinywot_servient *self, void *memory, size_t memory_size_byte
+) {
+  self->things = (struct tinywot_servient_thing *)memory;
+  self->things_count_n = 0;
+  self->things_max_n = memory_size_byte / sizeof(struct tinywot_servient_thing);
+}
+
+/* Find the first position in self whose base is not less than the
+   first length_byte characters of base, and whether it is equal. */
+static bool tinywot_servient_search(
+  struct tinywot_servient const *self,
+  char const *base,
+  size_t length_byte,
+  size_t *position
+) {
+  size_t low = 0;
+  size_t high = self->things_count_n;
+
+  while (low < high) {
+    size_t middle = low + (high - low) / 2U;
+
+    if (tinywot_target_compare_n(
+          self->things[middle].base, base, length_byte
+        ) < 0) {
+      low = middle + 1U;
+    } else {
+      high = middle;
+    }
+  }
+
+  *position = low;
+
+  return low < self->things_count_n
+         && self->things[low].base_length_byte == length_byte
+         && memcmp(self->things[low].base, base, length_byte) == 0;
+}
+
+enum tinywot_status tinywot_servient_add_thing(
+  struct tinywot_servient *self,
+  char const *base,
+  struct tinywot_thing const *thing
+) {
+  size_t base_length_byte = strlen(base);
+  size_t position = 0;
+
+  if (base_length_byte > 0 && base[base_length_byte - 1] == '/') {
+    return TINYWOT_STATUS_ERROR_NOT_ALLOWED;
+  }
+
+  if (tinywot_servient_search(self, base, base_length_byte, &position)) {
+    return TINYWOT_STATUS_ERROR_NOT_ALLOWED;
+  }
+
+  if (self->things_count_n + 1 > self->things_max_n) {
+    return TINYWOT_STATUS_ERROR_NOT_ENOUGH_MEMORY;
+  }
+
+  memmove(
+    &self->things[position + 1],
+    &self->things[position],
+    (self->things_count_n - position) * sizeof(struct tinywot_servient_thing)
+  );
+
+  self->things[position].base = base;
+  self->things[position].base_length_byte = base_length_byte;
+  self->things[position].thing = thing;
+  self->things_count_n += 1;
+
+  return TINYWOT_STATUS_SUCCESS;
+}
+
+enum tinywot_status tinywot_servient_remove_thing(
+  struct tinywot_servient *self, char const *base
+) {
+  size_t position = 0;
+
+  if (!tinywot_servient_search(self, base, strlen(base), &position)) {
+    return TINYWOT_STATUS_ERROR_NOT_FOUND;
+  }
+
+  self->things_count_n -= 1;
+
+  memmove(
+    &self->things[position],
+    &self->things[position + 1],
+    (self->things_count_n - position) * sizeof(struct tinywot_servient_thing)
+  );
+
+  return TINYWOT_STATUS_SUCCESS;
+}
+
+enum tinywot_status tinywot_servient_find_thing(
+  struct tinywot_servient const *self,
+  struct tinywot_thing const **thing,
+  char const *target,
+  size_t target_length_byte,
+  size_t *base_length_byte
+) {
+  size_t length_byte = target_length_byte;
+
+  /* Try every prefix ending before a slash (or at the end), from the
+     longest one. */
+  for (;;) {
+    size_t position = 0;
+
+    if (tinywot_servient_search(self, target, length_byte, &position)) {
+      *thing = self->things[position].thing;
+      *base_length_byte = length_byte;
+
+      return TINYWOT_STATUS_SUCCESS;
+    }
+
+    if (length_byte == 0) {
+      return TINYWOT_STATUS_ERROR_NOT_FOUND;
+    }
+
+    do {
+      length_byte -= 1;
+    } while (length_byte > 0 && target[length_byte] != '/');
+  }
+}
+
+enum tinywot_status tinywot_servient_process_request(
+  struct tinywot_servient const *self,
+  struct tinywot_response *response,
+  struct tinywot_request *request
+) {
+  struct tinywot_thing const *thing = NULL;
+  char const *view = request->target_view;
+  size_t view_length_byte = request->target_view_length_byte;
+  tinywot_target_id_t target_id = request->target_id;
+  size_t target_length_byte = 0;
+  size_t base_length_byte = 0;
+  char const *target =
+    tinywot_request_get_target(request, &target_length_byte);
+  enum tinywot_status status = TINYWOT_STATUS_ERROR_NOT_FOUND;
+
+  if (target) {
+    status = tinywot_servient_find_thing(
+      self, &thing, target, target_length_byte, &base_length_byte
+    );
+  }
+
+  if (status != TINYWOT_STATUS_SUCCESS) {
+    response->status = tinywot_response_status_from_tinywot_status(status);
+
+    return TINYWOT_STATUS_SUCCESS;
+  }
+
+  if (base_length_byte < target_length_byte) {
+    request->target_view = target + base_length_byte;
+    request->target_view_length_byte = target_length_byte - base_length_byte;
+  } else {
+    request->target_view = "/";
+    request->target_view_length_byte = 1;
+  }
+
+  request->target_id = TINYWOT_TARGET_ID_NONE;
+
+  status = tinywot_thing_process_request(thing, response, request);
+
+  request->target_view = view;
+  request->target_view_length_byte = view_length_byte;
+  request->target_id = target_id;
+
+  return status;
+}
+
+void tinywot_scheduler_init(
+  struct tinywot_scheduler *self, void *memory, size_t memory_size_byte
+) {
+  self->tasks = (struct tinywot_task *)memory;
+  self->tasks_count_n = 0;
+  self->tasks_max_n = memory_size_byte / sizeof(struct tinywot_task);
+  self->sequence = 0;
+  self->running = false;
+}
+
+/* Whether a comes before b on a clock (or counter) wrapping around at
+   2^32. */
+static bool tinywot_ticks_before(uint_least32_t a, uint_least32_t b) {
+  return ((a - b) & 0xFFFFFFFFUL) >= 0x80000000UL;
+}
+
+/* Whether a should run before b. */
+static bool tinywot_task_before(
+  struct tinywot_task const *a, struct tinywot_task const *b
+) {
+  if (a->priority != b->priority) {
+    return a->priority > b->priority;
+  }
+
+  if (a->has_deadline != b->has_deadline) {
+    return a->has_deadline;
+  }
+
+  if (a->has_deadline && a->deadline != b->deadline) {
+    return tinywot_ticks_before(a->deadline, b->deadline);
+  }
+
+  return tinywot_ticks_before(a->sequence, b->sequence);
+}
+
+static void tinywot_task_swap(struct tinywot_task *a, struct tinywot_task *b) {
+  struct tinywot_task scratch = *a;
+
+  *a = *b;
+  *b = scratch;
+}
+
+/* Find the form that task will run, keeping it in task. */
+static void tinywot_task_find_form(struct tinywot_task *task) {
+  task->forms_generation = task->thing->forms_generation;
+
+  if (task->type == TINYWOT_TASK_TYPE_REQUEST) {
+    task->form_status =
+      tinywot_thing_lookup(task->thing, task->request, &task->form);
+  } else {
+    task->form_status = tinywot_thing_find_notification_form(
+      task->thing, task->observer, &task->form
+    );
+  }
+}
+
+/* Whether the form kept in task can still be run. Any change to the
+   forms may have moved it. */
+static bool tinywot_task_has_form(struct tinywot_task const *task) {
+  return task->form_status != TINYWOT_STATUS_ERROR_GENERIC
+         && task->forms_generation == task->thing->forms_generation;
+}
+
+#ifdef TINYWOT_ENABLE_FORM_PRIORITY
+/* Get the priority of the form kept in task, or 0 if there is none. */
+static uint_least8_t tinywot_task_form_priority(
+  struct tinywot_task const *task
+) {
+  struct tinywot_form scratch;
+  struct tinywot_form const *form = task->form;
+
+  if (task->form_status != TINYWOT_STATUS_SUCCESS) {
+    return 0;
+  }
+
+  if (task->thing->forms_in_flash) {
+    tinywot_thing_read_form(task->thing, form, &scratch);
+    form = &scratch;
+  }
+
+  return form->priority;
+}
+#endif
+
+/* Queue task, for which there must be space. */
+static void tinywot_scheduler_push(
+  struct tinywot_scheduler *self, struct tinywot_task const *task
+) {
+  size_t position = self->tasks_count_n;
+
+  self->tasks[position] = *task;
+  self->tasks[position].sequence = self->sequence;
+  self->sequence += 1;
+  self->tasks_count_n += 1;
+
+  while (position > 0) {
+    size_t parent = (position - 1) / 2U;
+
+    if (!tinywot_task_before(&self->tasks[position], &self->tasks[parent])) {
+      break;
+    }
+
+    tinywot_task_swap(&self->tasks[position], &self->tasks[parent]);
+    position = parent;
+  }
+}
+
+/* Take the most urgent task out of self, which must not be empty. */
+static void tinywot_scheduler_pop(
+  struct tinywot_scheduler *self, struct tinywot_task *task
+) {
+  size_t position = 0;
+
+  *task = self->tasks[0];
+  self->tasks_count_n -= 1;
+  self->tasks[0] = self->tasks[self->tasks_count_n];
+
+  for (;;) {
+    size_t child = position * 2U + 1U;
+
+    if (child >= self->tasks_count_n) {
+      break;
+    }
+
+    if (child + 1U < self->tasks_count_n
+        && tinywot_task_before(&self->tasks[child + 1U], &self->tasks[child])) {
+      child += 1U;
+    }
+
+    if (!tinywot_task_before(&self->tasks[child], &self->tasks[position])) {
+      break;
+    }
+
+    tinywot_task_swap(&self->tasks[position], &self->tasks[child]);
+    position = child;
+  }
+}
+
+enum tinywot_status tinywot_scheduler_submit(
+  struct tinywot_scheduler *self, struct tinywot_task const *task
+) {
+  struct tinywot_task queued = *task;
+  size_t reserved_n = self->running ? 1U : 0U;
+
+  if (self->tasks_count_n + reserved_n + 1 > self->tasks_max_n) {
+    return TINYWOT_STATUS_ERROR_NOT_ENOUGH_MEMORY;
+  }
+
+  queued.form = NULL;
+  queued.form_status = TINYWOT_STATUS_ERROR_GENERIC;
+
+#ifdef TINYWOT_ENABLE_FORM_PRIORITY
+  /* The form is looked up once here, then run by
+     tinywot_scheduler_run(). */
+  if (queued.type == TINYWOT_TASK_TYPE_REQUEST
+      || queued.type == TINYWOT_TASK_TYPE_NOTIFICATION) {
+    uint_least8_t priority = 0;
+
+    tinywot_task_find_form(&queued);
+    priority = tinywot_task_form_priority(&queued);
+
+    if (priority > queued.priority) {
+      queued.priority = priority;
+    }
+  }
+#endif
+
+  tinywot_scheduler_push(self, &queued);
+
+  return TINYWOT_STATUS_SUCCESS;
+}
+
+enum tinywot_status tinywot_scheduler_run(struct tinywot_scheduler *self) {
+  enum tinywot_status status = TINYWOT_STATUS_ERROR_GENERIC;
+  struct tinywot_task task;
+
+  if (self->tasks_count_n == 0) {
+    return TINYWOT_STATUS_ERROR_NOT_FOUND;
+  }
+
+  tinywot_scheduler_pop(self, &task);
+  self->running = true;
+
+  switch (task.type) {
+    case TINYWOT_TASK_TYPE_REQUEST:
+      if (!tinywot_task_has_form(&task)) {
+        tinywot_task_find_form(&task);
+      }
+
+      status = tinywot_thing_process_request_found(
+        task.thing, task.response, task.request, task.form, task.form_status
+      );
+      break;
+
+    case TINYWOT_TASK_TYPE_NOTIFICATION:
+      if (!tinywot_task_has_form(&task)) {
+        tinywot_task_find_form(&task);
+      }
+
+      status = tinywot_thing_process_notification_found(
+        task.response, task.observer, task.form, task.form_status
+      );
+      break;
+
+    case TINYWOT_TASK_TYPE_FUNCTION:
+      status = task.function(task.context);
+      break;
+
+    default:
+      status = TINYWOT_STATUS_ERROR_NOT_IMPLEMENTED;
+      break;
+  }
+
+  if (task.done) {
+    task.done(&task, status);
+  }
+
+  self->running = false;
+
+  /* The priority has already been worked out. */
+  if (status == TINYWOT_STATUS_NOT_FINISHED) {
+    tinywot_scheduler_push(self, &task);
+  }
+
+  return status;
+}
+
+void tinywot_coalescer_init(
+  struct tinywot_coalescer *self, void *memory, size_t memory_size_byte
+) {
+  self->targets = (struct tinywot_coalesced_target *)memory;
+  self->targets_count_n = 0;
+  self->targets_max_n =
+    memory_size_byte / sizeof(struct tinywot_coalesced_target);
+}
+
+static struct tinywot_coalesced_target *tinywot_coalescer_find(
+  struct tinywot_coalescer *self, char const *target
+) {
+  for (size_t i = 0; i < self->targets_count_n; i++) {
+    if (strcmp(self->targets[i].target, target) == 0) {
+      return &self->targets[i];
+    }
+  }
+
+  return NULL;
+}
+
+enum tinywot_status tinywot_coalescer_add_target(
+  struct tinywot_coalescer *self,
+  char const *target,
+  struct tinywot_coalesce_policy const *policy
+) {
+  struct tinywot_coalesced_target *coalesced = NULL;
+
+  if (tinywot_coalescer_find(self, target)) {
+    return TINYWOT_STATUS_ERROR_NOT_ALLOWED;
+  }
+
+  if (self->targets_count_n >= self->targets_max_n) {
+    return TINYWOT_STATUS_ERROR_NOT_ENOUGH_MEMORY;
+  }
+
+  coalesced = &self->targets[self->targets_count_n];
+  coalesced->target = target;
+  coalesced->policy = policy;
+  coalesced->pending = false;
+  coalesced->notified = false;
+  coalesced->value = 0;
+  coalesced->notified_value = 0;
+  coalesced->pending_since = 0;
+  coalesced->notified_at = 0;
+  self->targets_count_n += 1;
+
+  return TINYWOT_STATUS_SUCCESS;
+}
+
+enum tinywot_status tinywot_coalescer_update(
+  struct tinywot_coalescer *self,
+  char const *target,
+  uint_least32_t value,
+  uint_least32_t now
+) {
+  struct tinywot_coalesced_target *coalesced =
+    tinywot_coalescer_find(self, target);
+  uint_least32_t change = 0;
+
+  if (!coalesced) {
+    return TINYWOT_STATUS_ERROR_NOT_FOUND;
+  }
+
+  coalesced->value = value;
+
+  if (coalesced->pending) {
+    return TINYWOT_STATUS_SUCCESS;
+  }
+
+  change = value > coalesced->notified_value ?
+             value - coalesced->notified_value :
+             coalesced->notified_value - value;
+
+  if (coalesced->notified && change < coalesced->policy->threshold) {
+    return TINYWOT_STATUS_SUCCESS;
+  }
+
+  coalesced->pending = true;
+  coalesced->pending_since = now;
+
+  return TINYWOT_STATUS_SUCCESS;
+}
+
+size_t tinywot_coalescer_drain_events(
+  struct tinywot_coalescer *self,
+  struct tinywot_thing const *thing,
+  struct tinywot_event_ring *ring,
+  uint_least32_t now
+) {
+  struct tinywot_event event;
+  size_t drained_n = 0;
+
+  while (tinywot_event_ring_take(ring, &event) == TINYWOT_STATUS_SUCCESS) {
+    if (tinywot_coalescer_update(self, event.target, event.value, now)
+        != TINYWOT_STATUS_SUCCESS) {
+      tinywot_thing_mark_dirty_value(thing, event.target, &event.value);
+    }
+
+    drained_n += 1;
+  }
+
+  return drained_n;
+}
+
+/* Whether the rate limit of coalesced allows it to be notified at now. */
+static bool tinywot_coalesced_target_allowed(
+  struct tinywot_coalesced_target const *coalesced, uint_least32_t now
+) {
+  return !coalesced->notified
+         || ((now - coalesced->notified_at) & 0xFFFFFFFFUL)
+              >= coalesced->policy->min_interval_ticks;
+}
+
+/* Get when the pending update of coalesced is due. */
+static uint_least32_t tinywot_coalesced_target_due(
+  struct tinywot_coalesced_target const *coalesced
+) {
+  uint_least32_t due =
+    coalesced->pending_since + coalesced->policy->window_ticks;
+  uint_least32_t allowed =
+    coalesced->notified_at + coalesced->policy->min_interval_ticks;
+
+  if (coalesced->notified && tinywot_ticks_before(due, allowed)) {
+    due = allowed;
+  }
+
+  return due & 0xFFFFFFFFUL;
+}
+
+enum tinywot_status tinywot_coalescer_poll(
+  struct tinywot_coalescer *self,
+  struct tinywot_thing const *thing,
+  uint_least32_t now,
+  uint_least32_t *wait_ticks
+) {
+  bool due = false;
+  bool pending = false;
+  uint_least32_t wait = 0;
+
+  for (size_t i = 0; i < self->targets_count_n && !due; i++) {
+    struct tinywot_coalesced_target const *coalesced = &self->targets[i];
+
+    if (coalesced->pending) {
+      due = !tinywot_ticks_before(now, tinywot_coalesced_target_due(coalesced));
+    }
+  }
+
+  for (size_t i = 0; i < self->targets_count_n; i++) {
+    struct tinywot_coalesced_target *coalesced = &self->targets[i];
+    uint_least32_t remaining = 0;
+
+    if (!coalesced->pending) {
+      continue;
+    }
+
+    if (due && tinywot_coalesced_target_allowed(coalesced, now)) {
+      tinywot_thing_mark_dirty_value(
+        thing, coalesced->target, &coalesced->value
+      );
+      coalesced->pending = false;
+      coalesced->notified = true;
+      coalesced->notified_value = coalesced->value;
+      coalesced->notified_at = now;
+      continue;
+    }
+
+    remaining = (tinywot_coalesced_target_due(coalesced) - now) & 0xFFFFFFFFUL;
+
+    if (!pending || remaining < wait) {
+      wait = remaining;
+    }
+
+    pending = true;
+  }
+
+  if (!pending) {
+    return TINYWOT_STATUS_ERROR_NOT_FOUND;
+  }
+
+  *wait_ticks = wait;
+
+  return TINYWOT_STATUS_SUCCESS;
+}
@@ -0,0 +1,1131 @@
+/*
+  SPDX-FileCopyrightText: 2023 Junde Yhi <junde@yhi.moe>
+  SPDX-License-Identifier: MIT
+*/
+
+/*!
+  \file
+  \brief TinyWoT Core JSON writer implementation.
+*/
+
+#include <limits.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+
+#include <tinywot/core.h>
+#include <tinywot/json.h>
+
+/* Enough for the digits of an unsigned long (at most 64 bits), a sign,
+   and a decimal point. */
+#define TINYWOT_JSON_NUMBER_BUFFER_SIZE_BYTE 24U
+
+/*
+  Start a write: fail early on an earlier error, and remember where the
+  payload was.
+*/
+static enum tinywot_status tinywot_json_begin(
+  struct tinywot_json_writer *self, struct tinywot_payload_mark *mark
+) {
+  tinywot_payload_mark(self->payload, mark);
+
+  if (tinywot_status_is_error(self->status)) {
+    return self->status;
+  }
+
+  if (self->need_comma) {
+    return tinywot_payload_append(self->payload, ",", 1);
+  }
+
+  return TINYWOT_STATUS_SUCCESS;
+}
+
+/*
+  Finish a write: undo it and make the error sticky on failure, or
+  update the comma state on success.
+*/
+static enum tinywot_status tinywot_json_end(
+  struct tinywot_json_writer *self,
+  struct tinywot_payload_mark const *mark,
+  enum tinywot_status status,
+  bool need_comma
+) {
+  if (tinywot_status_is_error(status)) {
+    tinywot_payload_rollback(self->payload, mark);
+    self->status = status;
+  } else {
+    self->need_comma = need_comma;
+  }
+
+  return status;
+}
+
+/*
+  Write one token (with a comma before it if needed) atomically.
+*/
+static enum tinywot_status tinywot_json_write_token(
+  struct tinywot_json_writer *self,
+  void const *data,
+  size_t data_size_byte,
+  bool separated,
+  bool need_comma
+) {
+  struct tinywot_payload_mark mark;
+  enum tinywot_status status = TINYWOT_STATUS_SUCCESS;
+
+  if (separated) {
+    status = tinywot_json_begin(self, &mark);
+  } else if (tinywot_status_is_error(self->status)) {
+    return self->status;
+  } else {
+    tinywot_payload_mark(self->payload, &mark);
+  }
+
+  if (!tinywot_status_is_error(status)) {
+    status = tinywot_payload_append(self->payload, data, data_size_byte);
+  }
+
+  return tinywot_json_end(self, &mark, status, need_comma);
+}
+
+/*
+  Write the decimal digits of value backwards, ending right before end.
+  Return a pointer to the first digit.
+*/
+static char *tinywot_json_format_ulong(char *end, unsigned long value) {
+  do {
+    *--end = (char)('0' + (value % 10U));
+    value /= 10U;
+  } while (value > 0);
+
+  return end;
+}
+
+/*
+  Append a string with escapes and quotes, without a comma.
+*/
+static enum tinywot_status tinywot_json_append_string(
+  struct tinywot_payload *payload, char const *str, size_t str_length_byte
+) {
+  static char const hex[] = "0123456789abcdef";
+  enum tinywot_status status = TINYWOT_STATUS_SUCCESS;
+  char const *run = str;
+
+  status = tinywot_payload_append(payload, "\"", 1);
+
+  for (size_t i = 0; i < str_length_byte; i++) {
+    unsigned char c = (unsigned char)str[i];
+    char escape[6] = {'\\', 0, 0, 0, 0, 0};
+    size_t escape_length_byte = 2;
+
+    if (tinywot_status_is_error(status)) {
+      return status;
+    }
+
+    switch (c) {
+      case '"':
+      case '\\':
+        escape[1] = (char)c;
+        break;
+
+      case '\b':
+        escape[1] = 'b';
+        break;
+
+      case '\f':
+        escape[1] = 'f';
+        break;
+
+      case '\n':
+        escape[1] = 'n';
+        break;
+
+      case '\r':
+        escape[1] = 'r';
+        break;
+
+      case '\t':
+        escape[1] = 't';
+        break;
+
+      default:
+        if (c >= 0x20) {
+          continue;
+        }
+
+        escape[1] = 'u';
+        escape[2] = '0';
+        escape[3] = '0';
+        escape[4] = hex[c >> 4];
+        escape[5] = hex[c & 0xf];
+        escape_length_byte = 6;
+        break;
+    }
+
+    /* Characters not needing an escape are appended in runs. */
+    status = tinywot_payload_append(payload, run, (size_t)(&str[i] - run));
+    run = &str[i + 1];
+
+    if (!tinywot_status_is_error(status)) {
+      status = tinywot_payload_append(payload, escape, escape_length_byte);
+    }
+  }
+
+  if (!tinywot_status_is_error(status)) {
+    status = tinywot_payload_append(
+      payload, run, (size_t)(&str[str_length_byte] - run)
+    );
+  }
+
+  if (!tinywot_status_is_error(status)) {
+    status = tinywot_payload_append(payload, "\"", 1);
+  }
+
+  return status;
+}
+
+void tinywot_json_writer_init(
+  struct tinywot_json_writer *self, struct tinywot_payload *payload
+) {
+  self->payload = payload;
+  self->status = TINYWOT_STATUS_SUCCESS;
+  self->need_comma = false;
+}
+
+enum tinywot_status tinywot_json_write_object_begin(
+  struct tinywot_json_writer *self
+) {
+  return tinywot_json_write_token(self, "{", 1, true, false);
+}
+
+enum tinywot_status tinywot_json_write_object_end(
+  struct tinywot_json_writer *self
+) {
+  return tinywot_json_write_token(self, "}", 1, false, true);
+}
+
+enum tinywot_status tinywot_json_write_array_begin(
+  struct tinywot_json_writer *self
+) {
+  return tinywot_json_write_token(self, "[", 1, true, false);
+}
+
+enum tinywot_status tinywot_json_write_array_end(
+  struct tinywot_json_writer *self
+) {
+  return tinywot_json_write_token(self, "]", 1, false, true);
+}
+
+enum tinywot_status tinywot_json_write_key(
+  struct tinywot_json_writer *self, char const *key
+) {
+  struct tinywot_payload_mark mark;
+  enum tinywot_status status = tinywot_json_begin(self, &mark);
+
+  if (tinywot_status_is_error(self->status)) {
+    return status;
+  }
+
+  if (!tinywot_status_is_error(status)) {
+    status = tinywot_json_append_string(self->payload, key, strlen(key));
+  }
+
+  if (!tinywot_status_is_error(status)) {
+    status = tinywot_payload_append(self->payload, ":", 1);
+  }
+
+  return tinywot_json_end(self, &mark, status, false);
+}
+
+enum tinywot_status tinywot_json_write_string(
+  struct tinywot_json_writer *self, char const *str
+) {
+  return tinywot_json_write_string_n(self, str, strlen(str));
+}
+
+enum tinywot_status tinywot_json_write_string_n(
+  struct tinywot_json_writer *self, char const *str, size_t str_length_byte
+) {
+  struct tinywot_payload_mark mark;
+  enum tinywot_status status = tinywot_json_begin(self, &mark);
+
+  if (tinywot_status_is_error(self->status)) {
+    return status;
+  }
+
+  if (!tinywot_status_is_error(status)) {
+    status = tinywot_json_append_string(self->payload, str, str_length_byte);
+  }
+
+  return tinywot_json_end(self, &mark, status, true);
+}
+
+enum tinywot_status tinywot_json_write_int(
+  struct tinywot_json_writer *self, long value
+) {
+  char buf[TINYWOT_JSON_NUMBER_BUFFER_SIZE_BYTE];
+  char *end = buf + sizeof(buf);
+  char *head = NULL;
+
+  /* Negate in unsigned arithmetic, so LONG_MIN does not overflow. */
+  if (value < 0) {
+    head = tinywot_json_format_ulong(end, 0UL - (unsigned long)value);
+    *--head = '-';
+  } else {
+    head = tinywot_json_format_ulong(end, (unsigned long)value);
+  }
+
+  return tinywot_json_write_token(
+    self, head, (size_t)(end - head), true, true
+  );
+}
+
+enum tinywot_status tinywot_json_write_uint(
+  struct tinywot_json_writer *self, unsigned long value
+) {
+  char buf[TINYWOT_JSON_NUMBER_BUFFER_SIZE_BYTE];
+  char *end = buf + sizeof(buf);
+  char *head = tinywot_json_format_ulong(end, value);
+
+  return tinywot_json_write_token(
+    self, head, (size_t)(end - head), true, true
+  );
+}
+
+enum tinywot_status tinywot_json_write_float(
+  struct tinywot_json_writer *self, double value, unsigned int decimals_n
+) {
+  static unsigned long const scales[TINYWOT_JSON_FLOAT_DECIMALS_MAX_N + 1]
+    = {1UL, 10UL, 100UL, 1000UL, 10000UL, 100000UL, 1000000UL};
+  char buf[TINYWOT_JSON_NUMBER_BUFFER_SIZE_BYTE];
+  char *end = buf + sizeof(buf);
+  char *head = end;
+  bool negative = value < 0;
+  unsigned long scale = 0;
+  unsigned long scaled = 0;
+  double rounded = 0;
+
+  if (tinywot_status_is_error(self->status)) {
+    return self->status;
+  }
+
+  if (decimals_n > TINYWOT_JSON_FLOAT_DECIMALS_MAX_N) {
+    self->status = TINYWOT_STATUS_ERROR_NOT_ALLOWED;
+    return self->status;
+  }
+
+  /* NaN is the only value not equal to itself; infinities are out of
+     the range of any finite value. */
+  if (value != value || value - value != 0) {
+    return tinywot_json_write_null(self);
+  }
+
+  scale = scales[decimals_n];
+  rounded = (negative ? -value : value) * (double)scale + 0.5;
+
+  if (rounded >= (double)ULONG_MAX) {
+    self->status = TINYWOT_STATUS_ERROR_NOT_ALLOWED;
+    return self->status;
+  }
+
+  scaled = (unsigned long)rounded;
+
+  if (decimals_n > 0) {
+    unsigned long fraction = scaled % scale;
+
+    for (unsigned int i = 0; i < decimals_n; i++) {
+      *--head = (char)('0' + (fraction % 10U));
+      fraction /= 10U;
+    }
+
+    *--head = '.';
+  }
+
+  head = tinywot_json_format_ulong(head, scaled / scale);
+
+  /* Do not write -0 when a small negative value is rounded to 0. */
+  if (negative && scaled > 0) {
+    *--head = '-';
+  }
+
+  return tinywot_json_write_token(
+    self, head, (size_t)(end - head), true, true
+  );
+}
+
+enum tinywot_status tinywot_json_write_bool(
+  struct tinywot_json_writer *self, bool value
+) {
+  if (value) {
+    return tinywot_json_write_token(self, "true", 4, true, true);
+  } else {
+    return tinywot_json_write_token(self, "false", 5, true, true);
+  }
+}
+
+enum tinywot_status tinywot_json_write_null(struct tinywot_json_writer *self) {
+  return tinywot_json_write_token(self, "null", 4, true, true);
+}
+
+enum tinywot_status tinywot_json_write_raw(
+  struct tinywot_json_writer *self, void const *data, size_t data_size_byte
+) {
+  return tinywot_json_write_token(self, data, data_size_byte, true, true);
+}
+
+/*
+  Read one property into the object being written by writer. Return
+  SUCCESS if the property has been written or skipped.
+*/
+static enum tinywot_status tinywot_json_batch_read(
+  struct tinywot_json_writer *writer,
+  struct tinywot_json_batch const *batch,
+  struct tinywot_form const *form
+) {
+  struct tinywot_payload *pl = writer->payload;
+  struct tinywot_payload_mark mark;
+  enum tinywot_status status = TINYWOT_STATUS_ERROR_GENERIC;
+  struct tinywot_request request = {0};
+  struct tinywot_response response = {0};
+  unsigned char const *value = NULL;
+  size_t value_length_byte = 0;
+  bool need_comma = false;
+
+  /* The key is written first, so a failed property needs undoing. */
+  tinywot_payload_mark(writer->payload, &mark);
+  need_comma = writer->need_comma;
+  status = tinywot_json_write_key(writer, form->name);
+
+  if (tinywot_status_is_error(status)) {
+    return status;
+  }
+
+  /* The handler writes its value right after the key. */
+  response.payload.content = (unsigned char *)(pl->content)
+                             + pl->content_length_byte;
+  response.payload.content_buffer_size_byte =
+    pl->content_buffer_size_byte - pl->content_length_byte;
+
+  request.op = TINYWOT_OPERATION_TYPE_READPROPERTY;
+
+  request.target_view = form->target;
+  request.target_view_length_byte = strlen(form->target);
+
+#if TINYWOT_REQUEST_TARGET_BUFFER_SIZE_BYTE > 0
+  if (request.target_view_length_byte < sizeof(request.target)) {
+    memcpy(
+      request.target, form->target, request.target_view_length_byte + 1
+    );
+  }
+#endif
+
+  status = form->handler ?
+    form->handler(&response.payload, &request.payload, form->context) :
+    TINYWOT_STATUS_ERROR_NOT_IMPLEMENTED;
+
+  if (status == TINYWOT_STATUS_SUCCESS) {
+    value = (unsigned char const *)response.payload.content;
+    value_length_byte = response.payload.content_length_byte;
+
+    while (value_length_byte > 0 && value[value_length_byte - 1] == '\0') {
+      value_length_byte -= 1;
+    }
+
+    if (value_length_byte == 0
+        || response.payload.content_type != batch->content_type) {
+      status = TINYWOT_STATUS_ERROR_GENERIC;
+    }
+  } else if (status == TINYWOT_STATUS_NOT_FINISHED) {
+    status = TINYWOT_STATUS_ERROR_GENERIC;
+  }
+
+  if (status == TINYWOT_STATUS_SUCCESS) {
+    /* A handler may point content to its own memory instead of copying
+       (e.g. when there is no space), so copy it in that case. */
+    if (value != (unsigned char const *)(pl->content)
+                   + pl->content_length_byte) {
+      status = tinywot_payload_append(pl, value, value_length_byte);
+    } else {
+      pl->content_length_byte += value_length_byte;
+    }
+  }
+
+  if (status == TINYWOT_STATUS_SUCCESS) {
+    writer->need_comma = true;
+    return TINYWOT_STATUS_SUCCESS;
+  }
+
+  tinywot_payload_rollback(writer->payload, &mark);
+  writer->need_comma = need_comma;
+
+  if (batch->policy == TINYWOT_JSON_BATCH_POLICY_SKIP
+      && status != TINYWOT_STATUS_ERROR_NOT_ENOUGH_MEMORY) {
+    return TINYWOT_STATUS_SUCCESS;
+  }
+
+  writer->status = status;
+  return status;
+}
+
+/*
+  Start a batch result, or fail on payloads the batch cannot write into.
+*/
+static enum tinywot_status tinywot_json_batch_begin(
+  struct tinywot_json_writer *writer, struct tinywot_payload *payload
+) {
+  /* tinywot_json_batch_end() needs the payload even on failure. */
+  tinywot_json_writer_init(writer, payload);
+
+  /* Handlers write straight into content, which only works when content
+     is the whole payload. */
+  if (payload->segments) {
+    return TINYWOT_STATUS_ERROR_NOT_IMPLEMENTED;
+  }
+
+  payload->content_length_byte = 0;
+
+  return tinywot_json_write_object_begin(writer);
+}
+
+static enum tinywot_status tinywot_json_batch_end(
+  struct tinywot_json_writer *writer,
+  struct tinywot_json_batch const *batch,
+  enum tinywot_status status
+) {
+  struct tinywot_payload *pl = writer->payload;
+
+  if (status == TINYWOT_STATUS_SUCCESS) {
+    status = tinywot_json_write_object_end(writer);
+  }
+
+  if (status == TINYWOT_STATUS_SUCCESS) {
+    pl->content_type = batch->content_type;
+  } else {
+    pl->content_length_byte = 0;
+  }
+
+  return status;
+}
+
+/*
+  Whether form is the readproperty form that its target resolves to, and
+  not one overridden by a form added later.
+*/
+static bool tinywot_json_batch_resolves(
+  struct tinywot_thing const *thing, struct tinywot_form const *form
+) {
+  struct tinywot_form *found = NULL;
+
+  return tinywot_thing_find_form(
+           thing, &found, form->target, TINYWOT_OPERATION_TYPE_READPROPERTY
+         ) == TINYWOT_STATUS_SUCCESS
+         && found == form;
+}
+
+enum tinywot_status tinywot_json_handler_read_all_properties(
+  struct tinywot_payload *response_payload,
+  struct tinywot_payload *request_payload,
+  void *context
+) {
+  struct tinywot_json_batch const *batch =
+    (struct tinywot_json_batch const *)context;
+  struct tinywot_thing const *thing = batch->thing;
+  struct tinywot_json_writer writer;
+  enum tinywot_status status = TINYWOT_STATUS_ERROR_GENERIC;
+
+  (void)request_payload;
+
+  /* Names would have to be read from program memory. */
+  if (thing->forms_in_flash) {
+    return TINYWOT_STATUS_ERROR_NOT_IMPLEMENTED;
+  }
+
+  status = tinywot_json_batch_begin(&writer, response_payload);
+
+  for (size_t i = 0;
+       i < thing->forms_count_n && status == TINYWOT_STATUS_SUCCESS;
+       i++) {
+    struct tinywot_form const *form = &thing->forms[i];
+
+    /* Removed forms have an UNKNOWN op, so they are skipped here too. */
+    if (tinywot_form_accepts(form, TINYWOT_OPERATION_TYPE_READPROPERTY)
+        && form->name && tinywot_json_batch_resolves(thing, form)) {
+      status = tinywot_json_batch_read(&writer, batch, form);
+    }
+  }
+
+  return tinywot_json_batch_end(&writer, batch, status);
+}
+
+/*
+  Skip JSON whitespace from p, but not beyond end.
+*/
+static char const *tinywot_json_skip_space(char const *p, char const *end) {
+  while (p < end && (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r')) {
+    p++;
+  }
+
+  return p;
+}
+
+/*
+  Find the readproperty form of a property by its name.
+*/
+static struct tinywot_form const *tinywot_json_batch_find(
+  struct tinywot_thing const *thing, char const *name, size_t name_length_byte
+) {
+  for (size_t i = thing->forms_count_n; i > 0; i--) {
+    struct tinywot_form const *form = &thing->forms[i - 1];
+
+    if (tinywot_form_accepts(form, TINYWOT_OPERATION_TYPE_READPROPERTY)
+        && form->name
+        && strncmp(form->name, name, name_length_byte) == 0
+        && form->name[name_length_byte] == '\0'
+        && tinywot_json_batch_resolves(thing, form)) {
+      return form;
+    }
+  }
+
+  return NULL;
+}
+
+enum tinywot_status tinywot_json_handler_read_multiple_properties(
+  struct tinywot_payload *response_payload,
+  struct tinywot_payload *request_payload,
+  void *context
+) {
+  struct tinywot_json_batch const *batch =
+    (struct tinywot_json_batch const *)context;
+  struct tinywot_json_writer writer;
+  enum tinywot_status status = TINYWOT_STATUS_ERROR_GENERIC;
+  char const *p = (char const *)request_payload->content;
+  char const *end = p + request_payload->content_length_byte;
+
+  if (batch->thing->forms_in_flash) {
+    return TINYWOT_STATUS_ERROR_NOT_IMPLEMENTED;
+  }
+
+  status = tinywot_json_batch_begin(&writer, response_payload);
+
+  if (status != TINYWOT_STATUS_SUCCESS) {
+    return tinywot_json_batch_end(&writer, batch, status);
+  }
+
+  p = tinywot_json_skip_space(p, end);
+
+  if (p == end || *p != '[') {
+    return tinywot_json_batch_end(
+      &writer, batch, TINYWOT_STATUS_ERROR_NOT_ALLOWED
+    );
+  }
+
+  p = tinywot_json_skip_space(p + 1, end);
+
+  if (p < end && *p == ']') {
+    return tinywot_json_batch_end(&writer, batch, status);
+  }
+
+  while (status == TINYWOT_STATUS_SUCCESS) {
+    char const *name = NULL;
+    struct tinywot_form const *form = NULL;
+
+    if (p == end || *p != '"') {
+      status = TINYWOT_STATUS_ERROR_NOT_ALLOWED;
+      break;
+    }
+
+    name = ++p;
+
+    while (p < end && *p != '"' && *p != '\\') {
+      p++;
+    }
+
+    if (p == end || *p != '"') {
+      status = TINYWOT_STATUS_ERROR_NOT_ALLOWED;
+      break;
+    }
+
+    form = tinywot_json_batch_find(batch->thing, name, (size_t)(p - name));
+
+    if (form) {
+      status = tinywot_json_batch_read(&writer, batch, form);
+    } else if (batch->policy == TINYWOT_JSON_BATCH_POLICY_ABORT) {
+      status = TINYWOT_STATUS_ERROR_NOT_FOUND;
+    }
+
+    p = tinywot_json_skip_space(p + 1, end);
+
+    if (p < end && *p == ',') {
+      p = tinywot_json_skip_space(p + 1, end);
+    } else if (p < end && *p == ']') {
+      break;
+    } else if (status == TINYWOT_STATUS_SUCCESS) {
+      status = TINYWOT_STATUS_ERROR_NOT_ALLOWED;
+    }
+  }
+
+  return tinywot_json_batch_end(&writer, batch, status);
+}
+
+/* The names of operation types in a TD, by tinywot_operation_type. */
+static char const *const tinywot_json_td_op_names[] = {
+  NULL,
+  "readproperty",
+  "writeproperty",
+  "observeproperty",
+  "unobserveproperty",
+  "invokeaction",
+  "queryaction",
+  "cancelaction",
+  "subscribeevent",
+  "unsubscribeevent",
+  "readallproperties",
+  "writeallproperties",
+  "readmultipleproperties",
+  "writemultipleproperties",
+  "observeallproperties",
+  "unobserveallproperties",
+  "queryallactions",
+  "subscribeallevents",
+  "unsubscribeallevents",
+};
+
+/* The keys of the kinds of affordances in a TD. */
+static char const *const tinywot_json_td_kind_keys[] = {
+  NULL,
+  "properties",
+  "actions",
+  "events",
+};
+
+/*
+  Get the kind of affordance (an index of tinywot_json_td_kind_keys) that
+  form belongs to, or 0 for the top level. Removed forms are -1.
+*/
+static int tinywot_json_td_kind(struct tinywot_form const *form) {
+  switch (form->op) {
+    case TINYWOT_OPERATION_TYPE_UNKNOWN:
+      return -1;
+
+    case TINYWOT_OPERATION_TYPE_READPROPERTY:
+    case TINYWOT_OPERATION_TYPE_WRITEPROPERTY:
+    case TINYWOT_OPERATION_TYPE_OBSERVEPROPERTY:
+    case TINYWOT_OPERATION_TYPE_UNOBSERVEPROPERTY:
+      return form->name ? 1 : 0;
+
+    case TINYWOT_OPERATION_TYPE_INVOKEACTION:
+    case TINYWOT_OPERATION_TYPE_QUERYACTION:
+    case TINYWOT_OPERATION_TYPE_CANCELACTION:
+      return form->name ? 2 : 0;
+
+    case TINYWOT_OPERATION_TYPE_SUBSCRIBEEVENT:
+    case TINYWOT_OPERATION_TYPE_UNSUBSCRIBEEVENT:
+      return form->name ? 3 : 0;
+
+    default:
+      return 0;
+  }
+}
+
+/*
+  Whether two strings that may be NULL are the same.
+*/
+static bool tinywot_json_td_same(char const *a, char const *b) {
+  return a == b || (a && b && strcmp(a, b) == 0);
+}
+
+/*
+  Whether the forms at positions of thing belong to the same affordance
+  (or both to the top level).
+*/
+static bool tinywot_json_td_same_affordance(
+  struct tinywot_thing const *thing, size_t a, size_t b
+) {
+  struct tinywot_form const *form_a = &thing->forms[a];
+  struct tinywot_form const *form_b = &thing->forms[b];
+  int kind = tinywot_json_td_kind(form_a);
+
+  return kind == tinywot_json_td_kind(form_b)
+         && (kind == 0 || tinywot_json_td_same(form_a->name, form_b->name));
+}
+
+/*
+  Whether the form at position i has been written, as marked in marks, a
+  bit for each form.
+*/
+static bool tinywot_json_td_marked(unsigned char const *marks, size_t i) {
+  return (marks[i / CHAR_BIT] & (1U << (i % CHAR_BIT))) != 0;
+}
+
+static void tinywot_json_td_mark(unsigned char *marks, size_t i) {
+  marks[i / CHAR_BIT] |= (unsigned char)(1U << (i % CHAR_BIT));
+}
+
+/*
+  Write the names of all operation types of form.
+*/
+static void tinywot_json_td_write_ops(
+  struct tinywot_json_writer *writer, struct tinywot_form const *form
+) {
+  size_t names_n =
+    sizeof(tinywot_json_td_op_names) / sizeof(tinywot_json_td_op_names[0]);
+
+  if ((size_t)form->op < names_n) {
+    tinywot_json_write_string(writer, tinywot_json_td_op_names[form->op]);
+  }
+
+  for (size_t op = 1; op < names_n; op++) {
+    if (op != (size_t)form->op
+        && (form->ops & TINYWOT_OPERATION_TYPE_BIT(op)) != 0) {
+      tinywot_json_write_string(writer, tinywot_json_td_op_names[op]);
+    }
+  }
+}
+
+/*
+  Write the forms of the affordance of the form at position first of
+  thing, one for each target with all its operation types. Every form
+  written is marked in marks, so that it is skipped from then on.
+*/
+static void tinywot_json_td_write_forms(
+  struct tinywot_json_writer *writer,
+  struct tinywot_thing const *thing,
+  size_t first,
+  unsigned char *marks
+) {
+  tinywot_json_write_key(writer, "forms");
+  tinywot_json_write_array_begin(writer);
+
+  for (size_t i = first; i < thing->forms_count_n; i++) {
+    if (tinywot_json_td_marked(marks, i)
+        || !tinywot_json_td_same_affordance(thing, first, i)) {
+      continue;
+    }
+
+    tinywot_json_write_object_begin(writer);
+    tinywot_json_write_key(writer, "href");
+    tinywot_json_write_string(writer, thing->forms[i].target);
+    tinywot_json_write_key(writer, "op");
+    tinywot_json_write_array_begin(writer);
+
+    for (size_t j = i; j < thing->forms_count_n; j++) {
+      struct tinywot_form const *form = &thing->forms[j];
+
+      if (!tinywot_json_td_marked(marks, j)
+          && tinywot_json_td_same_affordance(thing, i, j)
+          && strcmp(form->target, thing->forms[i].target) == 0) {
+        tinywot_json_td_write_ops(writer, form);
+        tinywot_json_td_mark(marks, j);
+      }
+    }
+
+    tinywot_json_write_array_end(writer);
+    tinywot_json_write_object_end(writer);
+  }
+
+  tinywot_json_write_array_end(writer);
+}
+
+/*
+  Write the whole TD of self, with marks holding a cleared bit for each
+  form.
+*/
+static void tinywot_json_td_write(
+  struct tinywot_json_writer *writer,
+  struct tinywot_json_td const *self,
+  unsigned char *marks
+) {
+  struct tinywot_thing const *thing = self->thing;
+  size_t top_level = thing->forms_count_n;
+
+  tinywot_json_write_object_begin(writer);
+  tinywot_json_write_key(writer, "@context");
+  tinywot_json_write_string(writer, "https://www.w3.org/2022/wot/td/v1.1");
+  tinywot_json_write_key(writer, "title");
+  tinywot_json_write_string(writer, self->title);
+
+  if (self->base) {
+    tinywot_json_write_key(writer, "base");
+    tinywot_json_write_string(writer, self->base);
+  }
+
+  tinywot_json_write_key(writer, "securityDefinitions");
+  tinywot_json_write_raw(
+    writer,
+    "{\"nosec_sc\":{\"scheme\":\"nosec\"}}",
+    sizeof("{\"nosec_sc\":{\"scheme\":\"nosec\"}}") - 1
+  );
+  tinywot_json_write_key(writer, "security");
+  tinywot_json_write_string(writer, "nosec_sc");
+
+  for (int kind = 1; kind <= 3; kind++) {
+    bool begun = false;
+
+    for (size_t i = 0; i < thing->forms_count_n; i++) {
+      struct tinywot_form const *form = &thing->forms[i];
+
+      /* Forms of an affordance already written are marked. */
+      if (tinywot_json_td_kind(form) != kind
+          || tinywot_json_td_marked(marks, i)) {
+        continue;
+      }
+
+      if (!begun) {
+        tinywot_json_write_key(writer, tinywot_json_td_kind_keys[kind]);
+        tinywot_json_write_object_begin(writer);
+        begun = true;
+      }
+
+      tinywot_json_write_key(writer, form->name);
+      tinywot_json_write_object_begin(writer);
+      tinywot_json_td_write_forms(writer, thing, i, marks);
+      tinywot_json_write_object_end(writer);
+    }
+
+    if (begun) {
+      tinywot_json_write_object_end(writer);
+    }
+  }
+
+  for (size_t i = 0; i < thing->forms_count_n; i++) {
+    if (tinywot_json_td_kind(&thing->forms[i]) == 0) {
+      top_level = i;
+      break;
+    }
+  }
+
+  if (top_level < thing->forms_count_n) {
+    tinywot_json_td_write_forms(writer, thing, top_level, marks);
+  }
+
+  tinywot_json_write_object_end(writer);
+}
+
+void tinywot_json_td_init(
+  struct tinywot_json_td *self,
+  struct tinywot_thing const *thing,
+  char const *title,
+  char const *base,
+  uint_fast16_t content_type,
+  void *memory,
+  size_t memory_size_byte
+) {
+  self->thing = thing;
+  self->title = title;
+  self->base = base;
+  self->content_type = content_type;
+  self->content = (unsigned char *)memory;
+  self->content_buffer_size_byte = memory_size_byte;
+  self->content_length_byte = 0;
+  self->generation = 0;
+  self->version = 0;
+}
+
+enum tinywot_status tinywot_json_td_update(struct tinywot_json_td *self) {
+  struct tinywot_payload payload = {0};
+  struct tinywot_json_writer writer;
+  size_t marks_size_byte = 0;
+  unsigned char *marks = NULL;
+
+  if (self->content_length_byte != 0
+      && self->generation == self->thing->forms_generation) {
+    return TINYWOT_STATUS_SUCCESS;
+  }
+
+  /* Names and targets would have to be read from program memory. */
+  if (self->thing->forms_in_flash) {
+    return TINYWOT_STATUS_ERROR_NOT_IMPLEMENTED;
+  }
+
+  /* The marks of written forms are kept at the end of content, after
+     the room for the TD. */
+  marks_size_byte = (self->thing->forms_count_n + CHAR_BIT - 1) / CHAR_BIT;
+
+  if (self->content_buffer_size_byte < marks_size_byte) {
+    self->content_length_byte = 0;
+
+    return TINYWOT_STATUS_ERROR_NOT_ENOUGH_MEMORY;
+  }
+
+  marks =
+    self->content + (self->content_buffer_size_byte - marks_size_byte);
+  memset(marks, 0, marks_size_byte);
+
+  payload.content = self->content;
+  payload.content_buffer_size_byte =
+    self->content_buffer_size_byte - marks_size_byte;
+
+  tinywot_json_writer_init(&writer, &payload);
+  tinywot_json_td_write(&writer, self, marks);
+
+  if (writer.status != TINYWOT_STATUS_SUCCESS) {
+    self->content_length_byte = 0;
+
+    return writer.status;
+  }
+
+  self->content_length_byte = payload.content_length_byte;
+  self->generation = self->thing->forms_generation;
+
+  /* 0 is never sent, as it means no ETag in a request. */
+  self->version += 1;
+  if (self->version == 0) {
+    self->version = 1;
+  }
+
+  return TINYWOT_STATUS_SUCCESS;
+}
+
+enum tinywot_status tinywot_json_td_handler(
+  struct tinywot_payload *response_payload,
+  struct tinywot_payload *request_payload,
+  void *context
+) {
+  struct tinywot_json_td *self = (struct tinywot_json_td *)context;
+  struct tinywot_response *response =
+    tinywot_response_of_payload(response_payload);
+  struct tinywot_request const *request =
+    tinywot_request_of_payload(request_payload);
+  size_t remaining_byte = 0;
+  size_t block_byte = 0;
+
+  if (response->offset_byte == 0) {
+    enum tinywot_status status = tinywot_json_td_update(self);
+
+    if (status != TINYWOT_STATUS_SUCCESS) {
+      return status;
+    }
+  }
+
+  /* Another request may have generated a new TD since the first block. */
+  if (response->offset_byte > 0 && tinywot_request_get_etag(request) != 0
+      && tinywot_request_get_etag(request) != self->version) {
+    return TINYWOT_STATUS_ERROR_VERSION_MISMATCH;
+  }
+
+  if (self->content_length_byte == 0
+      || response->offset_byte > self->content_length_byte) {
+    return TINYWOT_STATUS_ERROR_NOT_ALLOWED;
+  }
+
+  response->etag = self->version;
+  response_payload->content_type = self->content_type;
+
+  if (response->offset_byte == 0
+      && tinywot_request_get_etag(request) == self->version) {
+    response_payload->content_length_byte = 0;
+    return TINYWOT_STATUS_NOT_MODIFIED;
+  }
+
+  remaining_byte = self->content_length_byte - response->offset_byte;
+
+  if (response_payload->content_buffer_size_byte == 0) {
+    response_payload->content = self->content + response->offset_byte;
+    response_payload->content_length_byte = remaining_byte;
+
+    return TINYWOT_STATUS_SUCCESS;
+  }
+
+  block_byte = remaining_byte < response_payload->content_buffer_size_byte ?
+    remaining_byte : response_payload->content_buffer_size_byte;
+
+  memcpy(
+    response_payload->content,
+    self->content + response->offset_byte,
+    block_byte
+  );
+  response_payload->content_length_byte = block_byte;
+
+  return block_byte < remaining_byte ?
+    TINYWOT_STATUS_NOT_FINISHED : TINYWOT_STATUS_SUCCESS;
+}
+
+#ifdef TINYWOT_ENABLE_INSTRUMENTATION
+/*
+  Write the statistics of one form as a JSON object.
+*/
+static void tinywot_json_write_form_stats(
+  struct tinywot_json_writer *writer,
+  struct tinywot_form const *form,
+  struct tinywot_form_stats const *stats
+) {
+  tinywot_json_write_object_begin(writer);
+  tinywot_json_write_key(writer, "target");
+  tinywot_json_write_string(writer, form->target);
+  tinywot_json_write_key(writer, "op");
+  tinywot_json_write_uint(writer, (unsigned long)form->op);
+  tinywot_json_write_key(writer, "hits");
+  tinywot_json_write_uint(writer, (unsigned long)stats->hits_n);
+  tinywot_json_write_key(writer, "errors");
+  tinywot_json_write_uint(writer, (unsigned long)stats->errors_n);
+  tinywot_json_write_key(writer, "latencies");
+  tinywot_json_write_array_begin(writer);
+
+  for (size_t i = 0; i < TINYWOT_INSTRUMENTATION_LATENCY_BUCKETS_N; i++) {
+    tinywot_json_write_uint(writer, (unsigned long)stats->latencies_n[i]);
+  }
+
+  tinywot_json_write_array_end(writer);
+  tinywot_json_write_object_end(writer);
+}
+
+enum tinywot_status tinywot_json_handler_read_instrumentation(
+  struct tinywot_payload *response_payload,
+  struct tinywot_payload *request_payload,
+  void *context
+) {
+  struct tinywot_json_batch const *batch =
+    (struct tinywot_json_batch const *)context;
+  struct tinywot_thing const *thing = batch->thing;
+  struct tinywot_instrumentation const *instrumentation =
+    thing->instrumentation;
+  struct tinywot_json_writer writer;
+
+  (void)request_payload;
+
+  /* Targets would have to be read from program memory. */
+  if (!instrumentation || thing->forms_in_flash) {
+    return TINYWOT_STATUS_ERROR_NOT_IMPLEMENTED;
+  }
+
+  response_payload->content_length_byte = 0;
+  tinywot_json_writer_init(&writer, response_payload);
+
+  tinywot_json_write_object_begin(&writer);
+  tinywot_json_write_key(&writer, "lookups");
+  tinywot_json_write_uint(&writer, (unsigned long)instrumentation->lookups_n);
+  tinywot_json_write_key(&writer, "notFound");
+  tinywot_json_write_uint(
+    &writer, (unsigned long)instrumentation->not_found_n
+  );
+  tinywot_json_write_key(&writer, "notAllowed");
+  tinywot_json_write_uint(
+    &writer, (unsigned long)instrumentation->not_allowed_n
+  );
+  tinywot_json_write_key(&writer, "forms");
+  tinywot_json_write_array_begin(&writer);
+
+  for (size_t i = 0;
+       i < thing->forms_count_n && i < instrumentation->forms_stats_max_n;
+       i++) {
+    /* Skip removed forms; see tinywot_thing_remove_form(). */
+    if (thing->forms[i].op != TINYWOT_OPERATION_TYPE_UNKNOWN) {
+      tinywot_json_write_form_stats(
+        &writer, &thing->forms[i], &instrumentation->forms_stats[i]
+      );
+    }
+  }
+
+  tinywot_json_write_array_end(&writer);
+  tinywot_json_write_object_end(&writer);
+
+  if (writer.status != TINYWOT_STATUS_SUCCESS) {
+    response_payload->content_length_byte = 0;
+    return writer.status;
+  }
+
+  response_payload->content_type = batch->content_type;
+
+  return TINYWOT_STATUS_SUCCESS;
+}
+#endif
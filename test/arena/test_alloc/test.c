@@ -0,0 +1,117 @@
+/*
+  SPDX-FileCopyrightText: 2023 Junde Yhi <junde@yhi.moe>
+  SPDX-License-Identifier: MIT
+*/
+
+/*!
+  \file
+  \brief Unit tests for `tinywot_arena` and
+  `tinywot_response_alloc_content()`.
+*/
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <tinywot/core.h>
+#include <tinywot-test.h>
+#include <unity.h>
+
+static enum tinywot_status handler_property_greeting_read(
+  struct tinywot_payload *res, struct tinywot_payload *req, void *context
+) {
+  struct tinywot_response *response = tinywot_response_of_payload(res);
+  enum tinywot_status status = TINYWOT_STATUS_ERROR_GENERIC;
+
+  (void)req;
+  (void)context;
+
+  status = tinywot_response_alloc_content(response, 0);
+
+  if (status != TINYWOT_STATUS_SUCCESS) {
+    return status;
+  }
+
+  return tinywot_payload_append_string(res, "hello");
+}
+
+static void tinywot_arena_should_allocate_aligned_memory(void) {
+  struct tinywot_arena arena;
+  unsigned char *memory = tinywot_test_mallocd(TINYWOT_TEST_MEMORY_SIZE_BYTE);
+  unsigned char *a = NULL;
+  long double *b = NULL;
+
+  tinywot_arena_init(&arena, memory, TINYWOT_TEST_MEMORY_SIZE_BYTE);
+
+  a = tinywot_arena_alloc(&arena, 1);
+  TEST_ASSERT_NOT_NULL(a);
+  b = tinywot_arena_alloc(&arena, sizeof(*b));
+  TEST_ASSERT_NOT_NULL(b);
+  TEST_ASSERT_EQUAL_UINT(0U, ((uintptr_t)b) % sizeof(*b));
+  *b = 1.0L;
+
+  TEST_ASSERT_NULL(
+    tinywot_arena_alloc(&arena, TINYWOT_TEST_MEMORY_SIZE_BYTE)
+  );
+  TEST_ASSERT_NOT_NULL(
+    tinywot_arena_alloc(&arena, tinywot_arena_remaining_byte(&arena))
+  );
+  TEST_ASSERT_EQUAL_UINT(0U, tinywot_arena_remaining_byte(&arena));
+
+  tinywot_arena_reset(&arena);
+  TEST_ASSERT_EQUAL_UINT(
+    TINYWOT_TEST_MEMORY_SIZE_BYTE, tinywot_arena_remaining_byte(&arena)
+  );
+  TEST_ASSERT_EQUAL_PTR(memory, tinywot_arena_alloc(&arena, 1));
+
+  tinywot_test_free(memory);
+}
+
+static void tinywot_response_should_alloc_content_from_arena(void) {
+  struct tinywot_form const form = {
+    .name = "greeting",
+    .target = "/greeting",
+    .op = TINYWOT_OPERATION_TYPE_READPROPERTY,
+    .handler = handler_property_greeting_read,
+  };
+  struct tinywot_thing thing;
+  struct tinywot_arena arena;
+  unsigned char memory[TINYWOT_TEST_SMALL_MEMORY_SIZE_BYTE];
+  struct tinywot_request request = {0};
+  struct tinywot_response response = {0};
+
+  tinywot_thing_init_static(&thing, &form, sizeof(form));
+  tinywot_arena_init(&arena, memory, sizeof(memory));
+
+  request.op = TINYWOT_OPERATION_TYPE_READPROPERTY;
+  memcpy(request.target, "/greeting", sizeof("/greeting"));
+
+  /* no arena */
+  tinywot_thing_process_request(&thing, &response, &request);
+  TEST_ASSERT_EQUAL(TINYWOT_RESPONSE_STATUS_INTERNAL_ERROR, response.status);
+
+  response.arena = &arena;
+  tinywot_thing_process_request(&thing, &response, &request);
+  TEST_ASSERT_EQUAL(TINYWOT_RESPONSE_STATUS_OK, response.status);
+  TEST_ASSERT_EQUAL_PTR(memory, response.payload.content);
+  TEST_ASSERT_EQUAL_STRING("hello", response.payload.content);
+
+  /* the arena is used up until the binding resets it */
+  tinywot_thing_process_request(&thing, &response, &request);
+  TEST_ASSERT_EQUAL(TINYWOT_RESPONSE_STATUS_INTERNAL_ERROR, response.status);
+
+  tinywot_arena_reset(&arena);
+  tinywot_thing_process_request(&thing, &response, &request);
+  TEST_ASSERT_EQUAL(TINYWOT_RESPONSE_STATUS_OK, response.status);
+}
+
+void setUp(void) {}
+void tearDown(void) {}
+
+int main(void) {
+  UNITY_BEGIN();
+
+  RUN_TEST(tinywot_arena_should_allocate_aligned_memory);
+  RUN_TEST(tinywot_response_should_alloc_content_from_arena);
+
+  return UNITY_END();
+}
@@ -0,0 +1,275 @@
+/*
+  SPDX-FileCopyrightText: 2023 Junde Yhi <junde@yhi.moe>
+  SPDX-License-Identifier: MIT
+*/
+
+/*!
+  \file
+  \brief Benchmarks for `tinywot_thing_find_form()` and
+  `tinywot_thing_process_request()`.
+
+  Forms are registered on targets of the same length that only differ in
+  their last characters, which is the worst case of `strcmp()`. Cases:
+
+  - `hit_first`: the first registered form, i.e. the last one found by a
+    linear search.
+  - `hit_last`: the last registered form.
+  - `miss`: a target that is not registered.
+  - `override`: a target registered twice, so the later form is found.
+*/
+
+#include "../tinywot-bench.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include <tinywot/core.h>
+#include <unity.h>
+
+#if defined(ARDUINO)
+#define BENCH_FORMS_MAX_N (16U)
+#define BENCH_TARGET_LENGTH_MAX_BYTE (16U)
+static size_t const forms_ns[] = {1, 4, 16};
+static size_t const target_lengths_byte[] = {8, 16};
+#else
+#define BENCH_FORMS_MAX_N (1024U)
+#define BENCH_TARGET_LENGTH_MAX_BYTE (60U)
+static size_t const forms_ns[] = {1, 4, 16, 64, 256, 1024};
+static size_t const target_lengths_byte[] = {8, 32, 60};
+#endif
+
+#define ARRAY_N(a) (sizeof(a) / sizeof((a)[0]))
+
+/* One more for the overriding form. */
+static struct tinywot_form forms[BENCH_FORMS_MAX_N + 1];
+static size_t index_memory[BENCH_FORMS_MAX_N + 1];
+static char targets[BENCH_FORMS_MAX_N + 1][BENCH_TARGET_LENGTH_MAX_BYTE + 1];
+static struct tinywot_thing thing;
+
+static enum tinywot_status handler_bench(
+  struct tinywot_payload *res, struct tinywot_payload *req, void *context
+) {
+  (void)req;
+  (void)context;
+
+  res->content_length_byte = 0;
+
+  return TINYWOT_STATUS_SUCCESS;
+}
+
+/* Write the i-th target of length_byte characters, e.g. /aaa00001. */
+static void make_target(char *target, size_t i, size_t length_byte) {
+  memset(target, 'a', length_byte);
+  target[0] = '/';
+
+  for (size_t j = length_byte; j > 1 && j > length_byte - 5; j--) {
+    target[j - 1] = (char)('0' + i % 10U);
+    i /= 10U;
+  }
+
+  target[length_byte] = '\0';
+}
+
+/* Set up thing with forms_n forms (the last of them overriding the
+   first one if override is true). */
+static void make_thing(size_t forms_n, size_t length_byte, bool override) {
+  tinywot_thing_init_dynamic(&thing, forms, sizeof(forms));
+
+  for (size_t i = 0; i < forms_n; i++) {
+    struct tinywot_form form = {0};
+
+    make_target(targets[i], i, length_byte);
+    form.target = targets[i];
+    form.op = TINYWOT_OPERATION_TYPE_READPROPERTY;
+    form.handler = handler_bench;
+
+    TEST_ASSERT_EQUAL(
+      TINYWOT_STATUS_SUCCESS, tinywot_thing_add_form(&thing, &form)
+    );
+  }
+
+  if (override) {
+    struct tinywot_form form = {0};
+
+    form.target = targets[0];
+    form.op = TINYWOT_OPERATION_TYPE_READPROPERTY;
+    form.handler = handler_bench;
+
+    TEST_ASSERT_EQUAL(
+      TINYWOT_STATUS_SUCCESS, tinywot_thing_add_form(&thing, &form)
+    );
+  }
+
+  /* The target after the last registered one is never registered. */
+  make_target(targets[forms_n], forms_n + 1U, length_byte);
+}
+
+static void bench_find_form_one(
+  char const *name,
+  size_t forms_n,
+  size_t length_byte,
+  char const *target,
+  enum tinywot_status expected
+) {
+  char params[64];
+  unsigned long iterations = tinywot_bench_iterations(forms_n);
+  unsigned long begin = 0;
+  unsigned long elapsed = 0;
+  struct tinywot_form *form = NULL;
+
+  TEST_ASSERT_EQUAL(
+    expected,
+    tinywot_thing_find_form(
+      &thing, &form, target, TINYWOT_OPERATION_TYPE_READPROPERTY
+    )
+  );
+
+  begin = tinywot_bench_now();
+
+  for (unsigned long i = 0; i < iterations; i++) {
+    tinywot_bench_sink += (uintptr_t)tinywot_thing_find_form(
+      &thing, &form, target, TINYWOT_OPERATION_TYPE_READPROPERTY
+    );
+  }
+
+  elapsed = tinywot_bench_now() - begin;
+
+  snprintf(
+    params,
+    sizeof(params),
+    "forms_n=%lu target_length_byte=%lu",
+    (unsigned long)forms_n,
+    (unsigned long)length_byte
+  );
+  tinywot_bench_report(name, params, iterations, elapsed);
+}
+
+static void bench_find_form_all(bool indexed) {
+  for (size_t i = 0; i < ARRAY_N(forms_ns); i++) {
+    for (size_t j = 0; j < ARRAY_N(target_lengths_byte); j++) {
+      size_t n = forms_ns[i];
+      size_t length_byte = target_lengths_byte[j];
+
+      make_thing(n, length_byte, false);
+
+      if (indexed) {
+        TEST_ASSERT_EQUAL(
+          TINYWOT_STATUS_SUCCESS,
+          tinywot_thing_init_index(
+            &thing, index_memory, sizeof(index_memory)
+          )
+        );
+      }
+
+      bench_find_form_one(
+        indexed ? "find_form_indexed_hit_first" : "find_form_hit_first",
+        n, length_byte, targets[0], TINYWOT_STATUS_SUCCESS
+      );
+      bench_find_form_one(
+        indexed ? "find_form_indexed_hit_last" : "find_form_hit_last",
+        n, length_byte, targets[n - 1], TINYWOT_STATUS_SUCCESS
+      );
+      bench_find_form_one(
+        indexed ? "find_form_indexed_miss" : "find_form_miss",
+        n, length_byte, targets[n], TINYWOT_STATUS_ERROR_NOT_FOUND
+      );
+
+      make_thing(n, length_byte, true);
+
+      if (indexed) {
+        TEST_ASSERT_EQUAL(
+          TINYWOT_STATUS_SUCCESS,
+          tinywot_thing_init_index(
+            &thing, index_memory, sizeof(index_memory)
+          )
+        );
+      }
+
+      bench_find_form_one(
+        indexed ? "find_form_indexed_override" : "find_form_override",
+        n, length_byte, targets[0], TINYWOT_STATUS_SUCCESS
+      );
+    }
+  }
+}
+
+static void bench_find_form(void) {
+  bench_find_form_all(false);
+}
+
+static void bench_find_form_indexed(void) {
+  bench_find_form_all(true);
+}
+
+static void bench_process_request_one(
+  char const *name,
+  size_t forms_n,
+  size_t length_byte,
+  char const *target,
+  enum tinywot_response_status expected
+) {
+  char params[64];
+  unsigned long iterations = tinywot_bench_iterations(forms_n);
+  unsigned long begin = 0;
+  unsigned long elapsed = 0;
+  struct tinywot_request request = {0};
+  struct tinywot_response response = {0};
+
+  request.op = TINYWOT_OPERATION_TYPE_READPROPERTY;
+  strcpy(request.target, target);
+
+  tinywot_thing_process_request(&thing, &response, &request);
+  TEST_ASSERT_EQUAL(expected, response.status);
+
+  begin = tinywot_bench_now();
+
+  for (unsigned long i = 0; i < iterations; i++) {
+    tinywot_thing_process_request(&thing, &response, &request);
+    tinywot_bench_sink += (uintptr_t)response.status;
+  }
+
+  elapsed = tinywot_bench_now() - begin;
+
+  snprintf(
+    params,
+    sizeof(params),
+    "forms_n=%lu target_length_byte=%lu",
+    (unsigned long)forms_n,
+    (unsigned long)length_byte
+  );
+  tinywot_bench_report(name, params, iterations, elapsed);
+}
+
+static void bench_process_request(void) {
+  for (size_t i = 0; i < ARRAY_N(forms_ns); i++) {
+    for (size_t j = 0; j < ARRAY_N(target_lengths_byte); j++) {
+      size_t n = forms_ns[i];
+      size_t length_byte = target_lengths_byte[j];
+
+      make_thing(n, length_byte, false);
+
+      bench_process_request_one(
+        "process_request_hit_first", n, length_byte, targets[0],
+        TINYWOT_RESPONSE_STATUS_OK
+      );
+      bench_process_request_one(
+        "process_request_miss", n, length_byte, targets[n],
+        TINYWOT_RESPONSE_STATUS_NOT_FOUND
+      );
+    }
+  }
+}
+
+void setUp(void) {}
+void tearDown(void) {}
+
+int main(void) {
+  UNITY_BEGIN();
+
+  RUN_TEST(bench_find_form);
+  RUN_TEST(bench_find_form_indexed);
+  RUN_TEST(bench_process_request);
+
+  return UNITY_END();
+}
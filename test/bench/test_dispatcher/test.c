@@ -0,0 +1,150 @@
+/*
+  SPDX-FileCopyrightText: 2023 Junde Yhi <junde@yhi.moe>
+  SPDX-License-Identifier: MIT
+*/
+
+/*!
+  \file
+  \brief Benchmarks for `TINYWOT_DISPATCH_DEFINE()` against
+  `tinywot_thing_process_request()` on the same forms.
+
+  Cases:
+
+  - `hit_first`: the first listed form.
+  - `hit_last`: the last listed form.
+  - `miss`: a target that is not listed.
+*/
+
+#include "../tinywot-bench.h"
+
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include <tinywot/core.h>
+#include <tinywot/dispatch.h>
+#include <unity.h>
+
+static enum tinywot_status handler_bench(
+  struct tinywot_payload *res, struct tinywot_payload *req, void *context
+) {
+  (void)req;
+  (void)context;
+
+  res->content_length_byte = 0;
+
+  return TINYWOT_STATUS_SUCCESS;
+}
+
+#define BENCH_FORM(X, target_) \
+  X(NULL, target_, TINYWOT_OPERATION_TYPE_READPROPERTY, handler_bench, NULL)
+
+#define BENCH_FORMS(X) \
+  BENCH_FORM(X, "/aaa00000") \
+  BENCH_FORM(X, "/aaa00001") \
+  BENCH_FORM(X, "/aaa00002") \
+  BENCH_FORM(X, "/aaa00003") \
+  BENCH_FORM(X, "/aaa00004") \
+  BENCH_FORM(X, "/aaa00005") \
+  BENCH_FORM(X, "/aaa00006") \
+  BENCH_FORM(X, "/aaa00007")
+
+static TINYWOT_DISPATCH_DEFINE(bench_dispatch, BENCH_FORMS)
+
+static struct tinywot_form const forms[] = {
+  BENCH_FORMS(TINYWOT_DISPATCH_FORM)
+};
+
+static struct tinywot_thing thing;
+
+static void bench_one(
+  char const *name,
+  char const *target,
+  bool dispatcher,
+  enum tinywot_response_status expected
+) {
+  char params[32];
+  size_t forms_n = sizeof(forms) / sizeof(forms[0]);
+  unsigned long iterations = tinywot_bench_iterations(forms_n);
+  unsigned long begin = 0;
+  unsigned long elapsed = 0;
+  struct tinywot_request request = {0};
+  struct tinywot_response response = {0};
+
+  request.op = TINYWOT_OPERATION_TYPE_READPROPERTY;
+  strcpy(request.target, target);
+
+  if (dispatcher) {
+    bench_dispatch(&response, &request);
+  } else {
+    tinywot_thing_process_request(&thing, &response, &request);
+  }
+
+  TEST_ASSERT_EQUAL(expected, response.status);
+
+  begin = tinywot_bench_now();
+
+  if (dispatcher) {
+    for (unsigned long i = 0; i < iterations; i++) {
+      bench_dispatch(&response, &request);
+      tinywot_bench_sink += (uintptr_t)response.status;
+    }
+  } else {
+    for (unsigned long i = 0; i < iterations; i++) {
+      tinywot_thing_process_request(&thing, &response, &request);
+      tinywot_bench_sink += (uintptr_t)response.status;
+    }
+  }
+
+  elapsed = tinywot_bench_now() - begin;
+
+  snprintf(params, sizeof(params), "forms_n=%lu", (unsigned long)forms_n);
+  tinywot_bench_report(name, params, iterations, elapsed);
+}
+
+static void bench_dispatcher(void) {
+  bench_one(
+    "dispatcher_hit_first", "/aaa00000", true, TINYWOT_RESPONSE_STATUS_OK
+  );
+  bench_one(
+    "dispatcher_hit_last", "/aaa00007", true, TINYWOT_RESPONSE_STATUS_OK
+  );
+  bench_one(
+    "dispatcher_miss", "/aaa00008", true, TINYWOT_RESPONSE_STATUS_NOT_FOUND
+  );
+}
+
+static void bench_process_request(void) {
+  bench_one(
+    "static_process_request_hit_first",
+    "/aaa00000",
+    false,
+    TINYWOT_RESPONSE_STATUS_OK
+  );
+  bench_one(
+    "static_process_request_hit_last",
+    "/aaa00007",
+    false,
+    TINYWOT_RESPONSE_STATUS_OK
+  );
+  bench_one(
+    "static_process_request_miss",
+    "/aaa00008",
+    false,
+    TINYWOT_RESPONSE_STATUS_NOT_FOUND
+  );
+}
+
+void setUp(void) {
+  tinywot_thing_init_static(&thing, forms, sizeof(forms));
+}
+
+void tearDown(void) {}
+
+int main(void) {
+  UNITY_BEGIN();
+
+  RUN_TEST(bench_dispatcher);
+  RUN_TEST(bench_process_request);
+
+  return UNITY_END();
+}
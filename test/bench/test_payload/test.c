@@ -0,0 +1,78 @@
+/*
+  SPDX-FileCopyrightText: 2023 Junde Yhi <junde@yhi.moe>
+  SPDX-License-Identifier: MIT
+*/
+
+/*!
+  \file
+  \brief Benchmarks for `tinywot_payload_append()`.
+
+  Chunks of a fixed size are appended to a payload until it is full, then
+  the payload is emptied and filled again. `ns_per_op` is per chunk.
+*/
+
+#include "../tinywot-bench.h"
+
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include <tinywot/core.h>
+#include <unity.h>
+
+#if defined(ARDUINO)
+#define BENCH_PAYLOAD_SIZE_BYTE (128U)
+#else
+#define BENCH_PAYLOAD_SIZE_BYTE (4096U)
+#endif
+
+static size_t const chunk_sizes_byte[] = {1, 8, 64};
+
+static unsigned char payload_memory[BENCH_PAYLOAD_SIZE_BYTE];
+static unsigned char chunk[64];
+
+static void bench_payload_append(void) {
+  memset(chunk, 'a', sizeof(chunk));
+
+  for (size_t i = 0; i < sizeof(chunk_sizes_byte) / sizeof(size_t); i++) {
+    size_t chunk_size_byte = chunk_sizes_byte[i];
+    unsigned long iterations = tinywot_bench_iterations(1U);
+    unsigned long begin = 0;
+    unsigned long elapsed = 0;
+    struct tinywot_payload payload = {0};
+    char params[48];
+
+    payload.content = payload_memory;
+    payload.content_buffer_size_byte = sizeof(payload_memory);
+
+    begin = tinywot_bench_now();
+
+    for (unsigned long j = 0; j < iterations; j++) {
+      if (tinywot_payload_append(&payload, chunk, chunk_size_byte)
+          != TINYWOT_STATUS_SUCCESS) {
+        payload.content_length_byte = 0;
+      }
+    }
+
+    elapsed = tinywot_bench_now() - begin;
+    tinywot_bench_sink += (uintptr_t)payload.content_length_byte;
+
+    snprintf(
+      params,
+      sizeof(params),
+      "chunk_size_byte=%lu",
+      (unsigned long)chunk_size_byte
+    );
+    tinywot_bench_report("payload_append", params, iterations, elapsed);
+  }
+}
+
+void setUp(void) {}
+void tearDown(void) {}
+
+int main(void) {
+  UNITY_BEGIN();
+
+  RUN_TEST(bench_payload_append);
+
+  return UNITY_END();
+}
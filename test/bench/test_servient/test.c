@@ -0,0 +1,158 @@
+/*
+  SPDX-FileCopyrightText: 2023 Junde Yhi <junde@yhi.moe>
+  SPDX-License-Identifier: MIT
+*/
+
+/*!
+  \file
+  \brief Benchmarks for `tinywot_servient_process_request()`.
+
+  Every hosted Thing is the same one with a single form on `/status`,
+  on bases like `/things/00042`. Cases:
+
+  - `hit_first`: the Thing with the smallest base.
+  - `hit_last`: the Thing with the largest base.
+  - `miss`: a base that is not registered.
+*/
+
+#include "../tinywot-bench.h"
+
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include <tinywot/core.h>
+#include <unity.h>
+
+#if defined(ARDUINO)
+#define BENCH_THINGS_MAX_N (16U)
+static size_t const things_ns[] = {1, 4, 16};
+#else
+#define BENCH_THINGS_MAX_N (1000U)
+static size_t const things_ns[] = {1, 10, 100, 1000};
+#endif
+
+#define ARRAY_N(a) (sizeof(a) / sizeof((a)[0]))
+
+/* "/things/" and 5 digits. */
+#define BENCH_BASE_LENGTH_BYTE (13U)
+
+static struct tinywot_form forms[1];
+static struct tinywot_thing thing;
+static struct tinywot_servient_thing things[BENCH_THINGS_MAX_N];
+static char bases[BENCH_THINGS_MAX_N + 1][BENCH_BASE_LENGTH_BYTE + 1];
+static struct tinywot_servient servient;
+
+static enum tinywot_status handler_bench(
+  struct tinywot_payload *res, struct tinywot_payload *req, void *context
+) {
+  (void)req;
+  (void)context;
+
+  res->content_length_byte = 0;
+
+  return TINYWOT_STATUS_SUCCESS;
+}
+
+/* Write the i-th base, e.g. /things/00042. */
+static void make_base(char *base, size_t i) {
+  strcpy(base, "/things/00000");
+
+  for (size_t j = BENCH_BASE_LENGTH_BYTE; j > BENCH_BASE_LENGTH_BYTE - 5; j--) {
+    base[j - 1] = (char)('0' + i % 10U);
+    i /= 10U;
+  }
+}
+
+/* Set up servient with things_n Things. */
+static void make_servient(size_t things_n) {
+  tinywot_servient_init(&servient, things, sizeof(things));
+
+  for (size_t i = 0; i < things_n; i++) {
+    make_base(bases[i], i);
+
+    TEST_ASSERT_EQUAL(
+      TINYWOT_STATUS_SUCCESS,
+      tinywot_servient_add_thing(&servient, bases[i], &thing)
+    );
+  }
+
+  /* The base after the last registered one is never registered. */
+  make_base(bases[things_n], things_n);
+}
+
+static void bench_process_request_one(
+  char const *name,
+  size_t things_n,
+  char const *base,
+  enum tinywot_response_status expected
+) {
+  char params[32];
+  unsigned long iterations = tinywot_bench_iterations(1);
+  unsigned long begin = 0;
+  unsigned long elapsed = 0;
+  struct tinywot_request request = {0};
+  struct tinywot_response response = {0};
+
+  request.op = TINYWOT_OPERATION_TYPE_READPROPERTY;
+  strcpy(request.target, base);
+  strcat(request.target, "/status");
+
+  tinywot_servient_process_request(&servient, &response, &request);
+  TEST_ASSERT_EQUAL(expected, response.status);
+
+  begin = tinywot_bench_now();
+
+  for (unsigned long i = 0; i < iterations; i++) {
+    tinywot_servient_process_request(&servient, &response, &request);
+    tinywot_bench_sink += (uintptr_t)response.status;
+  }
+
+  elapsed = tinywot_bench_now() - begin;
+
+  snprintf(params, sizeof(params), "things_n=%lu", (unsigned long)things_n);
+  tinywot_bench_report(name, params, iterations, elapsed);
+}
+
+static void bench_process_request(void) {
+  for (size_t i = 0; i < ARRAY_N(things_ns); i++) {
+    size_t n = things_ns[i];
+
+    make_servient(n);
+
+    bench_process_request_one(
+      "servient_process_request_hit_first", n, bases[0],
+      TINYWOT_RESPONSE_STATUS_OK
+    );
+    bench_process_request_one(
+      "servient_process_request_hit_last", n, bases[n - 1],
+      TINYWOT_RESPONSE_STATUS_OK
+    );
+    bench_process_request_one(
+      "servient_process_request_miss", n, bases[n],
+      TINYWOT_RESPONSE_STATUS_NOT_FOUND
+    );
+  }
+}
+
+void setUp(void) {
+  struct tinywot_form form = {0};
+
+  form.target = "/status";
+  form.op = TINYWOT_OPERATION_TYPE_READPROPERTY;
+  form.handler = handler_bench;
+
+  tinywot_thing_init_dynamic(&thing, forms, sizeof(forms));
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_SUCCESS, tinywot_thing_add_form(&thing, &form)
+  );
+}
+
+void tearDown(void) {}
+
+int main(void) {
+  UNITY_BEGIN();
+
+  RUN_TEST(bench_process_request);
+
+  return UNITY_END();
+}
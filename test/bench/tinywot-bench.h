@@ -0,0 +1,120 @@
+/*
+  SPDX-FileCopyrightText: 2023 Junde Yhi <junde@yhi.moe>
+  SPDX-License-Identifier: MIT
+*/
+
+/*!
+  \file
+  \brief Definitions for the benchmarks of TinyWoT Core.
+
+  Benchmarks are Unity tests under `test/bench/`, run by the
+  `bench_native` and `bench_uno` environments (and ignored by the
+  `test_*` ones). Each measurement is reported as a Unity message of
+  space-separated `key=value` fields, starting with `bench=`:
+
+      bench=find_form_hit_first forms_n=16 target_length_byte=8
+        iterations=12500 ns_per_op=157
+
+  (on one line), so results can be collected with e.g.
+  `pio test -e bench_native -v | grep -o 'bench=.*'`.
+
+  This must be included before any other header.
+*/
+
+#ifndef TINYWOT_BENCH_H
+#define TINYWOT_BENCH_H
+
+#if !defined(ARDUINO) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 199309L
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <unity.h>
+
+#if defined(ARDUINO)
+#include <Arduino.h>
+#else
+#include <time.h>
+#endif
+
+#if defined(ARDUINO)
+/*! \brief The length of a tick of `tinywot_bench_now()` in ns. */
+#define TINYWOT_BENCH_TICK_NS (1000UL)
+/*! \brief The amount of work per measurement, in forms (or bytes). */
+#define TINYWOT_BENCH_WORK_N (4000UL)
+#else
+#define TINYWOT_BENCH_TICK_NS (1UL)
+#define TINYWOT_BENCH_WORK_N (400000UL)
+#endif
+
+/*!
+  \brief Where benchmarks store results, so that they are not optimized
+  out.
+*/
+static volatile uintptr_t tinywot_bench_sink;
+
+/*!
+  \brief Get the current time in ticks of `TINYWOT_BENCH_TICK_NS`.
+
+  Only differences are meaningful, and they wrap around.
+*/
+static inline unsigned long tinywot_bench_now(void) {
+#if defined(ARDUINO)
+  return micros();
+#else
+  struct timespec now;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+
+  return (unsigned long)now.tv_sec * 1000000000UL
+         + (unsigned long)now.tv_nsec;
+#endif
+}
+
+/*!
+  \brief Get the number of iterations for operations costing `cost_n`
+  each, e.g. the number of forms scanned.
+*/
+static inline unsigned long tinywot_bench_iterations(unsigned long cost_n) {
+  unsigned long iterations = TINYWOT_BENCH_WORK_N / (cost_n ? cost_n : 1U);
+
+  return iterations < 10U ? 10U : iterations;
+}
+
+/*!
+  \brief Report a measurement.
+
+  \param[in] name The name of the benchmark.
+  \param[in] params Other `key=value` fields describing it.
+  \param[in] iterations The number of operations measured.
+  \param[in] elapsed_ticks The time taken by all operations.
+*/
+static inline void tinywot_bench_report(
+  char const *name,
+  char const *params,
+  unsigned long iterations,
+  unsigned long elapsed_ticks
+) {
+  char line[160];
+
+  /* Split the division, so that nothing overflows with 32-bit longs. */
+  unsigned long ns_per_op =
+    (elapsed_ticks / iterations) * TINYWOT_BENCH_TICK_NS
+    + (elapsed_ticks % iterations) * TINYWOT_BENCH_TICK_NS / iterations;
+
+  snprintf(
+    line,
+    sizeof(line),
+    "bench=%s %s iterations=%lu ns_per_op=%lu",
+    name,
+    params,
+    iterations,
+    ns_per_op
+  );
+
+  TEST_MESSAGE(line);
+}
+
+#endif /* TINYWOT_BENCH_H */
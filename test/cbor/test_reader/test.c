@@ -0,0 +1,204 @@
+/*
+  SPDX-FileCopyrightText: 2023 Junde Yhi <junde@yhi.moe>
+  SPDX-License-Identifier: MIT
+*/
+
+/*!
+  \file
+  \brief Unit tests for `tinywot_cbor_reader`.
+*/
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <tinywot/cbor.h>
+#include <tinywot/core.h>
+#include <tinywot-test.h>
+#include <unity.h>
+
+static unsigned char document[] = {
+  0xa4,
+  0x66, 's', 't', 'a', 't', 'u', 's',
+  0xf5,
+  0x65, 'l', 'e', 'v', 'e', 'l',
+  0x82, 0xf9, 0x3e, 0x00, 0x18, 0x64,
+  0x66, 'o', 'f', 'f', 's', 'e', 't',
+  0x3a, 0x00, 0x01, 0x86, 0x9f,
+  0x64, 'n', 'o', 'n', 'e',
+  0xf6,
+};
+
+static struct tinywot_payload payload;
+
+static void tinywot_cbor_reader_should_read_a_document(void) {
+  struct tinywot_cbor_reader r;
+  size_t pairs_count_n = 0;
+  size_t items_count_n = 0;
+  char const *key = NULL;
+  size_t key_length_byte = 0;
+  bool status = false;
+  double level = 0;
+  unsigned long level_max = 0;
+  long offset = 0;
+
+  tinywot_cbor_reader_init(&r, &payload);
+
+  tinywot_cbor_read_map_begin(&r, &pairs_count_n);
+  TEST_ASSERT_EQUAL_UINT(4U, pairs_count_n);
+
+  tinywot_cbor_read_string(&r, &key, &key_length_byte);
+  TEST_ASSERT_EQUAL_UINT(6U, key_length_byte);
+  TEST_ASSERT_EQUAL_MEMORY("status", key, key_length_byte);
+  tinywot_cbor_read_bool(&r, &status);
+  TEST_ASSERT_TRUE(status);
+
+  tinywot_cbor_read_string(&r, &key, &key_length_byte);
+  tinywot_cbor_read_array_begin(&r, &items_count_n);
+  TEST_ASSERT_EQUAL_UINT(2U, items_count_n);
+  tinywot_cbor_read_float(&r, &level);
+  TEST_ASSERT_TRUE(level == 1.5);
+  tinywot_cbor_read_uint(&r, &level_max);
+  TEST_ASSERT_EQUAL_UINT(100U, level_max);
+
+  tinywot_cbor_read_string(&r, &key, &key_length_byte);
+  tinywot_cbor_read_int(&r, &offset);
+  TEST_ASSERT_TRUE(offset == -100000L);
+
+  tinywot_cbor_read_string(&r, &key, &key_length_byte);
+  tinywot_cbor_read_null(&r);
+
+  TEST_ASSERT_EQUAL(TINYWOT_STATUS_SUCCESS, r.status);
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_END_OF_STREAM, tinywot_cbor_read_null(&r)
+  );
+}
+
+static void tinywot_cbor_reader_should_skip_items(void) {
+  struct tinywot_cbor_reader r;
+  struct tinywot_cbor_item item;
+
+  tinywot_cbor_reader_init(&r, &payload);
+
+  /* The first pair, then the whole array. */
+  tinywot_cbor_read(&r, &item);
+  TEST_ASSERT_EQUAL(TINYWOT_CBOR_TYPE_MAP, item.type);
+  tinywot_cbor_skip(&r);
+  tinywot_cbor_skip(&r);
+  tinywot_cbor_skip(&r);
+  tinywot_cbor_skip(&r);
+
+  TEST_ASSERT_EQUAL(TINYWOT_STATUS_SUCCESS, tinywot_cbor_peek(&r, &item));
+  TEST_ASSERT_EQUAL(TINYWOT_CBOR_TYPE_TEXT, item.type);
+  TEST_ASSERT_EQUAL_MEMORY("offset", item.content, item.argument);
+
+  /* The whole map at once. */
+  tinywot_cbor_reader_init(&r, &payload);
+  TEST_ASSERT_EQUAL(TINYWOT_STATUS_SUCCESS, tinywot_cbor_skip(&r));
+  TEST_ASSERT_EQUAL_UINT(sizeof(document), r.offset_byte);
+}
+
+static void tinywot_cbor_reader_should_reject_a_wrong_type(void) {
+  struct tinywot_cbor_reader r;
+  unsigned long value = 0;
+  size_t pairs_count_n = 0;
+
+  tinywot_cbor_reader_init(&r, &payload);
+
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_ERROR_NOT_ALLOWED, tinywot_cbor_read_uint(&r, &value)
+  );
+  TEST_ASSERT_EQUAL_UINT(0U, r.offset_byte);
+
+  /* Errors are sticky. */
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_ERROR_NOT_ALLOWED,
+    tinywot_cbor_read_map_begin(&r, &pairs_count_n)
+  );
+}
+
+static void tinywot_cbor_reader_should_reject_malformed_items(void) {
+  /* A text string longer than the data, an array missing an item, an
+     indefinite-length array, and a reserved additional information. */
+  static unsigned char const truncated[] = {0x65, 'a', 'b'};
+  static unsigned char const unfinished[] = {0x82, 0x01};
+  static unsigned char const indefinite[] = {0x9f, 0x01, 0xff};
+  static unsigned char const reserved[] = {0x1c};
+  struct tinywot_payload pl = {0};
+  struct tinywot_cbor_reader r;
+  struct tinywot_cbor_item item;
+
+  pl.content = (unsigned char *)truncated;
+  pl.content_length_byte = sizeof(truncated);
+  tinywot_cbor_reader_init(&r, &pl);
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_ERROR_NOT_ALLOWED, tinywot_cbor_read(&r, &item)
+  );
+
+  pl.content = (unsigned char *)unfinished;
+  pl.content_length_byte = sizeof(unfinished);
+  tinywot_cbor_reader_init(&r, &pl);
+  TEST_ASSERT_EQUAL(TINYWOT_STATUS_ERROR_NOT_ALLOWED, tinywot_cbor_skip(&r));
+  TEST_ASSERT_EQUAL_UINT(0U, r.offset_byte);
+
+  pl.content = (unsigned char *)indefinite;
+  pl.content_length_byte = sizeof(indefinite);
+  tinywot_cbor_reader_init(&r, &pl);
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_ERROR_NOT_IMPLEMENTED, tinywot_cbor_read(&r, &item)
+  );
+
+  pl.content = (unsigned char *)reserved;
+  pl.content_length_byte = sizeof(reserved);
+  tinywot_cbor_reader_init(&r, &pl);
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_ERROR_NOT_ALLOWED, tinywot_cbor_read(&r, &item)
+  );
+}
+
+static void tinywot_cbor_reader_should_read_what_is_written(void) {
+  struct tinywot_payload *pl =
+    tinywot_test_payload_new(TINYWOT_TEST_MEMORY_SIZE_BYTE);
+  struct tinywot_cbor_writer w;
+  struct tinywot_cbor_reader r;
+  double const values[] = {0.0, -2.0, 0.333251953125, 65504.0, 1.0e10};
+  double value = 0;
+
+  TEST_ASSERT_NOT_NULL(pl);
+  tinywot_cbor_writer_init(&w, pl);
+
+  for (size_t i = 0; i < sizeof(values) / sizeof(values[0]); i++) {
+    tinywot_cbor_write_float(&w, values[i]);
+  }
+
+  tinywot_cbor_reader_init(&r, pl);
+
+  for (size_t i = 0; i < sizeof(values) / sizeof(values[0]); i++) {
+    TEST_ASSERT_EQUAL(
+      TINYWOT_STATUS_SUCCESS, tinywot_cbor_read_float(&r, &value)
+    );
+    TEST_ASSERT_TRUE(value == values[i]);
+  }
+
+  tinywot_test_payload_delete(pl);
+}
+
+void setUp(void) {
+  memset(&payload, 0, sizeof(payload));
+  payload.content = document;
+  payload.content_buffer_size_byte = sizeof(document);
+  payload.content_length_byte = sizeof(document);
+}
+
+void tearDown(void) {}
+
+int main(void) {
+  UNITY_BEGIN();
+
+  RUN_TEST(tinywot_cbor_reader_should_read_a_document);
+  RUN_TEST(tinywot_cbor_reader_should_skip_items);
+  RUN_TEST(tinywot_cbor_reader_should_reject_a_wrong_type);
+  RUN_TEST(tinywot_cbor_reader_should_reject_malformed_items);
+  RUN_TEST(tinywot_cbor_reader_should_read_what_is_written);
+
+  return UNITY_END();
+}
@@ -0,0 +1,166 @@
+/*
+  SPDX-FileCopyrightText: 2023 Junde Yhi <junde@yhi.moe>
+  SPDX-License-Identifier: MIT
+*/
+
+/*!
+  \file
+  \brief Unit tests for `tinywot_cbor_writer`.
+*/
+
+#include <float.h>
+#include <limits.h>
+#include <math.h>
+#include <stddef.h>
+#include <string.h>
+#include <tinywot/cbor.h>
+#include <tinywot/core.h>
+#include <tinywot-test.h>
+#include <unity.h>
+
+static void tinywot_cbor_writer_should_write_a_document(void) {
+  struct tinywot_payload *pl =
+    tinywot_test_payload_new(TINYWOT_TEST_MEMORY_SIZE_BYTE);
+  struct tinywot_cbor_writer w;
+  unsigned char const bytes[] = {0x01, 0x02};
+  unsigned char const expected[] = {
+    0xa6,
+    0x66, 's', 't', 'a', 't', 'u', 's',
+    0xf4,
+    0x6b, 't', 'e', 'm', 'p', 'e', 'r', 'a', 't', 'u', 'r', 'e',
+    0x82, 0xf9, 0x4d, 0x60, 0xfa, 0x47, 0xc3, 0x50, 0x00,
+    0x61, 'n',
+    0x39, 0x01, 0xf3,
+    0x66, 'v', 'a', 'l', 'u', 'e', 's',
+    0x84, 0x00, 0x18, 0x18, 0x1a, 0x00, 0x01, 0x00, 0x00,
+    0x1a, 0xff, 0xff, 0xff, 0xff,
+    0x61, 'b',
+    0x42, 0x01, 0x02,
+    0x61, 'x',
+    0xc1, 0xf6,
+  };
+
+  TEST_ASSERT_NOT_NULL(pl);
+  tinywot_cbor_writer_init(&w, pl);
+
+  tinywot_cbor_write_map_begin(&w, 6);
+  tinywot_cbor_write_string(&w, "status");
+  tinywot_cbor_write_bool(&w, false);
+  tinywot_cbor_write_string(&w, "temperature");
+  tinywot_cbor_write_array_begin(&w, 2);
+  tinywot_cbor_write_float(&w, 21.5);
+  tinywot_cbor_write_float(&w, 100000.0);
+  tinywot_cbor_write_string_n(&w, "nothing", 1);
+  tinywot_cbor_write_int(&w, -500);
+  tinywot_cbor_write_string(&w, "values");
+  tinywot_cbor_write_array_begin(&w, 4);
+  tinywot_cbor_write_uint(&w, 0);
+  tinywot_cbor_write_int(&w, 24);
+  tinywot_cbor_write_uint(&w, 65536UL);
+  tinywot_cbor_write_uint(&w, 4294967295UL);
+  tinywot_cbor_write_string(&w, "b");
+  tinywot_cbor_write_bytes(&w, bytes, sizeof(bytes));
+  tinywot_cbor_write_string(&w, "x");
+  tinywot_cbor_write_tag(&w, 1);
+  tinywot_cbor_write_null(&w);
+
+  TEST_ASSERT_EQUAL(TINYWOT_STATUS_SUCCESS, w.status);
+  TEST_ASSERT_EQUAL_UINT(sizeof(expected), pl->content_length_byte);
+  TEST_ASSERT_EQUAL_MEMORY(expected, pl->content, sizeof(expected));
+
+  tinywot_test_payload_delete(pl);
+}
+
+static void tinywot_cbor_writer_should_write_long_min(void) {
+  struct tinywot_payload *pl =
+    tinywot_test_payload_new(TINYWOT_TEST_MEMORY_SIZE_BYTE);
+  struct tinywot_cbor_writer w;
+  struct tinywot_cbor_reader r;
+  long value = 0;
+
+  TEST_ASSERT_NOT_NULL(pl);
+  tinywot_cbor_writer_init(&w, pl);
+
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_SUCCESS, tinywot_cbor_write_int(&w, LONG_MIN)
+  );
+
+  tinywot_cbor_reader_init(&r, pl);
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_SUCCESS, tinywot_cbor_read_int(&r, &value)
+  );
+  TEST_ASSERT_TRUE(value == LONG_MIN);
+
+  tinywot_test_payload_delete(pl);
+}
+
+#if DBL_MANT_DIG > FLT_MANT_DIG
+static void tinywot_cbor_writer_should_write_doubles_out_of_float(void) {
+  struct tinywot_payload *pl =
+    tinywot_test_payload_new(TINYWOT_TEST_MEMORY_SIZE_BYTE);
+  struct tinywot_cbor_writer w;
+  unsigned char const expected[] = {
+    0xfb, 0x7e, 0x37, 0xe4, 0x3c, 0x88, 0x00, 0x75, 0x9c,
+    0xfb, 0xfe, 0x37, 0xe4, 0x3c, 0x88, 0x00, 0x75, 0x9c,
+    0xf9, 0x7c, 0x00,
+  };
+
+  TEST_ASSERT_NOT_NULL(pl);
+  tinywot_cbor_writer_init(&w, pl);
+
+  /* Beyond FLT_MAX, so never narrowed to float. */
+  tinywot_cbor_write_float(&w, 1e300);
+  tinywot_cbor_write_float(&w, -1e300);
+  tinywot_cbor_write_float(&w, HUGE_VAL);
+
+  TEST_ASSERT_EQUAL(TINYWOT_STATUS_SUCCESS, w.status);
+  TEST_ASSERT_EQUAL_UINT(sizeof(expected), pl->content_length_byte);
+  TEST_ASSERT_EQUAL_MEMORY(expected, pl->content, sizeof(expected));
+
+  tinywot_test_payload_delete(pl);
+}
+#endif
+
+static void tinywot_cbor_writer_should_fail_atomically(void) {
+  struct tinywot_payload *pl = tinywot_test_payload_new(4);
+  struct tinywot_cbor_writer w;
+
+  TEST_ASSERT_NOT_NULL(pl);
+  tinywot_cbor_writer_init(&w, pl);
+
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_SUCCESS, tinywot_cbor_write_uint(&w, 1000)
+  );
+  TEST_ASSERT_EQUAL_UINT(3U, pl->content_length_byte);
+
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_ERROR_NOT_ENOUGH_MEMORY,
+    tinywot_cbor_write_string(&w, "ab")
+  );
+  TEST_ASSERT_EQUAL_UINT(3U, pl->content_length_byte);
+
+  /* Errors are sticky, even if this would have fit. */
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_ERROR_NOT_ENOUGH_MEMORY, tinywot_cbor_write_null(&w)
+  );
+  TEST_ASSERT_EQUAL_UINT(3U, pl->content_length_byte);
+  TEST_ASSERT_EQUAL(TINYWOT_STATUS_ERROR_NOT_ENOUGH_MEMORY, w.status);
+
+  tinywot_test_payload_delete(pl);
+}
+
+void setUp(void) {}
+void tearDown(void) {}
+
+int main(void) {
+  UNITY_BEGIN();
+
+  RUN_TEST(tinywot_cbor_writer_should_write_a_document);
+  RUN_TEST(tinywot_cbor_writer_should_write_long_min);
+#if DBL_MANT_DIG > FLT_MANT_DIG
+  RUN_TEST(tinywot_cbor_writer_should_write_doubles_out_of_float);
+#endif
+  RUN_TEST(tinywot_cbor_writer_should_fail_atomically);
+
+  return UNITY_END();
+}
@@ -0,0 +1,274 @@
+/*
+  SPDX-FileCopyrightText: 2023 Junde Yhi <junde@yhi.moe>
+  SPDX-License-Identifier: MIT
+*/
+
+/*!
+  \file
+  \brief Unit tests for `tinywot_coalescer_poll()`.
+*/
+
+#include <stddef.h>
+#include <string.h>
+#include <tinywot/core.h>
+#include <tinywot-test.h>
+#include <unity.h>
+
+static struct tinywot_form const forms[] = {
+  {
+    .name = "temperature",
+    .target = "/temperature",
+    .op = TINYWOT_OPERATION_TYPE_OBSERVEPROPERTY,
+  },
+  {
+    .name = "humidity",
+    .target = "/humidity",
+    .op = TINYWOT_OPERATION_TYPE_OBSERVEPROPERTY,
+  },
+  {
+    .name = "overheating",
+    .target = "/oh",
+    .op = TINYWOT_OPERATION_TYPE_SUBSCRIBEEVENT,
+  },
+};
+
+static struct tinywot_thing thing;
+static struct tinywot_observer observers[3];
+static struct tinywot_coalesced_target targets[2];
+static struct tinywot_coalescer coalescer;
+
+/* observers[0] of /temperature, observers[1] of /humidity, observers[2]
+   of /oh. */
+static void observe(char const *target, enum tinywot_operation_type op) {
+  struct tinywot_request request = {0};
+  struct tinywot_response response = {0};
+
+  request.op = op;
+  request.origin = (unsigned char const *)"alice";
+  request.origin_length_byte = 5;
+  strcpy(request.target, target);
+
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_SUCCESS,
+    tinywot_thing_process_request(&thing, &response, &request)
+  );
+  TEST_ASSERT_EQUAL(TINYWOT_RESPONSE_STATUS_OK, response.status);
+}
+
+/* Check whether observer is dirty with value, then clean it. */
+static void assert_notified(
+  struct tinywot_observer *observer, bool dirty, uint_least32_t value
+) {
+  TEST_ASSERT_EQUAL(dirty, observer->dirty);
+
+  if (dirty) {
+    TEST_ASSERT_EQUAL_UINT32(value, observer->value);
+  }
+
+  observer->dirty = false;
+}
+
+static void tinywot_coalescer_should_add_targets(void) {
+  static struct tinywot_coalesce_policy const policy = {0};
+
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_ERROR_NOT_ALLOWED,
+    tinywot_coalescer_add_target(&coalescer, "/temperature", &policy)
+  );
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_ERROR_NOT_ENOUGH_MEMORY,
+    tinywot_coalescer_add_target(&coalescer, "/oh", &policy)
+  );
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_ERROR_NOT_FOUND,
+    tinywot_coalescer_update(&coalescer, "/oh", 1, 0)
+  );
+}
+
+static void tinywot_coalescer_should_keep_min_interval(void) {
+  static struct tinywot_coalesce_policy const policy = {
+    .min_interval_ticks = 100,
+    .window_ticks = 10,
+  };
+  uint_least32_t wait = 0;
+
+  targets[0].policy = &policy;
+
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_ERROR_NOT_FOUND,
+    tinywot_coalescer_poll(&coalescer, &thing, 0, &wait)
+  );
+
+  /* The first update waits for the window. */
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_SUCCESS,
+    tinywot_coalescer_update(&coalescer, "/temperature", 1, 0)
+  );
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_SUCCESS,
+    tinywot_coalescer_poll(&coalescer, &thing, 5, &wait)
+  );
+  TEST_ASSERT_EQUAL_UINT32(5, wait);
+  assert_notified(&observers[0], false, 0);
+
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_ERROR_NOT_FOUND,
+    tinywot_coalescer_poll(&coalescer, &thing, 10, &wait)
+  );
+  assert_notified(&observers[0], true, 1);
+
+  /* Later ones are merged until the interval has passed. */
+  tinywot_coalescer_update(&coalescer, "/temperature", 2, 20);
+  tinywot_coalescer_update(&coalescer, "/temperature", 3, 30);
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_SUCCESS,
+    tinywot_coalescer_poll(&coalescer, &thing, 30, &wait)
+  );
+  TEST_ASSERT_EQUAL_UINT32(80, wait);
+  assert_notified(&observers[0], false, 0);
+
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_ERROR_NOT_FOUND,
+    tinywot_coalescer_poll(&coalescer, &thing, 110, &wait)
+  );
+  assert_notified(&observers[0], true, 3);
+}
+
+static void tinywot_coalescer_should_drop_small_changes(void) {
+  static struct tinywot_coalesce_policy const policy = {
+    .threshold = 5,
+  };
+  uint_least32_t wait = 0;
+
+  targets[0].policy = &policy;
+
+  tinywot_coalescer_update(&coalescer, "/temperature", 100, 0);
+  tinywot_coalescer_poll(&coalescer, &thing, 0, &wait);
+  assert_notified(&observers[0], true, 100);
+
+  tinywot_coalescer_update(&coalescer, "/temperature", 103, 1);
+  tinywot_coalescer_update(&coalescer, "/temperature", 96, 2);
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_ERROR_NOT_FOUND,
+    tinywot_coalescer_poll(&coalescer, &thing, 3, &wait)
+  );
+  assert_notified(&observers[0], false, 0);
+
+  tinywot_coalescer_update(&coalescer, "/temperature", 95, 4);
+  tinywot_coalescer_poll(&coalescer, &thing, 4, &wait);
+  assert_notified(&observers[0], true, 95);
+}
+
+static void tinywot_coalescer_should_batch_targets(void) {
+  static struct tinywot_coalesce_policy const fast = {
+    .window_ticks = 50,
+  };
+  static struct tinywot_coalesce_policy const slow = {
+    .window_ticks = 1000,
+  };
+  uint_least32_t wait = 0;
+
+  targets[0].policy = &fast;
+  targets[1].policy = &slow;
+
+  tinywot_coalescer_update(&coalescer, "/humidity", 7, 0);
+  tinywot_coalescer_update(&coalescer, "/temperature", 8, 10);
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_SUCCESS,
+    tinywot_coalescer_poll(&coalescer, &thing, 10, &wait)
+  );
+  TEST_ASSERT_EQUAL_UINT32(50, wait);
+
+  /* /humidity goes out early with /temperature. */
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_ERROR_NOT_FOUND,
+    tinywot_coalescer_poll(&coalescer, &thing, 60, &wait)
+  );
+  assert_notified(&observers[0], true, 8);
+  assert_notified(&observers[1], true, 7);
+}
+
+static void tinywot_coalescer_should_wrap_around(void) {
+  static struct tinywot_coalesce_policy const policy = {
+    .window_ticks = 0x20,
+  };
+  uint_least32_t wait = 0;
+
+  targets[0].policy = &policy;
+
+  tinywot_coalescer_update(&coalescer, "/temperature", 1, 0xFFFFFFF0UL);
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_SUCCESS,
+    tinywot_coalescer_poll(&coalescer, &thing, 0x0F, &wait)
+  );
+  TEST_ASSERT_EQUAL_UINT32(1, wait);
+  assert_notified(&observers[0], false, 0);
+
+  tinywot_coalescer_poll(&coalescer, &thing, 0x10, &wait);
+  assert_notified(&observers[0], true, 1);
+}
+
+static void tinywot_coalescer_should_drain_events(void) {
+  static struct tinywot_event events[4];
+  static struct tinywot_coalesce_policy const policy = {
+    .window_ticks = 10,
+  };
+  struct tinywot_event_ring ring;
+  uint_least32_t wait = 0;
+
+  targets[0].policy = &policy;
+
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_SUCCESS,
+    tinywot_event_ring_init(&ring, events, sizeof(events))
+  );
+  tinywot_event_ring_post(&ring, "/temperature", 4);
+  tinywot_event_ring_post(&ring, "/oh", 1);
+  tinywot_event_ring_post(&ring, "/temperature", 5);
+
+  TEST_ASSERT_EQUAL_UINT(
+    3U, tinywot_coalescer_drain_events(&coalescer, &thing, &ring, 0)
+  );
+
+  /* /oh is not coalesced. */
+  assert_notified(&observers[0], false, 0);
+  assert_notified(&observers[2], true, 1);
+
+  tinywot_coalescer_poll(&coalescer, &thing, 10, &wait);
+  assert_notified(&observers[0], true, 5);
+}
+
+void setUp(void) {
+  static struct tinywot_coalesce_policy const policy = {0};
+
+  tinywot_thing_init_static(&thing, forms, sizeof(forms));
+  tinywot_thing_init_observers(&thing, observers, sizeof(observers));
+  observe("/temperature", TINYWOT_OPERATION_TYPE_OBSERVEPROPERTY);
+  observe("/humidity", TINYWOT_OPERATION_TYPE_OBSERVEPROPERTY);
+  observe("/oh", TINYWOT_OPERATION_TYPE_SUBSCRIBEEVENT);
+
+  tinywot_coalescer_init(&coalescer, targets, sizeof(targets));
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_SUCCESS,
+    tinywot_coalescer_add_target(&coalescer, "/temperature", &policy)
+  );
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_SUCCESS,
+    tinywot_coalescer_add_target(&coalescer, "/humidity", &policy)
+  );
+}
+
+void tearDown(void) {}
+
+int main(void) {
+  UNITY_BEGIN();
+
+  RUN_TEST(tinywot_coalescer_should_add_targets);
+  RUN_TEST(tinywot_coalescer_should_keep_min_interval);
+  RUN_TEST(tinywot_coalescer_should_drop_small_changes);
+  RUN_TEST(tinywot_coalescer_should_batch_targets);
+  RUN_TEST(tinywot_coalescer_should_wrap_around);
+  RUN_TEST(tinywot_coalescer_should_drain_events);
+
+  return UNITY_END();
+}
@@ -0,0 +1,92 @@
+/* Generated by tinywot-forms.py from forms.txt. */
+/* Do not edit. */
+
+#ifndef EXAMPLE_DISPATCH_H
+#define EXAMPLE_DISPATCH_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <tinywot/core.h>
+#include <tinywot/dispatch.h>
+
+tinywot_form_handler_t handler_property_status_read;
+tinywot_form_handler_t handler_action_toggle;
+tinywot_form_handler_t handler_property_status_write;
+
+#define EXAMPLE_FORMS(X) \
+  X("status", "/status", TINYWOT_OPERATION_TYPE_READPROPERTY, handler_property_status_read, NULL) \
+  X("toggle", "/toggle", TINYWOT_OPERATION_TYPE_INVOKEACTION, handler_action_toggle, NULL) \
+  X("overheating", "/oh", TINYWOT_OPERATION_TYPE_SUBSCRIBEEVENT, NULL, NULL) \
+  X("overheating", "/oh", TINYWOT_OPERATION_TYPE_UNSUBSCRIBEEVENT, NULL, NULL) \
+  X("status", "/status", TINYWOT_OPERATION_TYPE_WRITEPROPERTY, handler_property_status_write, NULL)
+
+static inline enum tinywot_status example_dispatch(
+  struct tinywot_response *response, struct tinywot_request *request
+) {
+  size_t target_length_byte = 0;
+  char const *target =
+    tinywot_request_get_target(request, &target_length_byte);
+  bool allowed = false;
+
+  if (!target) {
+    return tinywot_dispatch_reject(response, false);
+  }
+
+  switch (tinywot_target_hash_n(target, target_length_byte)) {
+    case 0xbfbef540UL:
+      if (target_length_byte == 7U
+          && memcmp(target, "/status", 7U) == 0) {
+        allowed = true;
+
+        switch (request->op) {
+          case TINYWOT_OPERATION_TYPE_READPROPERTY:
+            TINYWOT_DISPATCH_CALL(handler_property_status_read, NULL);
+            break;
+          case TINYWOT_OPERATION_TYPE_WRITEPROPERTY:
+            TINYWOT_DISPATCH_CALL(handler_property_status_write, NULL);
+            break;
+          default:
+            break;
+        }
+      }
+      break;
+    case 0xc48ab926UL:
+      if (target_length_byte == 7U
+          && memcmp(target, "/toggle", 7U) == 0) {
+        allowed = true;
+
+        switch (request->op) {
+          case TINYWOT_OPERATION_TYPE_INVOKEACTION:
+            TINYWOT_DISPATCH_CALL(handler_action_toggle, NULL);
+            break;
+          default:
+            break;
+        }
+      }
+      break;
+    case 0xdb999c11UL:
+      if (target_length_byte == 3U
+          && memcmp(target, "/oh", 3U) == 0) {
+        allowed = true;
+
+        switch (request->op) {
+          case TINYWOT_OPERATION_TYPE_SUBSCRIBEEVENT:
+            TINYWOT_DISPATCH_CALL(NULL, NULL);
+            break;
+          case TINYWOT_OPERATION_TYPE_UNSUBSCRIBEEVENT:
+            TINYWOT_DISPATCH_CALL(NULL, NULL);
+            break;
+          default:
+            break;
+        }
+      }
+      break;
+    default:
+      break;
+  }
+
+  return tinywot_dispatch_reject(response, allowed);
+}
+
+#endif /* EXAMPLE_DISPATCH_H */
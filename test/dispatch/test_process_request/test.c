@@ -0,0 +1,183 @@
+/*
+  SPDX-FileCopyrightText: 2023 Junde Yhi <junde@yhi.moe>
+  SPDX-License-Identifier: MIT
+*/
+
+/*!
+  \file
+  \brief Unit tests for dispatchers from `tinywot/dispatch.h`.
+
+  The hashed dispatcher generated into `dispatch.h`, one defined with
+  `TINYWOT_DISPATCH_DEFINE()` from its form list, and a `tinywot_thing`
+  of the same forms must respond alike.
+*/
+
+#include <stddef.h>
+#include <string.h>
+#include <tinywot/core.h>
+#include <tinywot/dispatch.h>
+#include <tinywot-test.h>
+#include <unity.h>
+
+#include "dispatch.h"
+
+static TINYWOT_DISPATCH_DEFINE(example_dispatch_chained, EXAMPLE_FORMS)
+
+static struct tinywot_form const example_forms[] = {
+  EXAMPLE_FORMS(TINYWOT_DISPATCH_FORM)
+};
+
+static struct tinywot_thing thing;
+
+typedef enum tinywot_status dispatch_t(
+  struct tinywot_response *response, struct tinywot_request *request
+);
+
+static enum tinywot_status dispatch_thing(
+  struct tinywot_response *response, struct tinywot_request *request
+) {
+  return tinywot_thing_process_request(&thing, response, request);
+}
+
+static dispatch_t *const dispatchers[] = {
+  dispatch_thing,
+  example_dispatch,
+  example_dispatch_chained,
+};
+
+/* Process a request on length_byte characters of target with every
+   dispatcher, expecting the same response. */
+static void process(
+  char const *target,
+  size_t length_byte,
+  enum tinywot_operation_type op,
+  enum tinywot_request_fragment fragment,
+  enum tinywot_response_status expected
+) {
+  /* The write handler of the example compares against "false" too. */
+  static char const content[8] = "true";
+
+  for (size_t i = 0; i < sizeof(dispatchers) / sizeof(dispatchers[0]); i++) {
+    struct tinywot_request request = {0};
+    struct tinywot_response response = {0};
+    unsigned char buffer[TINYWOT_TEST_SMALL_MEMORY_SIZE_BYTE] = {0};
+
+    request.target_view = target;
+    request.target_view_length_byte = length_byte;
+    request.op = op;
+    request.fragment = fragment;
+    request.payload.content = (void *)content;
+    request.payload.content_length_byte = sizeof("true");
+    request.payload.content_type = 50;
+
+    response.payload.content = buffer;
+    response.payload.content_buffer_size_byte = sizeof(buffer);
+
+    TEST_ASSERT_EQUAL(
+      TINYWOT_STATUS_SUCCESS, dispatchers[i](&response, &request)
+    );
+    TEST_ASSERT_EQUAL(expected, response.status);
+
+    if (expected == TINYWOT_RESPONSE_STATUS_OK) {
+      TEST_ASSERT_EQUAL(50, response.payload.content_type);
+    }
+  }
+}
+
+static void tinywot_dispatch_should_call_handlers(void) {
+  process(
+    "/status",
+    7,
+    TINYWOT_OPERATION_TYPE_READPROPERTY,
+    TINYWOT_REQUEST_FRAGMENT_NONE,
+    TINYWOT_RESPONSE_STATUS_OK
+  );
+  process(
+    "/status",
+    7,
+    TINYWOT_OPERATION_TYPE_WRITEPROPERTY,
+    TINYWOT_REQUEST_FRAGMENT_NONE,
+    TINYWOT_RESPONSE_STATUS_OK
+  );
+  process(
+    "/toggle",
+    7,
+    TINYWOT_OPERATION_TYPE_INVOKEACTION,
+    TINYWOT_REQUEST_FRAGMENT_NONE,
+    TINYWOT_RESPONSE_STATUS_OK
+  );
+}
+
+static void tinywot_dispatch_should_reject(void) {
+  process(
+    "/status",
+    7,
+    TINYWOT_OPERATION_TYPE_INVOKEACTION,
+    TINYWOT_REQUEST_FRAGMENT_NONE,
+    TINYWOT_RESPONSE_STATUS_NOT_ALLOWED
+  );
+
+  /* Neither a prefix nor a longer target matches. */
+  process(
+    "/status/1",
+    6,
+    TINYWOT_OPERATION_TYPE_READPROPERTY,
+    TINYWOT_REQUEST_FRAGMENT_NONE,
+    TINYWOT_RESPONSE_STATUS_NOT_FOUND
+  );
+  process(
+    "/status/1",
+    9,
+    TINYWOT_OPERATION_TYPE_READPROPERTY,
+    TINYWOT_REQUEST_FRAGMENT_NONE,
+    TINYWOT_RESPONSE_STATUS_NOT_FOUND
+  );
+}
+
+static void tinywot_dispatch_should_not_implement(void) {
+  /* No handler, and no observers. */
+  process(
+    "/oh",
+    3,
+    TINYWOT_OPERATION_TYPE_SUBSCRIBEEVENT,
+    TINYWOT_REQUEST_FRAGMENT_NONE,
+    TINYWOT_RESPONSE_STATUS_NOT_SUPPORTED
+  );
+
+  process(
+    "/status",
+    7,
+    TINYWOT_OPERATION_TYPE_WRITEPROPERTY,
+    TINYWOT_REQUEST_FRAGMENT_BEGIN,
+    TINYWOT_RESPONSE_STATUS_NOT_SUPPORTED
+  );
+}
+
+static void tinywot_dispatch_should_keep_override(void) {
+  struct tinywot_form *form = NULL;
+
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_SUCCESS,
+    tinywot_thing_find_form(
+      &thing, &form, "/status", TINYWOT_OPERATION_TYPE_WRITEPROPERTY
+    )
+  );
+  TEST_ASSERT_TRUE(form->handler == handler_property_status_write);
+}
+
+void setUp(void) {
+  tinywot_thing_init_static(&thing, example_forms, sizeof(example_forms));
+}
+
+void tearDown(void) {}
+
+int main(void) {
+  UNITY_BEGIN();
+
+  RUN_TEST(tinywot_dispatch_should_call_handlers);
+  RUN_TEST(tinywot_dispatch_should_reject);
+  RUN_TEST(tinywot_dispatch_should_not_implement);
+  RUN_TEST(tinywot_dispatch_should_keep_override);
+
+  return UNITY_END();
+}
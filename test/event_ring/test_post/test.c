@@ -0,0 +1,161 @@
+/*
+  SPDX-FileCopyrightText: 2023 Junde Yhi <junde@yhi.moe>
+  SPDX-License-Identifier: MIT
+*/
+
+/*!
+  \file
+  \brief Unit tests for `tinywot_event_ring` and
+  `tinywot_thing_drain_events()`.
+*/
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <tinywot/core.h>
+#include <tinywot-test.h>
+#include <unity.h>
+
+static enum tinywot_status handler_event_overheating(
+  struct tinywot_payload *res, struct tinywot_payload *req, void *context
+) {
+  uint_least32_t value = 0;
+
+  (void)context;
+
+  if (req->content_length_byte != sizeof(value)) {
+    return TINYWOT_STATUS_ERROR_GENERIC;
+  }
+
+  memcpy(&value, req->content, sizeof(value));
+  memcpy(res->content, &value, sizeof(value));
+  res->content_length_byte = sizeof(value);
+
+  return TINYWOT_STATUS_SUCCESS;
+}
+
+static struct tinywot_form const forms[] = {
+  {
+    .name = "overheating",
+    .target = "/oh",
+    .op = TINYWOT_OPERATION_TYPE_SUBSCRIBEEVENT,
+    .handler = handler_event_overheating,
+  },
+};
+
+static void tinywot_event_ring_should_post_and_take(void) {
+  struct tinywot_event_ring ring;
+  struct tinywot_event events[5];
+  struct tinywot_event event = {0};
+
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_ERROR_NOT_ENOUGH_MEMORY,
+    tinywot_event_ring_init(&ring, events, sizeof(events[0]) - 1)
+  );
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_SUCCESS,
+    tinywot_event_ring_init(&ring, events, sizeof(events))
+  );
+
+  /* 5 does not make a power of 2, so only 4 are used */
+  for (uint_least32_t i = 0; i < 4; i++) {
+    TEST_ASSERT_EQUAL(
+      TINYWOT_STATUS_SUCCESS, tinywot_event_ring_post(&ring, "/oh", i)
+    );
+  }
+
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_ERROR_NOT_ENOUGH_MEMORY,
+    tinywot_event_ring_post(&ring, "/oh", 4)
+  );
+
+  for (uint_least32_t i = 0; i < 4; i++) {
+    TEST_ASSERT_EQUAL(
+      TINYWOT_STATUS_SUCCESS, tinywot_event_ring_take(&ring, &event)
+    );
+    TEST_ASSERT_EQUAL_UINT(i, event.value);
+  }
+
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_ERROR_NOT_FOUND, tinywot_event_ring_take(&ring, &event)
+  );
+
+  /* the indices wrap around */
+  for (uint_least32_t i = 0; i < 1000; i++) {
+    TEST_ASSERT_EQUAL(
+      TINYWOT_STATUS_SUCCESS, tinywot_event_ring_post(&ring, "/oh", i)
+    );
+    TEST_ASSERT_EQUAL(
+      TINYWOT_STATUS_SUCCESS, tinywot_event_ring_take(&ring, &event)
+    );
+    TEST_ASSERT_EQUAL_UINT(i, event.value);
+  }
+}
+
+static void tinywot_thing_should_drain_events(void) {
+  struct tinywot_thing thing;
+  struct tinywot_observer observers[2];
+  struct tinywot_event_ring ring;
+  struct tinywot_event events[4];
+  struct tinywot_observer *observer = NULL;
+  struct tinywot_request request = {0};
+  struct tinywot_response response = {0};
+  uint_least32_t value = 0;
+
+  tinywot_thing_init_static(&thing, forms, sizeof(forms));
+  tinywot_thing_init_observers(&thing, observers, sizeof(observers));
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_SUCCESS,
+    tinywot_event_ring_init(&ring, events, sizeof(events))
+  );
+
+  response.payload.content = &value;
+  response.payload.content_buffer_size_byte = sizeof(value);
+
+  request.op = TINYWOT_OPERATION_TYPE_SUBSCRIBEEVENT;
+  request.origin = (unsigned char const *)"bob";
+  request.origin_length_byte = 3;
+  memcpy(request.target, "/oh", sizeof("/oh"));
+  tinywot_thing_process_request(&thing, &response, &request);
+  TEST_ASSERT_EQUAL(TINYWOT_RESPONSE_STATUS_INTERNAL_ERROR, response.status);
+
+  /* it was not a notification, so the payload was not a value */
+  request.payload.content = &value;
+  request.payload.content_length_byte = sizeof(value);
+  tinywot_thing_process_request(&thing, &response, &request);
+  TEST_ASSERT_EQUAL(TINYWOT_RESPONSE_STATUS_OK, response.status);
+
+  /* pretend to be an ISR */
+  tinywot_event_ring_post(&ring, "/oh", 90);
+  tinywot_event_ring_post(&ring, "/lorem", 0);
+  tinywot_event_ring_post(&ring, "/oh", 95);
+
+  TEST_ASSERT_EQUAL_UINT(3U, tinywot_thing_drain_events(&thing, &ring));
+  TEST_ASSERT_EQUAL_UINT(0U, tinywot_thing_drain_events(&thing, &ring));
+
+  /* two events make one notification with the latest value */
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_SUCCESS, tinywot_thing_next_notification(&thing, &observer)
+  );
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_SUCCESS,
+    tinywot_thing_process_notification(&thing, &response, observer)
+  );
+  TEST_ASSERT_EQUAL_UINT(95U, value);
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_ERROR_NOT_FOUND,
+    tinywot_thing_next_notification(&thing, &observer)
+  );
+}
+
+void setUp(void) {}
+void tearDown(void) {}
+
+int main(void) {
+  UNITY_BEGIN();
+
+  RUN_TEST(tinywot_event_ring_should_post_and_take);
+  RUN_TEST(tinywot_thing_should_drain_events);
+
+  return UNITY_END();
+}
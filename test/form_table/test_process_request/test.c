@@ -0,0 +1,191 @@
+/*
+  SPDX-FileCopyrightText: 2023 Junde Yhi <junde@yhi.moe>
+  SPDX-License-Identifier: MIT
+*/
+
+/*!
+  \file
+  \brief Unit tests for `tinywot_form_table_process_request()`.
+*/
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <tinywot/core.h>
+#include <tinywot-test.h>
+#include <unity.h>
+
+tinywot_form_handler_t handler_property_status_read;
+
+/* Count calls in the context. */
+static enum tinywot_status handler_action_toggle(
+  struct tinywot_payload *res,
+  struct tinywot_payload *req,
+  void *context
+) {
+  (void)req;
+
+  *(unsigned int *)context += 1;
+  res->content_length_byte = 0;
+
+  return TINYWOT_STATUS_SUCCESS;
+}
+
+static unsigned int toggles_n = 0;
+
+static char const *const targets[] = {"/status", "/toggle", "/status"};
+
+static uint_least8_t const ops[] = {
+  TINYWOT_OPERATION_TYPE_READPROPERTY,
+  TINYWOT_OPERATION_TYPE_INVOKEACTION,
+  TINYWOT_OPERATION_TYPE_WRITEPROPERTY,
+};
+
+static tinywot_form_handler_t *const handlers[] = {
+  handler_property_status_read,
+  handler_action_toggle,
+  NULL,
+};
+
+static void *const contexts[] = {NULL, &toggles_n, NULL};
+
+static struct tinywot_form_table const table = {
+  .targets = targets,
+  .ops = ops,
+  .op_sets = NULL,
+  .handlers = handlers,
+  .names = NULL,
+  .contexts = contexts,
+  .forms_count_n = sizeof(targets) / sizeof(targets[0]),
+};
+
+static enum tinywot_response_status process(
+  char const *target, enum tinywot_operation_type op
+) {
+  struct tinywot_request request = {0};
+  struct tinywot_response response = {0};
+
+  request.op = op;
+  strcpy(request.target, target);
+
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_SUCCESS,
+    tinywot_form_table_process_request(&table, &response, &request)
+  );
+
+  return response.status;
+}
+
+static void tinywot_form_table_should_find_forms(void) {
+  size_t position = SIZE_MAX;
+
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_SUCCESS,
+    tinywot_form_table_find(
+      &table, &position, "/status", TINYWOT_OPERATION_TYPE_WRITEPROPERTY
+    )
+  );
+  TEST_ASSERT_EQUAL_size_t(2U, position);
+
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_ERROR_NOT_ALLOWED,
+    tinywot_form_table_find(
+      &table, &position, "/toggle", TINYWOT_OPERATION_TYPE_READPROPERTY
+    )
+  );
+
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_ERROR_NOT_FOUND,
+    tinywot_form_table_find(
+      &table, &position, "/nothing", TINYWOT_OPERATION_TYPE_READPROPERTY
+    )
+  );
+}
+
+static void tinywot_form_table_should_find_forms_by_op_sets(void) {
+  static char const *const targets_ops[] = {"/status", "/status", "/gone"};
+  static uint_least8_t const ops_ops[] = {
+    TINYWOT_OPERATION_TYPE_READPROPERTY,
+    TINYWOT_OPERATION_TYPE_UNKNOWN,
+    TINYWOT_OPERATION_TYPE_UNKNOWN,
+  };
+  static uint_least32_t const op_sets[] = {
+    TINYWOT_OPERATION_TYPE_BIT(TINYWOT_OPERATION_TYPE_WRITEPROPERTY)
+      | TINYWOT_OPERATION_TYPE_BIT(TINYWOT_OPERATION_TYPE_OBSERVEPROPERTY),
+    TINYWOT_OPERATION_TYPE_BIT(TINYWOT_OPERATION_TYPE_INVOKEACTION),
+    0,
+  };
+  static tinywot_form_handler_t *const handlers_ops[] = {NULL, NULL, NULL};
+  struct tinywot_form_table const table_ops = {
+    .targets = targets_ops,
+    .ops = ops_ops,
+    .op_sets = op_sets,
+    .handlers = handlers_ops,
+    .forms_count_n = sizeof(targets_ops) / sizeof(targets_ops[0]),
+  };
+  size_t position = SIZE_MAX;
+
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_SUCCESS,
+    tinywot_form_table_find(
+      &table_ops, &position, "/status", TINYWOT_OPERATION_TYPE_WRITEPROPERTY
+    )
+  );
+  TEST_ASSERT_EQUAL_size_t(0U, position);
+
+  /* The removed form allows nothing. */
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_ERROR_NOT_ALLOWED,
+    tinywot_form_table_find(
+      &table_ops, &position, "/status", TINYWOT_OPERATION_TYPE_INVOKEACTION
+    )
+  );
+
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_ERROR_NOT_FOUND,
+    tinywot_form_table_find(
+      &table_ops, &position, "/gone", TINYWOT_OPERATION_TYPE_READPROPERTY
+    )
+  );
+}
+
+static void tinywot_form_table_should_process_requests(void) {
+  TEST_ASSERT_EQUAL(
+    TINYWOT_RESPONSE_STATUS_OK,
+    process("/status", TINYWOT_OPERATION_TYPE_READPROPERTY)
+  );
+
+  TEST_ASSERT_EQUAL(
+    TINYWOT_RESPONSE_STATUS_OK,
+    process("/toggle", TINYWOT_OPERATION_TYPE_INVOKEACTION)
+  );
+  TEST_ASSERT_EQUAL_UINT(1U, toggles_n);
+
+  TEST_ASSERT_EQUAL(
+    TINYWOT_RESPONSE_STATUS_NOT_SUPPORTED,
+    process("/status", TINYWOT_OPERATION_TYPE_WRITEPROPERTY)
+  );
+
+  TEST_ASSERT_EQUAL(
+    TINYWOT_RESPONSE_STATUS_NOT_ALLOWED,
+    process("/toggle", TINYWOT_OPERATION_TYPE_READPROPERTY)
+  );
+
+  TEST_ASSERT_EQUAL(
+    TINYWOT_RESPONSE_STATUS_NOT_FOUND,
+    process("/nothing", TINYWOT_OPERATION_TYPE_READPROPERTY)
+  );
+}
+
+void setUp(void) {}
+void tearDown(void) {}
+
+int main(void) {
+  UNITY_BEGIN();
+
+  RUN_TEST(tinywot_form_table_should_find_forms);
+  RUN_TEST(tinywot_form_table_should_find_forms_by_op_sets);
+  RUN_TEST(tinywot_form_table_should_process_requests);
+
+  return UNITY_END();
+}
@@ -0,0 +1,224 @@
+/*
+  SPDX-FileCopyrightText: 2023 Junde Yhi <junde@yhi.moe>
+  SPDX-License-Identifier: MIT
+*/
+
+/*!
+  \file
+  \brief Unit tests for `tinywot_json_handler_read_all_properties()` and
+  `tinywot_json_handler_read_multiple_properties()`.
+*/
+
+#include <stddef.h>
+#include <string.h>
+#include <tinywot/core.h>
+#include <tinywot/json.h>
+#include <tinywot-test.h>
+#include <unity.h>
+
+/* Defined in tinywot-test.c. */
+tinywot_form_handler_t handler_property_status_read;
+
+static enum tinywot_status handler_property_temperature_read(
+  struct tinywot_payload *res, struct tinywot_payload *req, void *context
+) {
+  struct tinywot_json_writer w;
+
+  (void)req;
+  (void)context;
+
+  tinywot_json_writer_init(&w, res);
+  tinywot_json_write_float(&w, 21.5, 1);
+  res->content_type = 50;
+
+  return w.status;
+}
+
+static enum tinywot_status handler_property_broken_read(
+  struct tinywot_payload *res, struct tinywot_payload *req, void *context
+) {
+  (void)res;
+  (void)req;
+  (void)context;
+
+  return TINYWOT_STATUS_ERROR_GENERIC;
+}
+
+static enum tinywot_status handler_property_status_read_true(
+  struct tinywot_payload *res, struct tinywot_payload *req, void *context
+) {
+  (void)req;
+  (void)context;
+
+  res->content_type = 50;
+
+  return tinywot_payload_append(res, "true", 4);
+}
+
+static struct tinywot_json_batch batch = {
+  .thing = NULL,
+  .content_type = 50,
+  .policy = TINYWOT_JSON_BATCH_POLICY_ABORT,
+};
+
+static struct tinywot_form const forms[] = {
+  {
+    .name = "status",
+    .target = "/status",
+    .op = TINYWOT_OPERATION_TYPE_READPROPERTY,
+    .handler = handler_property_status_read,
+  },
+  {
+    .name = "broken",
+    .target = "/broken",
+    .op = TINYWOT_OPERATION_TYPE_READPROPERTY,
+    .handler = handler_property_broken_read,
+  },
+  {
+    .name = "temperature",
+    .target = "/temperature",
+    .op = TINYWOT_OPERATION_TYPE_READPROPERTY,
+    .handler = handler_property_temperature_read,
+  },
+  {
+    .name = NULL,
+    .target = "/properties",
+    .op = TINYWOT_OPERATION_TYPE_READALLPROPERTIES,
+    .handler = tinywot_json_handler_read_all_properties,
+    .context = &batch,
+  },
+  {
+    .name = NULL,
+    .target = "/properties",
+    .op = TINYWOT_OPERATION_TYPE_READMULTIPLEPROPERTIES,
+    .handler = tinywot_json_handler_read_multiple_properties,
+    .context = &batch,
+  },
+};
+
+static struct tinywot_thing thing;
+static struct tinywot_request request;
+static struct tinywot_response response;
+static unsigned char content_out[TINYWOT_TEST_MEMORY_SIZE_BYTE];
+
+static void request_properties(
+  enum tinywot_operation_type op, char const *names
+) {
+  memset(&request, 0, sizeof(request));
+  request.op = op;
+  memcpy(request.target, "/properties", sizeof("/properties"));
+
+  if (names) {
+    request.payload.content = (void *)names;
+    request.payload.content_length_byte = strlen(names);
+    request.payload.content_buffer_size_byte = strlen(names);
+    request.payload.content_type = 50;
+  }
+
+  memset(&response, 0, sizeof(response));
+  response.payload.content = content_out;
+  response.payload.content_buffer_size_byte = sizeof(content_out);
+
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_SUCCESS,
+    tinywot_thing_process_request(&thing, &response, &request)
+  );
+}
+
+static void assert_response(char const *expected) {
+  TEST_ASSERT_EQUAL(TINYWOT_RESPONSE_STATUS_OK, response.status);
+  TEST_ASSERT_EQUAL_UINT(50U, response.payload.content_type);
+  TEST_ASSERT_EQUAL_UINT(
+    strlen(expected), response.payload.content_length_byte
+  );
+  TEST_ASSERT_EQUAL_MEMORY(
+    expected, response.payload.content, strlen(expected)
+  );
+}
+
+static void tinywot_json_batch_should_abort(void) {
+  batch.policy = TINYWOT_JSON_BATCH_POLICY_ABORT;
+
+  request_properties(TINYWOT_OPERATION_TYPE_READALLPROPERTIES, NULL);
+  TEST_ASSERT_EQUAL(TINYWOT_RESPONSE_STATUS_INTERNAL_ERROR, response.status);
+  TEST_ASSERT_EQUAL_UINT(0U, response.payload.content_length_byte);
+
+  request_properties(
+    TINYWOT_OPERATION_TYPE_READMULTIPLEPROPERTIES, "[\"status\", \"lorem\"]"
+  );
+  TEST_ASSERT_EQUAL(TINYWOT_RESPONSE_STATUS_NOT_FOUND, response.status);
+
+  request_properties(
+    TINYWOT_OPERATION_TYPE_READMULTIPLEPROPERTIES, " [ \"temperature\" ,"
+    "\"status\" ] "
+  );
+  assert_response("{\"temperature\":21.5,\"status\":false}");
+}
+
+static void tinywot_json_batch_should_skip(void) {
+  batch.policy = TINYWOT_JSON_BATCH_POLICY_SKIP;
+
+  request_properties(TINYWOT_OPERATION_TYPE_READALLPROPERTIES, NULL);
+  assert_response("{\"status\":false,\"temperature\":21.5}");
+
+  request_properties(
+    TINYWOT_OPERATION_TYPE_READMULTIPLEPROPERTIES,
+    "[\"broken\",\"lorem\",\"temperature\"]"
+  );
+  assert_response("{\"temperature\":21.5}");
+
+  request_properties(TINYWOT_OPERATION_TYPE_READMULTIPLEPROPERTIES, "[]");
+  assert_response("{}");
+
+  request_properties(
+    TINYWOT_OPERATION_TYPE_READMULTIPLEPROPERTIES, "{\"status\"}"
+  );
+  TEST_ASSERT_EQUAL(TINYWOT_RESPONSE_STATUS_NOT_ALLOWED, response.status);
+}
+
+static void tinywot_json_batch_should_skip_overridden_forms(void) {
+  static struct tinywot_form forms_dynamic[8];
+  static struct tinywot_form const status = {
+    .name = "status",
+    .target = "/status",
+    .op = TINYWOT_OPERATION_TYPE_READPROPERTY,
+    .handler = handler_property_status_read_true,
+  };
+
+  batch.policy = TINYWOT_JSON_BATCH_POLICY_SKIP;
+
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_SUCCESS,
+    tinywot_thing_init_dynamic_from_static(
+      &thing, forms_dynamic, sizeof(forms_dynamic), forms, sizeof(forms)
+    )
+  );
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_SUCCESS, tinywot_thing_add_form(&thing, &status)
+  );
+
+  request_properties(TINYWOT_OPERATION_TYPE_READALLPROPERTIES, NULL);
+  assert_response("{\"temperature\":21.5,\"status\":true}");
+
+  request_properties(
+    TINYWOT_OPERATION_TYPE_READMULTIPLEPROPERTIES, "[\"status\"]"
+  );
+  assert_response("{\"status\":true}");
+}
+
+void setUp(void) {
+  tinywot_thing_init_static(&thing, forms, sizeof(forms));
+  batch.thing = &thing;
+}
+
+void tearDown(void) {}
+
+int main(void) {
+  UNITY_BEGIN();
+
+  RUN_TEST(tinywot_json_batch_should_abort);
+  RUN_TEST(tinywot_json_batch_should_skip);
+  RUN_TEST(tinywot_json_batch_should_skip_overridden_forms);
+
+  return UNITY_END();
+}
@@ -0,0 +1,298 @@
+/*
+  SPDX-FileCopyrightText: 2023 Junde Yhi <junde@yhi.moe>
+  SPDX-License-Identifier: MIT
+*/
+
+/*!
+  \file
+  \brief Unit tests for `tinywot_json_td`.
+*/
+
+#include <stddef.h>
+#include <string.h>
+#include <tinywot/core.h>
+#include <tinywot/json.h>
+#include <tinywot-test.h>
+#include <unity.h>
+
+tinywot_form_handler_t handler_property_status_read;
+tinywot_form_handler_t handler_property_status_write;
+tinywot_form_handler_t handler_action_toggle;
+
+static char const td_prefix[] =
+  "{\"@context\":\"https://www.w3.org/2022/wot/td/v1.1\","
+  "\"title\":\"Lamp\","
+  "\"securityDefinitions\":{\"nosec_sc\":{\"scheme\":\"nosec\"}},"
+  "\"security\":\"nosec_sc\","
+  "\"properties\":{\"status\":{\"forms\":[{\"href\":\"/status\","
+  "\"op\":[\"readproperty\",\"writeproperty\"]}]}},";
+
+static char const td_actions[] =
+  "\"actions\":{\"toggle\":{\"forms\":[{\"href\":\"/toggle\","
+  "\"op\":[\"invokeaction\"]}]}},";
+
+static char const td_suffix[] =
+  "\"forms\":[{\"href\":\"/.well-known/wot\",\"op\":[\"readproperty\"]}]}";
+
+static struct tinywot_thing *thing;
+static struct tinywot_json_td td;
+static unsigned char *td_memory;
+
+/* Fetch the TD in blocks of TINYWOT_TEST_SMALL_MEMORY_SIZE_BYTE. */
+static size_t fetch(char *received, uint_least32_t etag) {
+  enum tinywot_status status = TINYWOT_STATUS_ERROR_GENERIC;
+  struct tinywot_request request = {0};
+  struct tinywot_response response = {0};
+  unsigned char block[TINYWOT_TEST_SMALL_MEMORY_SIZE_BYTE];
+  size_t received_byte = 0;
+
+  request.op = TINYWOT_OPERATION_TYPE_READPROPERTY;
+  request.etag = etag;
+  strcpy(request.target, "/.well-known/wot");
+
+  response.payload.content = block;
+  response.payload.content_buffer_size_byte = sizeof(block);
+
+  do {
+    status = tinywot_thing_process_request(thing, &response, &request);
+    TEST_ASSERT_EQUAL_UINT32(td.version, response.etag);
+    TEST_ASSERT_EQUAL_UINT(432U, response.payload.content_type);
+
+    memcpy(
+      received + received_byte,
+      response.payload.content,
+      response.payload.content_length_byte
+    );
+    received_byte += response.payload.content_length_byte;
+    tinywot_response_next_block(&response);
+
+    /* Following blocks must be of the version of the first one. */
+    request.etag = response.etag;
+  } while (status == TINYWOT_STATUS_NOT_FINISHED);
+
+  received[received_byte] = '\0';
+
+  return received_byte;
+}
+
+static void tinywot_json_td_should_describe_forms(void) {
+  char *received = tinywot_test_malloc0(TINYWOT_TEST_MEMORY_SIZE_BYTE);
+  char *expected = tinywot_test_malloc0(TINYWOT_TEST_MEMORY_SIZE_BYTE);
+
+  strcat(expected, td_prefix);
+  strcat(expected, td_actions);
+  strcat(expected, td_suffix);
+
+  TEST_ASSERT_EQUAL_size_t(strlen(expected), fetch(received, 0));
+  TEST_ASSERT_EQUAL_STRING(expected, received);
+  TEST_ASSERT_EQUAL_UINT32(1U, td.version);
+
+  /* Nothing has changed, so the TD is not generated again. */
+  fetch(received, 0);
+  TEST_ASSERT_EQUAL_UINT32(1U, td.version);
+  TEST_ASSERT_EQUAL_STRING(expected, received);
+
+  /* A client with the current version gets nothing. */
+  TEST_ASSERT_EQUAL_size_t(0U, fetch(received, td.version));
+
+  tinywot_test_free(expected);
+  tinywot_test_free(received);
+}
+
+static void tinywot_json_td_should_follow_changes(void) {
+  char *received = tinywot_test_malloc0(TINYWOT_TEST_MEMORY_SIZE_BYTE);
+  char *expected = tinywot_test_malloc0(TINYWOT_TEST_MEMORY_SIZE_BYTE);
+
+  fetch(received, 0);
+  TEST_ASSERT_EQUAL_UINT32(1U, td.version);
+
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_SUCCESS,
+    tinywot_thing_remove_form(
+      thing, "/toggle", TINYWOT_OPERATION_TYPE_INVOKEACTION
+    )
+  );
+
+  strcat(expected, td_prefix);
+  strcat(expected, td_suffix);
+
+  fetch(received, 1U);
+  TEST_ASSERT_EQUAL_UINT32(2U, td.version);
+  TEST_ASSERT_EQUAL_STRING(expected, received);
+
+  tinywot_test_free(expected);
+  tinywot_test_free(received);
+}
+
+static void tinywot_json_td_should_group_forms(void) {
+  char *received = tinywot_test_malloc0(TINYWOT_TEST_MEMORY_SIZE_BYTE);
+  struct tinywot_form form = {0};
+
+  /* Added after other affordances, but still grouped with the first
+     forms of "status". */
+  form.name = "status";
+  form.target = "/status/raw";
+  form.op = TINYWOT_OPERATION_TYPE_READPROPERTY;
+  form.handler = handler_property_status_read;
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_SUCCESS, tinywot_thing_add_form(thing, &form)
+  );
+
+  fetch(received, 0);
+  TEST_ASSERT_EQUAL_STRING(
+    "{\"@context\":\"https://www.w3.org/2022/wot/td/v1.1\","
+    "\"title\":\"Lamp\","
+    "\"securityDefinitions\":{\"nosec_sc\":{\"scheme\":\"nosec\"}},"
+    "\"security\":\"nosec_sc\","
+    "\"properties\":{\"status\":{\"forms\":[{\"href\":\"/status\","
+    "\"op\":[\"readproperty\",\"writeproperty\"]},"
+    "{\"href\":\"/status/raw\",\"op\":[\"readproperty\"]}]}},"
+    "\"actions\":{\"toggle\":{\"forms\":[{\"href\":\"/toggle\","
+    "\"op\":[\"invokeaction\"]}]}},"
+    "\"forms\":[{\"href\":\"/.well-known/wot\","
+    "\"op\":[\"readproperty\"]}]}",
+    received
+  );
+
+  tinywot_test_free(received);
+}
+
+static void tinywot_json_td_should_detect_changes_between_blocks(void) {
+  char *received = tinywot_test_malloc0(TINYWOT_TEST_MEMORY_SIZE_BYTE);
+  struct tinywot_request request = {0};
+  struct tinywot_response response = {0};
+  unsigned char block[TINYWOT_TEST_SMALL_MEMORY_SIZE_BYTE];
+
+  request.op = TINYWOT_OPERATION_TYPE_READPROPERTY;
+  strcpy(request.target, "/.well-known/wot");
+
+  response.payload.content = block;
+  response.payload.content_buffer_size_byte = sizeof(block);
+
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_NOT_FINISHED,
+    tinywot_thing_process_request(thing, &response, &request)
+  );
+  TEST_ASSERT_EQUAL_UINT32(1U, response.etag);
+  tinywot_response_next_block(&response);
+  request.etag = response.etag;
+
+  /* Another requester gets a new TD in the meantime. */
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_SUCCESS,
+    tinywot_thing_remove_form(
+      thing, "/toggle", TINYWOT_OPERATION_TYPE_INVOKEACTION
+    )
+  );
+  fetch(received, 0);
+  TEST_ASSERT_EQUAL_UINT32(2U, td.version);
+
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_SUCCESS,
+    tinywot_thing_process_request(thing, &response, &request)
+  );
+  TEST_ASSERT_EQUAL(
+    TINYWOT_RESPONSE_STATUS_PRECONDITION_FAILED, response.status
+  );
+  TEST_ASSERT_EQUAL_size_t(0U, response.payload.content_length_byte);
+
+  tinywot_test_free(received);
+}
+
+static void tinywot_json_td_should_continue_from_random_version(void) {
+  char *received = tinywot_test_malloc0(TINYWOT_TEST_MEMORY_SIZE_BYTE);
+  size_t received_byte = 0;
+
+  /* As an application would do after a reboot. */
+  td.version = 0xa5a5a5a5U;
+
+  received_byte = fetch(received, 0);
+  TEST_ASSERT_NOT_EQUAL(0U, received_byte);
+  TEST_ASSERT_EQUAL_UINT32(0xa5a5a5a6U, td.version);
+
+  /* An ETag from before the reboot does not match. */
+  TEST_ASSERT_EQUAL_size_t(received_byte, fetch(received, 1U));
+
+  /* 0 is skipped on overflow. */
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_SUCCESS,
+    tinywot_thing_remove_form(
+      thing, "/toggle", TINYWOT_OPERATION_TYPE_INVOKEACTION
+    )
+  );
+  td.version = 0xffffffffU;
+  fetch(received, 0);
+  TEST_ASSERT_EQUAL_UINT32(1U, td.version);
+
+  tinywot_test_free(received);
+}
+
+static void tinywot_json_td_should_fail_when_too_small(void) {
+  tinywot_json_td_init(&td, thing, "Lamp", NULL, 432U, td_memory, 16U);
+
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_ERROR_NOT_ENOUGH_MEMORY, tinywot_json_td_update(&td)
+  );
+  TEST_ASSERT_EQUAL_UINT32(0U, td.version);
+  TEST_ASSERT_EQUAL_size_t(0U, td.content_length_byte);
+}
+
+void setUp(void) {
+  struct tinywot_form form = {0};
+
+  thing = tinywot_test_thing_new();
+  td_memory = tinywot_test_mallocd(TINYWOT_TEST_MEMORY_SIZE_BYTE);
+
+  tinywot_json_td_init(
+    &td, thing, "Lamp", NULL, 432U, td_memory, TINYWOT_TEST_MEMORY_SIZE_BYTE
+  );
+
+  form.name = "status";
+  form.target = "/status";
+  form.op = TINYWOT_OPERATION_TYPE_READPROPERTY;
+  form.handler = handler_property_status_read;
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_SUCCESS, tinywot_thing_add_form(thing, &form)
+  );
+
+  form.op = TINYWOT_OPERATION_TYPE_WRITEPROPERTY;
+  form.handler = handler_property_status_write;
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_SUCCESS, tinywot_thing_add_form(thing, &form)
+  );
+
+  form.name = "toggle";
+  form.target = "/toggle";
+  form.op = TINYWOT_OPERATION_TYPE_INVOKEACTION;
+  form.handler = handler_action_toggle;
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_SUCCESS, tinywot_thing_add_form(thing, &form)
+  );
+
+  form.name = NULL;
+  form.target = "/.well-known/wot";
+  form.op = TINYWOT_OPERATION_TYPE_READPROPERTY;
+  form.handler = tinywot_json_td_handler;
+  form.context = &td;
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_SUCCESS, tinywot_thing_add_form(thing, &form)
+  );
+}
+
+void tearDown(void) {
+  tinywot_test_free(td_memory);
+  tinywot_test_thing_delete(thing);
+}
+
+int main(void) {
+  UNITY_BEGIN();
+
+  RUN_TEST(tinywot_json_td_should_describe_forms);
+  RUN_TEST(tinywot_json_td_should_follow_changes);
+  RUN_TEST(tinywot_json_td_should_group_forms);
+  RUN_TEST(tinywot_json_td_should_detect_changes_between_blocks);
+  RUN_TEST(tinywot_json_td_should_continue_from_random_version);
+  RUN_TEST(tinywot_json_td_should_fail_when_too_small);
+
+  return UNITY_END();
+}
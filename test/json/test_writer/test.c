@@ -0,0 +1,120 @@
+/*
+  SPDX-FileCopyrightText: 2023 Junde Yhi <junde@yhi.moe>
+  SPDX-License-Identifier: MIT
+*/
+
+/*!
+  \file
+  \brief Unit tests for `tinywot_json_writer`.
+*/
+
+#include <limits.h>
+#include <stddef.h>
+#include <string.h>
+#include <tinywot/core.h>
+#include <tinywot/json.h>
+#include <tinywot-test.h>
+#include <unity.h>
+
+static void tinywot_json_writer_should_write_a_document(void) {
+  struct tinywot_payload *pl =
+    tinywot_test_payload_new(TINYWOT_TEST_MEMORY_SIZE_BYTE);
+  struct tinywot_json_writer w;
+  char const expected[] =
+    "{\"name\":\"a \\\"b\\\"\\n\\u0001\","
+    "\"values\":[0,-42,4294967295,21.50,-0.1,0,null],"
+    "\"on\":true,\"off\":false,\"none\":null,\"raw\":{},\"empty\":[]}";
+
+  TEST_ASSERT_NOT_NULL(pl);
+  tinywot_json_writer_init(&w, pl);
+
+  tinywot_json_write_object_begin(&w);
+  tinywot_json_write_key(&w, "name");
+  tinywot_json_write_string(&w, "a \"b\"\n\x01");
+  tinywot_json_write_key(&w, "values");
+  tinywot_json_write_array_begin(&w);
+  tinywot_json_write_int(&w, 0);
+  tinywot_json_write_int(&w, -42);
+  tinywot_json_write_uint(&w, 4294967295UL);
+  tinywot_json_write_float(&w, 21.5, 2);
+  tinywot_json_write_float(&w, -0.125, 1);
+  tinywot_json_write_float(&w, -0.01, 0);
+  tinywot_json_write_float(&w, 0.0 / 0.0, 2);
+  tinywot_json_write_array_end(&w);
+  tinywot_json_write_key(&w, "on");
+  tinywot_json_write_bool(&w, true);
+  tinywot_json_write_key(&w, "off");
+  tinywot_json_write_bool(&w, false);
+  tinywot_json_write_key(&w, "none");
+  tinywot_json_write_null(&w);
+  tinywot_json_write_key(&w, "raw");
+  tinywot_json_write_raw(&w, "{}", 2);
+  tinywot_json_write_key(&w, "empty");
+  tinywot_json_write_array_begin(&w);
+  tinywot_json_write_array_end(&w);
+  tinywot_json_write_object_end(&w);
+
+  TEST_ASSERT_EQUAL(TINYWOT_STATUS_SUCCESS, w.status);
+  TEST_ASSERT_EQUAL_UINT(strlen(expected), pl->content_length_byte);
+  TEST_ASSERT_EQUAL_MEMORY(expected, pl->content, strlen(expected));
+
+  tinywot_test_payload_delete(pl);
+}
+
+static void tinywot_json_writer_should_write_long_min(void) {
+  struct tinywot_payload *pl =
+    tinywot_test_payload_new(TINYWOT_TEST_MEMORY_SIZE_BYTE);
+  struct tinywot_json_writer w;
+  unsigned char buf[TINYWOT_TEST_MEMORY_SIZE_BYTE] = {0};
+
+  TEST_ASSERT_NOT_NULL(pl);
+  tinywot_json_writer_init(&w, pl);
+
+  TEST_ASSERT_EQUAL(TINYWOT_STATUS_SUCCESS, tinywot_json_write_int(&w, LONG_MIN));
+  memcpy(buf, pl->content, pl->content_length_byte);
+  TEST_ASSERT_EQUAL('-', buf[0]);
+  TEST_ASSERT_EQUAL('8', buf[pl->content_length_byte - 1]);
+
+  tinywot_test_payload_delete(pl);
+}
+
+static void tinywot_json_writer_should_fail_when_no_enough_memory(void) {
+  struct tinywot_payload *pl =
+    tinywot_test_payload_new(TINYWOT_TEST_SMALL_MEMORY_SIZE_BYTE);
+  struct tinywot_json_writer w;
+  enum tinywot_status sc = TINYWOT_STATUS_ERROR_GENERIC;
+
+  TEST_ASSERT_NOT_NULL(pl);
+  tinywot_json_writer_init(&w, pl);
+
+  tinywot_json_write_array_begin(&w);
+  tinywot_json_write_string(&w, "0123456789");
+  TEST_ASSERT_EQUAL(TINYWOT_STATUS_SUCCESS, w.status);
+  TEST_ASSERT_EQUAL_UINT(13U, pl->content_length_byte);
+
+  /* the failed write is undone */
+  sc = tinywot_json_write_string(&w, "abc");
+  TEST_ASSERT_EQUAL(TINYWOT_STATUS_ERROR_NOT_ENOUGH_MEMORY, sc);
+  TEST_ASSERT_EQUAL_UINT(13U, pl->content_length_byte);
+
+  /* the error is sticky, even if the next write would fit */
+  sc = tinywot_json_write_array_end(&w);
+  TEST_ASSERT_EQUAL(TINYWOT_STATUS_ERROR_NOT_ENOUGH_MEMORY, sc);
+  TEST_ASSERT_EQUAL(TINYWOT_STATUS_ERROR_NOT_ENOUGH_MEMORY, w.status);
+  TEST_ASSERT_EQUAL_UINT(13U, pl->content_length_byte);
+
+  tinywot_test_payload_delete(pl);
+}
+
+void setUp(void) {}
+void tearDown(void) {}
+
+int main(void) {
+  UNITY_BEGIN();
+
+  RUN_TEST(tinywot_json_writer_should_write_a_document);
+  RUN_TEST(tinywot_json_writer_should_write_long_min);
+  RUN_TEST(tinywot_json_writer_should_fail_when_no_enough_memory);
+
+  return UNITY_END();
+}
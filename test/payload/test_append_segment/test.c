@@ -0,0 +1,119 @@
+/*
+  SPDX-FileCopyrightText: 2023 Junde Yhi <junde@yhi.moe>
+  SPDX-License-Identifier: MIT
+*/
+
+/*!
+  \file
+  \brief Unit tests for `tinywot_payload_append_segment()`.
+*/
+
+#include <stddef.h>
+#include <string.h>
+#include <tinywot/core.h>
+#include <tinywot-test.h>
+#include <unity.h>
+
+static char const head[] = "{\"temperature\":";
+static char const tail[] = "}";
+static char const expected[] = "{\"temperature\":21.5}";
+
+static void tinywot_payload_append_segment_should_succeed(void) {
+  struct tinywot_payload *pl =
+    tinywot_test_payload_new(TINYWOT_TEST_SMALL_MEMORY_SIZE_BYTE);
+  struct tinywot_payload_segment segs[4] = {0};
+  unsigned char buf[TINYWOT_TEST_MEMORY_SIZE_BYTE] = {0};
+  enum tinywot_status sc = TINYWOT_STATUS_ERROR_GENERIC;
+
+  TEST_ASSERT_NOT_NULL(pl);
+  tinywot_payload_init_segments(pl, segs, sizeof(segs));
+  TEST_ASSERT_EQUAL_UINT(4U, pl->segments_max_n);
+  TEST_ASSERT_EQUAL_UINT(0U, pl->segments_count_n);
+
+  /* static data is referenced, not copied */
+  sc = tinywot_payload_append_segment(
+    pl, head, strlen(head), TINYWOT_PAYLOAD_SEGMENT_OWNERSHIP_STATIC
+  );
+  TEST_ASSERT_EQUAL(TINYWOT_STATUS_SUCCESS, sc);
+  TEST_ASSERT_EQUAL_UINT(1U, pl->segments_count_n);
+  TEST_ASSERT_EQUAL_PTR(head, segs[0].content);
+
+  /* consecutive copies share one segment in content */
+  sc = tinywot_payload_append_string(pl, "21");
+  TEST_ASSERT_EQUAL(TINYWOT_STATUS_SUCCESS, sc);
+  sc = tinywot_payload_append(pl, ".5", 2);
+  TEST_ASSERT_EQUAL(TINYWOT_STATUS_SUCCESS, sc);
+  TEST_ASSERT_EQUAL_UINT(2U, pl->segments_count_n);
+  TEST_ASSERT_EQUAL_PTR(pl->content, segs[1].content);
+  TEST_ASSERT_EQUAL_UINT(4U, segs[1].content_length_byte);
+  TEST_ASSERT_EQUAL(TINYWOT_PAYLOAD_SEGMENT_OWNERSHIP_CONTENT, segs[1].ownership);
+
+  sc = tinywot_payload_append_segment(
+    pl, tail, strlen(tail), TINYWOT_PAYLOAD_SEGMENT_OWNERSHIP_BORROWED
+  );
+  TEST_ASSERT_EQUAL(TINYWOT_STATUS_SUCCESS, sc);
+  TEST_ASSERT_EQUAL_UINT(3U, pl->segments_count_n);
+  TEST_ASSERT_EQUAL_UINT(strlen(expected), pl->content_length_byte);
+
+  /* a copy after a reference starts a new segment past the used bytes */
+  sc = tinywot_payload_append(pl, "!", 1);
+  TEST_ASSERT_EQUAL(TINYWOT_STATUS_SUCCESS, sc);
+  TEST_ASSERT_EQUAL_UINT(4U, pl->segments_count_n);
+  TEST_ASSERT_EQUAL_PTR((unsigned char *)pl->content + 4, segs[3].content);
+
+  sc = tinywot_payload_gather(pl, buf, sizeof(buf));
+  TEST_ASSERT_EQUAL(TINYWOT_STATUS_SUCCESS, sc);
+  TEST_ASSERT_EQUAL_MEMORY(expected, buf, strlen(expected));
+  TEST_ASSERT_EQUAL('!', buf[strlen(expected)]);
+
+  tinywot_test_payload_delete(pl);
+}
+
+static void tinywot_payload_append_segment_should_fail_when_no_enough_memory(
+  void
+) {
+  struct tinywot_payload *pl =
+    tinywot_test_payload_new(TINYWOT_TEST_SMALL_MEMORY_SIZE_BYTE);
+  struct tinywot_payload_segment segs[1] = {0};
+  unsigned char buf[4] = {0};
+  enum tinywot_status sc = TINYWOT_STATUS_ERROR_GENERIC;
+
+  TEST_ASSERT_NOT_NULL(pl);
+
+  /* not a scatter-gather payload */
+  sc = tinywot_payload_append_segment(
+    pl, head, strlen(head), TINYWOT_PAYLOAD_SEGMENT_OWNERSHIP_STATIC
+  );
+  TEST_ASSERT_EQUAL(TINYWOT_STATUS_ERROR_NOT_ALLOWED, sc);
+
+  tinywot_payload_init_segments(pl, segs, sizeof(segs));
+
+  sc = tinywot_payload_append_segment(
+    pl, head, strlen(head), TINYWOT_PAYLOAD_SEGMENT_OWNERSHIP_STATIC
+  );
+  TEST_ASSERT_EQUAL(TINYWOT_STATUS_SUCCESS, sc);
+
+  /* no segment left */
+  sc = tinywot_payload_append(pl, "21", 2);
+  TEST_ASSERT_EQUAL(TINYWOT_STATUS_ERROR_NOT_ENOUGH_MEMORY, sc);
+  TEST_ASSERT_EQUAL_UINT(1U, pl->segments_count_n);
+  TEST_ASSERT_EQUAL_UINT(strlen(head), pl->content_length_byte);
+
+  /* buffer too small */
+  sc = tinywot_payload_gather(pl, buf, sizeof(buf));
+  TEST_ASSERT_EQUAL(TINYWOT_STATUS_ERROR_NOT_ENOUGH_MEMORY, sc);
+
+  tinywot_test_payload_delete(pl);
+}
+
+void setUp(void) {}
+void tearDown(void) {}
+
+int main(void) {
+  UNITY_BEGIN();
+
+  RUN_TEST(tinywot_payload_append_segment_should_succeed);
+  RUN_TEST(tinywot_payload_append_segment_should_fail_when_no_enough_memory);
+
+  return UNITY_END();
+}
@@ -0,0 +1,91 @@
+/*
+  SPDX-FileCopyrightText: 2023 Junde Yhi <junde@yhi.moe>
+  SPDX-License-Identifier: MIT
+*/
+
+/*!
+  \file
+  \brief Unit tests for `tinywot_payload_mark()` and
+  `tinywot_payload_rollback()`.
+*/
+
+#include <stddef.h>
+#include <string.h>
+#include <tinywot/core.h>
+#include <tinywot-test.h>
+#include <unity.h>
+
+static void tinywot_payload_rollback_should_undo_appends(void) {
+  struct tinywot_payload *pl =
+    tinywot_test_payload_new(TINYWOT_TEST_SMALL_MEMORY_SIZE_BYTE);
+  struct tinywot_payload_mark mark;
+
+  TEST_ASSERT_NOT_NULL(pl);
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_SUCCESS, tinywot_payload_append(pl, "ab", 2U)
+  );
+
+  tinywot_payload_mark(pl, &mark);
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_SUCCESS, tinywot_payload_append(pl, "cd", 2U)
+  );
+
+  tinywot_payload_rollback(pl, &mark);
+  TEST_ASSERT_EQUAL_UINT(2U, pl->content_length_byte);
+
+  tinywot_test_payload_delete(pl);
+}
+
+static void tinywot_payload_rollback_should_undo_segments(void) {
+  struct tinywot_payload *pl =
+    tinywot_test_payload_new(TINYWOT_TEST_SMALL_MEMORY_SIZE_BYTE);
+  struct tinywot_payload_segment segs[4] = {0};
+  struct tinywot_payload_mark mark;
+  unsigned char buf[TINYWOT_TEST_SMALL_MEMORY_SIZE_BYTE] = {0};
+
+  TEST_ASSERT_NOT_NULL(pl);
+  tinywot_payload_init_segments(pl, segs, sizeof(segs));
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_SUCCESS, tinywot_payload_append_string(pl, "ab")
+  );
+
+  /* Both a grown segment and a new one are undone. */
+  tinywot_payload_mark(pl, &mark);
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_SUCCESS, tinywot_payload_append_string(pl, "c")
+  );
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_SUCCESS,
+    tinywot_payload_append_segment(
+      pl, "de", 2U, TINYWOT_PAYLOAD_SEGMENT_OWNERSHIP_STATIC
+    )
+  );
+  TEST_ASSERT_EQUAL_UINT(2U, pl->segments_count_n);
+
+  tinywot_payload_rollback(pl, &mark);
+  TEST_ASSERT_EQUAL_UINT(1U, pl->segments_count_n);
+  TEST_ASSERT_EQUAL_UINT(2U, segs[0].content_length_byte);
+  TEST_ASSERT_EQUAL_UINT(2U, pl->content_length_byte);
+
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_SUCCESS, tinywot_payload_append_string(pl, "x")
+  );
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_SUCCESS, tinywot_payload_gather(pl, buf, sizeof(buf))
+  );
+  TEST_ASSERT_EQUAL_MEMORY("abx", buf, 3U);
+
+  tinywot_test_payload_delete(pl);
+}
+
+void setUp(void) {}
+void tearDown(void) {}
+
+int main(void) {
+  UNITY_BEGIN();
+
+  RUN_TEST(tinywot_payload_rollback_should_undo_appends);
+  RUN_TEST(tinywot_payload_rollback_should_undo_segments);
+
+  return UNITY_END();
+}
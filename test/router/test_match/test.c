@@ -0,0 +1,412 @@
+/*
+  SPDX-FileCopyrightText: 2023 Junde Yhi <junde@yhi.moe>
+  SPDX-License-Identifier: MIT
+*/
+
+/*!
+  \file
+  \brief Unit tests for `tinywot_router_match()`.
+*/
+
+#include <stddef.h>
+#include <string.h>
+#include <tinywot/core.h>
+#include <tinywot-test.h>
+#include <unity.h>
+
+static char const pattern_root[] = "/";
+static char const pattern_status[] = "/properties/status";
+static char const pattern_property[] = "/properties/{name}";
+static char const pattern_action[] = "/actions/{name}/{id}";
+static char const pattern_logs[] = "/logs/*";
+
+static struct tinywot_router_node nodes[24];
+
+static void tinywot_test_router_init(struct tinywot_router *router) {
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_SUCCESS, tinywot_router_init(router, nodes, sizeof(nodes))
+  );
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_SUCCESS, tinywot_router_insert(router, pattern_root)
+  );
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_SUCCESS, tinywot_router_insert(router, pattern_property)
+  );
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_SUCCESS, tinywot_router_insert(router, pattern_status)
+  );
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_SUCCESS, tinywot_router_insert(router, pattern_action)
+  );
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_SUCCESS, tinywot_router_insert(router, pattern_logs)
+  );
+}
+
+static void tinywot_router_match_should_succeed(void) {
+  enum tinywot_status status = TINYWOT_STATUS_ERROR_GENERIC;
+  struct tinywot_router router = {0};
+  struct tinywot_target_param params[2] = {0};
+  size_t params_count_n = 0;
+  char const *pattern = NULL;
+
+  tinywot_test_router_init(&router);
+
+  /* A literal segment wins over a wildcard. */
+  status = tinywot_router_match(
+    &router, "/properties/status", &pattern, params, 2, &params_count_n
+  );
+  TEST_ASSERT_EQUAL(TINYWOT_STATUS_SUCCESS, status);
+  TEST_ASSERT_EQUAL_PTR(pattern_status, pattern);
+  TEST_ASSERT_EQUAL_UINT(0, params_count_n);
+
+  status = tinywot_router_match(
+    &router, "/properties/colour", &pattern, params, 2, &params_count_n
+  );
+  TEST_ASSERT_EQUAL(TINYWOT_STATUS_SUCCESS, status);
+  TEST_ASSERT_EQUAL_PTR(pattern_property, pattern);
+  TEST_ASSERT_EQUAL_UINT(1, params_count_n);
+  TEST_ASSERT_EQUAL_UINT(6, params[0].value_length_byte);
+  TEST_ASSERT_EQUAL_STRING_LEN("colour", params[0].value, 6);
+
+  status = tinywot_router_match(
+    &router, "/actions/fade/42", &pattern, params, 2, &params_count_n
+  );
+  TEST_ASSERT_EQUAL(TINYWOT_STATUS_SUCCESS, status);
+  TEST_ASSERT_EQUAL_PTR(pattern_action, pattern);
+  TEST_ASSERT_EQUAL_UINT(2, params_count_n);
+  TEST_ASSERT_EQUAL_STRING_LEN("fade", params[0].value, 4);
+  TEST_ASSERT_EQUAL_STRING_LEN("42", params[1].value, 2);
+
+  status = tinywot_router_match(
+    &router, "/logs/2023/01/01", &pattern, params, 2, &params_count_n
+  );
+  TEST_ASSERT_EQUAL(TINYWOT_STATUS_SUCCESS, status);
+  TEST_ASSERT_EQUAL_PTR(pattern_logs, pattern);
+  TEST_ASSERT_EQUAL_UINT(1, params_count_n);
+  TEST_ASSERT_EQUAL_STRING("2023/01/01", params[0].value);
+
+  status = tinywot_router_match(
+    &router, "/", &pattern, params, 2, &params_count_n
+  );
+  TEST_ASSERT_EQUAL(TINYWOT_STATUS_SUCCESS, status);
+  TEST_ASSERT_EQUAL_PTR(pattern_root, pattern);
+}
+
+static void tinywot_router_match_should_fail_when_mismatch(void) {
+  enum tinywot_status status = TINYWOT_STATUS_ERROR_GENERIC;
+  struct tinywot_router router = {0};
+  size_t params_count_n = 0;
+  char const *pattern = NULL;
+
+  tinywot_test_router_init(&router);
+
+  status = tinywot_router_match(
+    &router, "/properties", &pattern, NULL, 0, &params_count_n
+  );
+  TEST_ASSERT_EQUAL(TINYWOT_STATUS_ERROR_NOT_FOUND, status);
+  TEST_ASSERT_NULL(pattern);
+
+  status = tinywot_router_match(
+    &router, "/actions/fade", &pattern, NULL, 0, &params_count_n
+  );
+  TEST_ASSERT_EQUAL(TINYWOT_STATUS_ERROR_NOT_FOUND, status);
+
+  status = tinywot_router_match(
+    &router, "/properties/status/extra", &pattern, NULL, 0, &params_count_n
+  );
+  TEST_ASSERT_EQUAL(TINYWOT_STATUS_ERROR_NOT_FOUND, status);
+  TEST_ASSERT_NULL(pattern);
+}
+
+static enum tinywot_status handler_property_echo_name_read(
+  struct tinywot_payload *res, struct tinywot_payload *req, void *context
+) {
+  struct tinywot_request *request = tinywot_request_of_payload(req);
+
+  (void)context;
+
+  TEST_ASSERT_EQUAL_UINT(1, request->params_count_n);
+
+  return tinywot_payload_append(
+    res, request->params[0].value, request->params[0].value_length_byte
+  );
+}
+
+static struct tinywot_form const form_property_read = {
+  .name = NULL,
+  .target = pattern_property,
+  .op = TINYWOT_OPERATION_TYPE_READPROPERTY,
+  .handler = handler_property_echo_name_read,
+  .context = NULL,
+};
+
+static void tinywot_router_match_should_serve_requests(void) {
+  enum tinywot_status status = TINYWOT_STATUS_ERROR_GENERIC;
+  struct tinywot_thing *thing = tinywot_test_thing_new_example();
+  struct tinywot_router router = {0};
+  struct tinywot_request request = {0};
+  struct tinywot_response response = {0};
+  char content_out[TINYWOT_TEST_SMALL_MEMORY_SIZE_BYTE];
+
+  (void)tinywot_router_init(&router, nodes, sizeof(nodes));
+  status = tinywot_thing_init_router(thing, &router);
+  TEST_ASSERT_EQUAL(TINYWOT_STATUS_SUCCESS, status);
+
+  /* Replace the toggle action with the wildcard property. */
+  status = tinywot_thing_change_form(
+    thing, "/toggle", TINYWOT_OPERATION_TYPE_INVOKEACTION, &form_property_read
+  );
+  TEST_ASSERT_EQUAL(TINYWOT_STATUS_SUCCESS, status);
+
+  request.op = TINYWOT_OPERATION_TYPE_READPROPERTY;
+  strcpy(request.target, "/properties/brightness");
+  response.payload.content = content_out;
+  response.payload.content_buffer_size_byte = sizeof(content_out);
+
+  status = tinywot_thing_process_request(thing, &response, &request);
+  TEST_ASSERT_EQUAL(TINYWOT_STATUS_SUCCESS, status);
+  TEST_ASSERT_EQUAL(TINYWOT_RESPONSE_STATUS_OK, response.status);
+  TEST_ASSERT_EQUAL_UINT(10, response.payload.content_length_byte);
+  TEST_ASSERT_EQUAL_MEMORY("brightness", response.payload.content, 10);
+
+  /* Exact targets are still served through the router. */
+  response.payload.content_length_byte = 0;
+  strcpy(request.target, "/status");
+
+  status = tinywot_thing_process_request(thing, &response, &request);
+  TEST_ASSERT_EQUAL(TINYWOT_RESPONSE_STATUS_OK, response.status);
+  TEST_ASSERT_EQUAL_STRING("false", response.payload.content);
+
+  strcpy(request.target, "/lorem");
+
+  status = tinywot_thing_process_request(thing, &response, &request);
+  TEST_ASSERT_EQUAL(TINYWOT_RESPONSE_STATUS_NOT_FOUND, response.status);
+
+  tinywot_test_thing_delete(thing);
+}
+
+static char const target_brightness[] = "/properties/brightness";
+
+static enum tinywot_status handler_property_brightness_read(
+  struct tinywot_payload *res, struct tinywot_payload *req, void *context
+) {
+  (void)req;
+  (void)context;
+
+  return tinywot_payload_append(res, "50", 2);
+}
+
+static struct tinywot_form const form_brightness_read = {
+  .name = "brightness",
+  .target = target_brightness,
+  .op = TINYWOT_OPERATION_TYPE_READPROPERTY,
+  .handler = handler_property_brightness_read,
+  .context = NULL,
+};
+
+static struct tinywot_form const form_brightness_write = {
+  .name = "brightness",
+  .target = target_brightness,
+  .op = TINYWOT_OPERATION_TYPE_WRITEPROPERTY,
+  .handler = NULL,
+  .context = NULL,
+};
+
+static enum tinywot_response_status request_brightness(
+  struct tinywot_thing const *thing,
+  char const *target,
+  enum tinywot_operation_type op,
+  char const *expected
+) {
+  struct tinywot_request request = {0};
+  struct tinywot_response response = {0};
+  char content_out[TINYWOT_TEST_SMALL_MEMORY_SIZE_BYTE];
+
+  request.op = op;
+  strcpy(request.target, target);
+  response.payload.content = content_out;
+  response.payload.content_buffer_size_byte = sizeof(content_out);
+
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_SUCCESS,
+    tinywot_thing_process_request(thing, &response, &request)
+  );
+
+  if (expected) {
+    TEST_ASSERT_EQUAL(TINYWOT_RESPONSE_STATUS_OK, response.status);
+    TEST_ASSERT_EQUAL_UINT(
+      strlen(expected), response.payload.content_length_byte
+    );
+    TEST_ASSERT_EQUAL_MEMORY(
+      expected, response.payload.content, strlen(expected)
+    );
+  }
+
+  return response.status;
+}
+
+static void tinywot_router_should_fall_back_to_wildcards(void) {
+  struct tinywot_thing *thing = tinywot_test_thing_new_example();
+  struct tinywot_router router = {0};
+  size_t params_count_n = 0;
+  char const *pattern = NULL;
+
+  (void)tinywot_router_init(&router, nodes, sizeof(nodes));
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_SUCCESS, tinywot_thing_init_router(thing, &router)
+  );
+
+  /* Make room for the forms below. */
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_SUCCESS,
+    tinywot_thing_remove_form(
+      thing, "/oh", TINYWOT_OPERATION_TYPE_SUBSCRIBEEVENT
+    )
+  );
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_SUCCESS,
+    tinywot_thing_remove_form(
+      thing, "/oh", TINYWOT_OPERATION_TYPE_UNSUBSCRIBEEVENT
+    )
+  );
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_SUCCESS,
+    tinywot_thing_remove_form(
+      thing, "/toggle", TINYWOT_OPERATION_TYPE_INVOKEACTION
+    )
+  );
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_ERROR_NOT_FOUND,
+    tinywot_router_match(&router, "/oh", &pattern, NULL, 0, &params_count_n)
+  );
+
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_SUCCESS, tinywot_thing_add_form(thing, &form_property_read)
+  );
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_SUCCESS,
+    tinywot_thing_add_form(thing, &form_brightness_write)
+  );
+
+  /* A literal target without the op does not shadow the wildcard. */
+  request_brightness(
+    thing, target_brightness, TINYWOT_OPERATION_TYPE_READPROPERTY,
+    "brightness"
+  );
+  TEST_ASSERT_EQUAL(
+    TINYWOT_RESPONSE_STATUS_NOT_SUPPORTED,
+    request_brightness(
+      thing, target_brightness, TINYWOT_OPERATION_TYPE_WRITEPROPERTY, NULL
+    )
+  );
+  TEST_ASSERT_EQUAL(
+    TINYWOT_RESPONSE_STATUS_NOT_ALLOWED,
+    request_brightness(
+      thing, "/properties/hue", TINYWOT_OPERATION_TYPE_WRITEPROPERTY, NULL
+    )
+  );
+
+  /* Removing the literal form brings the wildcard back. */
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_SUCCESS, tinywot_thing_add_form(thing, &form_brightness_read)
+  );
+  request_brightness(
+    thing, target_brightness, TINYWOT_OPERATION_TYPE_READPROPERTY, "50"
+  );
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_SUCCESS,
+    tinywot_thing_remove_form(
+      thing, target_brightness, TINYWOT_OPERATION_TYPE_READPROPERTY
+    )
+  );
+  request_brightness(
+    thing, target_brightness, TINYWOT_OPERATION_TYPE_READPROPERTY,
+    "brightness"
+  );
+
+  /* The target stays in the router until no form uses it. */
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_SUCCESS,
+    tinywot_router_match(
+      &router, target_brightness, &pattern, NULL, 0, &params_count_n
+    )
+  );
+  TEST_ASSERT_EQUAL_PTR(target_brightness, pattern);
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_SUCCESS,
+    tinywot_thing_remove_form(
+      thing, target_brightness, TINYWOT_OPERATION_TYPE_WRITEPROPERTY
+    )
+  );
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_SUCCESS,
+    tinywot_router_match(
+      &router, target_brightness, &pattern, NULL, 0, &params_count_n
+    )
+  );
+  TEST_ASSERT_EQUAL_PTR(pattern_property, pattern);
+
+  tinywot_test_thing_delete(thing);
+}
+
+static void tinywot_router_should_bound_depth(void) {
+  static char const pattern_deep[] = "/a/b/c/d/e/f/g/h";
+  static char const pattern_deeper[] = "/a/b/c/d/e/f/g/h/i";
+  struct tinywot_router router = {0};
+  struct tinywot_target_param params[2] = {0};
+  size_t params_count_n = 0;
+  char const *pattern = NULL;
+
+  TEST_ASSERT_EQUAL_UINT(8U, TINYWOT_ROUTER_DEPTH_MAX_N);
+
+  tinywot_test_router_init(&router);
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_SUCCESS, tinywot_router_insert(&router, pattern_deep)
+  );
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_ERROR_NOT_ALLOWED,
+    tinywot_router_insert(&router, pattern_deeper)
+  );
+
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_SUCCESS,
+    tinywot_router_match(
+      &router, pattern_deep, &pattern, params, 2, &params_count_n
+    )
+  );
+  TEST_ASSERT_EQUAL_PTR(pattern_deep, pattern);
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_ERROR_NOT_FOUND,
+    tinywot_router_match(
+      &router, pattern_deeper, &pattern, params, 2, &params_count_n
+    )
+  );
+
+  /* Longer requested targets are still matched by a rest wildcard. */
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_SUCCESS,
+    tinywot_router_match(
+      &router, "/logs/a/b/c/d/e/f/g/h/i/j", &pattern, params, 2,
+      &params_count_n
+    )
+  );
+  TEST_ASSERT_EQUAL_PTR(pattern_logs, pattern);
+  TEST_ASSERT_EQUAL_UINT(1, params_count_n);
+  TEST_ASSERT_EQUAL_UINT(19, params[0].value_length_byte);
+}
+
+void setUp(void) {}
+void tearDown(void) {}
+
+int main(void) {
+  UNITY_BEGIN();
+
+  RUN_TEST(tinywot_router_match_should_succeed);
+  RUN_TEST(tinywot_router_match_should_fail_when_mismatch);
+  RUN_TEST(tinywot_router_match_should_serve_requests);
+  RUN_TEST(tinywot_router_should_fall_back_to_wildcards);
+  RUN_TEST(tinywot_router_should_bound_depth);
+
+  return UNITY_END();
+}
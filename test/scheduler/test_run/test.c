@@ -0,0 +1,310 @@
+/*
+  SPDX-FileCopyrightText: 2023 Junde Yhi <junde@yhi.moe>
+  SPDX-License-Identifier: MIT
+*/
+
+/*!
+  \file
+  \brief Unit tests for `tinywot_scheduler_run()`.
+*/
+
+#include <stddef.h>
+#include <string.h>
+#include <tinywot/core.h>
+#include <tinywot-test.h>
+#include <unity.h>
+
+#define SCHEDULER_TASKS_MAX_N (4U)
+
+/* What has run, one character per task. */
+static char trace[16];
+static size_t trace_length_byte;
+
+static struct tinywot_task tasks[SCHEDULER_TASKS_MAX_N];
+static struct tinywot_scheduler scheduler;
+static struct tinywot_thing *thing;
+static struct tinywot_request requests[SCHEDULER_TASKS_MAX_N];
+static struct tinywot_response responses[SCHEDULER_TASKS_MAX_N];
+
+static void trace_append(char c) {
+  TEST_ASSERT_TRUE(trace_length_byte < sizeof(trace) - 1);
+
+  trace[trace_length_byte] = c;
+  trace_length_byte += 1;
+}
+
+/* Trace the first character of the name in context. */
+static enum tinywot_status handler_trace(
+  struct tinywot_payload *res, struct tinywot_payload *req, void *context
+) {
+  (void)res;
+  (void)req;
+
+  trace_append(*(char const *)context);
+
+  return TINYWOT_STATUS_SUCCESS;
+}
+
+static enum tinywot_status function_trace(void *context) {
+  trace_append(*(char const *)context);
+
+  return TINYWOT_STATUS_SUCCESS;
+}
+
+/* Trace, and ask for two more runs. */
+static enum tinywot_status function_trace_thrice(void *context) {
+  static unsigned int runs_n = 0;
+
+  trace_append(*(char const *)context);
+  runs_n += 1;
+
+  return runs_n % 3U != 0 ? TINYWOT_STATUS_NOT_FINISHED :
+                            TINYWOT_STATUS_SUCCESS;
+}
+
+/* Try to take the place of the running task. */
+static void done_submit(struct tinywot_task *task, enum tinywot_status status) {
+  struct tinywot_task other = {0};
+
+  (void)task;
+  (void)status;
+
+  other.type = TINYWOT_TASK_TYPE_FUNCTION;
+  other.function = function_trace;
+  other.context = "x";
+
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_ERROR_NOT_ENOUGH_MEMORY,
+    tinywot_scheduler_submit(&scheduler, &other)
+  );
+}
+
+static void submit_request(size_t i, char const *target) {
+  struct tinywot_task task = {0};
+
+  requests[i].op = !strcmp(target, "/stop") ?
+    TINYWOT_OPERATION_TYPE_INVOKEACTION :
+    TINYWOT_OPERATION_TYPE_READPROPERTY;
+  strcpy(requests[i].target, target);
+
+  task.type = TINYWOT_TASK_TYPE_REQUEST;
+  task.thing = thing;
+  task.request = &requests[i];
+  task.response = &responses[i];
+
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_SUCCESS, tinywot_scheduler_submit(&scheduler, &task)
+  );
+}
+
+static void submit_function(
+  char const *name,
+  uint_least8_t priority,
+  bool has_deadline,
+  uint_least32_t deadline
+) {
+  struct tinywot_task task = {0};
+
+  task.type = TINYWOT_TASK_TYPE_FUNCTION;
+  task.priority = priority;
+  task.has_deadline = has_deadline;
+  task.deadline = deadline;
+  task.function = function_trace;
+  task.context = (void *)name;
+
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_SUCCESS, tinywot_scheduler_submit(&scheduler, &task)
+  );
+}
+
+static void run_all(void) {
+  while (tinywot_scheduler_run(&scheduler)
+         != TINYWOT_STATUS_ERROR_NOT_FOUND) {
+  }
+}
+
+static void tinywot_scheduler_run_should_fail_when_empty(void) {
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_ERROR_NOT_FOUND, tinywot_scheduler_run(&scheduler)
+  );
+}
+
+static void tinywot_scheduler_run_should_follow_form_priority(void) {
+  submit_request(0, "/poll");
+  submit_request(1, "/pull");
+  submit_request(2, "/stop"); /* priority 7 */
+  submit_request(3, "/push");
+
+  TEST_ASSERT_EQUAL(TINYWOT_STATUS_SUCCESS, tinywot_scheduler_run(&scheduler));
+  TEST_ASSERT_EQUAL(TINYWOT_RESPONSE_STATUS_OK, responses[2].status);
+
+  run_all();
+  TEST_ASSERT_EQUAL_STRING("spuq", trace);
+}
+
+static void tinywot_scheduler_run_should_follow_notification_priority(
+  void
+) {
+  struct tinywot_observer observer = {0};
+  struct tinywot_task task = {0};
+
+  observer.target = "/poll";
+  observer.op = TINYWOT_OPERATION_TYPE_OBSERVEPROPERTY;
+
+  task.type = TINYWOT_TASK_TYPE_NOTIFICATION;
+  task.thing = thing;
+  task.observer = &observer;
+  task.response = &responses[0];
+
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_SUCCESS, tinywot_scheduler_submit(&scheduler, &task)
+  );
+  submit_function("a", 5, false, 0);
+
+  /* The notification is read from the readproperty form of /poll, which
+     has priority 0, not from its observeproperty form (priority 9). */
+  run_all();
+  TEST_ASSERT_EQUAL_STRING("ap", trace);
+}
+
+#ifdef TINYWOT_ENABLE_INSTRUMENTATION
+static void tinywot_scheduler_run_should_look_up_once(void) {
+  static struct tinywot_form_stats stats[8];
+  struct tinywot_instrumentation instrumentation;
+
+  tinywot_thing_init_instrumentation(
+    thing, &instrumentation, stats, sizeof(stats)
+  );
+
+  submit_request(0, "/stop");
+  run_all();
+
+  TEST_ASSERT_EQUAL_STRING("s", trace);
+  TEST_ASSERT_EQUAL_UINT32(1U, instrumentation.lookups_n);
+}
+#endif
+
+static void tinywot_scheduler_run_should_follow_task_priority(void) {
+  submit_request(0, "/stop");
+  submit_function("a", 9, false, 0);
+  submit_function("b", 7, false, 0);
+
+  run_all();
+  TEST_ASSERT_EQUAL_STRING("asb", trace);
+}
+
+static void tinywot_scheduler_run_should_follow_deadlines(void) {
+  submit_function("n", 0, false, 0);
+  submit_function("l", 0, true, 100);
+  submit_function("e", 0, true, 50);
+  submit_function("w", 0, true, 0xFFFFFFF0UL); /* before 0 */
+
+  run_all();
+  TEST_ASSERT_EQUAL_STRING("weln", trace);
+}
+
+static void tinywot_scheduler_run_should_requeue_not_finished(void) {
+  struct tinywot_task task = {0};
+
+  task.type = TINYWOT_TASK_TYPE_FUNCTION;
+  task.function = function_trace_thrice;
+  task.context = "a";
+
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_SUCCESS, tinywot_scheduler_submit(&scheduler, &task)
+  );
+  submit_function("b", 0, false, 0);
+
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_NOT_FINISHED, tinywot_scheduler_run(&scheduler)
+  );
+
+  run_all();
+  TEST_ASSERT_EQUAL_STRING("abaa", trace);
+}
+
+static void tinywot_scheduler_submit_should_keep_place_of_running(void) {
+  struct tinywot_task task = {0};
+
+  task.type = TINYWOT_TASK_TYPE_FUNCTION;
+  task.function = function_trace;
+  task.context = "a";
+  task.done = done_submit;
+
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_SUCCESS, tinywot_scheduler_submit(&scheduler, &task)
+  );
+  submit_function("b", 0, false, 0);
+  submit_function("c", 0, false, 0);
+  submit_function("d", 0, false, 0);
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_ERROR_NOT_ENOUGH_MEMORY,
+    tinywot_scheduler_submit(&scheduler, &task)
+  );
+
+  run_all();
+  TEST_ASSERT_EQUAL_STRING("abcd", trace);
+}
+
+void setUp(void) {
+  /* Each form traces its own character. */
+  static char const *const targets[] = {"/poll", "/pull", "/push", "/stop"};
+  static char const *const names[] = {"p", "u", "q", "s"};
+  struct tinywot_form form = {0};
+
+  thing = tinywot_test_thing_new();
+  form.handler = handler_trace;
+
+  for (size_t i = 0; i < sizeof(targets) / sizeof(targets[0]); i++) {
+    form.target = targets[i];
+    form.context = (void *)names[i];
+    form.op = TINYWOT_OPERATION_TYPE_READPROPERTY;
+    form.priority = 0;
+
+    if (!strcmp(targets[i], "/stop")) {
+      form.op = TINYWOT_OPERATION_TYPE_INVOKEACTION;
+      form.priority = 7;
+    }
+
+    TEST_ASSERT_EQUAL(
+      TINYWOT_STATUS_SUCCESS, tinywot_thing_add_form(thing, &form)
+    );
+  }
+
+  /* Observing /poll is urgent, but notifying it is not. */
+  form.target = "/poll";
+  form.context = "o";
+  form.op = TINYWOT_OPERATION_TYPE_OBSERVEPROPERTY;
+  form.priority = 9;
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_SUCCESS, tinywot_thing_add_form(thing, &form)
+  );
+
+  memset(trace, 0, sizeof(trace));
+  trace_length_byte = 0;
+  memset(requests, 0, sizeof(requests));
+  memset(responses, 0, sizeof(responses));
+
+  tinywot_scheduler_init(&scheduler, tasks, sizeof(tasks));
+}
+
+void tearDown(void) {
+  tinywot_test_thing_delete(thing);
+}
+
+int main(void) {
+  UNITY_BEGIN();
+
+  RUN_TEST(tinywot_scheduler_run_should_fail_when_empty);
+  RUN_TEST(tinywot_scheduler_run_should_follow_form_priority);
+  RUN_TEST(tinywot_scheduler_run_should_follow_notification_priority);
+#ifdef TINYWOT_ENABLE_INSTRUMENTATION
+  RUN_TEST(tinywot_scheduler_run_should_look_up_once);
+#endif
+  RUN_TEST(tinywot_scheduler_run_should_follow_task_priority);
+  RUN_TEST(tinywot_scheduler_run_should_follow_deadlines);
+  RUN_TEST(tinywot_scheduler_run_should_requeue_not_finished);
+  RUN_TEST(tinywot_scheduler_submit_should_keep_place_of_running);
+
+  return UNITY_END();
+}
@@ -0,0 +1,277 @@
+/*
+  SPDX-FileCopyrightText: 2023 Junde Yhi <junde@yhi.moe>
+  SPDX-License-Identifier: MIT
+*/
+
+/*!
+  \file
+  \brief Unit tests for `tinywot_servient`.
+*/
+
+#include <stddef.h>
+#include <string.h>
+#include <tinywot/core.h>
+#include <tinywot-test.h>
+#include <unity.h>
+
+#define SERVIENT_THINGS_MAX_N (3U)
+
+/* Echo the target seen by the Thing. */
+static enum tinywot_status handler_echo_target(
+  struct tinywot_payload *res, struct tinywot_payload *req, void *context
+) {
+  size_t target_length_byte = 0;
+  char const *target = tinywot_request_get_target(
+    tinywot_request_of_payload(req), &target_length_byte
+  );
+
+  (void)context;
+
+  return tinywot_payload_append(res, target, target_length_byte);
+}
+
+static struct tinywot_servient_thing things[SERVIENT_THINGS_MAX_N];
+static struct tinywot_servient servient;
+static struct tinywot_thing *device;
+static struct tinywot_thing *devices;
+static struct tinywot_request request;
+static struct tinywot_response response;
+static unsigned char *content_out;
+
+static void process(
+  char const *target,
+  enum tinywot_operation_type op,
+  enum tinywot_response_status expected
+) {
+  memset(&request, 0, sizeof(request));
+  strcpy(request.target, target);
+  request.op = op;
+
+  memset(&response, 0, sizeof(response));
+  memset(content_out, 0, TINYWOT_TEST_MEMORY_SIZE_BYTE);
+  response.payload.content = content_out;
+  response.payload.content_buffer_size_byte = TINYWOT_TEST_MEMORY_SIZE_BYTE;
+
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_SUCCESS,
+    tinywot_servient_process_request(&servient, &response, &request)
+  );
+  TEST_ASSERT_EQUAL(expected, response.status);
+
+  /* The request is given back as it was. */
+  TEST_ASSERT_NULL(request.target_view);
+  TEST_ASSERT_EQUAL_STRING(target, request.target);
+}
+
+static void tinywot_servient_add_thing_should_keep_order(void) {
+  TEST_ASSERT_EQUAL_UINT(2U, servient.things_count_n);
+  TEST_ASSERT_EQUAL_STRING("/devices", things[0].base);
+  TEST_ASSERT_EQUAL_STRING("/devices/1", things[1].base);
+
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_SUCCESS,
+    tinywot_servient_add_thing(&servient, "/a", device)
+  );
+  TEST_ASSERT_EQUAL_STRING("/a", things[0].base);
+  TEST_ASSERT_EQUAL_STRING("/devices", things[1].base);
+  TEST_ASSERT_EQUAL_STRING("/devices/1", things[2].base);
+}
+
+static void tinywot_servient_add_thing_should_fail(void) {
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_ERROR_NOT_ALLOWED,
+    tinywot_servient_add_thing(&servient, "/devices", device)
+  );
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_ERROR_NOT_ALLOWED,
+    tinywot_servient_add_thing(&servient, "/b/", device)
+  );
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_SUCCESS,
+    tinywot_servient_add_thing(&servient, "/b", device)
+  );
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_ERROR_NOT_ENOUGH_MEMORY,
+    tinywot_servient_add_thing(&servient, "/c", device)
+  );
+}
+
+static void tinywot_servient_find_thing_should_match_longest_base(void) {
+  struct tinywot_thing const *thing = NULL;
+  size_t base_length_byte = 0;
+
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_SUCCESS,
+    tinywot_servient_find_thing(
+      &servient, &thing, "/devices/1/status", 17, &base_length_byte
+    )
+  );
+  TEST_ASSERT_EQUAL_PTR(device, thing);
+  TEST_ASSERT_EQUAL_UINT(10U, base_length_byte);
+
+  /* A base only matches whole segments. */
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_SUCCESS,
+    tinywot_servient_find_thing(
+      &servient, &thing, "/devices/10/status", 18, &base_length_byte
+    )
+  );
+  TEST_ASSERT_EQUAL_PTR(devices, thing);
+  TEST_ASSERT_EQUAL_UINT(8U, base_length_byte);
+
+  /* Only the given length of the target counts. */
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_SUCCESS,
+    tinywot_servient_find_thing(
+      &servient, &thing, "/devices/1/status", 10, &base_length_byte
+    )
+  );
+  TEST_ASSERT_EQUAL_PTR(device, thing);
+
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_ERROR_NOT_FOUND,
+    tinywot_servient_find_thing(
+      &servient, &thing, "/devicesx/1", 11, &base_length_byte
+    )
+  );
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_ERROR_NOT_FOUND,
+    tinywot_servient_find_thing(&servient, &thing, "", 0, &base_length_byte)
+  );
+}
+
+static void tinywot_servient_find_thing_should_fall_back_to_empty_base(
+  void
+) {
+  struct tinywot_thing const *thing = NULL;
+  size_t base_length_byte = 0;
+
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_SUCCESS, tinywot_servient_add_thing(&servient, "", device)
+  );
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_SUCCESS,
+    tinywot_servient_find_thing(
+      &servient, &thing, "/status", 7, &base_length_byte
+    )
+  );
+  TEST_ASSERT_EQUAL_PTR(device, thing);
+  TEST_ASSERT_EQUAL_UINT(0U, base_length_byte);
+}
+
+static void tinywot_servient_process_request_should_strip_base(void) {
+  process(
+    "/devices/1/status",
+    TINYWOT_OPERATION_TYPE_READPROPERTY,
+    TINYWOT_RESPONSE_STATUS_OK
+  );
+  TEST_ASSERT_EQUAL_STRING("false", response.payload.content);
+
+  process(
+    "/devices/1/status",
+    TINYWOT_OPERATION_TYPE_INVOKEACTION,
+    TINYWOT_RESPONSE_STATUS_NOT_ALLOWED
+  );
+
+  process(
+    "/devices/10/status",
+    TINYWOT_OPERATION_TYPE_READPROPERTY,
+    TINYWOT_RESPONSE_STATUS_OK
+  );
+  TEST_ASSERT_EQUAL_STRING("/10/status", response.payload.content);
+
+  /* The base itself is the root of the Thing. */
+  process(
+    "/devices", TINYWOT_OPERATION_TYPE_READPROPERTY, TINYWOT_RESPONSE_STATUS_OK
+  );
+  TEST_ASSERT_EQUAL_STRING("/", response.payload.content);
+
+  process(
+    "/devices/", TINYWOT_OPERATION_TYPE_READPROPERTY, TINYWOT_RESPONSE_STATUS_OK
+  );
+  TEST_ASSERT_EQUAL_STRING("/", response.payload.content);
+}
+
+static void tinywot_servient_process_request_should_not_find(void) {
+  process(
+    "/status",
+    TINYWOT_OPERATION_TYPE_READPROPERTY,
+    TINYWOT_RESPONSE_STATUS_NOT_FOUND
+  );
+  process(
+    "/devices/2/status",
+    TINYWOT_OPERATION_TYPE_READPROPERTY,
+    TINYWOT_RESPONSE_STATUS_NOT_FOUND
+  );
+}
+
+static void tinywot_servient_remove_thing_should_succeed(void) {
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_SUCCESS,
+    tinywot_servient_remove_thing(&servient, "/devices/1")
+  );
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_ERROR_NOT_FOUND,
+    tinywot_servient_remove_thing(&servient, "/devices/1")
+  );
+  TEST_ASSERT_EQUAL_UINT(1U, servient.things_count_n);
+
+  /* Now the request goes to the Thing on /devices. */
+  process(
+    "/devices/1/status",
+    TINYWOT_OPERATION_TYPE_READPROPERTY,
+    TINYWOT_RESPONSE_STATUS_NOT_FOUND
+  );
+}
+
+void setUp(void) {
+  struct tinywot_form form = {0};
+
+  device = tinywot_test_thing_new_example();
+  devices = tinywot_test_thing_new();
+  content_out = tinywot_test_malloc0(TINYWOT_TEST_MEMORY_SIZE_BYTE);
+
+  form.op = TINYWOT_OPERATION_TYPE_READPROPERTY;
+  form.handler = handler_echo_target;
+
+  form.target = "/";
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_SUCCESS, tinywot_thing_add_form(devices, &form)
+  );
+
+  form.target = "/10/status";
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_SUCCESS, tinywot_thing_add_form(devices, &form)
+  );
+
+  tinywot_servient_init(&servient, things, sizeof(things));
+
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_SUCCESS,
+    tinywot_servient_add_thing(&servient, "/devices/1", device)
+  );
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_SUCCESS,
+    tinywot_servient_add_thing(&servient, "/devices", devices)
+  );
+}
+
+void tearDown(void) {
+  tinywot_test_free(content_out);
+  tinywot_test_thing_delete(devices);
+  tinywot_test_thing_delete(device);
+}
+
+int main(void) {
+  UNITY_BEGIN();
+
+  RUN_TEST(tinywot_servient_add_thing_should_keep_order);
+  RUN_TEST(tinywot_servient_add_thing_should_fail);
+  RUN_TEST(tinywot_servient_find_thing_should_match_longest_base);
+  RUN_TEST(tinywot_servient_find_thing_should_fall_back_to_empty_base);
+  RUN_TEST(tinywot_servient_process_request_should_strip_base);
+  RUN_TEST(tinywot_servient_process_request_should_not_find);
+  RUN_TEST(tinywot_servient_remove_thing_should_succeed);
+
+  return UNITY_END();
+}
@@ -0,0 +1,325 @@
+/*
+  SPDX-FileCopyrightText: 2023 Junde Yhi <junde@yhi.moe>
+  SPDX-License-Identifier: MIT
+*/
+
+/*!
+  \file
+  \brief Unit tests for `tinywot_thing_find_form_by_id()`.
+*/
+
+#include <stddef.h>
+#include <string.h>
+#include <tinywot/core.h>
+#include <tinywot-test.h>
+#include <unity.h>
+
+/* Room for 4 targets; the example Thing has 3. */
+static char const *registry_memory[4];
+
+/* Room for the slots of 4 targets and 8 forms. */
+static size_t slots_memory[4 + 8];
+
+static struct tinywot_thing *tinywot_test_thing_new_example_interned(
+  struct tinywot_target_registry *registry
+) {
+  struct tinywot_thing *thing = tinywot_test_thing_new_example();
+
+  tinywot_target_registry_init(
+    registry, registry_memory, sizeof(registry_memory)
+  );
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_SUCCESS,
+    tinywot_thing_intern_targets(
+      thing, registry, slots_memory, sizeof(slots_memory)
+    )
+  );
+
+  return thing;
+}
+
+static void tinywot_thing_find_form_by_id_should_succeed(void) {
+  enum tinywot_status status = TINYWOT_STATUS_ERROR_GENERIC;
+  struct tinywot_target_registry registry = {0};
+  struct tinywot_thing *thing =
+    tinywot_test_thing_new_example_interned(&registry);
+  struct tinywot_form *form = NULL;
+  tinywot_target_id_t id = TINYWOT_TARGET_ID_NONE;
+
+  /* /status, /toggle, /oh */
+  TEST_ASSERT_EQUAL_UINT(3, registry.targets_count_n);
+
+  status = tinywot_target_registry_find(&registry, "/status", &id);
+  TEST_ASSERT_EQUAL(TINYWOT_STATUS_SUCCESS, status);
+  TEST_ASSERT_NOT_EQUAL(TINYWOT_TARGET_ID_NONE, id);
+
+  status = tinywot_thing_find_form_by_id(
+    thing, &form, id, TINYWOT_OPERATION_TYPE_WRITEPROPERTY
+  );
+  TEST_ASSERT_EQUAL(TINYWOT_STATUS_SUCCESS, status);
+  TEST_ASSERT_EQUAL_PTR(&thing->forms[1], form);
+
+  tinywot_test_thing_delete(thing);
+}
+
+static void tinywot_thing_find_form_by_id_should_fail_when_mismatch(void) {
+  enum tinywot_status status = TINYWOT_STATUS_ERROR_GENERIC;
+  struct tinywot_target_registry registry = {0};
+  struct tinywot_thing *thing =
+    tinywot_test_thing_new_example_interned(&registry);
+  struct tinywot_form *form = NULL;
+  tinywot_target_id_t id = TINYWOT_TARGET_ID_NONE;
+
+  status = tinywot_target_registry_find(&registry, "/lorem", &id);
+  TEST_ASSERT_EQUAL(TINYWOT_STATUS_ERROR_NOT_FOUND, status);
+
+  status = tinywot_thing_find_form_by_id(
+    thing, &form, TINYWOT_TARGET_ID_NONE, TINYWOT_OPERATION_TYPE_READPROPERTY
+  );
+  TEST_ASSERT_EQUAL(TINYWOT_STATUS_ERROR_NOT_FOUND, status);
+  TEST_ASSERT_NULL(form);
+
+  (void)tinywot_target_registry_find(&registry, "/toggle", &id);
+  status = tinywot_thing_find_form_by_id(
+    thing, &form, id, TINYWOT_OPERATION_TYPE_READPROPERTY
+  );
+  TEST_ASSERT_EQUAL(TINYWOT_STATUS_ERROR_NOT_ALLOWED, status);
+  TEST_ASSERT_NULL(form);
+
+  tinywot_test_thing_delete(thing);
+}
+
+static void tinywot_thing_find_form_by_id_should_serve_requests(void) {
+  enum tinywot_status status = TINYWOT_STATUS_ERROR_GENERIC;
+  struct tinywot_target_registry registry = {0};
+  struct tinywot_thing *thing =
+    tinywot_test_thing_new_example_interned(&registry);
+  struct tinywot_request request = {0};
+  struct tinywot_response response = {0};
+  char content_out[TINYWOT_TEST_SMALL_MEMORY_SIZE_BYTE];
+
+  /* The target string is left empty; only the ID is used. */
+  request.op = TINYWOT_OPERATION_TYPE_READPROPERTY;
+  (void)tinywot_target_registry_find(&registry, "/status", &request.target_id);
+
+  response.payload.content = content_out;
+  response.payload.content_buffer_size_byte = sizeof(content_out);
+
+  status = tinywot_thing_process_request(thing, &response, &request);
+
+  TEST_ASSERT_EQUAL(TINYWOT_STATUS_SUCCESS, status);
+  TEST_ASSERT_EQUAL(TINYWOT_RESPONSE_STATUS_OK, response.status);
+  TEST_ASSERT_EQUAL_STRING("false", response.payload.content);
+
+  tinywot_test_thing_delete(thing);
+}
+
+static void tinywot_thing_find_form_by_id_should_look_up_static_forms(void) {
+  static struct tinywot_form const forms[] = {
+    {
+      .target = "/a",
+      .op = TINYWOT_OPERATION_TYPE_READPROPERTY,
+    },
+    {
+      .target = "/b",
+      .op = TINYWOT_OPERATION_TYPE_INVOKEACTION,
+    },
+  };
+  enum tinywot_status status = TINYWOT_STATUS_ERROR_GENERIC;
+  struct tinywot_target_registry registry = {0};
+  struct tinywot_thing thing = {0};
+  struct tinywot_form *form = NULL;
+  tinywot_target_id_t id = TINYWOT_TARGET_ID_NONE;
+
+  tinywot_thing_init_static(&thing, forms, sizeof(forms));
+  tinywot_target_registry_init(
+    &registry, registry_memory, sizeof(registry_memory)
+  );
+
+  status = tinywot_thing_intern_targets(
+    &thing, &registry, slots_memory, sizeof(slots_memory)
+  );
+  TEST_ASSERT_EQUAL(TINYWOT_STATUS_SUCCESS, status);
+
+  (void)tinywot_target_registry_find(&registry, "/b", &id);
+  status = tinywot_thing_find_form_by_id(
+    &thing, &form, id, TINYWOT_OPERATION_TYPE_INVOKEACTION
+  );
+  TEST_ASSERT_EQUAL(TINYWOT_STATUS_SUCCESS, status);
+  TEST_ASSERT_EQUAL_PTR(&forms[1], form);
+}
+
+static void tinywot_thing_find_form_by_id_should_find_forms_added_later(
+  void
+) {
+  static int context = 0;
+  struct tinywot_form const added = {
+    .target = "/oh",
+    .op = TINYWOT_OPERATION_TYPE_SUBSCRIBEEVENT,
+    .context = &context,
+  };
+  enum tinywot_status status = TINYWOT_STATUS_ERROR_GENERIC;
+  struct tinywot_target_registry registry = {0};
+  struct tinywot_thing *thing =
+    tinywot_test_thing_new_example_interned(&registry);
+  struct tinywot_form *form = NULL;
+  tinywot_target_id_t id = TINYWOT_TARGET_ID_NONE;
+
+  status = tinywot_thing_remove_form(
+    thing, "/oh", TINYWOT_OPERATION_TYPE_SUBSCRIBEEVENT
+  );
+  TEST_ASSERT_EQUAL(TINYWOT_STATUS_SUCCESS, status);
+
+  (void)tinywot_target_registry_find(&registry, "/oh", &id);
+  status = tinywot_thing_find_form_by_id(
+    thing, &form, id, TINYWOT_OPERATION_TYPE_SUBSCRIBEEVENT
+  );
+  TEST_ASSERT_EQUAL(TINYWOT_STATUS_ERROR_NOT_ALLOWED, status);
+
+  status = tinywot_thing_add_form(thing, &added);
+  TEST_ASSERT_EQUAL(TINYWOT_STATUS_SUCCESS, status);
+
+  status = tinywot_thing_find_form_by_id(
+    thing, &form, id, TINYWOT_OPERATION_TYPE_SUBSCRIBEEVENT
+  );
+  TEST_ASSERT_EQUAL(TINYWOT_STATUS_SUCCESS, status);
+  TEST_ASSERT_EQUAL_PTR(&context, form->context);
+
+  tinywot_test_thing_delete(thing);
+}
+
+static void tinywot_thing_find_form_by_id_should_fail_without_registry(
+  void
+) {
+  enum tinywot_status status = TINYWOT_STATUS_ERROR_GENERIC;
+  struct tinywot_thing *thing = tinywot_test_thing_new_example();
+  struct tinywot_form *form = NULL;
+
+  status = tinywot_thing_find_form_by_id(
+    thing, &form, 1, TINYWOT_OPERATION_TYPE_READPROPERTY
+  );
+  TEST_ASSERT_EQUAL(TINYWOT_STATUS_ERROR_NOT_FOUND, status);
+  TEST_ASSERT_NULL(form);
+
+  tinywot_test_thing_delete(thing);
+}
+
+static void tinywot_thing_find_form_by_id_should_not_compare_strings(void) {
+  enum tinywot_status status = TINYWOT_STATUS_ERROR_GENERIC;
+  struct tinywot_target_registry registry = {0};
+  struct tinywot_thing *thing =
+    tinywot_test_thing_new_example_interned(&registry);
+  struct tinywot_form *form = NULL;
+  tinywot_target_id_t id = TINYWOT_TARGET_ID_NONE;
+
+  (void)tinywot_target_registry_find(&registry, "/status", &id);
+
+  /* Behind the back of the Thing, so that only a string comparison
+     would notice. */
+  thing->forms[0].target = "/elsewhere";
+  thing->forms[1].target = "/elsewhere";
+
+  status = tinywot_thing_find_form(
+    thing, &form, "/status", TINYWOT_OPERATION_TYPE_READPROPERTY
+  );
+  TEST_ASSERT_EQUAL(TINYWOT_STATUS_ERROR_NOT_FOUND, status);
+
+  status = tinywot_thing_find_form_by_id(
+    thing, &form, id, TINYWOT_OPERATION_TYPE_READPROPERTY
+  );
+  TEST_ASSERT_EQUAL(TINYWOT_STATUS_SUCCESS, status);
+  TEST_ASSERT_EQUAL_PTR(&thing->forms[0], form);
+
+  tinywot_test_thing_delete(thing);
+}
+
+static void tinywot_thing_find_form_by_id_should_follow_changes(void) {
+  struct tinywot_form const moved = {
+    .target = "/toggle",
+    .op = TINYWOT_OPERATION_TYPE_SUBSCRIBEEVENT,
+  };
+  enum tinywot_status status = TINYWOT_STATUS_ERROR_GENERIC;
+  struct tinywot_target_registry registry = {0};
+  struct tinywot_thing *thing =
+    tinywot_test_thing_new_example_interned(&registry);
+  struct tinywot_form *form = NULL;
+  tinywot_target_id_t id_toggle = TINYWOT_TARGET_ID_NONE;
+  tinywot_target_id_t id_oh = TINYWOT_TARGET_ID_NONE;
+
+  (void)tinywot_target_registry_find(&registry, "/toggle", &id_toggle);
+  (void)tinywot_target_registry_find(&registry, "/oh", &id_oh);
+
+  status = tinywot_thing_change_form(
+    thing, "/oh", TINYWOT_OPERATION_TYPE_SUBSCRIBEEVENT, &moved
+  );
+  TEST_ASSERT_EQUAL(TINYWOT_STATUS_SUCCESS, status);
+
+  status = tinywot_thing_find_form_by_id(
+    thing, &form, id_oh, TINYWOT_OPERATION_TYPE_SUBSCRIBEEVENT
+  );
+  TEST_ASSERT_EQUAL(TINYWOT_STATUS_ERROR_NOT_ALLOWED, status);
+
+  /* Both forms of /toggle are chained now. */
+  status = tinywot_thing_find_form_by_id(
+    thing, &form, id_toggle, TINYWOT_OPERATION_TYPE_INVOKEACTION
+  );
+  TEST_ASSERT_EQUAL(TINYWOT_STATUS_SUCCESS, status);
+  TEST_ASSERT_EQUAL_PTR(&thing->forms[2], form);
+
+  /* Compacting moves the forms after /status. */
+  status = tinywot_thing_remove_form(
+    thing, "/status", TINYWOT_OPERATION_TYPE_READPROPERTY
+  );
+  TEST_ASSERT_EQUAL(TINYWOT_STATUS_SUCCESS, status);
+  tinywot_thing_compact_forms(thing);
+
+  status = tinywot_thing_find_form_by_id(
+    thing, &form, id_toggle, TINYWOT_OPERATION_TYPE_SUBSCRIBEEVENT
+  );
+  TEST_ASSERT_EQUAL(TINYWOT_STATUS_SUCCESS, status);
+  TEST_ASSERT_EQUAL_PTR(&thing->forms[2], form);
+
+  tinywot_test_thing_delete(thing);
+}
+
+static void tinywot_thing_intern_targets_should_fail_without_memory(void) {
+  enum tinywot_status status = TINYWOT_STATUS_ERROR_GENERIC;
+  struct tinywot_target_registry registry = {0};
+  struct tinywot_thing *thing = tinywot_test_thing_new_example();
+  struct tinywot_form *form = NULL;
+
+  tinywot_target_registry_init(
+    &registry, registry_memory, sizeof(registry_memory)
+  );
+
+  status = tinywot_thing_intern_targets(
+    thing, &registry, slots_memory, sizeof(slots_memory[0]) * 8U
+  );
+  TEST_ASSERT_EQUAL(TINYWOT_STATUS_ERROR_NOT_ENOUGH_MEMORY, status);
+
+  status = tinywot_thing_find_form_by_id(
+    thing, &form, 1, TINYWOT_OPERATION_TYPE_READPROPERTY
+  );
+  TEST_ASSERT_EQUAL(TINYWOT_STATUS_ERROR_NOT_FOUND, status);
+
+  tinywot_test_thing_delete(thing);
+}
+
+void setUp(void) {}
+void tearDown(void) {}
+
+int main(void) {
+  UNITY_BEGIN();
+
+  RUN_TEST(tinywot_thing_find_form_by_id_should_succeed);
+  RUN_TEST(tinywot_thing_find_form_by_id_should_fail_when_mismatch);
+  RUN_TEST(tinywot_thing_find_form_by_id_should_serve_requests);
+  RUN_TEST(tinywot_thing_find_form_by_id_should_look_up_static_forms);
+  RUN_TEST(tinywot_thing_find_form_by_id_should_find_forms_added_later);
+  RUN_TEST(tinywot_thing_find_form_by_id_should_fail_without_registry);
+  RUN_TEST(tinywot_thing_find_form_by_id_should_not_compare_strings);
+  RUN_TEST(tinywot_thing_find_form_by_id_should_follow_changes);
+  RUN_TEST(tinywot_thing_intern_targets_should_fail_without_memory);
+
+  return UNITY_END();
+}
@@ -0,0 +1,150 @@
+/*
+  SPDX-FileCopyrightText: 2023 Junde Yhi <junde@yhi.moe>
+  SPDX-License-Identifier: MIT
+*/
+
+/*!
+  \file
+  \brief Unit tests for `tinywot_form_cache`.
+*/
+
+#include <stddef.h>
+#include <string.h>
+#include <tinywot/core.h>
+#include <tinywot-test.h>
+#include <unity.h>
+
+tinywot_form_handler_t handler_property_status_read;
+
+/* Count calls of handler_property_status_read() through the cache. */
+static enum tinywot_status handler_property_status_read_counted(
+  struct tinywot_payload *res,
+  struct tinywot_payload *req,
+  void *context
+) {
+  *(unsigned int *)context += 1;
+
+  return handler_property_status_read(res, req, NULL);
+}
+
+static void tinywot_form_cache_should_skip_handler_until_invalidated(void) {
+  enum tinywot_status status = TINYWOT_STATUS_ERROR_GENERIC;
+  struct tinywot_thing *thing = tinywot_test_thing_new();
+  struct tinywot_form_cache cache = {0};
+  unsigned int calls_n = 0;
+  unsigned char cache_memory[TINYWOT_TEST_SMALL_MEMORY_SIZE_BYTE] = {0};
+  struct tinywot_form const form = {
+    .name = "status",
+    .target = "/status",
+    .op = TINYWOT_OPERATION_TYPE_READPROPERTY,
+    .handler = tinywot_form_cache_handler,
+    .context = &cache,
+  };
+
+  struct tinywot_request request = {0};
+  struct tinywot_response response = {0};
+  uint_least32_t etag = 0;
+
+  unsigned char *content_out = tinywot_test_mallocd(
+    TINYWOT_TEST_SMALL_MEMORY_SIZE_BYTE
+  );
+
+  tinywot_form_cache_init(
+    &cache,
+    handler_property_status_read_counted,
+    &calls_n,
+    cache_memory,
+    sizeof(cache_memory)
+  );
+
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_SUCCESS, tinywot_thing_add_form(thing, &form)
+  );
+
+  request.op = TINYWOT_OPERATION_TYPE_READPROPERTY;
+  memcpy(request.target, "/status", sizeof("/status"));
+
+  response.payload.content = content_out;
+  response.payload.content_buffer_size_byte =
+    TINYWOT_TEST_SMALL_MEMORY_SIZE_BYTE;
+
+  /* The first request fills the cache. */
+  status = tinywot_thing_process_request(thing, &response, &request);
+  TEST_ASSERT_EQUAL(TINYWOT_STATUS_SUCCESS, status);
+  TEST_ASSERT_EQUAL(TINYWOT_RESPONSE_STATUS_OK, response.status);
+  TEST_ASSERT_EQUAL_UINT(1U, calls_n);
+  TEST_ASSERT_EQUAL_STRING("false", response.payload.content);
+  TEST_ASSERT_EQUAL_UINT(6U, response.payload.content_length_byte);
+  TEST_ASSERT_EQUAL_UINT(50U, response.payload.content_type);
+  TEST_ASSERT_NOT_EQUAL(0U, response.etag);
+  etag = response.etag;
+
+  /* A second request without an ETag is served from the cache. */
+  memset(content_out, 0, TINYWOT_TEST_SMALL_MEMORY_SIZE_BYTE);
+  response.payload.content_length_byte = 0;
+  status = tinywot_thing_process_request(thing, &response, &request);
+  TEST_ASSERT_EQUAL(TINYWOT_STATUS_SUCCESS, status);
+  TEST_ASSERT_EQUAL(TINYWOT_RESPONSE_STATUS_OK, response.status);
+  TEST_ASSERT_EQUAL_UINT(1U, calls_n);
+  TEST_ASSERT_EQUAL_STRING("false", response.payload.content);
+  TEST_ASSERT_EQUAL_UINT32(etag, response.etag);
+
+  /* A request with the ETag gets nothing. */
+  request.etag = etag;
+  status = tinywot_thing_process_request(thing, &response, &request);
+  TEST_ASSERT_EQUAL(TINYWOT_STATUS_SUCCESS, status);
+  TEST_ASSERT_EQUAL(TINYWOT_RESPONSE_STATUS_NOT_MODIFIED, response.status);
+  TEST_ASSERT_EQUAL_UINT(1U, calls_n);
+  TEST_ASSERT_EQUAL_UINT(0U, response.payload.content_length_byte);
+  TEST_ASSERT_EQUAL_UINT32(etag, response.etag);
+
+  /* After a change, the handler is called again, with a new ETag. */
+  tinywot_form_cache_invalidate(&cache);
+  status = tinywot_thing_process_request(thing, &response, &request);
+  TEST_ASSERT_EQUAL(TINYWOT_STATUS_SUCCESS, status);
+  TEST_ASSERT_EQUAL(TINYWOT_RESPONSE_STATUS_OK, response.status);
+  TEST_ASSERT_EQUAL_UINT(2U, calls_n);
+  TEST_ASSERT_EQUAL_UINT(6U, response.payload.content_length_byte);
+  TEST_ASSERT_NOT_EQUAL(etag, response.etag);
+
+  tinywot_test_free(content_out);
+  tinywot_test_thing_delete(thing);
+}
+
+static void tinywot_form_cache_should_fail_when_too_small(void) {
+  struct tinywot_form_cache cache = {0};
+  unsigned int calls_n = 0;
+  unsigned char cache_memory[2] = {0};
+  struct tinywot_response response = {0};
+  struct tinywot_request request = {0};
+  unsigned char content_out[TINYWOT_TEST_SMALL_MEMORY_SIZE_BYTE] = {0};
+
+  tinywot_form_cache_init(
+    &cache,
+    handler_property_status_read_counted,
+    &calls_n,
+    cache_memory,
+    sizeof(cache_memory)
+  );
+
+  response.payload.content = content_out;
+  response.payload.content_buffer_size_byte = sizeof(content_out);
+
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_ERROR_NOT_ENOUGH_MEMORY,
+    tinywot_form_cache_handler(&response.payload, &request.payload, &cache)
+  );
+  TEST_ASSERT_EQUAL_UINT32(0U, cache.cached_version);
+}
+
+void setUp(void) {}
+void tearDown(void) {}
+
+int main(void) {
+  UNITY_BEGIN();
+
+  RUN_TEST(tinywot_form_cache_should_skip_handler_until_invalidated);
+  RUN_TEST(tinywot_form_cache_should_fail_when_too_small);
+
+  return UNITY_END();
+}
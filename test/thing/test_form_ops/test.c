@@ -0,0 +1,236 @@
+/*
+  SPDX-FileCopyrightText: 2023 Junde Yhi <junde@yhi.moe>
+  SPDX-License-Identifier: MIT
+*/
+
+/*!
+  \file
+  \brief Unit tests for `tinywot_form::ops`.
+*/
+
+#include <stddef.h>
+#include <string.h>
+#include <tinywot/core.h>
+#include <tinywot-test.h>
+#include <unity.h>
+
+#define OPS_STATUS \
+  (TINYWOT_OPERATION_TYPE_BIT(TINYWOT_OPERATION_TYPE_READPROPERTY) \
+   | TINYWOT_OPERATION_TYPE_BIT(TINYWOT_OPERATION_TYPE_WRITEPROPERTY) \
+   | TINYWOT_OPERATION_TYPE_BIT(TINYWOT_OPERATION_TYPE_OBSERVEPROPERTY))
+
+static enum tinywot_operation_type handled_op;
+
+/* One handler for every operation type on /status. */
+static enum tinywot_status handler_property_status(
+  struct tinywot_payload *res, struct tinywot_payload *req, void *context
+) {
+  (void)res;
+  (void)context;
+
+  handled_op = tinywot_request_of_payload(req)->op;
+
+  return TINYWOT_STATUS_SUCCESS;
+}
+
+static struct tinywot_thing *thing;
+
+static enum tinywot_response_status process(
+  char const *target, enum tinywot_operation_type op
+) {
+  struct tinywot_request request = {0};
+  struct tinywot_response response = {0};
+
+  request.op = op;
+  strcpy(request.target, target);
+  handled_op = TINYWOT_OPERATION_TYPE_UNKNOWN;
+
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_SUCCESS,
+    tinywot_thing_process_request(thing, &response, &request)
+  );
+
+  return response.status;
+}
+
+static void tinywot_form_ops_should_pass_op_to_handler(void) {
+  TEST_ASSERT_EQUAL(
+    TINYWOT_RESPONSE_STATUS_OK,
+    process("/status", TINYWOT_OPERATION_TYPE_READPROPERTY)
+  );
+  TEST_ASSERT_EQUAL(TINYWOT_OPERATION_TYPE_READPROPERTY, handled_op);
+
+  TEST_ASSERT_EQUAL(
+    TINYWOT_RESPONSE_STATUS_OK,
+    process("/status", TINYWOT_OPERATION_TYPE_WRITEPROPERTY)
+  );
+  TEST_ASSERT_EQUAL(TINYWOT_OPERATION_TYPE_WRITEPROPERTY, handled_op);
+
+  TEST_ASSERT_EQUAL(
+    TINYWOT_RESPONSE_STATUS_NOT_ALLOWED,
+    process("/status", TINYWOT_OPERATION_TYPE_INVOKEACTION)
+  );
+  TEST_ASSERT_EQUAL(TINYWOT_OPERATION_TYPE_UNKNOWN, handled_op);
+}
+
+static void tinywot_form_ops_should_work_with_index(void) {
+  size_t memory_size_byte = thing->forms_max_n * sizeof(size_t);
+  void *memory = tinywot_test_malloc0(memory_size_byte);
+
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_SUCCESS,
+    tinywot_thing_init_index(thing, memory, memory_size_byte)
+  );
+
+  TEST_ASSERT_EQUAL(
+    TINYWOT_RESPONSE_STATUS_OK,
+    process("/status", TINYWOT_OPERATION_TYPE_OBSERVEPROPERTY)
+  );
+  TEST_ASSERT_EQUAL(TINYWOT_OPERATION_TYPE_OBSERVEPROPERTY, handled_op);
+
+  thing->forms_index = NULL;
+  tinywot_test_free(memory);
+}
+
+static void tinywot_thing_get_allowed_ops_should_succeed(void) {
+  struct tinywot_request request = {0};
+  uint_least32_t ops = 0;
+
+  strcpy(request.target, "/status");
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_SUCCESS,
+    tinywot_thing_get_allowed_ops(thing, &request, &ops)
+  );
+  TEST_ASSERT_EQUAL_UINT32(OPS_STATUS, ops);
+
+  /* Forms with the same target add up. */
+  strcpy(request.target, "/oh");
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_SUCCESS,
+    tinywot_thing_get_allowed_ops(thing, &request, &ops)
+  );
+  TEST_ASSERT_EQUAL_UINT32(
+    TINYWOT_OPERATION_TYPE_BIT(TINYWOT_OPERATION_TYPE_SUBSCRIBEEVENT)
+      | TINYWOT_OPERATION_TYPE_BIT(TINYWOT_OPERATION_TYPE_UNSUBSCRIBEEVENT),
+    ops
+  );
+
+  strcpy(request.target, "/lorem");
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_ERROR_NOT_FOUND,
+    tinywot_thing_get_allowed_ops(thing, &request, &ops)
+  );
+}
+
+static void tinywot_form_ops_should_be_removed_one_by_one(void) {
+  struct tinywot_form *form = NULL;
+
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_SUCCESS,
+    tinywot_thing_remove_form(
+      thing, "/status", TINYWOT_OPERATION_TYPE_WRITEPROPERTY
+    )
+  );
+  TEST_ASSERT_EQUAL(
+    TINYWOT_RESPONSE_STATUS_NOT_ALLOWED,
+    process("/status", TINYWOT_OPERATION_TYPE_WRITEPROPERTY)
+  );
+
+  /* The main op is taken over by the one left. */
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_SUCCESS,
+    tinywot_thing_remove_form(
+      thing, "/status", TINYWOT_OPERATION_TYPE_READPROPERTY
+    )
+  );
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_SUCCESS,
+    tinywot_thing_find_form(
+      thing, &form, "/status", TINYWOT_OPERATION_TYPE_OBSERVEPROPERTY
+    )
+  );
+  TEST_ASSERT_EQUAL(TINYWOT_OPERATION_TYPE_OBSERVEPROPERTY, form->op);
+  TEST_ASSERT_EQUAL_UINT32(0U, form->ops);
+  TEST_ASSERT_EQUAL_UINT(0U, thing->forms_removed_n);
+
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_SUCCESS,
+    tinywot_thing_remove_form(
+      thing, "/status", TINYWOT_OPERATION_TYPE_OBSERVEPROPERTY
+    )
+  );
+  TEST_ASSERT_EQUAL_UINT(1U, thing->forms_removed_n);
+  TEST_ASSERT_EQUAL(
+    TINYWOT_RESPONSE_STATUS_NOT_FOUND,
+    process("/status", TINYWOT_OPERATION_TYPE_OBSERVEPROPERTY)
+  );
+}
+
+static void tinywot_form_ops_should_not_contain_unknown(void) {
+  struct tinywot_form form = {0};
+
+  form.target = "/toggle";
+  form.op = TINYWOT_OPERATION_TYPE_INVOKEACTION;
+  form.ops = TINYWOT_OPERATION_TYPE_BIT(TINYWOT_OPERATION_TYPE_UNKNOWN);
+
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_ERROR_NOT_ALLOWED,
+    tinywot_thing_change_form(
+      thing, "/toggle", TINYWOT_OPERATION_TYPE_INVOKEACTION, &form
+    )
+  );
+
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_SUCCESS,
+    tinywot_thing_remove_form(
+      thing, "/toggle", TINYWOT_OPERATION_TYPE_INVOKEACTION
+    )
+  );
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_ERROR_NOT_ALLOWED, tinywot_thing_add_form(thing, &form)
+  );
+  TEST_ASSERT_EQUAL_UINT(1U, thing->forms_removed_n);
+}
+
+void setUp(void) {
+  struct tinywot_form form = {0};
+
+  thing = tinywot_test_thing_new_example();
+
+  form.name = "status";
+  form.target = "/status";
+  form.op = TINYWOT_OPERATION_TYPE_READPROPERTY;
+  form.ops = OPS_STATUS;
+  form.handler = handler_property_status;
+
+  /* Replace both forms of /status with one. */
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_SUCCESS,
+    tinywot_thing_remove_form(
+      thing, "/status", TINYWOT_OPERATION_TYPE_WRITEPROPERTY
+    )
+  );
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_SUCCESS,
+    tinywot_thing_change_form(
+      thing, "/status", TINYWOT_OPERATION_TYPE_READPROPERTY, &form
+    )
+  );
+  tinywot_thing_compact_forms(thing);
+}
+
+void tearDown(void) {
+  tinywot_test_thing_delete(thing);
+}
+
+int main(void) {
+  UNITY_BEGIN();
+
+  RUN_TEST(tinywot_form_ops_should_pass_op_to_handler);
+  RUN_TEST(tinywot_form_ops_should_work_with_index);
+  RUN_TEST(tinywot_thing_get_allowed_ops_should_succeed);
+  RUN_TEST(tinywot_form_ops_should_be_removed_one_by_one);
+  RUN_TEST(tinywot_form_ops_should_not_contain_unknown);
+
+  return UNITY_END();
+}
@@ -0,0 +1,165 @@
+/*
+  SPDX-FileCopyrightText: 2023 Junde Yhi <junde@yhi.moe>
+  SPDX-License-Identifier: MIT
+*/
+
+/*!
+  \file
+  \brief Unit tests for `tinywot_thing_init_index()`.
+*/
+
+#include <stddef.h>
+#include <string.h>
+#include <tinywot/core.h>
+#include <tinywot-test.h>
+#include <unity.h>
+
+static struct tinywot_form const form_status_read = {
+  .name = "status",
+  .target = "/status",
+  .op = TINYWOT_OPERATION_TYPE_READPROPERTY,
+  .handler = NULL,
+  .context = NULL,
+};
+
+static struct tinywot_form const form_status_write = {
+  .name = "status",
+  .target = "/status",
+  .op = TINYWOT_OPERATION_TYPE_WRITEPROPERTY,
+  .handler = NULL,
+  .context = NULL,
+};
+
+static struct tinywot_form const form_toggle_invoke = {
+  .name = "toggle",
+  .target = "/toggle",
+  .op = TINYWOT_OPERATION_TYPE_INVOKEACTION,
+  .handler = NULL,
+  .context = NULL,
+};
+
+static struct tinywot_form const form_aardvark_read = {
+  .name = "aardvark",
+  .target = "/aardvark",
+  .op = TINYWOT_OPERATION_TYPE_READPROPERTY,
+  .handler = NULL,
+  .context = NULL,
+};
+
+static void tinywot_thing_init_index_should_succeed(void) {
+  enum tinywot_status status = TINYWOT_STATUS_ERROR_GENERIC;
+  struct tinywot_thing *thing = tinywot_test_thing_new_example();
+  size_t size = TINYWOT_THING_INDEX_SIZE_BYTE(thing->forms_max_n);
+  void *memory = tinywot_test_mallocd(size);
+  struct tinywot_form *form = NULL;
+
+  status = tinywot_thing_init_index(thing, memory, size);
+  TEST_ASSERT_EQUAL(TINYWOT_STATUS_SUCCESS, status);
+  TEST_ASSERT_NOT_NULL(thing->forms_index);
+
+  status = tinywot_thing_find_form(
+    thing, &form, "/status", TINYWOT_OPERATION_TYPE_WRITEPROPERTY
+  );
+  TEST_ASSERT_EQUAL(TINYWOT_STATUS_SUCCESS, status);
+  TEST_ASSERT_EQUAL_PTR(&thing->forms[1], form);
+
+  form = NULL;
+  status = tinywot_thing_find_form(
+    thing, &form, "/lorem", TINYWOT_OPERATION_TYPE_READPROPERTY
+  );
+  TEST_ASSERT_EQUAL(TINYWOT_STATUS_ERROR_NOT_FOUND, status);
+  TEST_ASSERT_NULL(form);
+
+  status = tinywot_thing_find_form(
+    thing, &form, "/status", TINYWOT_OPERATION_TYPE_INVOKEACTION
+  );
+  TEST_ASSERT_EQUAL(TINYWOT_STATUS_ERROR_NOT_ALLOWED, status);
+  TEST_ASSERT_NULL(form);
+
+  tinywot_test_free(memory);
+  tinywot_test_thing_delete(thing);
+}
+
+static void tinywot_thing_init_index_should_fail_when_no_enough_memory(
+  void
+) {
+  enum tinywot_status status = TINYWOT_STATUS_ERROR_GENERIC;
+  struct tinywot_thing *thing = tinywot_test_thing_new_example();
+  size_t size = TINYWOT_THING_INDEX_SIZE_BYTE(thing->forms_count_n - 1);
+  void *memory = tinywot_test_mallocd(size);
+
+  status = tinywot_thing_init_index(thing, memory, size);
+
+  TEST_ASSERT_EQUAL(TINYWOT_STATUS_ERROR_NOT_ENOUGH_MEMORY, status);
+  TEST_ASSERT_NULL(thing->forms_index);
+
+  tinywot_test_free(memory);
+  tinywot_test_thing_delete(thing);
+}
+
+static void tinywot_thing_init_index_should_keep_up_with_changes(void) {
+  enum tinywot_status status = TINYWOT_STATUS_ERROR_GENERIC;
+  struct tinywot_thing *thing = tinywot_test_thing_new();
+  size_t size = TINYWOT_THING_INDEX_SIZE_BYTE(thing->forms_max_n);
+  void *memory = tinywot_test_mallocd(size);
+  struct tinywot_form *form = NULL;
+
+  status = tinywot_thing_init_index(thing, memory, size);
+  TEST_ASSERT_EQUAL(TINYWOT_STATUS_SUCCESS, status);
+
+  /* 0: /status read, 1: /toggle invoke, 2: /status write */
+  (void)tinywot_thing_add_form(thing, &form_status_read);
+  (void)tinywot_thing_add_form(thing, &form_toggle_invoke);
+  (void)tinywot_thing_add_form(thing, &form_status_write);
+
+  /* 3: /status read, overriding 0 */
+  status = tinywot_thing_add_form(thing, &form_status_read);
+  TEST_ASSERT_EQUAL(TINYWOT_STATUS_SUCCESS, status);
+
+  status = tinywot_thing_find_form(
+    thing, &form, "/status", TINYWOT_OPERATION_TYPE_READPROPERTY
+  );
+  TEST_ASSERT_EQUAL(TINYWOT_STATUS_SUCCESS, status);
+  TEST_ASSERT_EQUAL_PTR(&thing->forms[3], form);
+
+  /* 1: /toggle invoke -> /aardvark read */
+  status = tinywot_thing_change_form(
+    thing, "/toggle", TINYWOT_OPERATION_TYPE_INVOKEACTION, &form_aardvark_read
+  );
+  TEST_ASSERT_EQUAL(TINYWOT_STATUS_SUCCESS, status);
+
+  form = NULL;
+  status = tinywot_thing_find_form(
+    thing, &form, "/toggle", TINYWOT_OPERATION_TYPE_INVOKEACTION
+  );
+  TEST_ASSERT_EQUAL(TINYWOT_STATUS_ERROR_NOT_FOUND, status);
+  TEST_ASSERT_NULL(form);
+
+  status = tinywot_thing_find_form(
+    thing, &form, "/aardvark", TINYWOT_OPERATION_TYPE_READPROPERTY
+  );
+  TEST_ASSERT_EQUAL(TINYWOT_STATUS_SUCCESS, status);
+  TEST_ASSERT_EQUAL_PTR(&thing->forms[1], form);
+
+  status = tinywot_thing_find_form(
+    thing, &form, "/status", TINYWOT_OPERATION_TYPE_WRITEPROPERTY
+  );
+  TEST_ASSERT_EQUAL(TINYWOT_STATUS_SUCCESS, status);
+  TEST_ASSERT_EQUAL_PTR(&thing->forms[2], form);
+
+  tinywot_test_free(memory);
+  tinywot_test_thing_delete(thing);
+}
+
+void setUp(void) {}
+void tearDown(void) {}
+
+int main(void) {
+  UNITY_BEGIN();
+
+  RUN_TEST(tinywot_thing_init_index_should_succeed);
+  RUN_TEST(tinywot_thing_init_index_should_fail_when_no_enough_memory);
+  RUN_TEST(tinywot_thing_init_index_should_keep_up_with_changes);
+
+  return UNITY_END();
+}
@@ -0,0 +1,114 @@
+/*
+  SPDX-FileCopyrightText: 2023 Junde Yhi <junde@yhi.moe>
+  SPDX-License-Identifier: MIT
+*/
+
+/*!
+  \file
+  \brief Unit tests for `tinywot_thing_init_static_flash()`.
+*/
+
+#include <stddef.h>
+#include <string.h>
+#include <tinywot/core.h>
+#include <tinywot-test.h>
+#include <unity.h>
+
+tinywot_form_handler_t handler_property_status_read;
+
+static char const target_status[] TINYWOT_FLASH = "/status";
+static char const target_toggle[] TINYWOT_FLASH = "/toggle";
+
+static struct tinywot_form const forms[] TINYWOT_FLASH = {
+  {
+    .name = NULL,
+    .target = target_status,
+    .op = TINYWOT_OPERATION_TYPE_READPROPERTY,
+    .handler = handler_property_status_read,
+    .context = NULL,
+  },
+  {
+    .name = NULL,
+    .target = target_toggle,
+    .op = TINYWOT_OPERATION_TYPE_INVOKEACTION,
+    .handler = NULL,
+    .context = NULL,
+  },
+};
+
+static void tinywot_thing_init_static_flash_should_find_forms(void) {
+  struct tinywot_thing thing = {0};
+  struct tinywot_form *form = NULL;
+  struct tinywot_form copy = {0};
+  unsigned char index[TINYWOT_THING_INDEX_SIZE_BYTE(2)];
+
+  tinywot_thing_init_static_flash(&thing, forms, sizeof(forms));
+
+  TEST_ASSERT_TRUE(thing.forms_in_flash);
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_SUCCESS,
+    tinywot_thing_find_form(
+      &thing, &form, "/toggle", TINYWOT_OPERATION_TYPE_INVOKEACTION
+    )
+  );
+  TEST_ASSERT_EQUAL_PTR(&forms[1], form);
+
+  tinywot_thing_read_form(&thing, form, &copy);
+  TEST_ASSERT_EQUAL(TINYWOT_OPERATION_TYPE_INVOKEACTION, copy.op);
+
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_ERROR_NOT_ALLOWED,
+    tinywot_thing_find_form(
+      &thing, &form, "/toggle", TINYWOT_OPERATION_TYPE_READPROPERTY
+    )
+  );
+
+  /* Indices compare targets in RAM. */
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_ERROR_NOT_ALLOWED,
+    tinywot_thing_init_index(&thing, index, sizeof(index))
+  );
+
+  /* Other init functions go back to RAM. */
+  tinywot_thing_init_static(&thing, forms, sizeof(forms));
+  TEST_ASSERT_FALSE(thing.forms_in_flash);
+}
+
+static void tinywot_thing_init_static_flash_should_process_requests(void) {
+  struct tinywot_thing thing = {0};
+  struct tinywot_request request = {0};
+  struct tinywot_response response = {0};
+
+  tinywot_thing_init_static_flash(&thing, forms, sizeof(forms));
+
+  request.op = TINYWOT_OPERATION_TYPE_READPROPERTY;
+  memcpy(request.target, "/status", sizeof("/status"));
+
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_SUCCESS,
+    tinywot_thing_process_request(&thing, &response, &request)
+  );
+  TEST_ASSERT_EQUAL(TINYWOT_RESPONSE_STATUS_OK, response.status);
+  TEST_ASSERT_EQUAL_STRING("false", response.payload.content);
+
+  request.op = TINYWOT_OPERATION_TYPE_INVOKEACTION;
+  memcpy(request.target, "/toggle", sizeof("/toggle"));
+
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_SUCCESS,
+    tinywot_thing_process_request(&thing, &response, &request)
+  );
+  TEST_ASSERT_EQUAL(TINYWOT_RESPONSE_STATUS_NOT_SUPPORTED, response.status);
+}
+
+void setUp(void) {}
+void tearDown(void) {}
+
+int main(void) {
+  UNITY_BEGIN();
+
+  RUN_TEST(tinywot_thing_init_static_flash_should_find_forms);
+  RUN_TEST(tinywot_thing_init_static_flash_should_process_requests);
+
+  return UNITY_END();
+}
@@ -0,0 +1,101 @@
+/* Generated by tinywot-forms.py from forms.txt. */
+/* Do not edit. */
+
+#ifndef EXAMPLE_FORMS_H
+#define EXAMPLE_FORMS_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <tinywot/core.h>
+
+tinywot_form_handler_t handler_property_status_read;
+tinywot_form_handler_t handler_property_status_write;
+tinywot_form_handler_t handler_action_toggle;
+
+static struct tinywot_form const example_forms[] = {
+  {
+    .name = "toggle",
+    .target = "/toggle",
+    .op = TINYWOT_OPERATION_TYPE_INVOKEACTION,
+    .handler = handler_action_toggle,
+    .context = NULL,
+  },
+  {
+    .name = "colour",
+    .target = "/colour",
+    .op = TINYWOT_OPERATION_TYPE_READPROPERTY,
+    .handler = NULL,
+    .context = NULL,
+  },
+  {
+    .name = "brightness",
+    .target = "/brightness",
+    .op = TINYWOT_OPERATION_TYPE_READPROPERTY,
+    .handler = NULL,
+    .context = NULL,
+  },
+  {
+    .name = "brightness",
+    .target = "/brightness",
+    .op = TINYWOT_OPERATION_TYPE_WRITEPROPERTY,
+    .handler = NULL,
+    .context = NULL,
+  },
+  {
+    .name = "reset",
+    .target = "/reset",
+    .op = TINYWOT_OPERATION_TYPE_INVOKEACTION,
+    .handler = NULL,
+    .context = NULL,
+  },
+  {
+    .name = "status",
+    .target = "/status",
+    .op = TINYWOT_OPERATION_TYPE_READPROPERTY,
+    .handler = handler_property_status_read,
+    .context = NULL,
+  },
+  {
+    .name = "status",
+    .target = "/status",
+    .op = TINYWOT_OPERATION_TYPE_WRITEPROPERTY,
+    .handler = handler_property_status_write,
+    .context = NULL,
+  },
+  {
+    .name = "status",
+    .target = "/status",
+    .op = TINYWOT_OPERATION_TYPE_READPROPERTY,
+    .handler = handler_property_status_write,
+    .context = NULL,
+  },
+  {
+    .name = "overheating",
+    .target = "/oh",
+    .op = TINYWOT_OPERATION_TYPE_SUBSCRIBEEVENT,
+    .handler = NULL,
+    .context = NULL,
+  },
+  {
+    .name = "overheating",
+    .target = "/oh",
+    .op = TINYWOT_OPERATION_TYPE_UNSUBSCRIBEEVENT,
+    .handler = NULL,
+    .context = NULL,
+  },
+};
+
+static uint_least16_t const example_forms_hash_displacements[] = {
+  10, 0, 6,
+};
+
+static uint_least16_t const example_forms_hash_offsets[] = {
+  0, 1, 2, 4, 5, 8, 10,
+};
+
+static struct tinywot_form_hash_table const example_forms_hash =
+  TINYWOT_FORM_HASH_TABLE_INIT(
+    example_forms_hash_displacements, example_forms_hash_offsets
+  );
+
+#endif /* EXAMPLE_FORMS_H */
@@ -0,0 +1,103 @@
+/*
+  SPDX-FileCopyrightText: 2023 Junde Yhi <junde@yhi.moe>
+  SPDX-License-Identifier: MIT
+*/
+
+/*!
+  \file
+  \brief Unit tests for `tinywot_thing_init_static_hashed()`.
+*/
+
+#include <stddef.h>
+#include <string.h>
+#include <tinywot/core.h>
+#include <tinywot-test.h>
+#include <unity.h>
+
+#include "forms.h"
+
+static void tinywot_thing_init_static_hashed_should_succeed(void) {
+  enum tinywot_status status = TINYWOT_STATUS_ERROR_GENERIC;
+  struct tinywot_thing thing = {0};
+  struct tinywot_form *form = NULL;
+
+  tinywot_thing_init_static_hashed(
+    &thing, example_forms, sizeof(example_forms), &example_forms_hash
+  );
+
+  TEST_ASSERT_EQUAL_PTR(&example_forms_hash, thing.forms_hash);
+
+  /* Every declared target and op must be found. */
+  for (size_t i = 0; i < thing.forms_count_n; i++) {
+    form = NULL;
+    status = tinywot_thing_find_form(
+      &thing, &form, example_forms[i].target, example_forms[i].op
+    );
+
+    TEST_ASSERT_EQUAL(TINYWOT_STATUS_SUCCESS, status);
+    TEST_ASSERT_NOT_NULL(form);
+    TEST_ASSERT_EQUAL_STRING(example_forms[i].target, form->target);
+    TEST_ASSERT_EQUAL(example_forms[i].op, form->op);
+  }
+}
+
+static void tinywot_thing_init_static_hashed_should_keep_override(void) {
+  enum tinywot_status status = TINYWOT_STATUS_ERROR_GENERIC;
+  struct tinywot_thing thing = {0};
+  struct tinywot_form *form = NULL;
+
+  tinywot_thing_init_static_hashed(
+    &thing, example_forms, sizeof(example_forms), &example_forms_hash
+  );
+
+  /* The last line of forms.txt overrides the first one. */
+  status = tinywot_thing_find_form(
+    &thing, &form, "/status", TINYWOT_OPERATION_TYPE_READPROPERTY
+  );
+
+  TEST_ASSERT_EQUAL(TINYWOT_STATUS_SUCCESS, status);
+  TEST_ASSERT_TRUE(form->handler == handler_property_status_write);
+}
+
+static void tinywot_thing_init_static_hashed_should_fail_when_mismatch(
+  void
+) {
+  enum tinywot_status status = TINYWOT_STATUS_ERROR_GENERIC;
+  struct tinywot_thing thing = {0};
+  struct tinywot_form *form = NULL;
+
+  tinywot_thing_init_static_hashed(
+    &thing, example_forms, sizeof(example_forms), &example_forms_hash
+  );
+
+  status = tinywot_thing_find_form(
+    &thing, &form, "/lorem", TINYWOT_OPERATION_TYPE_READPROPERTY
+  );
+  TEST_ASSERT_EQUAL(TINYWOT_STATUS_ERROR_NOT_FOUND, status);
+  TEST_ASSERT_NULL(form);
+
+  status = tinywot_thing_find_form(
+    &thing, &form, "/toggle", TINYWOT_OPERATION_TYPE_READPROPERTY
+  );
+  TEST_ASSERT_EQUAL(TINYWOT_STATUS_ERROR_NOT_ALLOWED, status);
+  TEST_ASSERT_NULL(form);
+
+  /* A static Thing must not be changed. */
+  status = tinywot_thing_change_form(
+    &thing, "/toggle", TINYWOT_OPERATION_TYPE_INVOKEACTION, &example_forms[0]
+  );
+  TEST_ASSERT_EQUAL(TINYWOT_STATUS_ERROR_NOT_ALLOWED, status);
+}
+
+void setUp(void) {}
+void tearDown(void) {}
+
+int main(void) {
+  UNITY_BEGIN();
+
+  RUN_TEST(tinywot_thing_init_static_hashed_should_succeed);
+  RUN_TEST(tinywot_thing_init_static_hashed_should_keep_override);
+  RUN_TEST(tinywot_thing_init_static_hashed_should_fail_when_mismatch);
+
+  return UNITY_END();
+}
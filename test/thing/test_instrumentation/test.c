@@ -0,0 +1,230 @@
+/*
+  SPDX-FileCopyrightText: 2023 Junde Yhi <junde@yhi.moe>
+  SPDX-License-Identifier: MIT
+*/
+
+/*!
+  \file
+  \brief Unit tests for `tinywot_instrumentation`.
+
+  These need `TINYWOT_ENABLE_INSTRUMENTATION`, which is defined by the
+  `test_native` environment. They are ignored otherwise.
+*/
+
+#include <stddef.h>
+#include <string.h>
+#include <tinywot/core.h>
+#include <tinywot/json.h>
+#include <tinywot-test.h>
+#include <unity.h>
+
+#ifdef TINYWOT_ENABLE_INSTRUMENTATION
+struct recorder {
+  uint_least32_t now;
+  unsigned int before_n;
+  unsigned int after_n;
+  struct tinywot_form const *last_form;
+  enum tinywot_status last_status;
+};
+
+/* Every reading of the clock takes 3 ticks. */
+static uint_least32_t clock_fake(void *context) {
+  struct recorder *recorder = (struct recorder *)context;
+
+  recorder->now += 3U;
+
+  return recorder->now;
+}
+
+static void hook_before(
+  void *context,
+  struct tinywot_request const *request,
+  struct tinywot_response const *response,
+  struct tinywot_form const *form,
+  enum tinywot_status status
+) {
+  (void)request;
+  (void)response;
+  (void)form;
+  (void)status;
+
+  ((struct recorder *)context)->before_n += 1;
+}
+
+static void hook_after(
+  void *context,
+  struct tinywot_request const *request,
+  struct tinywot_response const *response,
+  struct tinywot_form const *form,
+  enum tinywot_status status
+) {
+  struct recorder *recorder = (struct recorder *)context;
+
+  (void)request;
+  (void)response;
+
+  recorder->after_n += 1;
+  recorder->last_form = form;
+  recorder->last_status = status;
+}
+
+static void process(
+  struct tinywot_thing *thing,
+  char const *target,
+  enum tinywot_operation_type op
+) {
+  struct tinywot_request request = {0};
+  struct tinywot_response response = {0};
+
+  request.op = op;
+  strcpy(request.target, target);
+
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_SUCCESS,
+    tinywot_thing_process_request(thing, &response, &request)
+  );
+}
+#endif
+
+static void tinywot_instrumentation_should_count(void) {
+#ifdef TINYWOT_ENABLE_INSTRUMENTATION
+  struct tinywot_thing *thing = tinywot_test_thing_new_example();
+  struct tinywot_instrumentation instrumentation;
+  struct tinywot_form_stats stats[5];
+  struct recorder recorder = {0};
+
+  tinywot_thing_init_instrumentation(
+    thing, &instrumentation, stats, sizeof(stats)
+  );
+  instrumentation.clock = clock_fake;
+  instrumentation.before_dispatch = hook_before;
+  instrumentation.after_dispatch = hook_after;
+  instrumentation.context = &recorder;
+
+  process(thing, "/status", TINYWOT_OPERATION_TYPE_READPROPERTY);
+  process(thing, "/status", TINYWOT_OPERATION_TYPE_READPROPERTY);
+  process(thing, "/toggle", TINYWOT_OPERATION_TYPE_READPROPERTY);
+  process(thing, "/nothing", TINYWOT_OPERATION_TYPE_READPROPERTY);
+
+  TEST_ASSERT_EQUAL_UINT32(4U, instrumentation.lookups_n);
+  TEST_ASSERT_EQUAL_UINT32(1U, instrumentation.not_found_n);
+  TEST_ASSERT_EQUAL_UINT32(1U, instrumentation.not_allowed_n);
+
+  TEST_ASSERT_EQUAL_UINT32(2U, stats[0].hits_n);
+  TEST_ASSERT_EQUAL_UINT32(0U, stats[0].errors_n);
+  TEST_ASSERT_EQUAL_UINT32(0U, stats[2].hits_n);
+
+  /* 3 ticks go to the bucket from 2 to below 4. */
+  TEST_ASSERT_EQUAL_UINT32(2U, stats[0].latencies_n[2]);
+
+  TEST_ASSERT_EQUAL_UINT(4U, recorder.before_n);
+  TEST_ASSERT_EQUAL_UINT(4U, recorder.after_n);
+  TEST_ASSERT_NULL(recorder.last_form);
+  TEST_ASSERT_EQUAL(TINYWOT_STATUS_ERROR_NOT_FOUND, recorder.last_status);
+
+  /* A form without a handler is an error. */
+  process(thing, "/oh", TINYWOT_OPERATION_TYPE_SUBSCRIBEEVENT);
+  TEST_ASSERT_EQUAL_UINT32(1U, stats[3].hits_n);
+  TEST_ASSERT_EQUAL_UINT32(1U, stats[3].errors_n);
+  TEST_ASSERT_EQUAL_STRING("/oh", recorder.last_form->target);
+
+  tinywot_test_thing_delete(thing);
+#else
+  TEST_IGNORE();
+#endif
+}
+
+static void tinywot_instrumentation_should_move_with_forms(void) {
+#ifdef TINYWOT_ENABLE_INSTRUMENTATION
+  struct tinywot_thing *thing = tinywot_test_thing_new_example();
+  struct tinywot_instrumentation instrumentation;
+  struct tinywot_form_stats stats[5];
+
+  tinywot_thing_init_instrumentation(
+    thing, &instrumentation, stats, sizeof(stats)
+  );
+
+  process(thing, "/toggle", TINYWOT_OPERATION_TYPE_INVOKEACTION);
+  TEST_ASSERT_EQUAL_UINT32(1U, stats[2].hits_n);
+
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_SUCCESS,
+    tinywot_thing_remove_form(
+      thing, "/status", TINYWOT_OPERATION_TYPE_WRITEPROPERTY
+    )
+  );
+  tinywot_thing_compact_forms(thing);
+
+  TEST_ASSERT_EQUAL_STRING("/toggle", thing->forms[1].target);
+  TEST_ASSERT_EQUAL_UINT32(1U, stats[1].hits_n);
+
+  tinywot_test_thing_delete(thing);
+#else
+  TEST_IGNORE();
+#endif
+}
+
+static void tinywot_instrumentation_should_be_readable(void) {
+#ifdef TINYWOT_ENABLE_INSTRUMENTATION
+  struct tinywot_thing *thing = tinywot_test_thing_new_example();
+  struct tinywot_instrumentation instrumentation;
+  struct tinywot_form_stats stats[5];
+  struct tinywot_json_batch batch = {
+    .thing = thing,
+    .content_type = 50,
+    .policy = TINYWOT_JSON_BATCH_POLICY_ABORT,
+  };
+  struct tinywot_response response = {0};
+  struct tinywot_request request = {0};
+  char *content = NULL;
+
+  tinywot_thing_init_instrumentation(
+    thing, &instrumentation, stats, sizeof(stats)
+  );
+
+  process(thing, "/status", TINYWOT_OPERATION_TYPE_READPROPERTY);
+  process(thing, "/nothing", TINYWOT_OPERATION_TYPE_READPROPERTY);
+
+  content = tinywot_test_malloc0(TINYWOT_TEST_MEMORY_SIZE_BYTE);
+  response.payload.content = content;
+  response.payload.content_buffer_size_byte =
+    TINYWOT_TEST_MEMORY_SIZE_BYTE - 1;
+
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_SUCCESS,
+    tinywot_json_handler_read_instrumentation(
+      &response.payload, &request.payload, &batch
+    )
+  );
+  TEST_ASSERT_EQUAL_UINT(50U, response.payload.content_type);
+  TEST_ASSERT_EQUAL_STRING_LEN(
+    "{\"lookups\":2,\"notFound\":1,\"notAllowed\":0,\"forms\":["
+    "{\"target\":\"/status\",\"op\":1,\"hits\":1,\"errors\":0,"
+    "\"latencies\":[0,0,0,0,0,0,0,0]},",
+    content,
+    strlen(
+      "{\"lookups\":2,\"notFound\":1,\"notAllowed\":0,\"forms\":["
+      "{\"target\":\"/status\",\"op\":1,\"hits\":1,\"errors\":0,"
+      "\"latencies\":[0,0,0,0,0,0,0,0]},"
+    )
+  );
+
+  tinywot_test_free(content);
+  tinywot_test_thing_delete(thing);
+#else
+  TEST_IGNORE();
+#endif
+}
+
+void setUp(void) {}
+void tearDown(void) {}
+
+int main(void) {
+  UNITY_BEGIN();
+
+  RUN_TEST(tinywot_instrumentation_should_count);
+  RUN_TEST(tinywot_instrumentation_should_move_with_forms);
+  RUN_TEST(tinywot_instrumentation_should_be_readable);
+
+  return UNITY_END();
+}
@@ -0,0 +1,236 @@
+/*
+  SPDX-FileCopyrightText: 2023 Junde Yhi <junde@yhi.moe>
+  SPDX-License-Identifier: MIT
+*/
+
+/*!
+  \file
+  \brief Unit tests for observers of `tinywot_thing`.
+*/
+
+#include <stddef.h>
+#include <string.h>
+#include <tinywot/core.h>
+#include <tinywot-test.h>
+#include <unity.h>
+
+/* Defined in tinywot-test.c. */
+tinywot_form_handler_t handler_property_status_read;
+
+static struct tinywot_form const forms[] = {
+  {
+    .name = "status",
+    .target = "/status",
+    .op = TINYWOT_OPERATION_TYPE_READPROPERTY,
+    .handler = handler_property_status_read,
+  },
+  {
+    .name = "status",
+    .target = "/status",
+    .op = TINYWOT_OPERATION_TYPE_OBSERVEPROPERTY,
+  },
+  {
+    .name = "status",
+    .target = "/status",
+    .op = TINYWOT_OPERATION_TYPE_UNOBSERVEPROPERTY,
+  },
+  {
+    .name = "overheating",
+    .target = "/oh",
+    .op = TINYWOT_OPERATION_TYPE_SUBSCRIBEEVENT,
+  },
+  {
+    .name = NULL,
+    .target = "/properties",
+    .op = TINYWOT_OPERATION_TYPE_OBSERVEALLPROPERTIES,
+  },
+};
+
+static struct tinywot_thing thing;
+static struct tinywot_observer observers[3];
+static unsigned char content_out[TINYWOT_TEST_MEMORY_SIZE_BYTE];
+static struct tinywot_response response;
+
+static enum tinywot_response_status request_from(
+  char const *origin, char const *target, enum tinywot_operation_type op
+) {
+  struct tinywot_request request = {0};
+
+  request.op = op;
+  request.origin = (unsigned char const *)origin;
+  request.origin_length_byte = strlen(origin);
+  memcpy(request.target, target, strlen(target) + 1);
+
+  memset(&response, 0, sizeof(response));
+  response.payload.content = content_out;
+  response.payload.content_buffer_size_byte = sizeof(content_out);
+
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_SUCCESS,
+    tinywot_thing_process_request(&thing, &response, &request)
+  );
+
+  return response.status;
+}
+
+static void tinywot_thing_should_notify_observers(void) {
+  struct tinywot_observer *observer = NULL;
+
+  TEST_ASSERT_EQUAL(
+    TINYWOT_RESPONSE_STATUS_OK,
+    request_from("alice", "/status", TINYWOT_OPERATION_TYPE_OBSERVEPROPERTY)
+  );
+  TEST_ASSERT_EQUAL(
+    TINYWOT_RESPONSE_STATUS_OK,
+    request_from("alice", "/status", TINYWOT_OPERATION_TYPE_OBSERVEPROPERTY)
+  );
+  TEST_ASSERT_EQUAL(
+    TINYWOT_RESPONSE_STATUS_OK,
+    request_from("bob", "/oh", TINYWOT_OPERATION_TYPE_SUBSCRIBEEVENT)
+  );
+  TEST_ASSERT_EQUAL(
+    TINYWOT_RESPONSE_STATUS_OK,
+    request_from(
+      "carol", "/properties", TINYWOT_OPERATION_TYPE_OBSERVEALLPROPERTIES
+    )
+  );
+
+  /* observing again does not take another record, so the pool is full */
+  TEST_ASSERT_EQUAL(
+    TINYWOT_RESPONSE_STATUS_INTERNAL_ERROR,
+    request_from("dave", "/status", TINYWOT_OPERATION_TYPE_OBSERVEPROPERTY)
+  );
+
+  /* nothing is dirty yet */
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_ERROR_NOT_FOUND,
+    tinywot_thing_next_notification(&thing, &observer)
+  );
+
+  /* alice and carol observe /status */
+  TEST_ASSERT_EQUAL_UINT(2U, tinywot_thing_mark_dirty(&thing, "/status"));
+  TEST_ASSERT_EQUAL_UINT(2U, tinywot_thing_mark_dirty(&thing, "/status"));
+
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_SUCCESS, tinywot_thing_next_notification(&thing, &observer)
+  );
+  TEST_ASSERT_EQUAL_UINT(5U, observer->origin_length_byte);
+  TEST_ASSERT_EQUAL_MEMORY("alice", observer->origin, 5);
+
+  memset(&response, 0, sizeof(response));
+  response.payload.content = content_out;
+  response.payload.content_buffer_size_byte = sizeof(content_out);
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_SUCCESS,
+    tinywot_thing_process_notification(&thing, &response, observer)
+  );
+  TEST_ASSERT_EQUAL(TINYWOT_RESPONSE_STATUS_OK, response.status);
+  TEST_ASSERT_EQUAL_STRING("false", response.payload.content);
+
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_SUCCESS, tinywot_thing_next_notification(&thing, &observer)
+  );
+  TEST_ASSERT_EQUAL_MEMORY("carol", observer->origin, 5);
+
+  /* no readallproperties form to notify with */
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_ERROR_NOT_FOUND,
+    tinywot_thing_process_notification(&thing, &response, observer)
+  );
+  tinywot_thing_remove_observer(&thing, observer);
+
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_ERROR_NOT_FOUND,
+    tinywot_thing_next_notification(&thing, &observer)
+  );
+
+  /* an event without a handler is notified without data */
+  TEST_ASSERT_EQUAL_UINT(1U, tinywot_thing_mark_dirty(&thing, "/oh"));
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_SUCCESS, tinywot_thing_next_notification(&thing, &observer)
+  );
+  TEST_ASSERT_EQUAL_MEMORY("bob", observer->origin, 3);
+  response.payload.content_length_byte = 1;
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_SUCCESS,
+    tinywot_thing_process_notification(&thing, &response, observer)
+  );
+  TEST_ASSERT_EQUAL_UINT(0U, response.payload.content_length_byte);
+
+  /* alice leaves */
+  TEST_ASSERT_EQUAL(
+    TINYWOT_RESPONSE_STATUS_OK,
+    request_from("alice", "/status", TINYWOT_OPERATION_TYPE_UNOBSERVEPROPERTY)
+  );
+  TEST_ASSERT_EQUAL_UINT(0U, tinywot_thing_mark_dirty(&thing, "/status"));
+}
+
+static void tinywot_thing_should_not_observe_without_observers(void) {
+  thing.observers = NULL;
+  thing.observers_max_n = 0;
+
+  TEST_ASSERT_EQUAL(
+    TINYWOT_RESPONSE_STATUS_NOT_SUPPORTED,
+    request_from("alice", "/status", TINYWOT_OPERATION_TYPE_OBSERVEPROPERTY)
+  );
+}
+
+static void tinywot_thing_should_not_observe_with_router(void) {
+  static struct tinywot_router_node nodes[8];
+  struct tinywot_router router = {0};
+
+  /* Observers would keep patterns, not the targets being observed. */
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_ERROR_NOT_ALLOWED,
+    tinywot_thing_init_router(&thing, &router)
+  );
+
+  tinywot_thing_init_static(&thing, forms, sizeof(forms));
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_SUCCESS, tinywot_router_init(&router, nodes, sizeof(nodes))
+  );
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_SUCCESS, tinywot_thing_init_router(&thing, &router)
+  );
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_ERROR_NOT_ALLOWED,
+    tinywot_thing_init_observers(&thing, observers, sizeof(observers))
+  );
+  TEST_ASSERT_NULL(thing.observers);
+
+  TEST_ASSERT_EQUAL(
+    TINYWOT_RESPONSE_STATUS_NOT_SUPPORTED,
+    request_from("alice", "/status", TINYWOT_OPERATION_TYPE_OBSERVEPROPERTY)
+  );
+}
+
+static void tinywot_thing_should_not_observe_forms_in_flash(void) {
+  tinywot_thing_init_static_flash(&thing, forms, sizeof(forms));
+
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_ERROR_NOT_ALLOWED,
+    tinywot_thing_init_observers(&thing, observers, sizeof(observers))
+  );
+  TEST_ASSERT_NULL(thing.observers);
+}
+
+void setUp(void) {
+  tinywot_thing_init_static(&thing, forms, sizeof(forms));
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_SUCCESS,
+    tinywot_thing_init_observers(&thing, observers, sizeof(observers))
+  );
+}
+
+void tearDown(void) {}
+
+int main(void) {
+  UNITY_BEGIN();
+
+  RUN_TEST(tinywot_thing_should_notify_observers);
+  RUN_TEST(tinywot_thing_should_not_observe_without_observers);
+  RUN_TEST(tinywot_thing_should_not_observe_with_router);
+  RUN_TEST(tinywot_thing_should_not_observe_forms_in_flash);
+
+  return UNITY_END();
+}
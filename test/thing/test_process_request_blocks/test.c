@@ -0,0 +1,122 @@
+/*
+  SPDX-FileCopyrightText: 2023 Junde Yhi <junde@yhi.moe>
+  SPDX-License-Identifier: MIT
+*/
+
+/*!
+  \file
+  \brief Unit tests for `tinywot_thing_process_request()` with a
+  response sent in blocks.
+*/
+
+#include <stddef.h>
+#include <string.h>
+#include <tinywot/core.h>
+#include <tinywot-test.h>
+#include <unity.h>
+
+static char const log_str[] =
+  "boot ok; sensor ok; wifi up; overheating; fan on; cooled down";
+
+/* Write log_str from the offset of the response, as much as fits. */
+static enum tinywot_status handler_property_log_read(
+  struct tinywot_payload *res,
+  struct tinywot_payload *req,
+  void *context
+) {
+  struct tinywot_response *response = tinywot_response_of_payload(res);
+  size_t remaining_byte = sizeof(log_str) - 1 - response->offset_byte;
+  size_t block_byte = remaining_byte < res->content_buffer_size_byte ?
+    remaining_byte : res->content_buffer_size_byte;
+
+  (void)req;
+  (void)context;
+
+  /* The cursor counts calls, to show that it is kept between blocks. */
+  response->cursor += 1;
+
+  memcpy(res->content, log_str + response->offset_byte, block_byte);
+  res->content_length_byte = block_byte;
+  res->content_type = 0;
+
+  return block_byte < remaining_byte ?
+    TINYWOT_STATUS_NOT_FINISHED : TINYWOT_STATUS_SUCCESS;
+}
+
+static void tinywot_process_request_should_send_blocks(void) {
+  enum tinywot_status status = TINYWOT_STATUS_ERROR_GENERIC;
+  struct tinywot_thing *thing = tinywot_test_thing_new();
+  struct tinywot_form const form = {
+    .name = "log",
+    .target = "/log",
+    .op = TINYWOT_OPERATION_TYPE_READPROPERTY,
+    .handler = handler_property_log_read,
+    .context = NULL,
+  };
+
+  struct tinywot_request request = {0};
+  struct tinywot_response response = {0};
+  char received[sizeof(log_str)] = {0};
+  size_t received_byte = 0;
+  size_t blocks_n = 0;
+
+  unsigned char *content_out = tinywot_test_mallocd(
+    TINYWOT_TEST_SMALL_MEMORY_SIZE_BYTE
+  );
+
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_SUCCESS, tinywot_thing_add_form(thing, &form)
+  );
+
+  request.op = TINYWOT_OPERATION_TYPE_READPROPERTY;
+  memcpy(request.target, "/log", sizeof("/log"));
+
+  response.payload.content = content_out;
+  response.payload.content_buffer_size_byte =
+    TINYWOT_TEST_SMALL_MEMORY_SIZE_BYTE;
+
+  /* Pretend to be a protocol binding sending blocks. */
+  for (;;) {
+    status = tinywot_thing_process_request(thing, &response, &request);
+    TEST_ASSERT_EQUAL(TINYWOT_RESPONSE_STATUS_OK, response.status);
+    TEST_ASSERT_EQUAL_UINT(received_byte, response.offset_byte);
+
+    memcpy(
+      received + received_byte,
+      response.payload.content,
+      response.payload.content_length_byte
+    );
+    received_byte += response.payload.content_length_byte;
+    blocks_n += 1;
+
+    if (status != TINYWOT_STATUS_NOT_FINISHED) {
+      break;
+    }
+
+    tinywot_response_next_block(&response);
+    TEST_ASSERT_EQUAL_UINT(0U, response.payload.content_length_byte);
+  }
+
+  TEST_ASSERT_EQUAL(TINYWOT_STATUS_SUCCESS, status);
+  TEST_ASSERT_EQUAL_UINT(
+    (sizeof(log_str) - 1 + TINYWOT_TEST_SMALL_MEMORY_SIZE_BYTE - 1)
+      / TINYWOT_TEST_SMALL_MEMORY_SIZE_BYTE,
+    blocks_n
+  );
+  TEST_ASSERT_EQUAL_UINT(blocks_n, response.cursor);
+  TEST_ASSERT_EQUAL_STRING(log_str, received);
+
+  tinywot_test_free(content_out);
+  tinywot_test_thing_delete(thing);
+}
+
+void setUp(void) {}
+void tearDown(void) {}
+
+int main(void) {
+  UNITY_BEGIN();
+
+  RUN_TEST(tinywot_process_request_should_send_blocks);
+
+  return UNITY_END();
+}
@@ -0,0 +1,151 @@
+/*
+  SPDX-FileCopyrightText: 2023 Junde Yhi <junde@yhi.moe>
+  SPDX-License-Identifier: MIT
+*/
+
+/*!
+  \file
+  \brief Unit tests for `tinywot_thing_process_request()` with a
+  request body sent in fragments.
+*/
+
+#include <stddef.h>
+#include <string.h>
+#include <tinywot/core.h>
+#include <tinywot-test.h>
+#include <unity.h>
+
+static char const firmware[] = "0123456789abcdefghijklmnopqrstuvwxyz";
+
+/* Pretend to be flash memory. */
+static unsigned char flash[sizeof(firmware)];
+static size_t flash_written_byte;
+static bool flash_committed;
+
+static enum tinywot_status handler_action_update(
+  struct tinywot_payload *res,
+  struct tinywot_payload *req,
+  void *context
+) {
+  struct tinywot_request *request = tinywot_request_of_payload(req);
+
+  (void)res;
+  (void)context;
+
+  if (request->fragment == TINYWOT_REQUEST_FRAGMENT_BEGIN
+      || request->fragment == TINYWOT_REQUEST_FRAGMENT_NONE) {
+    flash_written_byte = 0;
+    flash_committed = false;
+  }
+
+  if (request->offset_byte != flash_written_byte
+      || flash_written_byte + req->content_length_byte > sizeof(flash)) {
+    return TINYWOT_STATUS_ERROR_GENERIC;
+  }
+
+  memcpy(flash + flash_written_byte, req->content, req->content_length_byte);
+  flash_written_byte += req->content_length_byte;
+
+  if (request->fragment == TINYWOT_REQUEST_FRAGMENT_END
+      || request->fragment == TINYWOT_REQUEST_FRAGMENT_NONE) {
+    flash_committed = true;
+  }
+
+  return TINYWOT_STATUS_SUCCESS;
+}
+
+static struct tinywot_form const form_update = {
+  .name = "update",
+  .target = "/update",
+  .op = TINYWOT_OPERATION_TYPE_INVOKEACTION,
+  .flags = TINYWOT_FORM_FLAG_STREAMING,
+  .handler = handler_action_update,
+  .context = NULL,
+};
+
+static void tinywot_process_request_should_feed_fragments(void) {
+  struct tinywot_thing *thing = tinywot_test_thing_new();
+  struct tinywot_request request = {0};
+  struct tinywot_response response = {0};
+  size_t const fragment_byte = 10;
+  size_t offset_byte = 0;
+
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_SUCCESS, tinywot_thing_add_form(thing, &form_update)
+  );
+
+  request.op = TINYWOT_OPERATION_TYPE_INVOKEACTION;
+  memcpy(request.target, "/update", sizeof("/update"));
+
+  /* Pretend to be a protocol binding receiving Block1 messages. */
+  while (offset_byte < sizeof(firmware)) {
+    size_t remaining_byte = sizeof(firmware) - offset_byte;
+    size_t length_byte =
+      remaining_byte < fragment_byte ? remaining_byte : fragment_byte;
+
+    request.payload.content = (void *)(firmware + offset_byte);
+    request.payload.content_length_byte = length_byte;
+    request.payload.content_buffer_size_byte = length_byte;
+    request.offset_byte = offset_byte;
+    request.fragment = offset_byte == 0 ?
+      TINYWOT_REQUEST_FRAGMENT_BEGIN :
+      (remaining_byte <= fragment_byte ?
+        TINYWOT_REQUEST_FRAGMENT_END : TINYWOT_REQUEST_FRAGMENT_CONTINUE);
+
+    TEST_ASSERT_EQUAL(
+      TINYWOT_STATUS_SUCCESS,
+      tinywot_thing_process_request(thing, &response, &request)
+    );
+    TEST_ASSERT_EQUAL(TINYWOT_RESPONSE_STATUS_OK, response.status);
+    TEST_ASSERT_EQUAL(
+      request.fragment == TINYWOT_REQUEST_FRAGMENT_END, flash_committed
+    );
+
+    offset_byte += length_byte;
+  }
+
+  TEST_ASSERT_EQUAL_UINT(sizeof(firmware), flash_written_byte);
+  TEST_ASSERT_EQUAL_MEMORY(firmware, flash, sizeof(firmware));
+
+  tinywot_test_thing_delete(thing);
+}
+
+static void tinywot_process_request_should_reject_fragments_when_not_streaming(
+  void
+) {
+  struct tinywot_thing *thing = tinywot_test_thing_new_example();
+  struct tinywot_request request = {0};
+  struct tinywot_response response = {0};
+  unsigned char *content_out = tinywot_test_mallocd(
+    TINYWOT_TEST_MEMORY_SIZE_BYTE
+  );
+
+  request.op = TINYWOT_OPERATION_TYPE_READPROPERTY;
+  request.fragment = TINYWOT_REQUEST_FRAGMENT_BEGIN;
+  memcpy(request.target, "/status", sizeof("/status"));
+
+  response.payload.content = content_out;
+  response.payload.content_buffer_size_byte = TINYWOT_TEST_MEMORY_SIZE_BYTE;
+
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_SUCCESS,
+    tinywot_thing_process_request(thing, &response, &request)
+  );
+  TEST_ASSERT_EQUAL(TINYWOT_RESPONSE_STATUS_NOT_SUPPORTED, response.status);
+  TEST_ASSERT_EQUAL_UINT(0U, response.payload.content_length_byte);
+
+  tinywot_test_free(content_out);
+  tinywot_test_thing_delete(thing);
+}
+
+void setUp(void) {}
+void tearDown(void) {}
+
+int main(void) {
+  UNITY_BEGIN();
+
+  RUN_TEST(tinywot_process_request_should_feed_fragments);
+  RUN_TEST(tinywot_process_request_should_reject_fragments_when_not_streaming);
+
+  return UNITY_END();
+}
@@ -0,0 +1,108 @@
+/*
+  SPDX-FileCopyrightText: 2023 Junde Yhi <junde@yhi.moe>
+  SPDX-License-Identifier: MIT
+*/
+
+/*!
+  \file
+  \brief Unit tests for `tinywot_thing_process_request()` with a handler
+  completing its response later.
+*/
+
+#include <stddef.h>
+#include <string.h>
+#include <tinywot/core.h>
+#include <tinywot-test.h>
+#include <unity.h>
+
+/* Keep the response as a token, as if a sensor reading was started. */
+static enum tinywot_status handler_property_humidity_read(
+  struct tinywot_payload *res,
+  struct tinywot_payload *req,
+  void *context
+) {
+  (void)req;
+
+  *(struct tinywot_response **)context = tinywot_response_of_payload(res);
+
+  return TINYWOT_STATUS_PENDING;
+}
+
+/* Count completions, as if a protocol binding was sending responses. */
+static void on_complete_counted(
+  struct tinywot_response *response, void *context
+) {
+  (void)response;
+
+  *(unsigned int *)context += 1;
+}
+
+static void tinywot_process_request_should_complete_later(void) {
+  enum tinywot_status status = TINYWOT_STATUS_ERROR_GENERIC;
+  struct tinywot_thing *thing = tinywot_test_thing_new();
+  struct tinywot_response *token = NULL;
+  unsigned int completions_n = 0;
+  struct tinywot_form const form = {
+    .name = "humidity",
+    .target = "/humidity",
+    .op = TINYWOT_OPERATION_TYPE_READPROPERTY,
+    .handler = handler_property_humidity_read,
+    .context = &token,
+  };
+
+  struct tinywot_request request = {0};
+  struct tinywot_response response = {0};
+
+  unsigned char *content_out = tinywot_test_mallocd(
+    TINYWOT_TEST_SMALL_MEMORY_SIZE_BYTE
+  );
+
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_SUCCESS, tinywot_thing_add_form(thing, &form)
+  );
+
+  request.op = TINYWOT_OPERATION_TYPE_READPROPERTY;
+  memcpy(request.target, "/humidity", sizeof("/humidity"));
+
+  response.payload.content = content_out;
+  response.payload.content_buffer_size_byte =
+    TINYWOT_TEST_SMALL_MEMORY_SIZE_BYTE;
+  response.on_complete = on_complete_counted;
+  response.on_complete_context = &completions_n;
+
+  status = tinywot_thing_process_request(thing, &response, &request);
+  TEST_ASSERT_EQUAL(TINYWOT_STATUS_PENDING, status);
+  TEST_ASSERT_EQUAL(TINYWOT_RESPONSE_STATUS_PENDING, response.status);
+  TEST_ASSERT_EQUAL_PTR(&response, token);
+  TEST_ASSERT_EQUAL_UINT(0U, completions_n);
+
+  /* The sensor has answered. */
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_SUCCESS,
+    tinywot_payload_append_string(&token->payload, "42")
+  );
+  tinywot_response_complete(token, TINYWOT_STATUS_SUCCESS);
+
+  TEST_ASSERT_EQUAL(TINYWOT_RESPONSE_STATUS_OK, response.status);
+  TEST_ASSERT_EQUAL_UINT(1U, completions_n);
+  TEST_ASSERT_EQUAL_STRING("42", response.payload.content);
+
+  /* An error can be completed as well. */
+  tinywot_response_complete(token, TINYWOT_STATUS_ERROR_GENERIC);
+  TEST_ASSERT_EQUAL(TINYWOT_RESPONSE_STATUS_INTERNAL_ERROR, response.status);
+  TEST_ASSERT_EQUAL_UINT(2U, completions_n);
+
+  tinywot_test_free(content_out);
+  tinywot_test_thing_delete(thing);
+}
+
+void setUp(void) {}
+void tearDown(void) {}
+
+int main(void) {
+  UNITY_BEGIN();
+
+  RUN_TEST(tinywot_process_request_should_complete_later);
+
+  return UNITY_END();
+}
@@ -0,0 +1,195 @@
+/*
+  SPDX-FileCopyrightText: 2023 Junde Yhi <junde@yhi.moe>
+  SPDX-License-Identifier: MIT
+*/
+
+/*!
+  \file
+  \brief Unit tests for `tinywot_thing_process_request()` with
+  `tinywot_request::target_view`.
+*/
+
+#include <stddef.h>
+#include <string.h>
+#include <tinywot/core.h>
+#include <tinywot-test.h>
+#include <unity.h>
+
+/* Pretend that this is the receive buffer of a protocol binding. The
+   target is followed by more data instead of a NUL. */
+static char const received[] = "/status/lights/42?brightness=1";
+
+static enum tinywot_status handler_light_read(
+  struct tinywot_payload *res, struct tinywot_payload *req, void *context
+) {
+  struct tinywot_request *request = tinywot_request_of_payload(req);
+
+  (void)context;
+
+  /* Echo the captured ID. */
+  return tinywot_payload_append(
+    res, request->params[0].value, request->params[0].value_length_byte
+  );
+}
+
+static struct tinywot_thing *thing;
+static struct tinywot_request request;
+static struct tinywot_response response;
+static unsigned char *content_out;
+
+static void process(
+  size_t offset_byte,
+  size_t length_byte,
+  enum tinywot_operation_type op,
+  enum tinywot_response_status expected
+) {
+  request.target_view = received + offset_byte;
+  request.target_view_length_byte = length_byte;
+  request.op = op;
+
+  memset(&response, 0, sizeof(response));
+  response.payload.content = content_out;
+  response.payload.content_buffer_size_byte = TINYWOT_TEST_MEMORY_SIZE_BYTE;
+
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_SUCCESS,
+    tinywot_thing_process_request(thing, &response, &request)
+  );
+  TEST_ASSERT_EQUAL(expected, response.status);
+}
+
+static void check_status_forms(void) {
+  /* "/status" */
+  process(
+    0, 7, TINYWOT_OPERATION_TYPE_READPROPERTY, TINYWOT_RESPONSE_STATUS_OK
+  );
+  TEST_ASSERT_EQUAL_STRING("false", response.payload.content);
+
+  process(
+    0,
+    7,
+    TINYWOT_OPERATION_TYPE_INVOKEACTION,
+    TINYWOT_RESPONSE_STATUS_NOT_ALLOWED
+  );
+
+  /* Neither a prefix nor a longer target matches. */
+  process(
+    0, 5, TINYWOT_OPERATION_TYPE_READPROPERTY, TINYWOT_RESPONSE_STATUS_NOT_FOUND
+  );
+  process(
+    0, 8, TINYWOT_OPERATION_TYPE_READPROPERTY, TINYWOT_RESPONSE_STATUS_NOT_FOUND
+  );
+}
+
+static void tinywot_process_request_target_view_should_succeed(void) {
+  /* The buffer of the request is never looked at. */
+  strcpy(request.target, "/toggle");
+
+  check_status_forms();
+}
+
+static void tinywot_process_request_target_view_should_use_index(void) {
+  size_t memory_size_byte = thing->forms_max_n * sizeof(size_t);
+  void *memory = tinywot_test_malloc0(memory_size_byte);
+
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_SUCCESS,
+    tinywot_thing_init_index(thing, memory, memory_size_byte)
+  );
+
+  check_status_forms();
+
+  thing->forms_index = NULL;
+  tinywot_test_free(memory);
+}
+
+static void tinywot_process_request_target_view_should_use_router(void) {
+  static struct tinywot_router_node nodes[8];
+  struct tinywot_router router = {0};
+  struct tinywot_form form = {0};
+
+  form.name = "light";
+  form.target = "/lights/{id}";
+  form.op = TINYWOT_OPERATION_TYPE_READPROPERTY;
+  form.handler = handler_light_read;
+
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_SUCCESS, tinywot_thing_remove_form(
+      thing, "/oh", TINYWOT_OPERATION_TYPE_UNSUBSCRIBEEVENT
+    )
+  );
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_SUCCESS, tinywot_thing_add_form(thing, &form)
+  );
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_SUCCESS, tinywot_router_init(&router, nodes, sizeof(nodes))
+  );
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_SUCCESS, tinywot_thing_init_router(thing, &router)
+  );
+
+  /* "/lights/42" */
+  process(
+    7, 10, TINYWOT_OPERATION_TYPE_READPROPERTY, TINYWOT_RESPONSE_STATUS_OK
+  );
+  TEST_ASSERT_EQUAL_UINT(1U, request.params_count_n);
+  TEST_ASSERT_EQUAL_PTR(received + 15, request.params[0].value);
+  TEST_ASSERT_EQUAL_UINT(2U, request.params[0].value_length_byte);
+  TEST_ASSERT_EQUAL_UINT(2U, response.payload.content_length_byte);
+
+  /* "/lights/4" */
+  process(
+    7, 9, TINYWOT_OPERATION_TYPE_READPROPERTY, TINYWOT_RESPONSE_STATUS_OK
+  );
+  TEST_ASSERT_EQUAL_UINT(1U, request.params[0].value_length_byte);
+
+  /* "/lights" */
+  process(
+    7, 7, TINYWOT_OPERATION_TYPE_READPROPERTY, TINYWOT_RESPONSE_STATUS_NOT_FOUND
+  );
+
+  check_status_forms();
+
+  thing->router = NULL;
+}
+
+static void tinywot_thing_find_form_n_should_succeed(void) {
+  struct tinywot_form *form = NULL;
+
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_SUCCESS,
+    tinywot_thing_find_form_n(
+      thing, &form, "/togglexyz", 7, TINYWOT_OPERATION_TYPE_INVOKEACTION
+    )
+  );
+  TEST_ASSERT_EQUAL_STRING("/toggle", form->target);
+
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_ERROR_NOT_FOUND,
+    tinywot_thing_find_form_n(
+      thing, &form, "/toggle", 0, TINYWOT_OPERATION_TYPE_INVOKEACTION
+    )
+  );
+}
+
+void setUp(void) {
+  thing = tinywot_test_thing_new_example();
+  content_out = tinywot_test_mallocd(TINYWOT_TEST_MEMORY_SIZE_BYTE);
+  memset(&request, 0, sizeof(request));
+}
+
+void tearDown(void) {
+  tinywot_test_free(content_out);
+  tinywot_test_thing_delete(thing);
+}
+
+int main(void) {
+  UNITY_BEGIN();
+
+  RUN_TEST(tinywot_process_request_target_view_should_succeed);
+  RUN_TEST(tinywot_process_request_target_view_should_use_index);
+  RUN_TEST(tinywot_process_request_target_view_should_use_router);
+  RUN_TEST(tinywot_thing_find_form_n_should_succeed);
+
+  return UNITY_END();
+}
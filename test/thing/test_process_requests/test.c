@@ -0,0 +1,118 @@
+/*
+  SPDX-FileCopyrightText: 2023 Junde Yhi <junde@yhi.moe>
+  SPDX-License-Identifier: MIT
+*/
+
+/*!
+  \file
+  \brief Unit tests for `tinywot_thing_process_requests()`.
+*/
+
+#include <stddef.h>
+#include <string.h>
+#include <tinywot/core.h>
+#include <tinywot-test.h>
+#include <unity.h>
+
+/* Which handlers have been called, in order. */
+static char calls[16];
+static size_t calls_n;
+
+/* Log the character in context. */
+static enum tinywot_status handler_log(
+  struct tinywot_payload *res, struct tinywot_payload *req, void *context
+) {
+  (void)res;
+  (void)req;
+
+  calls[calls_n++] = *(char const *)context;
+
+  return TINYWOT_STATUS_SUCCESS;
+}
+
+static struct tinywot_form const forms[] = {
+  {
+    .name = "a",
+    .target = "/a",
+    .op = TINYWOT_OPERATION_TYPE_READPROPERTY,
+    .handler = handler_log,
+    .context = "a",
+  },
+  {
+    .name = "a",
+    .target = "/a",
+    .op = TINYWOT_OPERATION_TYPE_WRITEPROPERTY,
+    .handler = handler_log,
+    .context = "A",
+  },
+  {
+    .name = "b",
+    .target = "/b",
+    .op = TINYWOT_OPERATION_TYPE_READPROPERTY,
+    .handler = handler_log,
+    .context = "b",
+  },
+};
+
+static void set_request(
+  struct tinywot_request *request,
+  char const *target,
+  enum tinywot_operation_type op
+) {
+  memset(request, 0, sizeof(*request));
+  request->op = op;
+  memcpy(request->target, target, strlen(target) + 1);
+}
+
+static void tinywot_thing_process_requests_should_keep_order_per_target(
+  void
+) {
+  struct tinywot_thing thing;
+  struct tinywot_request requests[6];
+  struct tinywot_response responses[6];
+  enum tinywot_status statuses[6];
+
+  tinywot_thing_init_static(&thing, forms, sizeof(forms));
+  memset(responses, 0, sizeof(responses));
+
+  set_request(&requests[0], "/a", TINYWOT_OPERATION_TYPE_READPROPERTY);
+  set_request(&requests[1], "/b", TINYWOT_OPERATION_TYPE_READPROPERTY);
+  set_request(&requests[2], "/a", TINYWOT_OPERATION_TYPE_WRITEPROPERTY);
+  set_request(&requests[3], "/a", TINYWOT_OPERATION_TYPE_READPROPERTY);
+  set_request(&requests[4], "/b", TINYWOT_OPERATION_TYPE_READPROPERTY);
+  set_request(&requests[5], "/x", TINYWOT_OPERATION_TYPE_READPROPERTY);
+
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_SUCCESS,
+    tinywot_thing_process_requests(
+      &thing, responses, requests, 6, statuses
+    )
+  );
+
+  /* both reads of /b are grouped, but the write of /a stays between the
+     reads of /a */
+  TEST_ASSERT_EQUAL_UINT(5U, calls_n);
+  TEST_ASSERT_EQUAL_MEMORY("abbAa", calls, 5);
+
+  for (size_t i = 0; i < 5; i++) {
+    TEST_ASSERT_EQUAL(TINYWOT_STATUS_SUCCESS, statuses[i]);
+    TEST_ASSERT_EQUAL(TINYWOT_RESPONSE_STATUS_OK, responses[i].status);
+  }
+
+  TEST_ASSERT_EQUAL(TINYWOT_STATUS_ERROR_NOT_FOUND, statuses[5]);
+  TEST_ASSERT_EQUAL(TINYWOT_RESPONSE_STATUS_NOT_FOUND, responses[5].status);
+}
+
+void setUp(void) {
+  calls_n = 0;
+}
+
+void tearDown(void) {}
+
+int main(void) {
+  UNITY_BEGIN();
+
+  RUN_TEST(tinywot_thing_process_requests_should_keep_order_per_target);
+
+  return UNITY_END();
+}
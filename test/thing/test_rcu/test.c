@@ -0,0 +1,186 @@
+/*
+  SPDX-FileCopyrightText: 2023 Junde Yhi <junde@yhi.moe>
+  SPDX-License-Identifier: MIT
+*/
+
+/*!
+  \file
+  \brief Unit tests for `tinywot_thing_rcu`.
+*/
+
+#include <stddef.h>
+#include <string.h>
+#include <tinywot/core.h>
+#include <tinywot-test.h>
+#include <unity.h>
+
+tinywot_form_handler_t handler_property_status_read;
+
+static struct tinywot_form const form_status = {
+  .name = "status",
+  .target = "/status",
+  .op = TINYWOT_OPERATION_TYPE_READPROPERTY,
+  .handler = handler_property_status_read,
+  .context = NULL,
+};
+
+static enum tinywot_response_status process_status_read(
+  struct tinywot_thing_rcu *rcu
+) {
+  struct tinywot_request request = {0};
+  struct tinywot_response response = {0};
+
+  request.op = TINYWOT_OPERATION_TYPE_READPROPERTY;
+  memcpy(request.target, "/status", sizeof("/status"));
+
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_SUCCESS,
+    tinywot_thing_rcu_process_request(rcu, &response, &request)
+  );
+
+  return response.status;
+}
+
+static void tinywot_thing_rcu_should_publish_updates(void) {
+  struct tinywot_thing_rcu rcu = {0};
+  struct tinywot_thing *thing = NULL;
+  struct tinywot_form form = form_status;
+  void *memory = tinywot_test_mallocd(TINYWOT_TEST_MEMORY_SIZE_BYTE);
+
+  tinywot_thing_rcu_init(&rcu, memory, TINYWOT_TEST_MEMORY_SIZE_BYTE);
+  TEST_ASSERT_EQUAL(
+    TINYWOT_RESPONSE_STATUS_NOT_FOUND, process_status_read(&rcu)
+  );
+
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_SUCCESS, tinywot_thing_rcu_update_begin(&rcu, &thing)
+  );
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_SUCCESS, tinywot_thing_add_form(thing, &form_status)
+  );
+
+  /* Nothing is visible before publishing. */
+  TEST_ASSERT_EQUAL(
+    TINYWOT_RESPONSE_STATUS_NOT_FOUND, process_status_read(&rcu)
+  );
+
+  tinywot_thing_rcu_update_publish(&rcu);
+  TEST_ASSERT_EQUAL(TINYWOT_RESPONSE_STATUS_OK, process_status_read(&rcu));
+
+  /* The next update starts from the published forms. */
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_SUCCESS, tinywot_thing_rcu_update_begin(&rcu, &thing)
+  );
+  TEST_ASSERT_EQUAL_size_t(1U, thing->forms_count_n);
+
+  form.handler = NULL;
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_SUCCESS,
+    tinywot_thing_change_form(
+      thing, "/status", TINYWOT_OPERATION_TYPE_READPROPERTY, &form
+    )
+  );
+  TEST_ASSERT_EQUAL(TINYWOT_RESPONSE_STATUS_OK, process_status_read(&rcu));
+
+  tinywot_thing_rcu_update_publish(&rcu);
+  TEST_ASSERT_EQUAL(
+    TINYWOT_RESPONSE_STATUS_NOT_SUPPORTED, process_status_read(&rcu)
+  );
+
+  tinywot_test_free(memory);
+}
+
+static void tinywot_thing_rcu_should_keep_versions_being_read(void) {
+  struct tinywot_thing_rcu rcu = {0};
+  struct tinywot_thing *thing = NULL;
+  struct tinywot_thing const *reader = NULL;
+  struct tinywot_form *form = NULL;
+  void *memory = tinywot_test_mallocd(TINYWOT_TEST_MEMORY_SIZE_BYTE);
+
+  tinywot_thing_rcu_init(&rcu, memory, TINYWOT_TEST_MEMORY_SIZE_BYTE);
+
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_SUCCESS, tinywot_thing_rcu_update_begin(&rcu, &thing)
+  );
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_SUCCESS, tinywot_thing_add_form(thing, &form_status)
+  );
+  tinywot_thing_rcu_update_publish(&rcu);
+
+  reader = tinywot_thing_rcu_read_lock(&rcu);
+
+  /* The reader is on the current version, so one update can go on. */
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_SUCCESS, tinywot_thing_rcu_update_begin(&rcu, &thing)
+  );
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_SUCCESS,
+    tinywot_thing_remove_form(
+      thing, "/status", TINYWOT_OPERATION_TYPE_READPROPERTY
+    )
+  );
+  tinywot_thing_rcu_update_publish(&rcu);
+
+  /* The reader still sees its version... */
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_SUCCESS,
+    tinywot_thing_find_form(
+      reader, &form, "/status", TINYWOT_OPERATION_TYPE_READPROPERTY
+    )
+  );
+  TEST_ASSERT_EQUAL(
+    TINYWOT_RESPONSE_STATUS_NOT_FOUND, process_status_read(&rcu)
+  );
+
+  /* ...so it cannot be reused until the reader leaves. */
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_NOT_FINISHED, tinywot_thing_rcu_update_begin(&rcu, &thing)
+  );
+
+  tinywot_thing_rcu_read_unlock(&rcu, reader);
+
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_SUCCESS, tinywot_thing_rcu_update_begin(&rcu, &thing)
+  );
+
+  tinywot_test_free(memory);
+}
+
+static void tinywot_thing_rcu_should_not_copy_extensions(void) {
+  struct tinywot_thing_rcu rcu = {0};
+  struct tinywot_thing *thing = NULL;
+  size_t index_size_byte = 0;
+  void *index = NULL;
+  void *memory = tinywot_test_mallocd(TINYWOT_TEST_MEMORY_SIZE_BYTE);
+
+  tinywot_thing_rcu_init(&rcu, memory, TINYWOT_TEST_MEMORY_SIZE_BYTE);
+  index_size_byte = TINYWOT_THING_INDEX_SIZE_BYTE(rcu.versions[1].forms_max_n);
+  index = tinywot_test_mallocd(index_size_byte);
+
+  /* The index would not follow the forms copied into the version. */
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_SUCCESS,
+    tinywot_thing_init_index(&rcu.versions[1], index, index_size_byte)
+  );
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_ERROR_NOT_ALLOWED,
+    tinywot_thing_rcu_update_begin(&rcu, &thing)
+  );
+  TEST_ASSERT_NULL(thing);
+
+  tinywot_test_free(index);
+  tinywot_test_free(memory);
+}
+
+void setUp(void) {}
+void tearDown(void) {}
+
+int main(void) {
+  UNITY_BEGIN();
+
+  RUN_TEST(tinywot_thing_rcu_should_publish_updates);
+  RUN_TEST(tinywot_thing_rcu_should_keep_versions_being_read);
+  RUN_TEST(tinywot_thing_rcu_should_not_copy_extensions);
+
+  return UNITY_END();
+}
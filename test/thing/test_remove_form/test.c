@@ -0,0 +1,187 @@
+/*
+  SPDX-FileCopyrightText: 2023 Junde Yhi <junde@yhi.moe>
+  SPDX-License-Identifier: MIT
+*/
+
+/*!
+  \file
+  \brief Unit tests for `tinywot_thing_remove_form()` and
+  `tinywot_thing_compact_forms()`.
+*/
+
+#include <stddef.h>
+#include <string.h>
+#include <tinywot/core.h>
+#include <tinywot-test.h>
+#include <unity.h>
+
+static struct tinywot_form const form_toggle_invoke = {
+  .name = "toggle",
+  .target = "/toggle",
+  .op = TINYWOT_OPERATION_TYPE_INVOKEACTION,
+  .handler = NULL,
+  .context = NULL,
+};
+
+static void tinywot_thing_remove_form_should_succeed(void) {
+  enum tinywot_status status = TINYWOT_STATUS_ERROR_GENERIC;
+  struct tinywot_thing *thing = tinywot_test_thing_new_example();
+  struct tinywot_form *form = NULL;
+
+  status = tinywot_thing_remove_form(
+    thing, "/status", TINYWOT_OPERATION_TYPE_READPROPERTY
+  );
+  TEST_ASSERT_EQUAL(TINYWOT_STATUS_SUCCESS, status);
+  TEST_ASSERT_EQUAL_UINT(1, thing->forms_removed_n);
+
+  status = tinywot_thing_find_form(
+    thing, &form, "/status", TINYWOT_OPERATION_TYPE_READPROPERTY
+  );
+  TEST_ASSERT_EQUAL(TINYWOT_STATUS_ERROR_NOT_ALLOWED, status);
+  TEST_ASSERT_NULL(form);
+
+  status = tinywot_thing_remove_form(
+    thing, "/status", TINYWOT_OPERATION_TYPE_WRITEPROPERTY
+  );
+  TEST_ASSERT_EQUAL(TINYWOT_STATUS_SUCCESS, status);
+
+  /* Removed forms must not count as a target match either. */
+  status = tinywot_thing_find_form(
+    thing, &form, "/status", TINYWOT_OPERATION_TYPE_READPROPERTY
+  );
+  TEST_ASSERT_EQUAL(TINYWOT_STATUS_ERROR_NOT_FOUND, status);
+  TEST_ASSERT_NULL(form);
+
+  /* Neither can they be removed twice. */
+  status = tinywot_thing_remove_form(
+    thing, "/status", TINYWOT_OPERATION_TYPE_WRITEPROPERTY
+  );
+  TEST_ASSERT_EQUAL(TINYWOT_STATUS_ERROR_NOT_FOUND, status);
+  TEST_ASSERT_EQUAL_UINT(2, thing->forms_removed_n);
+
+  tinywot_test_thing_delete(thing);
+}
+
+static void tinywot_thing_remove_form_should_reenable_overridden_form(
+  void
+) {
+  enum tinywot_status status = TINYWOT_STATUS_ERROR_GENERIC;
+  struct tinywot_thing *thing = tinywot_test_thing_new();
+  size_t size = TINYWOT_THING_INDEX_SIZE_BYTE(thing->forms_max_n);
+  void *memory = tinywot_test_mallocd(size);
+  struct tinywot_form *form = NULL;
+
+  (void)tinywot_thing_init_index(thing, memory, size);
+  (void)tinywot_thing_add_form(thing, &form_toggle_invoke);
+  (void)tinywot_thing_add_form(thing, &form_toggle_invoke);
+
+  status = tinywot_thing_remove_form(
+    thing, "/toggle", TINYWOT_OPERATION_TYPE_INVOKEACTION
+  );
+  TEST_ASSERT_EQUAL(TINYWOT_STATUS_SUCCESS, status);
+
+  status = tinywot_thing_find_form(
+    thing, &form, "/toggle", TINYWOT_OPERATION_TYPE_INVOKEACTION
+  );
+  TEST_ASSERT_EQUAL(TINYWOT_STATUS_SUCCESS, status);
+  TEST_ASSERT_EQUAL_PTR(&thing->forms[0], form);
+
+  tinywot_test_free(memory);
+  tinywot_test_thing_delete(thing);
+}
+
+static void tinywot_thing_remove_form_should_fail_when_static(void) {
+  enum tinywot_status status = TINYWOT_STATUS_ERROR_GENERIC;
+  struct tinywot_thing thing = {0};
+
+  tinywot_thing_init_static(
+    &thing, &form_toggle_invoke, sizeof(form_toggle_invoke)
+  );
+
+  status = tinywot_thing_remove_form(
+    &thing, "/toggle", TINYWOT_OPERATION_TYPE_INVOKEACTION
+  );
+  TEST_ASSERT_EQUAL(TINYWOT_STATUS_ERROR_NOT_ALLOWED, status);
+}
+
+static void tinywot_thing_compact_forms_should_succeed(void) {
+  enum tinywot_status status = TINYWOT_STATUS_ERROR_GENERIC;
+  struct tinywot_thing *thing = tinywot_test_thing_new_example();
+  size_t size = TINYWOT_THING_INDEX_SIZE_BYTE(thing->forms_max_n);
+  void *memory = tinywot_test_mallocd(size);
+  struct tinywot_form *form = NULL;
+
+  (void)tinywot_thing_init_index(thing, memory, size);
+
+  (void)tinywot_thing_remove_form(
+    thing, "/status", TINYWOT_OPERATION_TYPE_READPROPERTY
+  );
+  (void)tinywot_thing_remove_form(
+    thing, "/oh", TINYWOT_OPERATION_TYPE_SUBSCRIBEEVENT
+  );
+
+  tinywot_thing_compact_forms(thing);
+  TEST_ASSERT_EQUAL_UINT(3, thing->forms_count_n);
+  TEST_ASSERT_EQUAL_UINT(0, thing->forms_removed_n);
+
+  status = tinywot_thing_find_form(
+    thing, &form, "/oh", TINYWOT_OPERATION_TYPE_UNSUBSCRIBEEVENT
+  );
+  TEST_ASSERT_EQUAL(TINYWOT_STATUS_SUCCESS, status);
+  TEST_ASSERT_EQUAL_PTR(&thing->forms[2], form);
+
+  /* The (full) example Thing can take 2 more forms now. */
+  status = tinywot_thing_add_form(thing, &form_toggle_invoke);
+  TEST_ASSERT_EQUAL(TINYWOT_STATUS_SUCCESS, status);
+  status = tinywot_thing_add_form(thing, &form_toggle_invoke);
+  TEST_ASSERT_EQUAL(TINYWOT_STATUS_SUCCESS, status);
+  status = tinywot_thing_add_form(thing, &form_toggle_invoke);
+  TEST_ASSERT_EQUAL(TINYWOT_STATUS_ERROR_NOT_ENOUGH_MEMORY, status);
+
+  status = tinywot_thing_find_form(
+    thing, &form, "/toggle", TINYWOT_OPERATION_TYPE_INVOKEACTION
+  );
+  TEST_ASSERT_EQUAL(TINYWOT_STATUS_SUCCESS, status);
+  TEST_ASSERT_EQUAL_PTR(&thing->forms[4], form);
+
+  tinywot_test_free(memory);
+  tinywot_test_thing_delete(thing);
+}
+
+static void tinywot_thing_add_form_should_compact_when_full(void) {
+  enum tinywot_status status = TINYWOT_STATUS_ERROR_GENERIC;
+  struct tinywot_thing *thing = tinywot_test_thing_new_example();
+  struct tinywot_form *form = NULL;
+
+  (void)tinywot_thing_remove_form(
+    thing, "/status", TINYWOT_OPERATION_TYPE_READPROPERTY
+  );
+
+  status = tinywot_thing_add_form(thing, &form_toggle_invoke);
+  TEST_ASSERT_EQUAL(TINYWOT_STATUS_SUCCESS, status);
+  TEST_ASSERT_EQUAL_UINT(0, thing->forms_removed_n);
+  TEST_ASSERT_EQUAL_UINT(thing->forms_max_n, thing->forms_count_n);
+
+  status = tinywot_thing_find_form(
+    thing, &form, "/status", TINYWOT_OPERATION_TYPE_WRITEPROPERTY
+  );
+  TEST_ASSERT_EQUAL(TINYWOT_STATUS_SUCCESS, status);
+  TEST_ASSERT_EQUAL_PTR(&thing->forms[0], form);
+
+  tinywot_test_thing_delete(thing);
+}
+
+void setUp(void) {}
+void tearDown(void) {}
+
+int main(void) {
+  UNITY_BEGIN();
+
+  RUN_TEST(tinywot_thing_remove_form_should_succeed);
+  RUN_TEST(tinywot_thing_remove_form_should_reenable_overridden_form);
+  RUN_TEST(tinywot_thing_remove_form_should_fail_when_static);
+  RUN_TEST(tinywot_thing_compact_forms_should_succeed);
+  RUN_TEST(tinywot_thing_add_form_should_compact_when_full);
+
+  return UNITY_END();
+}
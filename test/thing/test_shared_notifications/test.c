@@ -0,0 +1,254 @@
+/*
+  SPDX-FileCopyrightText: 2023 Junde Yhi <junde@yhi.moe>
+  SPDX-License-Identifier: MIT
+*/
+
+/*!
+  \file
+  \brief Unit tests for notifications shared among observers with
+  `tinywot_response_pool`.
+*/
+
+#include <stddef.h>
+#include <string.h>
+#include <tinywot/core.h>
+#include <tinywot-test.h>
+#include <unity.h>
+
+/* Count the notifications prepared. */
+static unsigned int reads_n;
+
+static enum tinywot_status handler_status_read(
+  struct tinywot_payload *res, struct tinywot_payload *req, void *context
+) {
+  (void)req;
+  (void)context;
+
+  reads_n += 1;
+
+  return tinywot_payload_append(res, "false", 5);
+}
+
+static struct tinywot_form const forms[] = {
+  {
+    .name = "status",
+    .target = "/status",
+    .op = TINYWOT_OPERATION_TYPE_READPROPERTY,
+    .handler = handler_status_read,
+  },
+  {
+    .name = "status",
+    .target = "/status",
+    .op = TINYWOT_OPERATION_TYPE_OBSERVEPROPERTY,
+  },
+  {
+    .name = "overheating",
+    .target = "/oh",
+    .op = TINYWOT_OPERATION_TYPE_SUBSCRIBEEVENT,
+  },
+};
+
+static struct tinywot_thing thing;
+static struct tinywot_observer observers[5];
+static struct tinywot_shared_response responses[2];
+static unsigned char buffers[2 * TINYWOT_TEST_SMALL_MEMORY_SIZE_BYTE];
+static struct tinywot_response_pool pool;
+
+static void observe(
+  char const *origin, char const *target, enum tinywot_operation_type op
+) {
+  struct tinywot_request request = {0};
+  struct tinywot_response response = {0};
+
+  request.op = op;
+  request.origin = (unsigned char const *)origin;
+  request.origin_length_byte = strlen(origin);
+  strcpy(request.target, target);
+
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_SUCCESS,
+    tinywot_thing_process_request(&thing, &response, &request)
+  );
+  TEST_ASSERT_EQUAL(TINYWOT_RESPONSE_STATUS_OK, response.status);
+}
+
+static void tinywot_response_pool_should_share_responses(void) {
+  struct tinywot_shared_response *a = NULL;
+  struct tinywot_shared_response *b = NULL;
+  struct tinywot_shared_response *c = NULL;
+
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_SUCCESS, tinywot_response_pool_acquire(&pool, &a)
+  );
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_SUCCESS, tinywot_response_pool_acquire(&pool, &b)
+  );
+  TEST_ASSERT_TRUE(a != b);
+  TEST_ASSERT_EQUAL_UINT(
+    TINYWOT_TEST_SMALL_MEMORY_SIZE_BYTE,
+    b->response.payload.content_buffer_size_byte
+  );
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_ERROR_NOT_ENOUGH_MEMORY,
+    tinywot_response_pool_acquire(&pool, &c)
+  );
+
+  tinywot_shared_response_retain(a);
+  tinywot_shared_response_release(a);
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_ERROR_NOT_ENOUGH_MEMORY,
+    tinywot_response_pool_acquire(&pool, &c)
+  );
+
+  /* The last reference gives it back, emptied. */
+  a->response.payload.content_length_byte = 3;
+  tinywot_shared_response_release(a);
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_SUCCESS, tinywot_response_pool_acquire(&pool, &c)
+  );
+  TEST_ASSERT_EQUAL_PTR(a, c);
+  TEST_ASSERT_EQUAL_UINT(0U, c->response.payload.content_length_byte);
+  TEST_ASSERT_EQUAL_UINT(1U, c->references_n);
+
+  /* A release too many is ignored. */
+  tinywot_shared_response_release(c);
+  tinywot_shared_response_release(c);
+  TEST_ASSERT_EQUAL_UINT(0U, c->references_n);
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_SUCCESS, tinywot_response_pool_acquire(&pool, &c)
+  );
+  TEST_ASSERT_EQUAL_PTR(a, c);
+}
+
+static void tinywot_thing_should_prepare_shared_notification(void) {
+  struct tinywot_observer *taken[4] = {NULL};
+  struct tinywot_shared_response *response = NULL;
+  size_t taken_n = 0;
+
+  observe("alice", "/status", TINYWOT_OPERATION_TYPE_OBSERVEPROPERTY);
+  observe("bob", "/oh", TINYWOT_OPERATION_TYPE_SUBSCRIBEEVENT);
+  observe("carol", "/status", TINYWOT_OPERATION_TYPE_OBSERVEPROPERTY);
+  observe("dave", "/status", TINYWOT_OPERATION_TYPE_OBSERVEPROPERTY);
+
+  TEST_ASSERT_EQUAL_UINT(3U, tinywot_thing_mark_dirty(&thing, "/status"));
+  TEST_ASSERT_EQUAL_UINT(1U, tinywot_thing_mark_dirty(&thing, "/oh"));
+
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_SUCCESS,
+    tinywot_thing_process_shared_notification(
+      &thing, &pool, taken, 4, &taken_n, &response
+    )
+  );
+
+  /* One read for three observers. */
+  TEST_ASSERT_EQUAL_UINT(1U, reads_n);
+  TEST_ASSERT_EQUAL_UINT(3U, taken_n);
+  TEST_ASSERT_EQUAL_MEMORY("alice", taken[0]->origin, 5);
+  TEST_ASSERT_EQUAL_MEMORY("carol", taken[1]->origin, 5);
+  TEST_ASSERT_EQUAL_MEMORY("dave", taken[2]->origin, 4);
+  TEST_ASSERT_EQUAL_UINT(3U, response->references_n);
+  TEST_ASSERT_EQUAL_UINT(5U, response->response.payload.content_length_byte);
+  TEST_ASSERT_EQUAL_MEMORY("false", response->response.payload.content, 5);
+
+  for (size_t i = 0; i < taken_n; i++) {
+    tinywot_shared_response_release(response);
+  }
+
+  TEST_ASSERT_EQUAL_UINT(0U, response->references_n);
+
+  /* Then bob. */
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_SUCCESS,
+    tinywot_thing_process_shared_notification(
+      &thing, &pool, taken, 4, &taken_n, &response
+    )
+  );
+  TEST_ASSERT_EQUAL_UINT(1U, taken_n);
+  TEST_ASSERT_EQUAL_MEMORY("bob", taken[0]->origin, 3);
+  TEST_ASSERT_EQUAL_UINT(0U, response->response.payload.content_length_byte);
+  tinywot_shared_response_release(response);
+
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_ERROR_NOT_FOUND,
+    tinywot_thing_process_shared_notification(
+      &thing, &pool, taken, 4, &taken_n, &response
+    )
+  );
+  TEST_ASSERT_EQUAL_UINT(0U, taken_n);
+}
+
+static void tinywot_thing_take_notifications_should_leave_the_rest(void) {
+  struct tinywot_observer *taken[2] = {NULL};
+
+  observe("alice", "/status", TINYWOT_OPERATION_TYPE_OBSERVEPROPERTY);
+  observe("carol", "/status", TINYWOT_OPERATION_TYPE_OBSERVEPROPERTY);
+  observe("dave", "/status", TINYWOT_OPERATION_TYPE_OBSERVEPROPERTY);
+  TEST_ASSERT_EQUAL_UINT(3U, tinywot_thing_mark_dirty(&thing, "/status"));
+
+  TEST_ASSERT_EQUAL_UINT(
+    2U, tinywot_thing_take_notifications(&thing, taken, 2)
+  );
+  TEST_ASSERT_EQUAL_UINT(
+    1U, tinywot_thing_take_notifications(&thing, taken, 2)
+  );
+  TEST_ASSERT_EQUAL_MEMORY("dave", taken[0]->origin, 4);
+  TEST_ASSERT_EQUAL_UINT(
+    0U, tinywot_thing_take_notifications(&thing, taken, 2)
+  );
+}
+
+static void tinywot_thing_should_keep_dirty_when_pool_is_empty(void) {
+  struct tinywot_observer *taken[4] = {NULL};
+  struct tinywot_shared_response *held[2] = {NULL};
+  struct tinywot_shared_response *response = NULL;
+  size_t taken_n = 0;
+
+  observe("alice", "/status", TINYWOT_OPERATION_TYPE_OBSERVEPROPERTY);
+  TEST_ASSERT_EQUAL_UINT(1U, tinywot_thing_mark_dirty(&thing, "/status"));
+
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_SUCCESS, tinywot_response_pool_acquire(&pool, &held[0])
+  );
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_SUCCESS, tinywot_response_pool_acquire(&pool, &held[1])
+  );
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_ERROR_NOT_ENOUGH_MEMORY,
+    tinywot_thing_process_shared_notification(
+      &thing, &pool, taken, 4, &taken_n, &response
+    )
+  );
+  TEST_ASSERT_EQUAL_UINT(0U, reads_n);
+
+  tinywot_shared_response_release(held[1]);
+  TEST_ASSERT_EQUAL(
+    TINYWOT_STATUS_SUCCESS,
+    tinywot_thing_process_shared_notification(
+      &thing, &pool, taken, 4, &taken_n, &response
+    )
+  );
+  TEST_ASSERT_EQUAL_UINT(1U, taken_n);
+  TEST_ASSERT_EQUAL_PTR(held[1], response);
+}
+
+void setUp(void) {
+  reads_n = 0;
+  tinywot_thing_init_static(&thing, forms, sizeof(forms));
+  tinywot_thing_init_observers(&thing, observers, sizeof(observers));
+  tinywot_response_pool_init(
+    &pool, responses, sizeof(responses), buffers, sizeof(buffers)
+  );
+}
+
+void tearDown(void) {}
+
+int main(void) {
+  UNITY_BEGIN();
+
+  RUN_TEST(tinywot_response_pool_should_share_responses);
+  RUN_TEST(tinywot_thing_should_prepare_shared_notification);
+  RUN_TEST(tinywot_thing_take_notifications_should_leave_the_rest);
+  RUN_TEST(tinywot_thing_should_keep_dirty_when_pool_is_empty);
+
+  return UNITY_END();
+}